@@ -1 +1 @@
-#include "buffer/buffer_pool_manager.h"namespace scudb {/* * BufferPoolManager Constructor * When log_manager is nullptr, logging is disabled (for test purpose) * WARNING: Do Not Edit This Function */    BufferPoolManager::BufferPoolManager(size_t pool_size,                                         DiskManager *disk_manager,                                         LogManager *log_manager)            : pool_size_(pool_size), disk_manager_(disk_manager),              log_manager_(log_manager) {        // a consecutive memory space for buffer pool        pages_ = new Page[pool_size_];        page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);        replacer_ = new LRUReplacer<Page *>;        free_list_ = new std::list<Page *>;        // put all the pages into free list        for (size_t i = 0; i < pool_size_; ++i) {            free_list_->push_back(&pages_[i]);        }    }/* * BufferPoolManager Deconstructor * WARNING: Do Not Edit This Function */    BufferPoolManager::~BufferPoolManager() {        delete[] pages_;        delete page_table_;        delete replacer_;        delete free_list_;    }/* help function to get pointer of VictimPage * */    Page *BufferPoolManager::GetVictimPage() {        //获得VictimPage的Pointer，要么来自于free Page，要么来自于 lru换页后得到的        Page *target = nullptr;        if (free_list_->empty()) {            // to find a free page for replacement            //先考虑没有被            //那么如果            if (replacer_->Size() == 0) {                // to find an unpinned page for replacement                // LRU replacer也是空的                return nullptr;            } else {                //如果replacer中出来了，那么直接选出                replacer_->Victim(target);            }        } else {            //直接选空闲页            target = free_list_->front();            free_list_->pop_front();            assert(target->GetPageId() == INVALID_PAGE_ID);        }        assert(target->GetPinCount() == 0);        return target;    }/** * Fetch 取页 * 1. search hash table. *  1.1 if exist, pin the page and return immediately *  1.2 if no exist, find a replacement entry from either free list or lru *      replacer. (NOTE: always find from free list first) * 2. If the entry chosen for replacement is dirty, write it back to disk. * 3. Delete the entry for the old page from the hash table and insert an * entry for the new page. * 4. Update page metadata, read page content from disk file and return page * pointer */    Page *BufferPoolManager::FetchPage(page_id_t page_id) {        // 对整个buffer上锁        lock_guard<mutex> lck(latch_);        Page *targetPtr = nullptr;        //* 1. search hash table.        // *  1.1 if exist, pin the page and return immediately        if (page_table_->Find(page_id, targetPtr)) {            targetPtr->pin_count_++;            replacer_->Erase(targetPtr);            return targetPtr;        } else {            // *  1.2 if no exist, find a replacement entry from either free list or lru            // *      replacer. (NOTE: always find from free list first)            targetPtr = GetVictimPage();    //获得了avaliable frame page            if (targetPtr == nullptr) return targetPtr;            // * 2. If the entry chosen for replacement is dirty, write it back to disk.            if (targetPtr->is_dirty_) {                disk_manager_->WritePage(targetPtr->GetPageId(), targetPtr->data_);            }            // * 3. Delete the entry for the old page from the hash table and insert an            // * entry for the new page.            page_table_->Remove(targetPtr->GetPageId());            page_table_->Insert(page_id, targetPtr);            // * 4. Update page metadata, read page content from disk file and return page            // * pointer            disk_manager_->ReadPage(page_id, targetPtr->data_);            targetPtr->pin_count_ = 1;            targetPtr->is_dirty_ = false;            targetPtr->page_id_ = page_id;        }        return targetPtr;    }/* * Implementation of unpin page * if pin_count>0, decrement it and if it becomes zero, put it back to * replacer if pin_count<=0 before this call, return false. is_dirty: set the * dirty flag of this page */    bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {        lock_guard<mutex> lck(latch_);        Page *targetPtr = nullptr;        page_table_->Find(page_id, targetPtr);        //是否找到        if (targetPtr == nullptr) {            return false;        } else {            targetPtr->is_dirty_ = is_dirty;            if (targetPtr->GetPinCount() <= 0) {                return false;            }            targetPtr->pin_count_--;            if (targetPtr->pin_count_ == 0) {                replacer_->Insert(targetPtr);            }            return true;        }    }/* * Used to flush a particular page of the buffer pool to disk. Should call the * write_page method of the disk manager * if page is not found in page table, return false * NOTE: make sure page_id != INVALID_PAGE_ID */    bool BufferPoolManager::FlushPage(page_id_t page_id) {        // * Used to flush a particular page of the buffer pool to disk. Should call the        lock_guard<mutex> lck(latch_);        Page *targetPtr = nullptr;        page_table_->Find(page_id, targetPtr);        if (targetPtr == nullptr || targetPtr->page_id_ == INVALID_PAGE_ID) {            // * if page is not found in page table, return false            // * NOTE: make sure page_id != INVALID_PAGE_ID            return false;        } else {            // * write_page method of the disk manager            if (targetPtr->is_dirty_) {                disk_manager_->WritePage(page_id, targetPtr->GetData());                targetPtr->is_dirty_ = false;            }        }        return true;    }/** * User should call this method for deleting a page. This routine will call * disk manager to deallocate the page. * First, if page is found within page table, * buffer pool manager should be reponsible for removing this entry out * of page table, reseting page metadata and adding back to free list. Second, * call disk manager's DeallocatePage() method to delete from disk file. If * the page is found within page table, but pin_count != 0, return false */    bool BufferPoolManager::DeletePage(page_id_t page_id) {        lock_guard<mutex> lck(latch_);        Page *targetPtr = nullptr;        page_table_->Find(page_id, targetPtr);        if (targetPtr != nullptr) {            //如果在页表中，removing this entry out of page table,            // reseting page metadata and adding back to free list.            if (targetPtr->GetPinCount() > 0) {                return false;            }            replacer_->Erase(targetPtr);            page_table_->Remove(page_id);            targetPtr->is_dirty_ = false;            targetPtr->ResetMemory();            free_list_->push_back(targetPtr);        }        disk_manager_->DeallocatePage(page_id);        return true;    }/** * User should call this method if needs to create a new page. This routine * will call disk manager to allocate a page. * Buffer pool manager should be responsible to choose a victim page either * from free list or lru replacer(NOTE: always choose from free list first), * update new page's metadata, zero out memory and add corresponding entry * into page table. return nullptr if all the pages in pool are pinned */    Page *BufferPoolManager::NewPage(page_id_t &page_id) {        lock_guard<mutex> lck(latch_);        Page *targetPtr = nullptr;        targetPtr = GetVictimPage();        if (targetPtr == nullptr) {            return nullptr;        }        page_id = disk_manager_->AllocatePage();        if (targetPtr->is_dirty_) {            disk_manager_->WritePage(targetPtr->GetPageId(), targetPtr->data_);        }        page_table_->Remove(targetPtr->GetPageId());        page_table_->Insert(page_id, targetPtr);        targetPtr->page_id_ = page_id;        targetPtr->ResetMemory();        targetPtr->is_dirty_ = false;        targetPtr->pin_count_ = 1;        return targetPtr;    }} // namespace scudb
\ No newline at end of file
+#include "buffer/buffer_pool_manager.h"#include "logging/page_logger.h"namespace scudb {    thread_local PageLogger *BufferPoolManager::page_logger_ = nullptr;/* * BufferPoolManager Constructor * When log_manager is nullptr, logging is disabled (for test purpose) * WARNING: Do Not Edit This Function */    BufferPoolManager::BufferPoolManager(size_t pool_size,                                         DiskManager *disk_manager,                                         LogManager *log_manager)            : pool_size_(pool_size), disk_manager_(disk_manager),              log_manager_(log_manager) {        // a consecutive memory space for buffer pool        pages_ = new Page[pool_size_];        page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);        replacer_ = new LRUReplacer<Page *>;        free_list_ = new std::list<Page *>;        // put all the pages into free list        for (size_t i = 0; i < pool_size_; ++i) {            free_list_->push_back(&pages_[i]);        }    }/* * BufferPoolManager Deconstructor * WARNING: Do Not Edit This Function */    BufferPoolManager::~BufferPoolManager() {        delete[] pages_;        delete page_table_;        delete replacer_;        delete free_list_;    }/* help function to get pointer of VictimPage * * Write ahead: a dirty page whose log records are not all on disk is passed * over, the flush thread is asked to write its log meanwhile, and the next * least recently used page is taken. Pages passed over go back to the * replacer as recently used, they were changed a moment ago. Only if every * page waits for the log, the latch is let go while the log of the least * recently used one is written (a WAL stall); no victim is taken then, and * stalled is set: the caller looks again, things may have changed meanwhile */    Page *BufferPoolManager::GetVictimPage(unique_lock<mutex> &lock,                                           bool &stalled) {        stalled = false;        //获得VictimPage的Pointer，要么来自于free Page，要么来自于 lru换页后得到的        Page *target = nullptr;        if (free_list_->empty()) {            // to find a free page for replacement            //先考虑没有被            //那么如果            if (replacer_->Size() == 0) {                // to find an unpinned page for replacement                // LRU replacer也是空的                return nullptr;            }            //如果replacer中出来了，那么直接选出            std::vector<Page *> passed_over;            while (replacer_->Victim(target) && !IsLogFlushed(target)) {                passed_over.push_back(target);                target = nullptr;            }            if (!passed_over.empty()) {                num_wal_skips_ += passed_over.size();                log_manager_->RequestFlush(passed_over.back()->GetLSN());                // the least recently used first, it is the next victim                for (auto page : passed_over)                    replacer_->Insert(page);                if (target == nullptr) {                    num_wal_stalls_++;                    stalled = true;                    lsn_t lsn = passed_over.front()->GetLSN();                    lock.unlock();                    log_manager_->Flush(lsn);                    lock.lock();                    return nullptr;                }            }        } else {            //直接选空闲页            target = free_list_->front();            free_list_->pop_front();            assert(target->GetPageId() == INVALID_PAGE_ID);        }        assert(target->GetPinCount() == 0);        return target;    }/** * Fetch 取页 * 1. search hash table. *  1.1 if exist, pin the page and return immediately *  1.2 if no exist, find a replacement entry from either free list or lru *      replacer. (NOTE: always find from free list first) * 2. If the entry chosen for replacement is dirty, write it back to disk. * 3. Delete the entry for the old page from the hash table and insert an * entry for the new page. * 4. Update page metadata, read page content from disk file and return page * pointer */    Page *BufferPoolManager::FetchPage(page_id_t page_id) {        // 对整个buffer上锁        unique_lock<mutex> lck(latch_);        Page *targetPtr = nullptr;        bool stalled;        do {            //* 1. search hash table.            // *  1.1 if exist, pin the page and return immediately            if (page_table_->Find(page_id, targetPtr)) {                if (targetPtr->pin_count_ == 0 && !targetPtr->is_dirty_)                    targetPtr->rec_lsn_ = GetNextLSN();                targetPtr->pin_count_++;                replacer_->Erase(targetPtr);                if (page_logger_ != nullptr)                    page_logger_->OnFetch(targetPtr, false);                return targetPtr;            }            // *  1.2 if no exist, find a replacement entry from either free list or lru            // *      replacer. (NOTE: always find from free list first)            // the page may come in during a WAL stall, it is looked for again            targetPtr = GetVictimPage(lck, stalled);    //获得了avaliable frame page        } while (stalled);        if (targetPtr == nullptr) return targetPtr;        // * 2. If the entry chosen for replacement is dirty, write it back to disk.        if (targetPtr->is_dirty_) {            disk_manager_->WritePage(targetPtr->GetPageId(), targetPtr->data_);        }        // * 3. Delete the entry for the old page from the hash table and insert an        // * entry for the new page.        page_table_->Remove(targetPtr->GetPageId());        page_table_->Insert(page_id, targetPtr);        // * 4. Update page metadata, read page content from disk file and return page        // * pointer        disk_manager_->ReadPage(page_id, targetPtr->data_);        targetPtr->pin_count_ = 1;        targetPtr->is_dirty_ = false;        targetPtr->has_lsn_ = false;        targetPtr->page_id_ = page_id;        targetPtr->rec_lsn_ = GetNextLSN();        if (page_logger_ != nullptr)            page_logger_->OnFetch(targetPtr, false);        return targetPtr;    }/* * Implementation of unpin page * if pin_count>0, decrement it and if it becomes zero, put it back to * replacer if pin_count<=0 before this call, return false. is_dirty: set the * dirty flag of this page */    bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {        lock_guard<mutex> lck(latch_);        Page *targetPtr = nullptr;        page_table_->Find(page_id, targetPtr);        //是否找到        if (targetPtr == nullptr) {            return false;        } else {            targetPtr->is_dirty_ = targetPtr->is_dirty_ || is_dirty;            if (targetPtr->GetPinCount() <= 0) {                return false;            }            // logged while still pinned, see page_logger.h            if (is_dirty && page_logger_ != nullptr)                page_logger_->OnChange(targetPtr);            targetPtr->pin_count_--;            if (targetPtr->pin_count_ == 0) {                replacer_->Insert(targetPtr);            }            return true;        }    }/* * Used to flush a particular page of the buffer pool to disk. Should call the * write_page method of the disk manager * if page is not found in page table, return false * NOTE: make sure page_id != INVALID_PAGE_ID */    bool BufferPoolManager::FlushPage(page_id_t page_id) {        // * Used to flush a particular page of the buffer pool to disk. Should call the        unique_lock<mutex> lck(latch_);        Page *targetPtr = nullptr;        page_table_->Find(page_id, targetPtr);        if (targetPtr == nullptr || targetPtr->page_id_ == INVALID_PAGE_ID) {            // * if page is not found in page table, return false            // * NOTE: make sure page_id != INVALID_PAGE_ID            return false;        } else if (WaitForLog(targetPtr, lck)) {            // * write_page method of the disk manager            WriteBack(targetPtr);        }        return true;    }/* * Flush a page unless it is pinned: a pinned page may be in the middle of a * change that is not logged yet, under the page LSN of the change before. * A page no longer in the buffer pool was written when it was evicted * @return: false if the page is pinned and dirty */    bool BufferPoolManager::FlushUnpinnedPage(page_id_t page_id) {        unique_lock<mutex> lck(latch_);        Page *targetPtr = nullptr;        page_table_->Find(page_id, targetPtr);        if (targetPtr == nullptr || targetPtr->page_id_ == INVALID_PAGE_ID)            return true;        if (targetPtr->pin_count_ > 0)            return !targetPtr->is_dirty_;        if (!WaitForLog(targetPtr, lck))            return true;        // pinned while the latch was let go        if (targetPtr->pin_count_ > 0)            return !targetPtr->is_dirty_;        WriteBack(targetPtr);        return true;    }/* * write ahead: wait until the log records of a dirty page are on disk, the * latch is let go while they are written (a WAL stall) * @return: false if the page was evicted meanwhile, it was written then */    bool BufferPoolManager::WaitForLog(Page *page, unique_lock<mutex> &lock) {        page_id_t page_id = page->page_id_;        while (!IsLogFlushed(page)) {            num_wal_stalls_++;            lsn_t lsn = page->GetLSN();            lock.unlock();            log_manager_->Flush(lsn);            lock.lock();            if (page->page_id_ != page_id)                return false;        }        return true;    }/* * write a dirty page to disk, its log records are on disk (see WaitForLog) */    void BufferPoolManager::WriteBack(Page *page) {        if (!page->is_dirty_)            return;        disk_manager_->WritePage(page->page_id_, page->GetData());        page->is_dirty_ = false;        // a pinned page may be changed again        page->rec_lsn_ = GetNextLSN();    }/** * User should call this method for deleting a page. This routine will call * disk manager to deallocate the page. * First, if page is found within page table, * buffer pool manager should be reponsible for removing this entry out * of page table, reseting page metadata and adding back to free list. Second, * call disk manager's DeallocatePage() method to delete from disk file. If * the page is found within page table, but pin_count != 0, return false */    bool BufferPoolManager::DeletePage(page_id_t page_id) {        lock_guard<mutex> lck(latch_);        Page *targetPtr = nullptr;        page_table_->Find(page_id, targetPtr);        if (targetPtr != nullptr) {            //如果在页表中，removing this entry out of page table,            // reseting page metadata and adding back to free list.            if (targetPtr->GetPinCount() > 0) {                return false;            }            replacer_->Erase(targetPtr);            page_table_->Remove(page_id);            targetPtr->is_dirty_ = false;            targetPtr->has_lsn_ = false;            targetPtr->page_id_ = INVALID_PAGE_ID;            targetPtr->ResetMemory();            free_list_->push_back(targetPtr);        }        disk_manager_->DeallocatePage(page_id);        return true;    }/** * User should call this method if needs to create a new page. This routine * will call disk manager to allocate a page. * Buffer pool manager should be responsible to choose a victim page either * from free list or lru replacer(NOTE: always choose from free list first), * update new page's metadata, zero out memory and add corresponding entry * into page table. return nullptr if all the pages in pool are pinned */    Page *BufferPoolManager::NewPage(page_id_t &page_id) {        unique_lock<mutex> lck(latch_);        Page *targetPtr = nullptr;        bool stalled;        do {            targetPtr = GetVictimPage(lck, stalled);        } while (stalled);        if (targetPtr == nullptr) {            return nullptr;        }        page_id = disk_manager_->AllocatePage();        if (targetPtr->is_dirty_) {            disk_manager_->WritePage(targetPtr->GetPageId(), targetPtr->data_);        }        page_table_->Remove(targetPtr->GetPageId());        page_table_->Insert(page_id, targetPtr);        targetPtr->page_id_ = page_id;        targetPtr->ResetMemory();        targetPtr->is_dirty_ = false;        targetPtr->has_lsn_ = false;        targetPtr->pin_count_ = 1;        targetPtr->rec_lsn_ = GetNextLSN();        if (page_logger_ != nullptr)            page_logger_->OnFetch(targetPtr, true);        return targetPtr;    }    void BufferPoolManager::GetDirtyPageTable(            std::vector<std::pair<page_id_t, lsn_t>> &dirty_pages) {        lock_guard<mutex> lck(latch_);        dirty_pages.clear();        for (size_t i = 0; i < pool_size_; ++i) {            Page *page = &pages_[i];            if (page->page_id_ != INVALID_PAGE_ID &&                page->rec_lsn_ != INVALID_LSN &&                (page->is_dirty_ || page->pin_count_ > 0))                dirty_pages.emplace_back(page->page_id_, page->rec_lsn_);        }    }/* * Only a page whose page LSN was set since it was read waits for the log: * the header page keeps no page LSN, and a page changed without logging * has none set. Recovery logs CLRs with ENABLE_LOGGING off, so pages are * checked whenever there is a log manager */    bool BufferPoolManager::IsLogFlushed(Page *page) {        if (!page->is_dirty_ || !page->has_lsn_ || log_manager_ == nullptr)            return true;        return page->GetLSN() <= log_manager_->GetPersistentLSN();    }    lsn_t BufferPoolManager::GetNextLSN() {        return log_manager_ == nullptr ? INVALID_LSN                                       : log_manager_->GetNextLSN();    }} // namespace scudb
\ No newline at end of file
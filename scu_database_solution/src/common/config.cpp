@@ -4,4 +4,10 @@ namespace scudb {
   std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
   std::chrono::duration<long long int> LOG_TIMEOUT =
    std::chrono::seconds(1);
+  std::chrono::milliseconds DURABILITY_WINDOW =
+   std::chrono::milliseconds(10);
+  std::chrono::milliseconds REPLICA_POLL_INTERVAL =
+   std::chrono::milliseconds(50);
+  std::chrono::milliseconds CHECKPOINT_INTERVAL =
+   std::chrono::seconds(30);
 }
@@ -7,18 +7,173 @@
 namespace scudb {
 
 bool LockManager::LockShared(Transaction *txn, const RID &rid) {
-  return false;
+  return Lock(txn, rid, LockMode::SHARED, true);
 }
 
 bool LockManager::LockExclusive(Transaction *txn, const RID &rid) {
-  return false;
+  return Lock(txn, rid, LockMode::EXCLUSIVE, true);
 }
 
 bool LockManager::LockUpgrade(Transaction *txn, const RID &rid) {
-  return false;
+  return Upgrade(txn, rid, true);
+}
+
+bool LockManager::TryLockShared(Transaction *txn, const RID &rid) {
+  return Lock(txn, rid, LockMode::SHARED, false);
+}
+
+bool LockManager::TryLockExclusive(Transaction *txn, const RID &rid) {
+  return Lock(txn, rid, LockMode::EXCLUSIVE, false);
+}
+
+bool LockManager::TryLockUpgrade(Transaction *txn, const RID &rid) {
+  return Upgrade(txn, rid, false);
+}
+
+/*
+ * The shared lock is given up for an exclusive request queued behind the
+ * granted locks, so no other request can slip in between
+ */
+bool LockManager::Upgrade(Transaction *txn, const RID &rid, bool is_wait) {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (txn->GetState() != TransactionState::GROWING) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  auto entry = lock_table_.find(rid);
+  if (entry == lock_table_.end())
+    return false;
+  LockRequestQueue &queue = entry->second;
+  auto request = queue.requests_.begin();
+  while (request != queue.requests_.end() &&
+         request->txn_id_ != txn->GetTransactionId())
+    ++request;
+  if (request == queue.requests_.end() || !request->granted_ ||
+      request->mode_ != LockMode::SHARED)
+    return false;
+  // two upgrades of one rid would wait for each other
+  if (queue.upgrading_ ||
+      MustDie(queue, txn->GetTransactionId(), LockMode::EXCLUSIVE)) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  if (!is_wait) {
+    // granted at once only if no other lock is granted
+    for (auto &other : queue.requests_) {
+      if (other.granted_ && other.txn_id_ != txn->GetTransactionId())
+        return false;
+    }
+  }
+
+  queue.requests_.erase(request);
+  txn->GetSharedLockSet()->erase(rid);
+  auto position = queue.requests_.begin();
+  while (position != queue.requests_.end() && position->granted_)
+    ++position;
+  request = queue.requests_.emplace(position, txn->GetTransactionId(),
+                                    LockMode::EXCLUSIVE);
+  queue.upgrading_ = true;
+  queue.cv_.wait(lock, [&] { return IsCompatible(queue, request); });
+  request->granted_ = true;
+  queue.upgrading_ = false;
+  txn->GetExclusiveLockSet()->insert(rid);
+  return true;
 }
 
+/*
+ * Under strict 2PL a lock is kept until the transaction ends, an earlier
+ * unlock (a tuple deleted within the transaction) leaves it held
+ */
 bool LockManager::Unlock(Transaction *txn, const RID &rid) {
+  std::unique_lock<std::mutex> lock(latch_);
+  auto entry = lock_table_.find(rid);
+  if (entry == lock_table_.end())
+    return false;
+  LockRequestQueue &queue = entry->second;
+  auto request = queue.requests_.begin();
+  while (request != queue.requests_.end() &&
+         request->txn_id_ != txn->GetTransactionId())
+    ++request;
+  if (request == queue.requests_.end())
+    return false;
+  if (strict_2PL_ && txn->GetState() != TransactionState::COMMITTED &&
+      txn->GetState() != TransactionState::ABORTED)
+    return false;
+  if (txn->GetState() == TransactionState::GROWING)
+    txn->SetState(TransactionState::SHRINKING);
+  if (request->mode_ == LockMode::SHARED)
+    txn->GetSharedLockSet()->erase(rid);
+  else
+    txn->GetExclusiveLockSet()->erase(rid);
+  queue.requests_.erase(request);
+  if (queue.requests_.empty())
+    lock_table_.erase(entry);
+  else
+    queue.cv_.notify_all();
+  return true;
+}
+
+bool LockManager::Lock(Transaction *txn, const RID &rid, LockMode mode,
+                       bool is_wait) {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (txn->GetState() != TransactionState::GROWING) {
+    // no lock is taken once one is released
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  LockRequestQueue &queue = lock_table_[rid];
+  if (MustDie(queue, txn->GetTransactionId(), mode)) {
+    txn->SetState(TransactionState::ABORTED);
+    if (queue.requests_.empty())
+      lock_table_.erase(rid);
+    return false;
+  }
+
+  auto request = queue.requests_.emplace(queue.requests_.end(),
+                                         txn->GetTransactionId(), mode);
+  if (!is_wait && !IsCompatible(queue, request)) {
+    queue.requests_.erase(request);
+    if (queue.requests_.empty())
+      lock_table_.erase(rid);
+    return false;
+  }
+  queue.cv_.wait(lock, [&] { return IsCompatible(queue, request); });
+  request->granted_ = true;
+  if (mode == LockMode::SHARED)
+    txn->GetSharedLockSet()->insert(rid);
+  else
+    txn->GetExclusiveLockSet()->insert(rid);
+  // shared requests behind this one may be granted too
+  queue.cv_.notify_all();
+  return true;
+}
+
+/*
+ * An exclusive lock is granted at the head of the queue only, a shared lock
+ * when all the requests before it are shared ones
+ */
+bool LockManager::IsCompatible(const LockRequestQueue &queue,
+                               std::list<LockRequest>::iterator request) {
+  if (request->mode_ == LockMode::EXCLUSIVE)
+    return request == queue.requests_.begin();
+  for (auto it = queue.requests_.begin(); it != request; ++it) {
+    if (it->mode_ == LockMode::EXCLUSIVE)
+      return false;
+  }
+  return true;
+}
+
+bool LockManager::MustDie(const LockRequestQueue &queue, txn_id_t txn_id,
+                          LockMode mode) {
+  for (auto &request : queue.requests_) {
+    if (request.txn_id_ == txn_id)
+      continue;
+    bool conflict = mode == LockMode::EXCLUSIVE ||
+                    request.mode_ == LockMode::EXCLUSIVE;
+    // a younger transaction in the way is waited for
+    if (conflict && request.txn_id_ < txn_id)
+      return true;
+  }
   return false;
 }
 
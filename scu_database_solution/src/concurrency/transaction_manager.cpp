@@ -5,6 +5,7 @@
 #include "concurrency/transaction_manager.h"
 #include "table/table_heap.h"
 
+#include <algorithm>
 #include <cassert>
 namespace scudb {
 
@@ -12,9 +13,14 @@ Transaction *TransactionManager::Begin() {
   Transaction *txn = new Transaction(next_txn_id_++);
 
   if (ENABLE_LOGGING) {
-    // TODO: write log and update transaction's prev_lsn here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::BEGIN);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(log_record));
+    txn->SetBeginLSN(txn->GetPrevLSN());
   }
 
+  std::lock_guard<std::mutex> guard(active_txns_latch_);
+  active_txns_[txn->GetTransactionId()] = txn;
   return txn;
 }
 
@@ -22,19 +28,48 @@ void TransactionManager::Commit(Transaction *txn) {
   txn->SetState(TransactionState::COMMITTED);
   // truly delete before commit
   auto write_set = txn->GetWriteSet();
+  // asynchronous if asked for, or if all the tables written are
+  bool is_async = txn->IsAsyncCommit() ||
+                  (!write_set->empty() &&
+                   std::all_of(write_set->begin(), write_set->end(),
+                               [](const WriteRecord &item) {
+                                 return item.table_->IsAsyncCommit();
+                               }));
+  std::vector<std::pair<TableHeap *, page_id_t>> overflow_pages;
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto table = item.table_;
     if (item.wtype_ == WType::DELETE) {
       // this also release the lock when holding the page latch
-      table->ApplyDelete(item.rid_, txn);
+      page_id_t overflow_page_id = table->ApplyDelete(item.rid_, txn);
+      if (overflow_page_id != INVALID_PAGE_ID)
+        overflow_pages.emplace_back(table, overflow_page_id);
     }
     write_set->pop_back();
   }
   write_set->clear();
 
+  {
+    // a checkpoint sees either the transaction or its commit record
+    std::lock_guard<std::mutex> guard(active_txns_latch_);
+    if (ENABLE_LOGGING) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                           LogRecordType::COMMIT);
+      txn->SetPrevLSN(log_manager_->AppendLogRecord(log_record));
+    }
+    active_txns_.erase(txn->GetTransactionId());
+  }
+  // a page taken again is logged after the commit record
+  for (auto &entry : overflow_pages)
+    entry.first->DeleteOverflowPages(entry.second);
   if (ENABLE_LOGGING) {
-    // TODO: write log and update transaction's prev_lsn here
+    // durable before its locks are released, along with other committers.
+    // A transaction reading the changes of an asynchronous one commits
+    // after it in the log, its flush takes both
+    if (is_async)
+      log_manager_->FlushAsync(txn->GetPrevLSN());
+    else
+      log_manager_->Flush(txn->GetPrevLSN());
   }
 
   // release all the lock
@@ -53,6 +88,7 @@ void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
   // rollback before releasing lock
   auto write_set = txn->GetWriteSet();
+  std::vector<std::pair<TableHeap *, page_id_t>> overflow_pages;
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto table = item.table_;
@@ -61,7 +97,9 @@ void TransactionManager::Abort(Transaction *txn) {
       table->RollbackDelete(item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
       LOG_DEBUG("rollback insert");
-      table->ApplyDelete(item.rid_, txn);
+      page_id_t overflow_page_id = table->ApplyDelete(item.rid_, txn);
+      if (overflow_page_id != INVALID_PAGE_ID)
+        overflow_pages.emplace_back(table, overflow_page_id);
     } else if (item.wtype_ == WType::UPDATE) {
       LOG_DEBUG("rollback update");
       table->UpdateTuple(item.tuple_, item.rid_, txn);
@@ -70,9 +108,17 @@ void TransactionManager::Abort(Transaction *txn) {
   }
   write_set->clear();
 
-  if (ENABLE_LOGGING) {
-    // TODO: write log and update transaction's prev_lsn here
+  {
+    std::lock_guard<std::mutex> guard(active_txns_latch_);
+    if (ENABLE_LOGGING) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                           LogRecordType::ABORT);
+      txn->SetPrevLSN(log_manager_->AppendLogRecord(log_record));
+    }
+    active_txns_.erase(txn->GetTransactionId());
   }
+  for (auto &entry : overflow_pages)
+    entry.first->DeleteOverflowPages(entry.second);
 
   // release all the lock
   std::unordered_set<RID> lock_set;
@@ -85,4 +131,24 @@ void TransactionManager::Abort(Transaction *txn) {
     lock_manager_->Unlock(txn, locked_rid);
   }
 }
+
+void TransactionManager::GetActiveTransactionTable(
+    std::vector<std::pair<txn_id_t, lsn_t>> &active_txns) {
+  std::lock_guard<std::mutex> guard(active_txns_latch_);
+  active_txns.clear();
+  for (auto &entry : active_txns_)
+    active_txns.emplace_back(entry.first, entry.second->GetPrevLSN());
+}
+
+lsn_t TransactionManager::GetOldestBeginLSN() {
+  std::lock_guard<std::mutex> guard(active_txns_latch_);
+  lsn_t oldest_lsn = INVALID_LSN;
+  for (auto &entry : active_txns_) {
+    lsn_t begin_lsn = entry.second->GetBeginLSN();
+    if (begin_lsn != INVALID_LSN &&
+        (oldest_lsn == INVALID_LSN || begin_lsn < oldest_lsn))
+      oldest_lsn = begin_lsn;
+  }
+  return oldest_lsn;
+}
 } // namespace scudb
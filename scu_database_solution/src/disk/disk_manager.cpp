@@ -1,46 +1,49 @@
 /**
  * disk_manager.cpp
  */
+#include <algorithm>
 #include <assert.h>
 #include <cstring>
 #include <iostream>
+#include <iterator>
 #include <sys/stat.h>
 #include <thread>
+#include <unistd.h>
+#include <vector>
 
 #include "common/logger.h"
 #include "disk/disk_manager.h"
 
 namespace scudb {
 
-static char *buffer_used = nullptr;
-
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
-      flush_log_f_(nullptr) {
-  std::string::size_type n = file_name_.find(".");
+    : DiskManager(db_file, "") {}
+
+/**
+ * A follower takes the names of the log and the master record from the db
+ * file of the primary
+ */
+DiskManager::DiskManager(const std::string &db_file,
+                         const std::string &primary_db_file)
+    : primary_file_name_(primary_db_file), file_name_(db_file),
+      next_page_id_(0), num_flushes_(0), num_reads_(0), num_writes_(0),
+      flush_log_(false), flush_log_f_(nullptr), buffer_used_(nullptr) {
+  const std::string &log_db_file =
+      primary_file_name_.empty() ? file_name_ : primary_file_name_;
+  std::string::size_type n = log_db_file.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
+  log_name_ = log_db_file.substr(0, n) + ".log";
+  master_name_ = log_db_file.substr(0, n) + ".master";
+  replica_name_ = log_db_file.substr(0, n) + ".replica";
 
-  log_io_.open(log_name_,
-               std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app |
-                                std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app |
-                                std::ios::out);
-  }
+  OpenLog();
 
   db_io_.open(db_file,
               std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
@@ -53,11 +56,14 @@ DiskManager::DiskManager(const std::string &db_file)
     // reopen with original mode
     db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   }
+  // pages of the file are taken
+  next_page_id_ = std::max(GetFileSize(file_name_), 0) / PAGE_SIZE;
 }
 
 DiskManager::~DiskManager() {
   db_io_.close();
-  log_io_.close();
+  for (auto &segment : log_segments_)
+    segment->close();
 }
 
 /**
@@ -65,6 +71,7 @@ DiskManager::~DiskManager() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = page_id * PAGE_SIZE;
+  num_writes_ += 1;
   // set write cursor to offset
   db_io_.seekp(offset);
   db_io_.write(page_data, PAGE_SIZE);
@@ -82,10 +89,13 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   int offset = page_id * PAGE_SIZE;
+  num_reads_ += 1;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error while reading");
     // std::cerr << "I/O error while reading" << std::endl;
+    // a page allocated but never written, recovery may redo it
+    memset(page_data, 0, PAGE_SIZE);
   } else {
     // set read cursor to offset
     db_io_.seekp(offset);
@@ -96,6 +106,9 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
       LOG_DEBUG("Read less than a page");
       // std::cerr << "Read less than a page" << std::endl;
       memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      // the stream is failed at end of file, later pages are read or
+      // written through it
+      db_io_.clear();
     }
   }
 }
@@ -103,11 +116,13 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
+ * The log goes on into the next segment when one is full; the end of log
+ * in the header of a segment is moved after the data is written
  */
 void DiskManager::WriteLog(char *log_data, int size) {
   // enforce swap log buffer
-  assert(log_data != buffer_used);
-  buffer_used = log_data;
+  assert(log_data != buffer_used_);
+  buffer_used_ = log_data;
 
   if (size == 0) // no effect on num_flushes_ if log buffer is empty
     return;
@@ -120,54 +135,224 @@ void DiskManager::WriteLog(char *log_data, int size) {
            std::future_status::ready);
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  std::lock_guard<std::mutex> guard(log_latch_);
+  while (size > 0) {
+    if (live_segments_.empty() ||
+        live_segments_.rbegin()->first + LOG_SEGMENT_SIZE == log_end_)
+      AddLogSegment(log_end_);
+    lsn_t start_lsn = live_segments_.rbegin()->first;
+    std::fstream &log_io = *log_segments_[live_segments_.rbegin()->second];
+    int count = std::min<lsn_t>(size, start_lsn + LOG_SEGMENT_SIZE - log_end_);
+    // sequence write
+    log_io.seekp(LOG_SEGMENT_HEADER_SIZE + log_end_ - start_lsn);
+    log_io.write(log_data, count);
+    log_end_ += count;
+    log_io.seekp(2 * sizeof(lsn_t));
+    log_io.write(reinterpret_cast<char *>(&log_end_), sizeof(lsn_t));
+    // check for I/O error
+    if (log_io.bad()) {
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    // needs to flush to keep disk file in sync
+    log_io.flush();
+    log_data += count;
+    size -= count;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
   flush_log_ = false;
 }
 
 /**
- * Read the contents of the log into the given memory area
- * Always read from the beginning and perform sequence read
- * @return: false means already reach the end
+ * Read the contents of the log into the given memory area, from the segments
+ * holding the bytes from offset on; bytes past the end of log read as 0
+ * @return: false means offset is not in the log, already truncated or
+ * beyond the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
+bool DiskManager::ReadLog(char *log_data, int size, lsn_t offset) {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  if (offset < log_start_ || offset >= log_end_) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+  int count = std::min<lsn_t>(size, log_end_ - offset);
+  memset(log_data + count, 0, size - count);
+  auto it = std::prev(live_segments_.upper_bound(offset));
+  while (count > 0) {
+    std::fstream &log_io = *log_segments_[it->second];
+    int read_count =
+        std::min<lsn_t>(count, it->first + LOG_SEGMENT_SIZE - offset);
+    log_io.seekg(LOG_SEGMENT_HEADER_SIZE + offset - it->first);
+    log_io.read(log_data, read_count);
+    if (log_io.gcount() < read_count) {
+      log_io.clear();
+      LOG_DEBUG("I/O error while reading log");
+    }
+    log_data += read_count;
+    offset += read_count;
+    count -= read_count;
+    ++it;
   }
-
   return true;
 }
 
+/**
+ * Returns lsn of the end of log, one past its last byte
+ */
+lsn_t DiskManager::GetLogSize() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  return log_end_;
+}
+
+lsn_t DiskManager::GetLogStart() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  return log_start_;
+}
+
+/**
+ * Segments wholly before lsn are free for reuse, the last segment is kept
+ * so that the log goes on from its end
+ */
+void DiskManager::TruncateLog(lsn_t lsn) {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  while (live_segments_.size() > 1 &&
+         live_segments_.begin()->first + LOG_SEGMENT_SIZE <= lsn) {
+    int index = live_segments_.begin()->second;
+    WriteLogSegmentHeader(index, INVALID_LSN, INVALID_LSN);
+    free_segments_.push_back(index);
+    live_segments_.erase(live_segments_.begin());
+  }
+  if (!live_segments_.empty())
+    log_start_ = live_segments_.begin()->first;
+}
+
+int DiskManager::GetLogSegmentCount() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  return log_segments_.size();
+}
+
+/**
+ * The master record is replaced as a whole, after the checkpoint it points
+ * to is on disk
+ */
+void DiskManager::WriteMasterRecord(lsn_t checkpoint_lsn) {
+  std::ofstream master_io(master_name_, std::ios::binary | std::ios::trunc);
+  master_io.write(reinterpret_cast<const char *>(&checkpoint_lsn),
+                  sizeof(lsn_t));
+  master_io.flush();
+  if (master_io.bad()) {
+    LOG_DEBUG("I/O error while writing master record");
+  }
+}
+
+lsn_t DiskManager::ReadMasterRecord() {
+  std::ifstream master_io(master_name_, std::ios::binary);
+  lsn_t checkpoint_lsn = INVALID_LSN;
+  if (!master_io.read(reinterpret_cast<char *>(&checkpoint_lsn),
+                      sizeof(lsn_t)))
+    return INVALID_LSN;
+  return checkpoint_lsn;
+}
+
+/**
+ * The slot is replaced by a rename, a primary in another process never
+ * reads it half written
+ */
+void DiskManager::WriteReplicaLSN(lsn_t lsn) {
+  if (lsn == INVALID_LSN) {
+    remove(replica_name_.c_str());
+    return;
+  }
+  std::string temp_name = replica_name_ + ".tmp";
+  {
+    std::ofstream replica_io(temp_name, std::ios::binary | std::ios::trunc);
+    replica_io.write(reinterpret_cast<const char *>(&lsn), sizeof(lsn_t));
+    replica_io.flush();
+    if (replica_io.bad()) {
+      LOG_DEBUG("I/O error while writing replica slot");
+      return;
+    }
+  }
+  if (rename(temp_name.c_str(), replica_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing replica slot");
+  }
+}
+
+lsn_t DiskManager::ReadReplicaLSN() {
+  std::ifstream replica_io(replica_name_, std::ios::binary);
+  lsn_t lsn = INVALID_LSN;
+  if (!replica_io.read(reinterpret_cast<char *>(&lsn), sizeof(lsn_t)))
+    return INVALID_LSN;
+  return lsn;
+}
+
+void DiskManager::RefreshLog() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  ReadLogSegmentHeaders();
+}
+
+/**
+ * The copy is fuzzy, the primary writes pages meanwhile: no page is newer
+ * than the log written by the end of the copy, redo brings the others up to
+ * date
+ */
+void DiskManager::CopyPrimaryPages() {
+  std::ifstream primary_io(primary_file_name_, std::ios::binary);
+  db_io_.flush();
+  if (truncate(file_name_.c_str(), 0) != 0) {
+    LOG_DEBUG("I/O error while truncating");
+  }
+  db_io_.seekp(0);
+  if (primary_io.peek() != std::ifstream::traits_type::eof())
+    db_io_ << primary_io.rdbuf();
+  db_io_.flush();
+  db_io_.clear();
+  std::lock_guard<std::mutex> guard(free_pages_latch_);
+  free_pages_.clear();
+  next_page_id_ = std::max(GetFileSize(file_name_), 0) / PAGE_SIZE;
+}
+
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuse the lowest deallocated page, otherwise keep an increasing counter
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() {
+  std::lock_guard<std::mutex> guard(free_pages_latch_);
+  if (!free_pages_.empty()) {
+    page_id_t page_id = *free_pages_.begin();
+    free_pages_.erase(free_pages_.begin());
+    return page_id;
+  }
+  return next_page_id_++;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * Free pages at the end of file are cut off the file, the others are kept in
+ * memory for reuse. Need bitmap in header page to track them across restart
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  return;
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(free_pages_latch_);
+  free_pages_.insert(page_id);
+  int file_size = GetFileSize(file_name_);
+  page_id_t end_page_id = std::max((page_id_t)next_page_id_,
+                                   (page_id_t)(file_size / PAGE_SIZE));
+  while (end_page_id > 0 && free_pages_.erase(end_page_id - 1) > 0)
+    end_page_id--;
+  if (end_page_id < next_page_id_)
+    next_page_id_ = end_page_id;
+  if (file_size > end_page_id * PAGE_SIZE) {
+    db_io_.flush();
+    if (truncate(file_name_.c_str(), end_page_id * PAGE_SIZE) != 0) {
+      LOG_DEBUG("I/O error while truncating");
+    }
+  }
+}
+
+void DiskManager::ReservePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(free_pages_latch_);
+  free_pages_.erase(page_id);
+  if (page_id >= next_page_id_)
+    next_page_id_ = page_id + 1;
 }
 
 /**
@@ -175,11 +360,100 @@ void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
  */
 int DiskManager::GetNumFlushes() const { return num_flushes_; }
 
+/**
+ * Returns number of pages read/written so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+int DiskManager::GetNumWrites() const { return num_writes_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Segment i of the log is file <log name>.i, segment 0 is the log name
+ * itself. The live segments, and the end of log, are found from the
+ * segment headers. Segment files are created on the first write, a missing
+ * segment 0 is an empty log
+ */
+void DiskManager::OpenLog() {
+  if (GetFileSize(log_name_) < 0 && primary_file_name_.empty()) {
+    // leftover segments of a log removed before
+    for (int i = 1; GetFileSize(GetLogSegmentName(i)) >= 0; i++)
+      remove(GetLogSegmentName(i).c_str());
+  }
+  ReadLogSegmentHeaders();
+}
+
+/**
+ * A follower opens the segment files read-only, the new ones when it reads
+ * the headers again
+ */
+void DiskManager::ReadLogSegmentHeaders() {
+  log_start_ = 0;
+  log_end_ = 0;
+  live_segments_.clear();
+  free_segments_.clear();
+  if (GetFileSize(log_name_) < 0)
+    return;
+  std::ios::openmode mode = std::ios::binary | std::ios::in;
+  if (primary_file_name_.empty())
+    mode |= std::ios::out;
+  for (int i = 0; GetFileSize(GetLogSegmentName(i)) >= 0; i++) {
+    if (i == (int)log_segments_.size())
+      log_segments_.emplace_back(
+          new std::fstream(GetLogSegmentName(i), mode));
+    lsn_t header[3] = {0, INVALID_LSN, INVALID_LSN};
+    log_segments_[i]->seekg(0);
+    log_segments_[i]->read(reinterpret_cast<char *>(header), sizeof(header));
+    log_segments_[i]->clear();
+    if (header[0] == LOG_SEGMENT_MAGIC && header[1] != INVALID_LSN) {
+      live_segments_[header[1]] = i;
+      log_end_ = std::max(log_end_, header[2]);
+    } else {
+      free_segments_.push_back(i);
+    }
+  }
+  if (!live_segments_.empty())
+    log_start_ = live_segments_.begin()->first;
+}
+
+std::string DiskManager::GetLogSegmentName(int index) {
+  return index == 0 ? log_name_ : log_name_ + "." + std::to_string(index);
+}
+
+/**
+ * A free segment is reused, only its header is written: the old records
+ * left in it are past the end of log. A new segment file is written out to
+ * its full size at once, later writes don't grow the file
+ */
+void DiskManager::AddLogSegment(lsn_t start_lsn) {
+  int index;
+  if (!free_segments_.empty()) {
+    index = free_segments_.back();
+    free_segments_.pop_back();
+  } else {
+    index = log_segments_.size();
+    log_segments_.emplace_back(new std::fstream(
+        GetLogSegmentName(index),
+        std::ios::binary | std::ios::trunc | std::ios::in | std::ios::out));
+    std::vector<char> zeros(LOG_SEGMENT_HEADER_SIZE + LOG_SEGMENT_SIZE, 0);
+    log_segments_[index]->write(zeros.data(), zeros.size());
+  }
+  WriteLogSegmentHeader(index, start_lsn, start_lsn);
+  live_segments_[start_lsn] = index;
+}
+
+void DiskManager::WriteLogSegmentHeader(int index, lsn_t start_lsn,
+                                        lsn_t end_lsn) {
+  lsn_t header[3] = {LOG_SEGMENT_MAGIC, start_lsn, end_lsn};
+  log_segments_[index]->seekp(0);
+  log_segments_[index]->write(reinterpret_cast<char *>(header),
+                              sizeof(header));
+  log_segments_[index]->flush();
+}
+
 /**
  * Private helper function to get disk file size
  */
@@ -8,8 +8,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "disk/disk_manager.h"
@@ -18,6 +21,8 @@
 #include "page/page.h"
 
 namespace scudb {
+    class PageLogger;
+
     class BufferPoolManager {
     public:
         BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
@@ -31,10 +36,31 @@ namespace scudb {
 
         bool FlushPage(page_id_t page_id);
 
+        // flush a page that is not pinned, for checkpoints
+        // @return: false if the page is pinned and dirty
+        bool FlushUnpinnedPage(page_id_t page_id);
+
         Page *NewPage(page_id_t &page_id);
 
         bool DeletePage(page_id_t page_id);
 
+        // recLSN of the pages that may have changes not on disk, pinned
+        // pages included
+        void GetDirtyPageTable(
+                std::vector<std::pair<page_id_t, lsn_t>> &dirty_pages);
+
+        // victims passed over because their log was not on disk, and page
+        // writes that waited for the log
+        inline int GetNumWALSkips() const { return num_wal_skips_; }
+        inline int GetNumWALStalls() const { return num_wal_stalls_; }
+
+        // the pages this thread fetches and unpins dirty are shown to
+        // page_logger (see page_logger.h), nullptr to stop
+        static inline void SetPageLogger(PageLogger *page_logger) {
+            page_logger_ = page_logger;
+        }
+        static inline PageLogger *GetPageLogger() { return page_logger_; }
+
     private:
         size_t pool_size_; // number of pages in buffer pool
         Page *pages_;      // array of pages
@@ -44,6 +70,18 @@ namespace scudb {
         Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
         std::list<Page *> *free_list_; // to find a free page for replacement
         std::mutex latch_;             // to protect shared data structure
-        Page *GetVictimPage();        // to get pointer of victim Page
+        // to get pointer of victim Page, none if the latch was let go for
+        // a WAL stall (stalled set)
+        Page *GetVictimPage(std::unique_lock<std::mutex> &lock, bool &stalled);
+        // to wait for the log of a dirty page, false if it was evicted
+        bool WaitForLog(Page *page, std::unique_lock<std::mutex> &lock);
+        void WriteBack(Page *page);   // to write a dirty page, log on disk
+        // the log records of a dirty page are all on disk
+        bool IsLogFlushed(Page *page);
+        std::atomic<int> num_wal_skips_{0};
+        std::atomic<int> num_wal_stalls_{0};
+        // lsn that no change made from now on goes below
+        lsn_t GetNextLSN();
+        static thread_local PageLogger *page_logger_;
     };
 } // namespace scudb
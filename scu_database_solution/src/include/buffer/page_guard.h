@@ -0,0 +1,67 @@
+/**
+ * page_guard.h
+ *
+ * RAII guard of a page read from the buffer pool: the page is pinned and
+ * read latched for the lifetime of the guard, so that pointers into its
+ * frame stay valid. Guards are movable but not copyable.
+ */
+
+#pragma once
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace scudb {
+
+class ReadPageGuard {
+public:
+  ReadPageGuard() = default;
+
+  // fetch and read latch a page, the guard is empty if all pages are pinned
+  ReadPageGuard(BufferPoolManager *buffer_pool_manager, page_id_t page_id)
+      : buffer_pool_manager_(buffer_pool_manager),
+        page_(buffer_pool_manager->FetchPage(page_id)) {
+    if (page_ != nullptr)
+      page_->RLatch();
+  }
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+
+  ReadPageGuard(ReadPageGuard &&other)
+      : buffer_pool_manager_(other.buffer_pool_manager_), page_(other.page_) {
+    other.page_ = nullptr;
+  }
+
+  ReadPageGuard &operator=(ReadPageGuard &&other) {
+    if (this != &other) {
+      Release();
+      buffer_pool_manager_ = other.buffer_pool_manager_;
+      page_ = other.page_;
+      other.page_ = nullptr;
+    }
+    return *this;
+  }
+
+  ~ReadPageGuard() { Release(); }
+
+  // unlatch and unpin the page early
+  inline void Release() {
+    if (page_ == nullptr)
+      return;
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+
+  inline bool IsValid() const { return page_ != nullptr; }
+
+  template <typename PageType> inline PageType *As() const {
+    return static_cast<PageType *>(page_);
+  }
+
+private:
+  BufferPoolManager *buffer_pool_manager_ = nullptr;
+  Page *page_ = nullptr;
+};
+
+} // namespace scudb
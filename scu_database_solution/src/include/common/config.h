@@ -14,6 +14,16 @@ namespace scudb {
 
 extern std::chrono::duration<long long int> LOG_TIMEOUT;
 
+// the log of an asynchronous commit is written out at most this long after
+// the commit returns
+extern std::chrono::milliseconds DURABILITY_WINDOW;
+
+// a replica looks for new log of its primary this often
+extern std::chrono::milliseconds REPLICA_POLL_INTERVAL;
+
+// the virtual table takes a checkpoint this often
+extern std::chrono::milliseconds CHECKPOINT_INTERVAL;
+
 extern std::atomic<bool> ENABLE_LOGGING;
 
 #define INVALID_PAGE_ID -1 // representing an invalid page id
@@ -23,11 +33,16 @@ extern std::atomic<bool> ENABLE_LOGGING;
 #define PAGE_SIZE 512     // size of a data page in byte
 #define LOG_BUFFER_SIZE                                                            \
   ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
+#define LOG_SEGMENT_SIZE                                                           \
+  (16 * LOG_BUFFER_SIZE)               // size of a log segment in byte
+#define LOG_SEGMENT_HEADER_SIZE 24     // header of a log segment file
+#define LOG_SEGMENT_MAGIC 0x4c4f4753   // marks a log segment in use
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
 #define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define MAX_KEY_SIZE 64                // size of the largest index key
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
-typedef int32_t lsn_t;     // log sequence number type
+typedef int64_t lsn_t;     // log sequence number type
 
 } // namespace scudb
\ No newline at end of file
@@ -32,6 +32,12 @@ public:
     RTrim(s);
   }
 
+  // whether s begins with prefix
+  static inline bool StartsWith(const std::string &s,
+                                const std::string &prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+  }
+
   static std::vector<std::string> Split(const std::string &s, char delim) {
     std::stringstream ss;
     std::vector<std::string> elems;
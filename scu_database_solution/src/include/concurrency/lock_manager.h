@@ -32,13 +32,51 @@ public:
   bool LockExclusive(Transaction *txn, const RID &rid);
   bool LockUpgrade(Transaction *txn, const RID &rid);
 
+  // as above, but never blocked: return false if the lock is not granted
+  // at once. The transaction is aborted only if it must die, so a page
+  // latch holder can let go of the latch and wait for the lock instead
+  bool TryLockShared(Transaction *txn, const RID &rid);
+  bool TryLockExclusive(Transaction *txn, const RID &rid);
+  bool TryLockUpgrade(Transaction *txn, const RID &rid);
+
   // unlock:
   // release the lock hold by the txn
   bool Unlock(Transaction *txn, const RID &rid);
   /*** END OF APIs ***/
 
 private:
+  enum class LockMode { SHARED = 0, EXCLUSIVE };
+
+  struct LockRequest {
+    LockRequest(txn_id_t txn_id, LockMode mode)
+        : txn_id_(txn_id), mode_(mode), granted_(false) {}
+    txn_id_t txn_id_;
+    LockMode mode_;
+    bool granted_;
+  };
+
+  // requests on one rid in arrival order, granted ones first
+  struct LockRequestQueue {
+    std::list<LockRequest> requests_;
+    std::condition_variable cv_;
+    // a granted shared lock is being upgraded
+    bool upgrading_ = false;
+  };
+
+  // queue the request and wait until it is granted, or die if an older
+  // transaction is in the way. Without is_wait a request that is not
+  // granted at once is taken back
+  bool Lock(Transaction *txn, const RID &rid, LockMode mode, bool is_wait);
+  bool Upgrade(Transaction *txn, const RID &rid, bool is_wait);
+  // the request can be granted in its place in the queue
+  bool IsCompatible(const LockRequestQueue &queue,
+                    std::list<LockRequest>::iterator request);
+  // wait-die: only an older transaction waits for a younger one
+  bool MustDie(const LockRequestQueue &queue, txn_id_t txn_id, LockMode mode);
+
   bool strict_2PL_;
+  std::mutex latch_;
+  std::unordered_map<RID, LockRequestQueue> lock_table_;
 };
 
 } // namespace scudb
@@ -52,7 +52,8 @@ public:
   Transaction(txn_id_t txn_id)
       : state_(TransactionState::GROWING),
         thread_id_(std::this_thread::get_id()),
-        txn_id_(txn_id), prev_lsn_(INVALID_LSN), shared_lock_set_{new std::unordered_set<RID>},
+        txn_id_(txn_id), prev_lsn_(INVALID_LSN), begin_lsn_(INVALID_LSN),
+        is_async_commit_(false), shared_lock_set_{new std::unordered_set<RID>},
         exclusive_lock_set_{new std::unordered_set<RID>} {
     // initialize sets
     write_set_.reset(new std::deque<WriteRecord>);
@@ -101,6 +102,16 @@ public:
 
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  inline lsn_t GetBeginLSN() { return begin_lsn_; }
+
+  inline void SetBeginLSN(lsn_t begin_lsn) { begin_lsn_ = begin_lsn; }
+
+  inline bool IsAsyncCommit() { return is_async_commit_; }
+
+  inline void SetAsyncCommit(bool is_async_commit) {
+    is_async_commit_ = is_async_commit;
+  }
+
 private:
   TransactionState state_;
   // thread id, single-threaded transactions
@@ -109,8 +120,12 @@ private:
   txn_id_t txn_id_;
   // Below are used by transaction, undo set
   std::shared_ptr<std::deque<WriteRecord>> write_set_;
-  // prev lsn
-  lsn_t prev_lsn_;
+  // prev lsn, read by checkpoints of other threads
+  std::atomic<lsn_t> prev_lsn_;
+  // lsn of the BEGIN record, undo may go back to it
+  lsn_t begin_lsn_;
+  // commit returns before the commit record is on disk, see log_manager.h
+  bool is_async_commit_;
 
   // Below are used by concurrent index
   // this deque contains page pointer that was latche during index operation
@@ -5,7 +5,11 @@
 
 #pragma once
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -22,8 +26,18 @@ public:
   void Commit(Transaction *txn);
   void Abort(Transaction *txn);
 
+  // transactions begun and not yet committed or aborted, with the lsn of
+  // their last record
+  void GetActiveTransactionTable(
+      std::vector<std::pair<txn_id_t, lsn_t>> &active_txns);
+  // lsn of the oldest BEGIN record of the active transactions,
+  // INVALID_LSN if there is none
+  lsn_t GetOldestBeginLSN();
+
 private:
   std::atomic<txn_id_t> next_txn_id_;
+  std::unordered_map<txn_id_t, Transaction *> active_txns_;
+  std::mutex active_txns_latch_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
 };
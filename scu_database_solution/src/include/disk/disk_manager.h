@@ -5,13 +5,34 @@
  * database. It also performs read and write of pages to and from disk, and
  * provides a logical file layer within the context of a database management
  * system.
+ *
+ * The log is split into segment files of LOG_SEGMENT_SIZE bytes, each with
+ * a header:
+ *  ------------------------------------------------------------
+ * | LOG_SEGMENT_MAGIC (8) | StartLSN (8) | EndLSN (8) | log ... |
+ *  ------------------------------------------------------------
+ * A segment holds the log from StartLSN on, up to EndLSN (exclusive) in the
+ * last one. Segments before a checkpoint no longer needed by recovery are
+ * truncated: their StartLSN is set to INVALID_LSN and they are reused for
+ * the log to come.
+ *
+ * A disk manager may follow the log of another one, the primary, as a
+ * replica does (see log_replica.h): its pages are its own, its log and
+ * master record are the primary's, opened read-only. The primary may be
+ * another process, the follower sees the log it writes when reading the
+ * segment headers again.
  */
 
 #pragma once
 #include <atomic>
 #include <fstream>
 #include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 
@@ -20,34 +41,90 @@ namespace scudb {
 class DiskManager {
 public:
   DiskManager(const std::string &db_file);
+  // follow the log of the primary with db file primary_db_file
+  DiskManager(const std::string &db_file, const std::string &primary_db_file);
   ~DiskManager();
 
   void WritePage(page_id_t page_id, const char *page_data);
   void ReadPage(page_id_t page_id, char *page_data);
 
   void WriteLog(char *log_data, int size);
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, lsn_t offset);
+  // lsn of the end of log, and of the oldest byte not truncated
+  lsn_t GetLogSize();
+  lsn_t GetLogStart();
+  // free the segments holding only the log before lsn
+  void TruncateLog(lsn_t lsn);
+  // segment files, live or free
+  int GetLogSegmentCount();
+
+  // lsn of the begin record of the last complete checkpoint, kept in a
+  // file of its own (the master record), INVALID_LSN if there is none
+  void WriteMasterRecord(lsn_t checkpoint_lsn);
+  lsn_t ReadMasterRecord();
+
+  // lsn a replica reads the log from, kept in a file of its own (the
+  // replica slot): the log from there on is not truncated. INVALID_LSN
+  // removes the slot, and is read if there is none
+  void WriteReplicaLSN(lsn_t lsn);
+  lsn_t ReadReplicaLSN();
+
+  // follower: read the segment headers again, for the log the primary
+  // wrote since
+  void RefreshLog();
+  // follower: replace the pages with a copy of the primary's db file
+  void CopyPrimaryPages();
 
   page_id_t AllocatePage();
   void DeallocatePage(page_id_t page_id);
+  // a page allocated before restart, found by recovery in the log, is not
+  // handed out again
+  void ReservePage(page_id_t page_id);
 
   int GetNumFlushes() const;
+  int GetNumReads() const;
+  int GetNumWrites() const;
   bool GetFlushState() const;
   inline void SetFlushLogFuture(std::future<void> *f) { flush_log_f_ = f; }
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
 private:
   int GetFileSize(const std::string &name);
-  // stream to write log file
-  std::fstream log_io_;
+  void OpenLog();
+  // find the live segments and the end of log from the segment headers
+  void ReadLogSegmentHeaders();
+  std::string GetLogSegmentName(int index);
+  // make a segment, a free one if any, hold the log from start_lsn on
+  void AddLogSegment(lsn_t start_lsn);
+  void WriteLogSegmentHeader(int index, lsn_t start_lsn, lsn_t end_lsn);
+  // streams of the log segment files, by index
+  std::vector<std::unique_ptr<std::fstream>> log_segments_;
+  // start lsn -> index of the live segments
+  std::map<lsn_t, int> live_segments_;
+  std::vector<int> free_segments_;
+  lsn_t log_start_;
+  lsn_t log_end_;
+  std::mutex log_latch_;
   std::string log_name_;
+  std::string master_name_;
+  std::string replica_name_;
+  // db file of the primary if this disk manager follows its log
+  std::string primary_file_name_;
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
   std::atomic<page_id_t> next_page_id_;
+  // deallocated pages, handed out again before the file grows. Kept in
+  // memory only, they are lost (not reused) after restart
+  std::set<page_id_t> free_pages_;
+  std::mutex free_pages_latch_;
   int num_flushes_;
+  std::atomic<int> num_reads_;
+  std::atomic<int> num_writes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
+  // log buffer of the last write, the next one must come from the other
+  char *buffer_used_;
 };
 
 } // namespace scudb
\ No newline at end of file
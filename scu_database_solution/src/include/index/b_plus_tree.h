@@ -7,12 +7,16 @@
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * With a log manager, the pages changed by an insert, remove or update are
+ * logged, see logging/page_logger.h.
  */
 #pragma once
 
 #include <queue>
+#include <utility>
 #include <vector>
 
+#include "common/rwmutex.h"
 #include "concurrency/transaction.h"
 #include "index/index_iterator.h"
 #include "page/b_plus_tree_internal_page.h"
@@ -28,7 +32,8 @@ public:
   explicit BPlusTree(const std::string &name,
                            BufferPoolManager *buffer_pool_manager,
                            const KeyComparator &comparator,
-                           page_id_t root_page_id = INVALID_PAGE_ID);
+                           page_id_t root_page_id = INVALID_PAGE_ID,
+                           LogManager *log_manager = nullptr);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -37,6 +42,12 @@ public:
   bool Insert(const KeyType &key, const ValueType &value,
               Transaction *transaction = nullptr);
 
+  // Insert key-value pairs sorted by key, inserted[i] tells whether the i-th
+  // pair went in (false for a duplicate key)
+  void InsertBatch(const std::vector<std::pair<KeyType, ValueType>> &items,
+                   std::vector<bool> &inserted,
+                   Transaction *transaction = nullptr);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
@@ -44,6 +55,10 @@ public:
   bool GetValue(const KeyType &key, std::vector<ValueType> &result,
                 Transaction *transaction = nullptr);
 
+  // replace the value associated with an existing key
+  bool Update(const KeyType &key, const ValueType &value,
+              Transaction *transaction = nullptr);
+
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
@@ -65,6 +80,12 @@ public:
 private:
   void StartNewTree(const KeyType &key, const ValueType &value);
 
+  // also return the separator key above the leaf, keys not less than it
+  // belong to leaves on the right
+  B_PLUS_TREE_LEAF_PAGE_TYPE *FindLeafPage(const KeyType &key,
+                                           KeyType &high_key,
+                                           bool &has_high_key);
+
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value,
                       Transaction *transaction = nullptr);
 
@@ -94,6 +115,10 @@ private:
   page_id_t root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
+  // nullptr if changes are not logged
+  LogManager *log_manager_;
+  // tree latch, readers share it and writers hold it exclusively
+  RWMutex latch_;
 };
 
 } // namespace scudb
@@ -8,8 +8,10 @@
 #include <string>
 #include <vector>
 
+#include "common/rwmutex.h"
 #include "index/b_plus_tree.h"
 #include "index/index.h"
+#include "index/posting_list.h"
 
 namespace scudb {
 
@@ -19,26 +21,49 @@ INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
 
 public:
+  // with a log manager, changes of the tree and the posting lists are logged
   BPlusTreeIndex(IndexMetadata *metadata,
                  BufferPoolManager *buffer_pool_manager,
-                 page_id_t root_page_id = INVALID_PAGE_ID);
+                 page_id_t root_page_id = INVALID_PAGE_ID,
+                 LogManager *log_manager = nullptr);
 
   ~BPlusTreeIndex() {}
 
   void InsertEntry(const Tuple &key, RID rid,
                    Transaction *transaction = nullptr) override;
 
-  void DeleteEntry(const Tuple &key,
+  // entries are sorted by key and go into the tree leaf by leaf
+  void InsertEntries(const std::vector<Tuple> &keys,
+                     const std::vector<RID> &rids,
+                     Transaction *transaction = nullptr) override;
+
+  void DeleteEntry(const Tuple &key, RID rid,
                    Transaction *transaction = nullptr) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> &result,
                Transaction *transaction = nullptr) override;
 
+  void ScanRange(const Tuple *low_key, const Tuple *high_key,
+                 std::vector<RID> &result,
+                 std::vector<std::vector<Value>> *entries = nullptr,
+                 Transaction *transaction = nullptr) override;
+
 protected:
+  // add rid to a key of a non-unique index, caller holds latch_
+  void InsertNonUnique(const KeyType &key, RID rid, Transaction *transaction);
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // posting lists of a non-unique index
+  PostingList posting_list_;
+  // a change of a non-unique index is logged as one operation
+  LogManager *log_manager_;
+  // writers hold this latch, range scans share it. A non-unique index reads
+  // a leaf value and then modifies the posting list it points to, the two
+  // steps stay atomic; a range scan keeps its leaves alive
+  RWMutex latch_;
 };
 
 } // namespace scudb
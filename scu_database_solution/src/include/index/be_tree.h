@@ -0,0 +1,109 @@
+/**
+ * be_tree.h
+ *
+ * Write optimized B-epsilon tree. Internal nodes keep a buffer of pending
+ * insert/delete messages besides pivots. An update is appended to the root
+ * buffer; when a buffer overflows, the messages of the child that has the
+ * most of them are moved down in one batch, so a leaf is read and written
+ * once per batch instead of once per update.
+ * (1) We only support unique key, inserting an existing key overwrites it
+ * (2) A query merges the messages met on its way down, newest first
+ * (3) Leaves split when they overflow, but are not merged after deletion
+ */
+#pragma once
+
+#include <vector>
+
+#include "common/rwmutex.h"
+#include "concurrency/transaction.h"
+#include "page/be_tree_page.h"
+
+namespace scudb {
+
+#define BETREE_TYPE BETree<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BETree {
+public:
+  explicit BETree(const std::string &name,
+                  BufferPoolManager *buffer_pool_manager,
+                  const KeyComparator &comparator,
+                  page_id_t root_page_id = INVALID_PAGE_ID,
+                  LogManager *log_manager = nullptr);
+
+  // Returns true if this tree has never been inserted into.
+  bool IsEmpty() const;
+
+  // Insert (or overwrite) a key-value pair.
+  void Insert(const KeyType &key, const ValueType &value,
+              Transaction *transaction = nullptr);
+
+  // Remove a key and its value.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result,
+                Transaction *transaction = nullptr);
+
+  // all the key-value pairs between low_key and high_key (inclusive, nullptr
+  // for no bound) in key order
+  void GetRange(const KeyType *low_key, const KeyType *high_key,
+                std::vector<MappingType> &result,
+                Transaction *transaction = nullptr);
+
+private:
+  typedef std::pair<KeyType, page_id_t> ChildType;
+
+  void Upsert(const BETreeMessageType &message);
+
+  // apply messages (in arrival order) to the subtree rooted at page_id
+  // @return: pivot & page id of the new right siblings if the node split
+  std::vector<ChildType> Apply(page_id_t page_id,
+                               std::vector<BETreeMessageType> &messages);
+
+  std::vector<ChildType> ApplyToLeaf(BETREE_PAGE_TYPE *node,
+                                     std::vector<BETreeMessageType> &messages);
+
+  std::vector<ChildType>
+  ApplyToInternal(BETREE_PAGE_TYPE *node,
+                  std::vector<BETreeMessageType> &messages);
+
+  // split children (and messages headed to them) into as many nodes as
+  // needed, the first part stays in node
+  std::vector<ChildType>
+  SplitInternal(BETREE_PAGE_TYPE *node, const std::vector<ChildType> &children,
+                const std::vector<BETreeMessageType> &messages);
+
+  void CollectRange(page_id_t page_id, const KeyType *low_key,
+                    const KeyType *high_key, std::vector<MappingType> &entries,
+                    std::vector<std::vector<BETreeMessageType>> &levels,
+                    size_t depth);
+
+  bool InRange(const KeyType &key, const KeyType *low_key,
+               const KeyType *high_key) const;
+
+  // apply one message to sorted entries
+  void ApplyMessage(std::vector<MappingType> &entries,
+                    const BETreeMessageType &message);
+
+  // same as BETreePage::ChildIndex, on children read out of a page
+  int ChildIndex(const std::vector<ChildType> &children,
+                 const KeyType &key) const;
+
+  BETREE_PAGE_TYPE *FetchNode(page_id_t page_id);
+  BETREE_PAGE_TYPE *NewNode(IndexPageType page_type);
+
+  void UpdateRootPageId(bool insert_record = false);
+
+  // member variable
+  std::string index_name_;
+  page_id_t root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  // nullptr if changes are not logged
+  LogManager *log_manager_;
+  // tree latch, readers share it and writers hold it exclusively
+  RWMutex latch_;
+};
+
+} // namespace scudb
@@ -0,0 +1,48 @@
+/**
+ * be_tree_index.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "index/be_tree.h"
+#include "index/index.h"
+
+namespace scudb {
+
+#define BETREE_INDEX_TYPE BETreeIndex<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BETreeIndex : public Index {
+
+public:
+  BETreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+              page_id_t root_page_id = INVALID_PAGE_ID,
+              LogManager *log_manager = nullptr);
+
+  ~BETreeIndex() {}
+
+  void InsertEntry(const Tuple &key, RID rid,
+                   Transaction *transaction = nullptr) override;
+
+  void DeleteEntry(const Tuple &key, RID rid,
+                   Transaction *transaction = nullptr) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> &result,
+               Transaction *transaction = nullptr) override;
+
+  void ScanRange(const Tuple *low_key, const Tuple *high_key,
+                 std::vector<RID> &result,
+                 std::vector<std::vector<Value>> *entries = nullptr,
+                 Transaction *transaction = nullptr) override;
+
+protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  BETree<KeyType, ValueType, KeyComparator> container_;
+};
+
+} // namespace scudb
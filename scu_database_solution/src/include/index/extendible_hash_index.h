@@ -0,0 +1,53 @@
+/**
+ * extendible_hash_index.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "index/extendible_hash_table.h"
+#include "index/index.h"
+
+namespace scudb {
+
+#define EXTENDIBLE_HASH_INDEX_TYPE                                             \
+  ExtendibleHashIndex<KeyType, ValueType, KeyComparator, KeyHasher>
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+class ExtendibleHashIndex : public Index {
+
+public:
+  ExtendibleHashIndex(IndexMetadata *metadata,
+                      BufferPoolManager *buffer_pool_manager,
+                      page_id_t root_page_id = INVALID_PAGE_ID,
+                      LogManager *log_manager = nullptr);
+
+  ~ExtendibleHashIndex() {}
+
+  void InsertEntry(const Tuple &key, RID rid,
+                   Transaction *transaction = nullptr) override;
+
+  void DeleteEntry(const Tuple &key, RID rid,
+                   Transaction *transaction = nullptr) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> &result,
+               Transaction *transaction = nullptr) override;
+
+  // a point lookup when both bounds are equal, otherwise every bucket is
+  // read and the result is sorted
+  void ScanRange(const Tuple *low_key, const Tuple *high_key,
+                 std::vector<RID> &result,
+                 std::vector<std::vector<Value>> *entries = nullptr,
+                 Transaction *transaction = nullptr) override;
+
+protected:
+  // comparator and hash function for key
+  KeyComparator comparator_;
+  KeyHasher hash_fn_;
+  // container
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator, KeyHasher> container_;
+};
+
+} // namespace scudb
@@ -0,0 +1,104 @@
+/**
+ * extendible_hash_table.h
+ *
+ * Disk resident extendible hash table, where a directory of 2^GlobalDepth
+ * slots maps the low bits of a key's hash to a bucket page. A full bucket is
+ * split in two by one more bit of hash, the directory doubles when the
+ * bucket already uses all its bits. A lookup reads one directory page and
+ * one bucket page whatever the number of keys.
+ * (1) We only support unique key
+ * (2) Buckets are not merged and the directory does not shrink on deletion
+ * (3) Keys are not ordered, a full scan visits every bucket once
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/rwmutex.h"
+#include "concurrency/transaction.h"
+#include "page/hash_bucket_page.h"
+#include "page/hash_directory_page.h"
+
+namespace scudb {
+
+// hash bits used at most, the directory has 2^HASH_MAX_GLOBAL_DEPTH slots
+#define HASH_MAX_GLOBAL_DEPTH 30
+
+#define HASH_TABLE_TEMPLATE_ARGUMENTS                                          \
+  template <typename KeyType, typename ValueType, typename KeyComparator,      \
+            typename KeyHasher>
+#define EXTENDIBLE_HASH_TABLE_TYPE                                             \
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator, KeyHasher>
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+class ExtendibleHashTable {
+public:
+  explicit ExtendibleHashTable(const std::string &name,
+                               BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator,
+                               const KeyHasher &hash_fn,
+                               page_id_t directory_page_id = INVALID_PAGE_ID,
+                               LogManager *log_manager = nullptr);
+
+  // Returns true if this table has never been inserted into.
+  bool IsEmpty() const;
+
+  // Insert a key-value pair, return false if key already exists.
+  bool Insert(const KeyType &key, const ValueType &value,
+              Transaction *transaction = nullptr);
+
+  // Remove a key and its value.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result,
+                Transaction *transaction = nullptr);
+
+  // return the stored key-value pair equal to key, the stored key may carry
+  // more bytes (included columns) than the one searched for
+  bool GetEntry(const KeyType &key, MappingType &entry,
+                Transaction *transaction = nullptr);
+
+  // all the key-value pairs, in no particular order
+  void GetAll(std::vector<MappingType> &result,
+              Transaction *transaction = nullptr);
+
+  uint32_t GetGlobalDepth() const;
+
+private:
+  typedef HashBucketPage<KeyType, ValueType, KeyComparator> BucketPage;
+
+  // read slot, returning the bucket page id and its local depth
+  page_id_t GetSlot(uint32_t slot, uint32_t &local_depth);
+  void SetSlot(uint32_t slot, page_id_t bucket_page_id, uint32_t local_depth);
+
+  // split the bucket of slot into two, by hash bit local_depth
+  void Split(uint32_t slot, page_id_t bucket_page_id, uint32_t local_depth);
+  // double the directory
+  void Grow();
+
+  HashDirectoryPage *FetchDirectory(page_id_t page_id);
+  BucketPage *FetchBucket(page_id_t page_id);
+  Page *NewPage(page_id_t &page_id);
+
+  void UpdateRootPageId(bool insert_record = false);
+
+  // member variable
+  std::string index_name_;
+  // first page of the directory chain
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  KeyHasher hash_fn_;
+  // nullptr if changes are not logged
+  LogManager *log_manager_;
+  // in-memory copy of global depth and of the directory chain, slot i lives
+  // in page directory_page_ids_[i / DIRECTORY_SLOT_COUNT]
+  uint32_t global_depth_;
+  std::vector<page_id_t> directory_page_ids_;
+  // table latch, readers share it and writers hold it exclusively
+  RWMutex latch_;
+};
+
+} // namespace scudb
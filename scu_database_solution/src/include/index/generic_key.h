@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
 #include "table/tuple.h"
@@ -20,7 +21,8 @@ public:
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data, 0, KeySize);
-    memcpy(data, tuple.GetData(), tuple.GetLength());
+    memcpy(data, tuple.GetData(),
+           std::min(static_cast<size_t>(tuple.GetLength()), KeySize));
   }
 
   // NOTE: for test purpose only
@@ -38,7 +40,18 @@ public:
     } else {
       int32_t offset = *reinterpret_cast<int32_t *>(
           const_cast<char *>(data + schema->GetOffset(column_id)));
+      // a varchar cut off by SetFromKey keeps the bytes inside the key
+      if (offset + sizeof(uint32_t) > KeySize)
+        return Value(column_type, std::string());
       data_ptr = (data + offset);
+      uint32_t length = *reinterpret_cast<const uint32_t *>(data_ptr);
+      if (length != PELOTON_VALUE_NULL &&
+          offset + sizeof(uint32_t) + length > KeySize) {
+        const char *text = data_ptr + sizeof(uint32_t);
+        return Value(column_type,
+                     std::string(text, strnlen(text, KeySize - offset -
+                                                         sizeof(uint32_t))));
+      }
     }
     return Value::DeserializeFrom(data_ptr, column_type);
   }
@@ -94,4 +107,54 @@ private:
   Schema *key_schema_;
 };
 
+/**
+ * Function object returns the hash of a key, used for hash indexes. Only
+ * the columns of key schema are hashed, so that keys equal under
+ * GenericComparator hash to the same value
+ */
+template <size_t KeySize> class GenericHashFunction {
+public:
+  inline uint32_t operator()(const GenericKey<KeySize> &key) const {
+    // FNV-1a over column bytes
+    uint64_t hash = 14695981039346656037ULL;
+    int column_count = key_schema_->GetColumnCount();
+    for (int i = 0; i < column_count; i++) {
+      const char *data;
+      uint32_t length;
+      Value value(TypeId::INVALID);
+      if (key_schema_->IsInlined(i)) {
+        // columns behind KeySize are cut off by SetFromKey
+        uint32_t offset = key_schema_->GetOffset(i);
+        data = key.data + offset;
+        length = offset < KeySize ? KeySize - offset : 0;
+        length = std::min(
+            length, (uint32_t)Type::GetTypeSize(key_schema_->GetType(i)));
+      } else {
+        value = key.ToValue(key_schema_, i);
+        data = value.GetData();
+        length = value.GetLength();
+      }
+      for (uint32_t j = 0; j < length; j++) {
+        hash ^= (uint8_t)data[j];
+        hash *= 1099511628211ULL;
+      }
+    }
+    // mix high bits into low bits, which pick the bucket
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (uint32_t)hash;
+  }
+
+  GenericHashFunction(const GenericHashFunction &other) {
+    this->key_schema_ = other.key_schema_;
+  }
+
+  // constructor
+  GenericHashFunction(Schema *key_schema) : key_schema_(key_schema) {}
+
+private:
+  Schema *key_schema_;
+};
+
 } // namespace scudb
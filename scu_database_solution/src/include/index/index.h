@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/config.h"
 #include "table/tuple.h"
 #include "type/value.h"
 
@@ -23,17 +24,33 @@ namespace scudb {
  * mapping relation and does the conversion between tuple key and index key
  */
 class Transaction;
+
+// data structure behind an index
+enum class IndexType { BPLUSTREE = 0, BETREE, HASH };
+
 class IndexMetadata {
   IndexMetadata() = delete;
 
 public:
   IndexMetadata(std::string index_name, std::string table_name,
-                const Schema *tuple_schema, const std::vector<int> &key_attrs)
-      : name_(index_name), table_name_(table_name), key_attrs_(key_attrs) {
+                const Schema *tuple_schema, const std::vector<int> &key_attrs,
+                bool is_unique = true,
+                const std::vector<int> &include_attrs = std::vector<int>(),
+                IndexType index_type = IndexType::BPLUSTREE)
+      : name_(index_name), table_name_(table_name), key_attrs_(key_attrs),
+        include_attrs_(include_attrs), is_unique_(is_unique),
+        index_type_(index_type) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(),
+                        include_attrs_.end());
+    entry_schema_ = Schema::CopySchema(tuple_schema, entry_attrs_);
   }
 
-  ~IndexMetadata() { delete key_schema_; };
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete entry_schema_;
+  };
 
   inline const std::string &GetName() const { return name_; }
 
@@ -51,13 +68,53 @@ public:
   //  columns
   inline const std::vector<int> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns the columns stored in the leaf besides the key, so that a query
+  // reading only key and included columns never touches the table heap
+  inline const std::vector<int> &GetIncludeAttrs() const {
+    return include_attrs_;
+  }
+
+  // Returns the mapping relation between columns of an index entry (key
+  // columns followed by included columns) and base table columns
+  inline const std::vector<int> &GetEntryAttrs() const { return entry_attrs_; }
+
+  // Returns a schema object pointer that represents an index entry
+  inline Schema *GetEntrySchema() const { return entry_schema_; }
+
+  // Returns the size of the largest entry in bytes, with varchar columns at
+  // their declared length (plus the terminating zero)
+  int GetMaxEntryLength() const {
+    int length = entry_schema_->GetLength();
+    for (int i : entry_schema_->GetUnlinedColumns())
+      length += sizeof(uint32_t) + entry_schema_->GetVariableLength(i) + 1;
+    return length;
+  }
+
+  // Whether every entry fits in an index key. Entries of other indexes may
+  // be cut off, they can't stand in for the tuples
+  inline bool IsEntryWhole() const {
+    return GetMaxEntryLength() <= MAX_KEY_SIZE;
+  }
+
+  // Whether one key maps to at most one tuple. A non-unique index keeps all
+  // the RIDs sharing one key inside a posting list
+  inline bool IsUnique() const { return is_unique_; }
+
+  // B+ tree by default, a B-epsilon tree buffers updates inside internal
+  // nodes for write heavy workloads, a hash index only serves equality
+  inline IndexType GetIndexType() const { return index_type_; }
+
+  // Whether keys are kept in order, so that range scans are cheap
+  inline bool IsOrdered() const { return index_type_ != IndexType::HASH; }
+
   // Get a string representation for debugging
   const std::string ToString() const {
     std::stringstream os;
 
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
-       << "Type = B+Tree, "
+       << "Type = " << IndexTypeToString(index_type_) << ", "
+       << "Unique = " << is_unique_ << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
 
@@ -65,12 +122,32 @@ public:
   }
 
 private:
+  static const char *IndexTypeToString(IndexType index_type) {
+    switch (index_type) {
+    case IndexType::BETREE:
+      return "BETree";
+    case IndexType::HASH:
+      return "Hash";
+    default:
+      return "B+Tree";
+    }
+  }
+
   std::string name_;
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<int> key_attrs_;
+  // columns stored along with the key
+  const std::vector<int> include_attrs_;
+  std::vector<int> entry_attrs_;
+  // whether duplicate keys are allowed
+  bool is_unique_;
+  // data structure of the index
+  IndexType index_type_;
   // schema of the indexed key
   Schema *key_schema_;
+  // schema of the key plus included columns
+  Schema *entry_schema_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -110,6 +187,12 @@ public:
     return metadata_->GetKeyAttrs();
   }
 
+  Schema *GetEntrySchema() const { return metadata_->GetEntrySchema(); }
+
+  const std::vector<int> &GetEntryAttrs() const {
+    return metadata_->GetEntryAttrs();
+  }
+
   // Get a string representation for debugging
   const std::string ToString() const {
     std::stringstream os;
@@ -122,17 +205,36 @@ public:
   ///////////////////////////////////////////////////////////////////
   // Point Modification
   ///////////////////////////////////////////////////////////////////
-  // designed for secondary indexes.
+  // designed for secondary indexes. key is laid out in entry schema, i.e.
+  // included columns follow the key columns
   virtual void InsertEntry(const Tuple &key, RID rid,
                            Transaction *transaction = nullptr) = 0;
 
-  // delete the index entry linked to given tuple
-  virtual void DeleteEntry(const Tuple &key,
+  // insert entries of a batch, keys[i] links to rids[i]. Indexes that can
+  // share work across a batch override it
+  virtual void InsertEntries(const std::vector<Tuple> &keys,
+                             const std::vector<RID> &rids,
+                             Transaction *transaction = nullptr) {
+    for (size_t i = 0; i < keys.size(); i++)
+      InsertEntry(keys[i], rids[i], transaction);
+  }
+
+  // delete the index entry linked to given tuple, rid tells the entries of
+  // one key apart in a non-unique index
+  virtual void DeleteEntry(const Tuple &key, RID rid,
                            Transaction *transaction = nullptr) = 0;
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> &result,
                        Transaction *transaction = nullptr) = 0;
 
+  // scan keys between low_key and high_key (both inclusive, nullptr for no
+  // bound) in key order. If entries is given, the entry of every result
+  // (values of entry schema) is appended to it as well, for index-only scans
+  virtual void ScanRange(const Tuple *low_key, const Tuple *high_key,
+                         std::vector<RID> &result,
+                         std::vector<std::vector<Value>> *entries = nullptr,
+                         Transaction *transaction = nullptr) = 0;
+
 private:
   //===--------------------------------------------------------------------===//
   //  Data members
@@ -13,8 +13,9 @@ namespace scudb {
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
 public:
-  // you may define your own constructor based on your member variables
-  IndexIterator();
+  // the iterator keeps current leaf page pinned until it moves past it
+  IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index,
+                BufferPoolManager *buffer_pool_manager);
   ~IndexIterator();
 
   bool isEnd();
@@ -24,7 +25,12 @@ public:
   IndexIterator &operator++();
 
 private:
-  // add your own private member variables here
+  // skip over exhausted leaf pages
+  void SkipToValid();
+
+  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_;
+  int index_;
+  BufferPoolManager *buffer_pool_manager_;
 };
 
 } // namespace scudb
@@ -0,0 +1,66 @@
+/**
+ * posting_list.h
+ *
+ * Posting lists for non-unique indexes. A key that points to a single tuple
+ * keeps that RID inline in the B+ tree leaf; once a second RID shows up, the
+ * leaf value is replaced by a reference to a chain of PostingListPages that
+ * stores all the RIDs of the key, delta encoded and in increasing order.
+ * A reference is told apart from an inline RID by its slot number.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "page/posting_list_page.h"
+
+namespace scudb {
+
+class PostingList {
+public:
+  explicit PostingList(BufferPoolManager *buffer_pool_manager)
+      : buffer_pool_manager_(buffer_pool_manager) {}
+
+  // slot number marking a leaf value as a reference to a posting list
+  static const int POSTING_LIST_SLOT = -2;
+
+  static inline bool IsPostingList(const RID &value) {
+    return value.GetSlotNum() == POSTING_LIST_SLOT;
+  }
+
+  static inline RID MakeReference(page_id_t head_page_id) {
+    return RID(head_page_id, POSTING_LIST_SLOT);
+  }
+
+  // create a posting list holding two different rids
+  // @return: head page id of the new list
+  page_id_t Create(const RID &first, const RID &second);
+
+  // @return: false if rid is already in the list
+  bool Insert(page_id_t head_page_id, const RID &rid);
+
+  // remove rid from the list, when only one rid is left the list is freed
+  // @return: the value that should be kept in the leaf for this key, either
+  // the list reference itself or the last remaining rid
+  RID Remove(page_id_t head_page_id, const RID &rid);
+
+  // append all the rids of the list into result, in increasing order
+  void Scan(page_id_t head_page_id, std::vector<RID> &result);
+
+  // free all the pages of the list
+  void Destroy(page_id_t head_page_id);
+
+private:
+  PostingListPage *FetchPage(page_id_t page_id);
+  PostingListPage *NewPage();
+  // link a fresh page behind page and put rids[begin, end) into it, spilling
+  // into more pages if needed. @return: the last page of the new pages
+  page_id_t SpillAfter(PostingListPage *page, const std::vector<RID> &rids,
+                       int begin, int end);
+
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+} // namespace scudb
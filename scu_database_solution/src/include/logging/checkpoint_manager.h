@@ -0,0 +1,65 @@
+/**
+ * checkpoint_manager.h
+ * Fuzzy checkpoints, taken while transactions go on: a CHECKPOINT_BEGIN
+ * record, then a CHECKPOINT_END record with the active transaction table
+ * (last lsn of each transaction) and the dirty page table (recLSN of each
+ * page), both read after BEGIN. Once END is on disk, the master record
+ * points recovery to BEGIN, analysis starts there.
+ *
+ * Redo starts from the smallest recLSN, so a checkpoint also writes out the
+ * pages dirty since before the previous checkpoint: restart reads about two
+ * checkpoint intervals of log, however long the log is. The log segments
+ * before that (and before the oldest active transaction, and the replica
+ * slot) are recycled.
+ */
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "logging/log_manager.h"
+
+namespace scudb {
+
+class CheckpointManager {
+public:
+  CheckpointManager(TransactionManager *transaction_manager,
+                    LogManager *log_manager,
+                    BufferPoolManager *buffer_pool_manager,
+                    DiskManager *disk_manager)
+      : transaction_manager_(transaction_manager), log_manager_(log_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        disk_manager_(disk_manager), last_checkpoint_lsn_(INVALID_LSN),
+        checkpoint_thread_(nullptr), is_running_(false) {}
+
+  ~CheckpointManager() { StopCheckpointThread(); }
+
+  // take a checkpoint, logging must be on
+  // @return: lsn of its begin record, INVALID_LSN if logging is off
+  lsn_t Checkpoint();
+
+  // spawn a separate thread to take a checkpoint every interval
+  void RunCheckpointThread(std::chrono::milliseconds interval);
+  void StopCheckpointThread();
+
+private:
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  DiskManager *disk_manager_;
+  // begin lsn of the last checkpoint taken
+  lsn_t last_checkpoint_lsn_;
+  // one checkpoint at a time
+  std::mutex checkpoint_latch_;
+  // checkpoint thread
+  std::thread *checkpoint_thread_;
+  bool is_running_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+} // namespace scudb
@@ -3,13 +3,36 @@
  * log manager maintain a separate thread that is awaken when the log buffer is
  * full or time out(every X second) to write log buffer's content into disk log
  * file.
+ *
+ * Records are appended into the log buffer while the previous one, the flush
+ * buffer, is written out: the flush thread swaps the two buffers and writes
+ * outside the latch, so appends only wait when the log buffer is full.
+ * Committing transactions wait in Flush until their commit record is on
+ * disk; all of them that append while a write is going on are made durable
+ * by the next one (group commit). Asynchronous commits do not wait: the
+ * flush thread writes their records within DURABILITY_WINDOW, so a crash
+ * loses at most that much of them.
+ *
+ * Appends take no latch: a record reserves its bytes of the log buffer with
+ * one compare-and-swap of a word packing the count of swaps, which tells the
+ * log buffer in use, and its used bytes, then it is serialized in parallel
+ * with other appends. A swap moves the word to the other buffer, and the
+ * write of the old one waits for the appends still copying into it.
+ *
+ * The lsn of a record is its offset in the log, so lsns go on after the
+ * records already in the log file. Lsns are 64 bits and don't wrap around;
+ * the word doesn't hold them, the lsn of the start of each buffer is set
+ * when it becomes the log buffer.
  */
 
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <future>
 #include <mutex>
+#include <thread>
 
 #include "disk/disk_manager.h"
 #include "logging/log_record.h"
@@ -19,18 +42,26 @@ namespace scudb {
 class LogManager {
 public:
   LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN),
-        disk_manager_(disk_manager) {
-    // TODO: you may intialize your own defined memeber variables here
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+      : reservation_(MakeReservation(0, 0)),
+        persistent_lsn_(disk_manager->GetLogSize() - 1),
+        flush_thread_(nullptr), is_running_(false),
+        is_flush_requested_(false), is_flushing_(false),
+        async_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+    for (int i = 0; i < 2; i++) {
+      buffers_[i] = new char[LOG_BUFFER_SIZE];
+      start_lsns_[i] = INVALID_LSN;
+      copied_[i] = 0;
+    }
+    start_lsns_[0] = disk_manager->GetLogSize();
   }
 
   ~LogManager() {
-    delete[] log_buffer_;
-    delete[] flush_buffer_;
-    log_buffer_ = nullptr;
-    flush_buffer_ = nullptr;
+    if (flush_thread_ != nullptr)
+      StopFlushThread();
+    for (int i = 0; i < 2; i++) {
+      delete[] buffers_[i];
+      buffers_[i] = nullptr;
+    }
   }
   // spawn a separate thread to wake up periodically to flush
   void RunFlushThread();
@@ -39,28 +70,103 @@ public:
   // append a log record into log buffer
   lsn_t AppendLogRecord(LogRecord &log_record);
 
+  // wait until the records up to lsn are on disk, forcing a flush; without
+  // a flush thread the caller writes the log buffer itself
+  void Flush(lsn_t lsn);
+  // have the records up to lsn written within DURABILITY_WINDOW, without
+  // waiting; without a flush thread they are written right away
+  void FlushAsync(lsn_t lsn);
+  // wake the flush thread to write the records up to lsn now, without
+  // waiting; nothing without a flush thread
+  void RequestFlush(lsn_t lsn);
+
+  // bytes appended and not yet on disk
+  inline lsn_t GetPersistentLSNLag() {
+    return GetNextLSN() - 1 - persistent_lsn_;
+  }
+  // how long the oldest asynchronous commit not yet on disk has waited
+  std::chrono::microseconds GetAsyncCommitLag();
+
   // get/set helper functions
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
+  // lsn of the next record, every record appended from now on has a lsn
+  // not below it
+  inline lsn_t GetNextLSN() {
+    uint64_t reservation = reservation_;
+    while (true) {
+      lsn_t lsn = GetLSN(reservation) + GetOffset(reservation);
+      // the start lsn read is the one of the buffer, if no swap came between
+      uint64_t now = reservation_;
+      if (GetSwapCount(now) == GetSwapCount(reservation))
+        return lsn;
+      reservation = now;
+    }
+  }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
-  inline char *GetLogBuffer() { return log_buffer_; }
+  inline char *GetLogBuffer() {
+    return buffers_[GetBufferIndex(reservation_)];
+  }
+
+  // write the record into data, size_ bytes
+  static void SerializeLogRecord(const LogRecord &log_record, char *data);
 
 private:
-  // TODO: you may add your own member variables
-  // also remember to change constructor accordingly
+  // reservation word: swaps of the buffers so far (32) | used bytes of the
+  // log buffer (32). The log buffer is the one of the parity of the swaps,
+  // the count only has to change at each swap and may wrap around
+  static inline uint64_t MakeReservation(uint32_t swap_count,
+                                         int32_t offset) {
+    return (uint64_t)swap_count << 32 | (uint32_t)offset;
+  }
+  static inline uint32_t GetSwapCount(uint64_t reservation) {
+    return reservation >> 32;
+  }
+  static inline int GetBufferIndex(uint64_t reservation) {
+    return (reservation >> 32) & 1;
+  }
+  static inline int32_t GetOffset(uint64_t reservation) {
+    return (uint32_t)reservation;
+  }
+  // lsn of the start of the log buffer of the reservation
+  inline lsn_t GetLSN(uint64_t reservation) {
+    return start_lsns_[GetBufferIndex(reservation)];
+  }
+
+  // make room in the log buffer: wake the flush thread, or write it here
+  void WaitForRoom(std::unique_lock<std::mutex> &lock);
+  // swap the buffers and write the flush buffer, the latch is released
+  // during the write; waits instead if another write is going on. A record
+  // larger than the log buffer takes the lsn after the flush buffer and is
+  // written right behind it
+  void FlushBuffer(std::unique_lock<std::mutex> &lock,
+                   LogRecord *log_record = nullptr);
 
-  // atomic counter, record the next log sequence number
-  std::atomic<lsn_t> next_lsn_;
+  // see MakeReservation
+  std::atomic<uint64_t> reservation_;
   // log records before & include persistent_lsn_ have been written to disk
   std::atomic<lsn_t> persistent_lsn_;
-  // log buffer related
-  char *log_buffer_;
-  char *flush_buffer_;
+  // log buffer and flush buffer take turns
+  char *buffers_[2];
+  // lsn of the start of each buffer, set before the swap making it the log
+  // buffer; the appends reading it are copied before the next swap to it
+  std::atomic<lsn_t> start_lsns_[2];
+  // bytes serialized into each buffer, the write waits for all reserved
+  std::atomic<int32_t> copied_[2];
   // latch to protect shared member variables
   std::mutex latch_;
   // flush thread
   std::thread *flush_thread_;
+  bool is_running_;
+  bool is_flush_requested_;
+  bool is_flushing_;
+  // last asynchronous commit record, and since when the ones not yet on
+  // disk wait
+  lsn_t async_lsn_;
+  std::chrono::steady_clock::time_point async_since_;
   // for notifying flush thread
   std::condition_variable cv_;
+  // for appenders waiting for room and committers waiting for a write
+  std::condition_variable flushed_cv_;
   // disk manager
   DiskManager *disk_manager_;
 };
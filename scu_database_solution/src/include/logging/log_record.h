@@ -2,9 +2,9 @@
  * log_record.h
  * For every write opeartion on table page, you should write ahead a
  * corresponding log record.
- * For EACH log record, HEADER is like (5 fields in common, 20 bytes in totoal)
+ * For EACH log record, HEADER is like (5 fields in common, 28 bytes in totoal)
  *-------------------------------------------------------------
- * | size | LSN | transID | prevLSN | LogType |
+ * | size (4) | LSN (8) | transID (4) | prevLSN (8) | LogType (4) |
  *-------------------------------------------------------------
  * For insert type log record
  *-------------------------------------------------------------
@@ -14,18 +14,66 @@
  *-------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
  *-------------------------------------------------------------
+ * where only applydelete has the tuple, undone by putting it back; a mark
+ * or rollback delete is redone and undone by its rid alone (tuple_size 0).
+ * A tuple with overflow pages is logged as the head kept in its table page,
+ * its overflow pages are logged when they are written (see page_logger.h)
+ *-------------------------------------------------------------
+ * | -tuple_size | first_overflow_page_id | TUPLE_INLINE_SIZE bytes |
+ *-------------------------------------------------------------
  * For update type log record
  *------------------------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size |
  * | new_tuple_data |
  *------------------------------------------------------------------------------
+ * An update keeping the length of the tuple is logged as a delta update,
+ * with the changed byte ranges only, each as old XOR new bytes
+ *------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | tuple_size | delta_size | offset (2) | length (2) |
+ * | xor_data | offset | length | xor_data | ... |
+ *------------------------------------------------------------------------------
+ * Applied to the tuple on the page, the delta redoes the update to the old
+ * tuple and undoes it from the new one; the page LSN tells which one the
+ * page holds.
  * For new page type log record
  *-------------------------------------------------------------
- * | HEADER | prev_page_id |
+ * | HEADER | prev_page_id | page_id |
  *-------------------------------------------------------------
+ * For index page type log record, a change of a B+ tree or posting list page
+ *------------------------------------------------------------------------------
+ * | HEADER | page_id | page_flags | data_size | data |
+ *------------------------------------------------------------------------------
+ * data is a delta of the whole page, in the ranges of a delta update, redone
+ * and undone alike while the page LSN tells which side the page is on. A new
+ * page (INDEX_PAGE_NEW) is zeroed before the delta is redone. The header
+ * page has no LSN: its records (INDEX_PAGE_IMAGE) hold the page before and
+ * after, and the bytes that differ are set to one side or the other. A page
+ * logged whole (INDEX_PAGE_WHOLE), a table page vacuum moved tuples of,
+ * holds both sides too, and all of the page is set to one of them while
+ * the page LSN tells which side the page is on.
+ * For compensation log record, written when recovery undoes a record
+ *------------------------------------------------------------------------------
+ * | HEADER | undo_next_lsn | action | tuple_rid | tuple_size | tuple_data |
+ *------------------------------------------------------------------------------
+ * action is the type of the record that redoes the undo: APPLYDELETE for an
+ * insert, ROLLBACKDELETE for a mark delete, MARKDELETE for a rollback delete,
+ * UPDATE back to the old tuple, or INSERT of a tuple deleted by APPLYDELETE
+ * back into its slot. undo_next_lsn is the prevLSN of the undone record.
+ * An index page is compensated by INDEXPAGE, with page_id and page_flags as
+ * tuple_rid and the data (sides swapped for an image) as tuple.
+ * For fuzzy checkpoint, BEGIN has HEADER only and END is
+ *------------------------------------------------------------------------------
+ * | HEADER | begin_lsn | txn_count | txn_id | last_lsn | ... |
+ * | page_count | page_id | rec_lsn | ... |
+ *------------------------------------------------------------------------------
+ * holding the active transactions and dirty pages seen after BEGIN.
+ *
+ * The LSN of a record is its byte offset in the log.
  */
 #pragma once
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "table/tuple.h"
@@ -44,6 +92,14 @@ enum class LogRecordType {
   ABORT,
   // when create a new page in heap table
   NEWPAGE,
+  // compensation, redo only
+  CLR,
+  CHECKPOINT_BEGIN,
+  CHECKPOINT_END,
+  // update in place, changed bytes only
+  DELTAUPDATE,
+  // change of an index page, see page_logger.h
+  INDEXPAGE,
 };
 
 class LogRecord {
@@ -73,32 +129,78 @@ public:
              log_record_type == LogRecordType::MARKDELETE ||
              log_record_type == LogRecordType::ROLLBACKDELETE);
       delete_rid_ = rid;
-      delete_tuple_ = tuple;
+      if (log_record_type == LogRecordType::APPLYDELETE)
+        delete_tuple_ = tuple;
     }
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) +
+            (log_record_type == LogRecordType::INSERT
+                 ? insert_tuple_.GetLogLength()
+                 : delete_tuple_.GetLogLength());
   }
 
-  // constructor for UPDATE type
+  // constructor for UPDATE type, made a DELTAUPDATE if the tuple keeps its
+  // length and the delta is smaller than the two tuples
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
             const RID &update_rid, const Tuple &old_tuple,
             const Tuple &new_tuple)
       : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
-        log_record_type_(log_record_type), update_rid_(update_rid),
-        old_tuple_(old_tuple), new_tuple_(new_tuple) {
+        log_record_type_(log_record_type), update_rid_(update_rid) {
+    if (old_tuple.GetLength() == new_tuple.GetLength()) {
+      MakeDelta(old_tuple, new_tuple, delta_);
+      if ((int32_t)delta_.size() < 2 * old_tuple.GetLength()) {
+        log_record_type_ = LogRecordType::DELTAUPDATE;
+        delta_tuple_size_ = old_tuple.GetLength();
+        size_ = HEADER_SIZE + sizeof(RID) + 2 * sizeof(int32_t) +
+                delta_.size();
+        return;
+      }
+      delta_.clear();
+    }
+    old_tuple_ = old_tuple;
+    new_tuple_ = new_tuple;
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() +
-            new_tuple.GetLength() + 2 * sizeof(int32_t);
+    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLogLength() +
+            new_tuple.GetLogLength() + 2 * sizeof(int32_t);
   }
 
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
-            page_id_t page_id)
+            page_id_t prev_page_id, page_id_t page_id)
       : size_(HEADER_SIZE), lsn_(INVALID_LSN), txn_id_(txn_id),
         prev_lsn_(prev_lsn), log_record_type_(log_record_type),
-        prev_page_id_(page_id) {
+        prev_page_id_(prev_page_id), page_id_(page_id) {
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(page_id_t);
+    size_ = HEADER_SIZE + 2 * sizeof(page_id_t);
+  }
+
+  // constructor for INDEXPAGE type, from the page before and after a change
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            page_id_t page_id, int32_t page_flags, const char *old_data,
+            const char *new_data);
+
+  // constructor for CLR type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            lsn_t undo_next_lsn, LogRecordType action, const RID &rid,
+            const Tuple &tuple)
+      : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type), undo_next_lsn_(undo_next_lsn),
+        action_(action), clr_rid_(rid), clr_tuple_(tuple) {
+    size_ = HEADER_SIZE + sizeof(lsn_t) + sizeof(LogRecordType) +
+            sizeof(RID) + sizeof(int32_t) + tuple.GetLogLength();
+  }
+
+  // constructor for CHECKPOINT_END type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            lsn_t begin_lsn,
+            const std::vector<std::pair<txn_id_t, lsn_t>> &active_txns,
+            const std::vector<std::pair<page_id_t, lsn_t>> &dirty_pages)
+      : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type), begin_lsn_(begin_lsn),
+        active_txns_(active_txns), dirty_pages_(dirty_pages) {
+    size_ = HEADER_SIZE + sizeof(lsn_t) + 2 * sizeof(int32_t) +
+            active_txns.size() * (sizeof(txn_id_t) + sizeof(lsn_t)) +
+            dirty_pages.size() * (sizeof(page_id_t) + sizeof(lsn_t));
   }
 
   ~LogRecord() {}
@@ -111,6 +213,31 @@ public:
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline page_id_t GetNewPageId() { return page_id_; }
+
+  inline int32_t GetPageFlags() { return page_flags_; }
+
+  inline lsn_t GetUndoNextLSN() { return undo_next_lsn_; }
+
+  inline LogRecordType GetAction() { return action_; }
+
+  inline lsn_t GetCheckpointBeginLSN() { return begin_lsn_; }
+
+  // changed byte ranges of two tuples of the same length, see above
+  static void MakeDelta(const Tuple &old_tuple, const Tuple &new_tuple,
+                        std::vector<char> &delta);
+  static void MakeDelta(const char *old_data, const char *new_data,
+                        int32_t size, std::vector<char> &delta);
+  // turn the old tuple of a DELTAUPDATE into the new one, or back
+  // @return: false if the tuple has not the length of the record's
+  bool ApplyDelta(char *tuple_data, int32_t tuple_size) const;
+  static void ApplyDelta(const char *delta, int32_t delta_size, char *data);
+
+  // page_flags of an INDEXPAGE record
+  static const int32_t INDEX_PAGE_NEW = 1;
+  static const int32_t INDEX_PAGE_IMAGE = 2;
+  static const int32_t INDEX_PAGE_WHOLE = 4;
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -155,10 +282,28 @@ private:
   RID update_rid_;
   Tuple old_tuple_;
   Tuple new_tuple_;
+  // case3': for delta update, the ranges of update_rid_
+  int32_t delta_tuple_size_ = 0;
+  std::vector<char> delta_;
 
   // case4: for new page opeartion
   page_id_t prev_page_id_ = INVALID_PAGE_ID;
-  const static int HEADER_SIZE = 20;
+  page_id_t page_id_ = INVALID_PAGE_ID;
+  // case4': for index page, page_id_ with its delta (or images) in delta_
+  int32_t page_flags_ = 0;
+
+  // case5: for compensation
+  lsn_t undo_next_lsn_ = INVALID_LSN;
+  LogRecordType action_ = LogRecordType::INVALID;
+  RID clr_rid_;
+  Tuple clr_tuple_;
+
+  // case6: for checkpoint end
+  lsn_t begin_lsn_ = INVALID_LSN;
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+
+  const static int HEADER_SIZE = 28;
 }; // namespace scudb
 
 } // namespace scudb
@@ -1,25 +1,47 @@
 /**
  * recovery_manager.h
  * Read log file from disk, redo and undo
+ *
+ * ARIES style: Redo first analyzes the log from the last complete checkpoint
+ * (see checkpoint_manager.h) to rebuild the active transaction table and the
+ * dirty page table, then repeats history from the smallest recLSN. Undo rolls
+ * back the transactions left active, all of them in one backward pass, and
+ * writes a compensation record (CLR) for every undone record when it has a
+ * log manager, so that a crash during recovery does not undo twice.
+ * Redo may be spread over worker threads, each one redoes the records of
+ * its share of the pages. Index pages are recovered alike, their operations
+ * are transactions of their own (see page_logger.h). A replica redoes the
+ * log of its primary the same way, then goes on with the records the log
+ * grows by (see log_replica.h).
+ *
+ * Recovery runs before the database takes transactions, with logging off
+ * (ENABLE_LOGGING false): the pages are changed without logging, and CLRs
+ * are appended to the log manager directly.
  */
 
 #pragma once
 #include <algorithm>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
-#include "logging/log_record.h"
+#include "logging/log_manager.h"
+#include "page/table_page.h"
 
 namespace scudb {
 
 class LogRecovery {
 public:
   LogRecovery(DiskManager *disk_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPoolManager *buffer_pool_manager,
+                    LogManager *log_manager = nullptr)
       : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager),
-        offset_(0) {
+        log_manager_(log_manager), end_lsn_(0), log_size_(0), offset_(0),
+        buffer_size_(0), read_count_(0) {
     // global transaction through recovery phase
     log_buffer_ = new char[LOG_BUFFER_SIZE];
   }
@@ -29,22 +51,91 @@ public:
     log_buffer_ = nullptr;
   }
 
-  void Redo();
+  // redo with worker_count threads applying records, besides this one
+  // reading the log
+  void Redo(int worker_count = 1);
+  // redo from the checkpoint at checkpoint_lsn instead of the one of the
+  // master record
+  void RedoFrom(lsn_t checkpoint_lsn, int worker_count = 1);
   void Undo();
   bool DeserializeLogRecord(const char *data, LogRecord &log_record);
 
+  // following the log after redo, as a replica does: read the records from
+  // lsn on, as far as the log goes now
+  // @return: lsn after the last record read
+  lsn_t ReadLogRecords(lsn_t lsn, std::vector<LogRecord> &records);
+  // redo records following the ones redone before, in lsn order
+  void RedoNext(std::vector<LogRecord> &records);
+
+  // records read from the log so far
+  inline int GetReadCount() { return read_count_; }
+  // after redo: lsn the log was read up to, and the transactions active
+  // there with their last lsn
+  inline lsn_t GetEndLSN() { return end_lsn_; }
+  inline const std::unordered_map<txn_id_t, lsn_t> &GetActiveTransactions() {
+    return active_txn_;
+  }
+
 private:
-  // TODO: you can add whatever member variable here
-  // Don't forget to initialize newly added variable in constructor
+  // rebuild active_txn_ and dirty_page_ from the checkpoint at
+  // checkpoint_lsn on
+  // @return: lsn the analysis starts from
+  lsn_t Analyze(lsn_t checkpoint_lsn);
+  // read the record at lsn through the log buffer, false at the end of log
+  bool ReadLogRecord(lsn_t lsn, LogRecord &log_record);
+  // records of a redo worker
+  struct RedoQueue {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::vector<LogRecord> records_;
+    bool is_done_ = false;
+  };
+  // records handed to a redo worker at once
+  static const size_t REDO_BATCH_SIZE = 256;
+
+  // page a record changes, INVALID_PAGE_ID if none
+  page_id_t GetRedoPageId(LogRecord &log_record);
+  // keep a page the record allocates from being handed out again
+  void ReservePage(LogRecord &log_record);
+  // redo the records of the pages of a worker, in order
+  void RedoLogRecords(std::vector<LogRecord> &records, int worker,
+                      int worker_count);
+  // repeat the change of a record on its page, unless the page has it
+  // @return: true if the page is changed
+  bool RedoLogRecord(TablePage *page, page_id_t page_id,
+                     LogRecord &log_record);
+  // redo the change of an index page, or of the CLR undoing it
+  bool RedoIndexPage(Page *page, int32_t page_flags, const char *data,
+                     int32_t data_size, lsn_t lsn);
+  // set the bytes of an image that differ between its two sides
+  void SetImageBytes(Page *page, const char *from, const char *to);
+  TablePage *FetchTablePage(page_id_t page_id);
+  // the tuple of a DELTAUPDATE on the page, with the delta applied
+  // @return: false if the page has no such tuple
+  bool ReadDeltaTuple(TablePage *page, LogRecord &log_record, Tuple &tuple);
+  // roll back the change of a record, logging a CLR for it
+  void UndoLogRecord(LogRecord &log_record);
+  void UndoIndexPage(LogRecord &log_record);
+  // apply a change to a table page, no logging
+  void Apply(TablePage *page, LogRecordType type, const RID &rid,
+             const Tuple &tuple);
+
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
+  // CLRs and end records of the undone transactions go here
+  LogManager *log_manager_;
   // maintain active transactions and its corresponds latest lsn
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
-  // mapping log sequence number to log file offset, for undo purpose
-  std::unordered_map<lsn_t, int> lsn_mapping_;
-  // log buffer related
-  int offset_;
+  // pages that may miss changes, with the lsn of the first one (recLSN)
+  std::unordered_map<page_id_t, lsn_t> dirty_page_;
+  // first lsn not read by the analysis
+  lsn_t end_lsn_;
+  // log buffer related, holds the log from offset_ on
+  lsn_t log_size_;
+  lsn_t offset_;
+  int buffer_size_;
   char *log_buffer_;
+  int read_count_;
 };
 
 } // namespace scudb
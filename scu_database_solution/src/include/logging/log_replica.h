@@ -0,0 +1,108 @@
+/**
+ * log_replica.h
+ * Read-only replica of a database, kept up to date by redoing the log of
+ * its primary. The log is not shipped: the replica reads the segment files
+ * from the directory the primary writes them to, the two may be processes
+ * of their own. The replica has a db file of its own, the disk manager
+ * follows the primary's log (see disk_manager.h).
+ *
+ * Bootstrap copies the primary's db file, taken after its last checkpoint,
+ * and redoes the log from that checkpoint on, as recovery does. Then the
+ * replica follows the log: the records it grows by are read and redone in
+ * batches ending where no transaction (nor index operation) is active.
+ * Readers hold the replica latch shared and see the database as of such a
+ * point, the applied lsn; a batch is redone with the latch held exclusive.
+ * Records after the last such point wait in memory: a transaction left
+ * active by a crash of the primary holds the replica back until recovery
+ * of the primary ends it.
+ *
+ * The lsn the replica reads from is kept in the replica slot, the primary
+ * does not truncate the log after it. A replica that goes away without
+ * stopping keeps the log of the primary growing.
+ */
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/rwmutex.h"
+#include "logging/log_recovery.h"
+
+namespace scudb {
+
+class LogReplica {
+public:
+  LogReplica(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
+      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager),
+        read_lsn_(INVALID_LSN), slot_lsn_(INVALID_LSN),
+        consistent_lsn_(INVALID_LSN), applied_lsn_(INVALID_LSN),
+        apply_thread_(nullptr), is_running_(false) {}
+
+  // stop following the log, and give up the replica slot
+  ~LogReplica();
+
+  // copy the pages of the primary and redo its log up to the end
+  void Bootstrap();
+  // redo the records the log has grown by, up to the last point no
+  // transaction is active
+  // @return: the applied lsn
+  lsn_t CatchUp();
+
+  // spawn a separate thread to catch up every interval
+  void RunApplyThread(std::chrono::milliseconds interval);
+  void StopApplyThread();
+
+  // readers see the database as of the applied lsn while they hold the
+  // latch
+  inline void RLock() { replica_latch_.RLock(); }
+  inline void RUnlock() { replica_latch_.RUnlock(); }
+
+  // the log before it is redone, INVALID_LSN until the database is as of a
+  // point no transaction is active
+  lsn_t GetAppliedLSN();
+  // replication lag: bytes of the primary's log not applied yet, and the
+  // time since the replica had all of it applied
+  lsn_t GetLagBytes();
+  std::chrono::milliseconds GetLagTime();
+
+private:
+  // read the end of the primary's log for the metrics
+  void UpdateLogEnd();
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  // keeps the log buffer, and the pages known to redo
+  std::unique_ptr<LogRecovery> log_recovery_;
+  // one catch up at a time, guards the ones below
+  std::mutex catch_up_latch_;
+  // next lsn to read, records read but not redone yet
+  lsn_t read_lsn_;
+  std::vector<LogRecord> pending_records_;
+  // transactions active at read_lsn_
+  std::set<txn_id_t> active_txns_;
+  lsn_t slot_lsn_;
+  // end of log at the end of the copy, no page is newer
+  lsn_t consistent_lsn_;
+  // held exclusive while a batch is redone
+  RWMutex replica_latch_;
+  // guards the metrics
+  std::mutex metrics_latch_;
+  lsn_t applied_lsn_;
+  // ends of log seen past the applied lsn, and when each was first seen
+  std::deque<std::pair<lsn_t, std::chrono::steady_clock::time_point>>
+      log_end_seen_;
+  // apply thread
+  std::thread *apply_thread_;
+  bool is_running_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+} // namespace scudb
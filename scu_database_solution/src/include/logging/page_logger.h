@@ -0,0 +1,75 @@
+/**
+ * page_logger.h
+ * Logging of the pages an operation changes that have no records of their
+ * own: index pages, and the overflow pages of a large tuple. While a page
+ * logger is set for a thread, the buffer pool shows it every page the
+ * thread fetches and every page the thread unpins dirty. A changed page is
+ * logged as an INDEXPAGE record, the delta from the page as fetched (or as
+ * last logged), and gets its LSN before the unpin lets the page be written
+ * out.
+ *
+ * An operation (an insert, a split with its parents, a merge) is a
+ * transaction of its own, with an id below INVALID_TXN_ID so it never meets
+ * one of the transaction manager. Its COMMIT record is not waited for: a
+ * transaction using the index commits later in the log. An operation cut
+ * off by a crash is rolled back by recovery, the tree latch kept other
+ * operations off its pages. Entries of aborted transactions stay in the
+ * index, as they do at runtime.
+ */
+
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "logging/log_manager.h"
+#include "page/page.h"
+
+namespace scudb {
+
+class PageLogger {
+public:
+  // log the pages this thread changes, unless logging is off or the thread
+  // has a page logger already, which logs them instead
+  explicit PageLogger(LogManager *log_manager);
+  // stop logging, an operation not committed is left to recovery
+  ~PageLogger();
+
+  // end the operation
+  void Commit();
+
+  // log a page fetched in this scope whole, both sides of every record,
+  // from its data as of now: call it with the page latched, before the
+  // page is changed. For a table page, whose bytes recovery may lay out
+  // otherwise than the tuple records did at runtime, so that a delta would
+  // not fit
+  void LogWhole(Page *page);
+
+  // called by the buffer pool, with the page pinned and its latch held
+  void OnFetch(Page *page, bool is_new);
+  void OnChange(Page *page);
+
+  // last lsn of the operations not committed, for a checkpoint
+  static void
+  GetActiveOperations(std::vector<std::pair<txn_id_t, lsn_t>> &active_ops);
+  // first lsn of the oldest operation not committed, INVALID_LSN if none
+  static lsn_t GetOldestBeginLSN();
+
+private:
+  // nullptr if this page logger logs nothing
+  LogManager *log_manager_;
+  txn_id_t txn_id_;
+  lsn_t prev_lsn_;
+  // each page seen, the page flags of its next record and its data as of
+  // the last record
+  std::unordered_map<page_id_t, std::pair<int32_t, std::vector<char>>> pages_;
+
+  // guards the ones below, appends of operations hold it too
+  static std::mutex latch_;
+  // first and last lsn of the operations not committed
+  static std::unordered_map<txn_id_t, std::pair<lsn_t, lsn_t>> active_ops_;
+  static txn_id_t next_txn_id_;
+};
+
+} // namespace scudb
@@ -67,6 +67,8 @@ private:
                     BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, int parent_index,
                      BufferPoolManager *buffer_pool_manager);
+  void AdoptChild(const ValueType &child,
+                  BufferPoolManager *buffer_pool_manager);
   MappingType array[0];
 };
 } // namespace scudb
@@ -10,13 +10,13 @@
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | LSN (8) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  -----------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) |
+ *  -----------------------------------------------------
  */
 #pragma once
 #include <utility>
@@ -41,6 +41,7 @@ public:
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
   const MappingType &GetItem(int index);
+  void SetValueAt(int index, const ValueType &value);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value,
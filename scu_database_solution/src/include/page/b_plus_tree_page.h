@@ -6,9 +6,9 @@
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 20 bytes in total):
+ * Header format (size in byte, 28 bytes in total):
  * ----------------------------------------------------------------------------
- * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ * | PageType (4) | LSN (8) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
  * | ParentPageId (4) | PageId(4) |
  * ----------------------------------------------------------------------------
@@ -60,7 +60,8 @@ public:
 private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_;
-  lsn_t lsn_;
+  // a lsn_t, as bytes to stay at offset 4 unpadded, see Page::GetLSN
+  char lsn_[sizeof(lsn_t)];
   int size_;
   int max_size_;
   page_id_t parent_page_id_;
@@ -0,0 +1,110 @@
+/**
+ * be_tree_page.h
+ *
+ * Node page of the B-epsilon tree. Leaf page stores key & value pairs in key
+ * order, same as a B+ tree leaf. Internal page stores pivots and children
+ * like a B+ tree internal page (the first key is invalid), and uses the rest
+ * of the page as a buffer of pending messages (insert or delete of one key)
+ * that are headed to its children, kept in arrival order.
+ *
+ * Leaf page format:
+ *  ----------------------------------------------------------------------
+ * | HEADER | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------------
+ *
+ * Internal page format (MaxSize slots for children, messages follow):
+ *  ----------------------------------------------------------------------
+ * | HEADER | INVALID_KEY + PAGE_ID(1) | ... | MESSAGE(1) | MESSAGE(2) | ...
+ *  ----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (8) | CurrentSize (4) | MaxSize (4) | PageId (4) |
+ *  ---------------------------------------------------------------------
+ *  --------------------------------------------
+ * | MessageCount (4) | MaxMessageCount (4) |
+ *  --------------------------------------------
+ */
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "page/b_plus_tree_page.h"
+
+namespace scudb {
+
+#define BETREE_PAGE_TYPE BETreePage<KeyType, ValueType, KeyComparator>
+#define BETreeMessageType BETreeMessage<KeyType, ValueType>
+
+enum class BETreeMessageOp : int32_t { INSERT = 0, DELETE };
+
+// a pending update of one key
+template <typename KeyType, typename ValueType> struct BETreeMessage {
+  KeyType key;
+  ValueType value;
+  BETreeMessageOp op;
+};
+
+INDEX_TEMPLATE_ARGUMENTS
+class BETreePage {
+public:
+  // After creating a new page from buffer pool, must call initialize method
+  // to set default values
+  void Init(page_id_t page_id, IndexPageType page_type);
+
+  bool IsLeafPage() const;
+  int GetSize() const;
+  int GetMaxSize() const;
+  page_id_t GetPageId() const;
+  int GetMessageCount() const;
+  int GetMaxMessageCount() const;
+
+  /**
+   * Leaf page
+   */
+  bool Lookup(const KeyType &key, ValueType &value,
+              const KeyComparator &comparator) const;
+  // first index i such that array[i].first >= key
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+  const MappingType &GetItem(int index) const;
+  void ReadEntries(std::vector<MappingType> &entries) const;
+  void WriteEntries(const std::vector<MappingType> &entries, int begin,
+                    int end);
+
+  /**
+   * Internal page
+   */
+  // index of the child whose subtree covers key
+  int ChildIndex(const KeyType &key, const KeyComparator &comparator) const;
+  page_id_t ChildAt(int index) const;
+  void ReadChildren(std::vector<std::pair<KeyType, page_id_t>> &children) const;
+  void WriteChildren(const std::vector<std::pair<KeyType, page_id_t>> &children,
+                     int begin, int end);
+  // append one message, return false if the buffer is full
+  bool AppendMessage(const BETreeMessageType &message);
+  // the most recent message on key, nullptr if none
+  const BETreeMessageType *FindMessage(const KeyType &key,
+                                       const KeyComparator &comparator) const;
+  const BETreeMessageType &MessageAt(int index) const;
+  void ReadMessages(std::vector<BETreeMessageType> &messages) const;
+  void WriteMessages(const std::vector<BETreeMessageType> &messages);
+
+private:
+  std::pair<KeyType, page_id_t> *Children();
+  const std::pair<KeyType, page_id_t> *Children() const;
+  BETreeMessageType *Messages();
+  const BETreeMessageType *Messages() const;
+
+  IndexPageType page_type_;
+  // a lsn_t, as bytes to stay at offset 4 unpadded, see Page::GetLSN
+  char lsn_[sizeof(lsn_t)];
+  int size_;
+  int max_size_;
+  page_id_t page_id_;
+  int message_count_;
+  int max_message_count_;
+  char data_[0];
+};
+
+} // namespace scudb
@@ -0,0 +1,94 @@
+/**
+ * column_chunk.h
+ *
+ * Encoded values of one column of the tuples in a page, the minipage of the
+ * column in an encoded PAX page. Every chunk takes the smallest encoding
+ * that applies to its values:
+ *  PLAIN: values as in a tuple
+ *  DICTIONARY: every distinct value once, values as bit packed entry codes
+ *  RLE: runs of equal fixed size values
+ *  FOR (frame of reference): integers as bit packed differences from the
+ *  smallest value of the chunk
+ *
+ *  Format (size in byte):
+ *  -------------------------------------------------------------
+ * | PLAIN (1) | Value_1 | ... | Value_n |                        fixed size
+ * | PLAIN (1) | Offset_1 (2) | ... | Offset_n (2) | values |     varchar
+ * | DICTIONARY (1) | EntryCount (2) | CodeWidth (1) | entries | codes |
+ * | RLE (1) | RunCount (2) | RunEnd_1 (2) | ... | Value_1 | ... |
+ * | FOR (1) | CodeWidth (1) | Base (8) | codes |
+ *  -------------------------------------------------------------
+ *
+ * A varchar is stored as length (4) + bytes like in a tuple, behind a table
+ * of offsets from the start of the chunk, and dictionary entries of varchar
+ * columns are laid out the same way. Codes take CodeWidth bits each. The
+ * chunk does not record its value count, the page does.
+ * Predicates are evaluated on the encoded values: once per dictionary entry
+ * or run, and on the codes of a frame of reference.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "type/value.h"
+
+namespace scudb {
+
+enum class CompareOp {
+  EQUAL = 0,
+  NOT_EQUAL,
+  LESS_THAN,
+  LESS_THAN_EQUAL,
+  GREATER_THAN,
+  GREATER_THAN_EQUAL
+};
+
+class ColumnChunk {
+public:
+  enum Encoding : char { PLAIN = 0, DICTIONARY, RLE, FOR };
+
+  // bytes values take in their smallest encoding
+  static int32_t GetEncodedSize(TypeId type, const std::vector<Value> &values);
+  // write values into data in their smallest encoding
+  // @return: bytes written
+  static int32_t Encode(TypeId type, const std::vector<Value> &values,
+                        char *data);
+
+  // (left op right) is true
+  static bool Compare(const Value &left, CompareOp op, const Value &right);
+
+  // read a chunk written by Encode
+  ColumnChunk(TypeId type, const char *data);
+
+  inline Encoding GetEncoding() const {
+    return static_cast<Encoding>(data_[0]);
+  }
+
+  // a varchar borrows the chunk
+  Value GetValue(int index) const;
+  // write a value as in a tuple, fixed size bytes or length + bytes
+  // @return: bytes written
+  int32_t CopyValue(int index, char *data) const;
+  // length + bytes of a varchar
+  int32_t GetVarcharSize(int index) const;
+
+  // clear matches[i] of every value i in [0, count) for which
+  // (value op constant) is not true, null compares to nothing
+  void Filter(CompareOp op, const Value &constant, int count,
+              std::vector<char> &matches) const;
+
+private:
+  // bytes of a value as in a tuple, for every encoding but FOR
+  const char *GetEntry(int index) const;
+  // value of a FOR chunk
+  int64_t GetInteger(int index) const;
+
+  TypeId type_;
+  const char *data_;
+  // codes of a DICTIONARY or FOR chunk
+  const char *codes_;
+  int code_width_;
+};
+
+} // namespace scudb
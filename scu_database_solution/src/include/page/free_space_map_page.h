@@ -0,0 +1,53 @@
+/**
+ * free_space_map_page.h
+ *
+ * Free space map page of a table heap. Keeps a 4 bit fill class for every
+ * page id of a range, FSM_ENTRY_COUNT page ids per map page: page p is
+ * described by entry p % FSM_ENTRY_COUNT of map page p / FSM_ENTRY_COUNT in
+ * the chain. Page ids not used by the heap keep class 0 (no space):
+ *  ----------------------------------------------------------------
+ * | HEADER | CLASS(0) CLASS(1) | CLASS(2) CLASS(3) | ...            |
+ *  ----------------------------------------------------------------
+ *
+ *  Header format (size in byte, 20 bytes in total):
+ *  --------------------------------------------------------------
+ * | PageId (4) | LSN (8) | NextPageId (4) | LastHeapPageId (4) |
+ *  --------------------------------------------------------------
+ *
+ * LastHeapPageId is only maintained in the first map page, it is the tail of
+ * the heap's page chain where new pages are linked.
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include "page/page.h"
+
+namespace scudb {
+
+// page ids described by one map page
+#define FSM_ENTRY_COUNT ((PAGE_SIZE - 20) * 2)
+
+class FreeSpaceMapPage : public Page {
+public:
+  /**
+   * Header related
+   */
+  void Init(page_id_t page_id);
+  page_id_t GetPageId();
+  page_id_t GetNextPageId();
+  void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetLastHeapPageId();
+  void SetLastHeapPageId(page_id_t last_heap_page_id);
+
+  /**
+   * Entry related, index is the position of a page id inside this map page
+   */
+  int GetFillClass(int index);
+  void SetFillClass(int index, int fill_class);
+  // first index at or after begin whose class is at least fill_class, -1 if
+  // none
+  int FindEntry(int fill_class, int begin);
+};
+} // namespace scudb
@@ -0,0 +1,60 @@
+/**
+ * hash_bucket_page.h
+ *
+ * Bucket page of the disk extendible hash index. Stores key & value pairs of
+ * the keys whose hash ends with the same LocalDepth bits, in no particular
+ * order:
+ *  ----------------------------------------------------------------------
+ * | HEADER | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 24 bytes in total):
+ *  --------------------------------------------------------------------------
+ * | PageId (4) | LSN (8) | LocalDepth (4) | CurrentSize (4) | MaxSize (4) |
+ *  --------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "page/b_plus_tree_page.h"
+
+namespace scudb {
+
+#define HASH_BUCKET_PAGE_TYPE HashBucketPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class HashBucketPage {
+public:
+  // After creating a new page from buffer pool, must call initialize method
+  // to set default values
+  void Init(page_id_t page_id, uint32_t local_depth);
+
+  page_id_t GetPageId() const;
+  uint32_t GetLocalDepth() const;
+  void SetLocalDepth(uint32_t local_depth);
+  int GetSize() const;
+  bool IsFull() const;
+
+  // index of key in this bucket, -1 if absent
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+  const MappingType &GetItem(int index) const;
+  // append a pair whose key is not in the bucket, return false if full
+  bool Append(const KeyType &key, const ValueType &value);
+  // remove the pair at index, the last pair takes its place
+  void RemoveAt(int index);
+  void ReadEntries(std::vector<MappingType> &entries) const;
+  void WriteEntries(const std::vector<MappingType> &entries);
+
+private:
+  page_id_t page_id_;
+  // a lsn_t, as bytes to stay at offset 4 unpadded, see Page::GetLSN
+  char lsn_[sizeof(lsn_t)];
+  uint32_t local_depth_;
+  int size_;
+  int max_size_;
+  MappingType array_[0];
+};
+
+} // namespace scudb
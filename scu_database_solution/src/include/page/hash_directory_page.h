@@ -0,0 +1,53 @@
+/**
+ * hash_directory_page.h
+ *
+ * Directory page of the disk extendible hash index. The directory has
+ * 2^GlobalDepth slots, slot i points to the bucket of the keys whose hash
+ * ends with the bits of i. Slots are spread over a chain of directory pages,
+ * DIRECTORY_SLOT_COUNT slots per page, the first page also holds the global
+ * depth and is the one registered in the header page:
+ *  ----------------------------------------------------------------
+ * | HEADER | BUCKET_PAGE_ID(1) ... | LOCAL_DEPTH(1) ... | FREE SPACE |
+ *  ----------------------------------------------------------------
+ *
+ *  Header format (size in byte, 20 bytes in total):
+ *  --------------------------------------------------------------
+ * | PageId (4) | LSN (8) | NextPageId (4) | GlobalDepth (4) |
+ *  --------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include "page/page.h"
+
+namespace scudb {
+
+// slots per directory page, a power of two
+#define DIRECTORY_SLOT_COUNT 64
+
+class HashDirectoryPage : public Page {
+public:
+  /**
+   * Header related
+   */
+  void Init(page_id_t page_id);
+  page_id_t GetPageId();
+  page_id_t GetNextPageId();
+  void SetNextPageId(page_id_t next_page_id);
+  // only meaningful in the first page of the chain
+  uint32_t GetGlobalDepth();
+  void SetGlobalDepth(uint32_t global_depth);
+
+  /**
+   * Slot related, index is the position of a slot inside this page
+   */
+  page_id_t GetBucketPageId(int index);
+  void SetBucketPageId(int index, page_id_t bucket_page_id);
+  uint32_t GetLocalDepth(int index);
+  void SetLocalDepth(int index, uint32_t local_depth);
+  // copy slots of other page, used when the directory doubles
+  void CopySlots(HashDirectoryPage *other, int begin, int end, int to);
+};
+} // namespace scudb
@@ -0,0 +1,48 @@
+/**
+ * overflow_page.h
+ *
+ * Overflow page of a large tuple. A tuple larger than
+ * TUPLE_OVERFLOW_THRESHOLD keeps its first bytes in a table page, the rest
+ * is split over a chain of overflow pages in order:
+ *  ----------------------------------------
+ * | HEADER | ... BYTES OF THE TUPLE ...    |
+ *  ----------------------------------------
+ *
+ *  Header format (size in byte, 20 bytes in total):
+ *  ------------------------------------------------------
+ * | PageId (4) | LSN (8) | NextPageId (4) | DataSize (4) |
+ *  ------------------------------------------------------
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include "page/page.h"
+
+namespace scudb {
+
+// bytes of a tuple held by one overflow page
+#define OVERFLOW_PAGE_CAPACITY (PAGE_SIZE - 20)
+
+class OverflowPage : public Page {
+public:
+  /**
+   * Header related
+   */
+  void Init(page_id_t page_id);
+  page_id_t GetPageId();
+  page_id_t GetNextPageId();
+  void SetNextPageId(page_id_t next_page_id);
+  int32_t GetDataSize();
+
+  /**
+   * Data related
+   */
+  // replace the content with size bytes of data, at most
+  // OVERFLOW_PAGE_CAPACITY
+  void WriteData(const char *data, int32_t size);
+  // copy out all the bytes held
+  void ReadData(char *data);
+};
+} // namespace scudb
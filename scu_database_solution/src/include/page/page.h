@@ -34,8 +34,17 @@ public:
   inline void RUnlatch() { rwlatch_.RUnlock(); }
   inline void RLatch() { rwlatch_.RLock(); }
 
-  inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
-  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
+  // the page LSN of every page kind that has one, 8 bytes at offset 4
+  inline lsn_t GetLSN() {
+    lsn_t lsn;
+    memcpy(&lsn, GetData() + 4, sizeof(lsn_t));
+    return lsn;
+  }
+  // a logged change: the page is written only after its log (write ahead)
+  inline void SetLSN(lsn_t lsn) {
+    memcpy(GetData() + 4, &lsn, sizeof(lsn_t));
+    has_lsn_ = true;
+  }
 
 private:
   // method used by buffer pool manager
@@ -45,6 +54,11 @@ private:
   page_id_t page_id_ = INVALID_PAGE_ID;
   int pin_count_ = 0;
   bool is_dirty_ = false;
+  // the page LSN was set since the page was read, the other pages keep no
+  // page LSN or have their log on disk
+  bool has_lsn_ = false;
+  // recLSN: changes not on disk yet have lsns from here on
+  lsn_t rec_lsn_ = INVALID_LSN;
   RWMutex rwlatch_;
 };
 
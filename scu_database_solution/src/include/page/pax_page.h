@@ -0,0 +1,191 @@
+/**
+ * pax_page.h
+ *
+ * PAX (partition attributes across) page format of a table heap. Values of
+ * every column of the tuples in a page are kept together in a minipage, so
+ * a scan that reads a few columns of a wide table touches only their bytes,
+ * and fixed size columns lie in plain arrays:
+ *  ----------------------------------------------------------------------
+ * | HEADER | SLOT STATES | MINIPAGE 1 | ... | MINIPAGE N | FREE | VARCHARS |
+ *  ----------------------------------------------------------------------
+ *                                                         ^
+ *                                                 free space pointer
+ *
+ *  Header format (size in byte):
+ *  --------------------------------------------------------------------------
+ * | PageId (4)| LSN (8)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ *  --------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------
+ * | SlotCount (4) | FreeSpaceMapPageId (4) | PAX_PAGE_MAGIC (4) |
+ *  --------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------
+ * | FragmentedSize (4) | ColumnCount (2) | InlineSize (2) | VarcharCount (2) |
+ * | Encoded (1) | Column_1 type (1) | Column_1 minipage offset (2) | ... |
+ *  --------------------------------------------------------------------------
+ *
+ * The fields up to FreeSpaceMapPageId are laid out as in TablePage, so walks
+ * of the page chain don't care about the format; the magic number sits where
+ * TablePage keeps its first free slot (-1 or a slot number), and tells a PAX
+ * page apart. The page describes its columns itself, TablePage forwards
+ * tuple operations to it.
+ * SlotCount slots are laid out by Init from the fixed length of the schema.
+ * A slot state is one byte: empty, tuple or deleted (not yet applied).
+ * Minipages are aligned to the size of their values. The minipage entry of a
+ * varchar column is the offset of its value, stored as length (4) + bytes at
+ * the end of the page like in a tuple. InlineSize is the fixed length of a
+ * tuple in row format.
+ * Tuples with overflow pages are not stored in PAX pages.
+ *
+ * Encode rewrites a page read-mostly: every minipage becomes a column chunk
+ * in its smallest encoding (see column_chunk.h), with no varchar area and as
+ * many slots as tuples, so that the page holds more tuples than its plain
+ * layout does. Tuples of an encoded page can be read, filtered and deleted,
+ * but not inserted or updated in place; an update is a delete and insert.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "concurrency/lock_manager.h"
+#include "logging/log_manager.h"
+#include "page/column_chunk.h"
+#include "page/page.h"
+#include "table/tuple.h"
+#include "table/tuple_view.h"
+
+namespace scudb {
+
+#define PAX_PAGE_MAGIC 0x50415850
+// bytes of varchar data planned for every varchar column of a slot
+#define PAX_VARCHAR_RESERVE 16
+
+class PaxPage : public Page {
+  friend class TupleView;
+
+public:
+  /**
+   * Header related
+   */
+  // lay out minipages for the columns of schema
+  void Init(page_id_t page_id, page_id_t prev_page_id, Schema *schema);
+  // same columns and slot count as layout_page
+  void Init(page_id_t page_id, page_id_t prev_page_id, PaxPage *layout_page);
+  page_id_t GetPageId();
+  // bytes for a tuple, 0 if all slots are taken
+  int32_t GetFreeSpaceSize();
+  int32_t GetSlotCount();
+
+  // slots in a page for the columns of schema, 0 if a tuple doesn't fit
+  static int32_t GetSlotCount(Schema *schema);
+
+  /**
+   * Encoding related
+   */
+  bool IsEncoded();
+  // bytes of the page with tuples encoded by its columns
+  int32_t GetEncodedSize(const std::vector<Tuple> &tuples);
+  // replace the tuples of the page with tuples encoded, in slots 0..n-1
+  // @return: false if they don't fit or a delete is pending, the page is
+  // left as it was
+  bool Encode(const std::vector<Tuple> &tuples);
+
+  /**
+   * Tuple related, see TablePage
+   */
+  bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
+                   LockManager *lock_manager, LogManager *log_manager);
+  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager,
+                  LogManager *log_manager);
+  bool UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple, const RID &rid,
+                   Transaction *txn, LockManager *lock_manager,
+                   LogManager *log_manager);
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  void RollbackDelete(const RID &rid, Transaction *txn,
+                      LogManager *log_manager);
+  bool RestoreTuple(const Tuple &tuple, const RID &rid);
+  void Compact();
+  bool IsEmpty();
+
+  bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
+                LockManager *lock_manager);
+  // the view reads the minipages of this page, no copy is made
+  bool GetTupleView(const RID &rid, TupleView &view, Transaction *txn,
+                    LockManager *lock_manager);
+  int GetTupleViews(int first_slot, std::vector<TupleView> &views,
+                    size_t max_count, Transaction *txn,
+                    LockManager *lock_manager, bool &is_blocked);
+
+  bool GetFirstTupleRid(RID &first_rid);
+  bool GetNextTupleRid(const RID &cur_rid, RID &next_rid);
+
+  /**
+   * Column related
+   */
+  // value of a column of the tuple in a slot, a varchar borrows the page
+  Value GetValue(int slot_num, int column_id);
+
+  // values of a fixed size column, one for every slot, empty ones included,
+  // in a plain page
+  inline const char *GetMinipage(int column_id) {
+    return GetData() + GetMinipageOffset(column_id);
+  }
+
+  /*
+   * Clear matches[slot] of every slot whose tuple fails (column op value),
+   * reading an encoded column without decoding it. Empty matches start out
+   * as the slots holding a tuple, so that calls chain into a conjunction
+   */
+  void Filter(int column_id, CompareOp op, const Value &value,
+              std::vector<char> &matches);
+
+private:
+  enum SlotState : char { EMPTY = 0, TUPLE, DELETED };
+
+  // plain layout for columns of types
+  void Init(page_id_t page_id, page_id_t prev_page_id,
+            const std::vector<TypeId> &types);
+  std::vector<TypeId> GetColumnTypes();
+  // values of a column of tuples in row format
+  void GetColumnValues(const std::vector<Tuple> &tuples, int column_id,
+                       std::vector<Value> &values);
+
+  SlotState GetSlotState(int slot_num);
+  void SetSlotState(int slot_num, SlotState state);
+  int32_t GetColumnCount();
+  int32_t GetVarcharCount();
+  TypeId GetColumnType(int column_id);
+  int32_t GetMinipageOffset(int column_id);
+  // bytes of a column in its minipage
+  int32_t GetColumnWidth(int column_id);
+  // bytes of a tuple in row format
+  int32_t GetTupleSize(int slot_num);
+  // bytes of the fixed length part of a tuple in row format
+  int32_t GetInlineSize();
+  // bytes a varchar value takes at the end of the page
+  int32_t GetVarcharSize(int slot_num, int column_id);
+
+  // copy the tuple in a slot out into row format
+  void ReadTuple(int slot_num, char *data);
+  // split a tuple in row format into the minipages of an empty slot, its
+  // varchar bytes must fit in the contiguous free space
+  void WriteTuple(int slot_num, const Tuple &tuple);
+  // varchar bytes of a slot become a hole
+  void ReleaseVarchars(int slot_num);
+  // log a delete record of the tuple in a slot, in row format like the
+  // records of a table page
+  void LogDelete(LogRecordType type, const RID &rid, Transaction *txn,
+                 LogManager *log_manager);
+
+  int32_t GetFreeSpacePointer();
+  void SetFreeSpacePointer(int32_t free_space_pointer);
+  int32_t GetFragmentedSize();
+  void SetFragmentedSize(int32_t fragmented_size);
+  // free space between the last minipage and the varchars, without holes
+  int32_t GetContiguousFreeSpaceSize();
+};
+
+} // namespace scudb
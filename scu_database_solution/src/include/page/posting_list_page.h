@@ -0,0 +1,76 @@
+/**
+ * posting_list_page.h
+ *
+ * Posting list page format, used by non-unique indexes to keep all the RIDs
+ * that share one key. RIDs are kept in increasing order and each one is
+ * stored as a varint encoded delta from its predecessor in the same page:
+ *  ----------------------------------------------------------------
+ * | HEADER | DELTA(1) | DELTA(2) | ... FREE SPACES ...              |
+ *  ----------------------------------------------------------------
+ *
+ *  Header format (size in byte, 36 bytes in total):
+ *  --------------------------------------------------------------------------
+ * | PageId (4) | LSN (8) | NextPageId (4) | TailPageId (4) | RidCount (4) |
+ *  --------------------------------------------------------------------------
+ *  ------------------------------
+ * | PayloadSize (4) | LastRid (8) |
+ *  ------------------------------
+ *
+ * Pages of one list are chained through NextPageId and every RID in a page
+ * is smaller than the first RID of the next page. TailPageId is only
+ * maintained in the head page, so that appending a RID larger than all the
+ * others (the common case for a growing heap) does not walk the chain.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "common/rid.h"
+#include "page/page.h"
+
+namespace scudb {
+
+class PostingListPage : public Page {
+public:
+  /**
+   * Header related
+   */
+  void Init(page_id_t page_id);
+  page_id_t GetPageId();
+  page_id_t GetNextPageId();
+  void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetTailPageId();
+  void SetTailPageId(page_id_t tail_page_id);
+  int32_t GetRidCount();
+  RID GetLastRid();
+
+  /**
+   * RID related
+   */
+  // append rid behind the last one, return false if no space left
+  bool Append(const RID &rid);
+  // decode all the rids of this page, in order, into result
+  void Decode(std::vector<RID> &result);
+  // decode only the first rid of this page
+  RID GetFirstRid();
+  // replace page content with rids[begin, end) as long as they fit
+  // @return: the number of rids that have been encoded
+  int Encode(const std::vector<RID> &rids, int begin, int end);
+
+private:
+  /**
+   * helper functions
+   */
+  int32_t GetPayloadSize();
+  void SetPayloadSize(int32_t payload_size);
+  void SetRidCount(int32_t rid_count);
+  void SetLastRid(const RID &rid);
+  int32_t GetFreeSpaceSize();
+  // varint (LEB128) encoding of rid delta
+  static int VarintSize(uint64_t value);
+  static int WriteVarint(char *dst, uint64_t value);
+  static int ReadVarint(const char *src, uint64_t &value);
+};
+} // namespace scudb
@@ -10,12 +10,30 @@
  *
  *  Header format (size in byte):
  *  --------------------------------------------------------------------------
- * | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ * | PageId (4)| LSN (8)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ *  --------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------
+ * | TupleCount (4) | FreeSpaceMapPageId (4) | FirstFreeSlot (4) |
+ *  --------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------
+ * | FragmentedSize (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  --------------------------------------------------------------------------
- *  --------------------------------------------------------------
- * | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  --------------------------------------------------------------
  *
+ * FreeSpaceMapPageId is only maintained in the first page of a table heap.
+ * Empty slots (size 0) form a list starting at FirstFreeSlot, the offset
+ * field of an empty slot holds the next empty slot (-1 for the end).
+ * Deleted tuples leave holes among the tuples, FragmentedSize counts their
+ * bytes; holes are reclaimed by Compact when an insert or update needs them.
+ *
+ * A tuple with overflow pages is stored as its head, its slot offset has
+ * the TUPLE_OVERFLOW_FLAG bit set:
+ *  ----------------------------------------------------------------------
+ * | TupleSize (4) | FirstOverflowPageId (4) | TUPLE_INLINE_SIZE bytes ... |
+ *  ----------------------------------------------------------------------
+ *
+ * A table heap created in PAX format is made of PaxPage (see pax_page.h),
+ * which has PAX_PAGE_MAGIC in place of FirstFreeSlot. The tuple operations
+ * below forward to it, so the heap and its iterators work on both formats.
  */
 
 #pragma once
@@ -26,7 +44,9 @@
 #include "concurrency/lock_manager.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
+#include "page/pax_page.h"
 #include "table/tuple.h"
+#include "table/tuple_view.h"
 
 namespace scudb {
 
@@ -42,9 +62,24 @@ public:
   page_id_t GetNextPageId();
   void SetPrevPageId(page_id_t prev_page_id);
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetFreeSpaceMapPageId();
+  void SetFreeSpaceMapPageId(page_id_t free_space_map_page_id);
+  // bytes left for tuple data and slots
+  int32_t GetFreeSpaceSize();
+  // the page is in PAX format
+  bool IsPaxPage();
+  inline PaxPage *AsPaxPage() {
+    return static_cast<PaxPage *>(static_cast<Page *>(this));
+  }
 
   /**
    * Tuple related
+   * A lock is never waited for under the page latch: a tuple locked by
+   * another transaction is refused, the transaction is left running unless
+   * it must die (an insert aborts it). TableHeap takes the locks before it
+   * latches a page.
+   * Insert and delete write no record with a null log_manager, for a caller
+   * logging the whole page with a page logger (see page_logger.h)
    */
   bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
                    LockManager *lock_manager,
@@ -60,11 +95,38 @@ public:
                    LogManager *log_manager); // when commit success
   void RollbackDelete(const RID &rid, Transaction *txn,
                       LogManager *log_manager); // when commit abort
+  // put a tuple into an empty slot or a new one, recovery redoes inserts
+  // and undoes ApplyDelete this way. Not logged
+  bool RestoreTuple(const Tuple &tuple, const RID &rid);
+
+  // move tuples to the end of page, so that holes left by deleted tuples
+  // join the free space
+  void Compact();
+
+  // true if no slot holds a tuple, deleted but not yet applied ones included
+  bool IsEmpty();
+
+  // first overflow page of a tuple, INVALID_PAGE_ID if it has none
+  page_id_t GetOverflowPageId(const RID &rid);
 
   // return tuple (with data pointing to heap) if success
   bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
                 LockManager *lock_manager);
 
+  // point view at the tuple bytes in this page, no copy is made. The view is
+  // valid while the page stays pinned and latched
+  bool GetTupleView(const RID &rid, TupleView &view, Transaction *txn,
+                    LockManager *lock_manager);
+
+  // append views of the tuples in slots from first_slot on to views, until
+  // max_count views are appended. Stop with is_blocked set at a tuple whose
+  // lock is held by another transaction, the caller waits for it with the
+  // page unlatched. Stop without it if the transaction is aborted instead
+  // @return: slot to continue from, GetTupleCount() if all slots are read
+  int GetTupleViews(int first_slot, std::vector<TupleView> &views,
+                    size_t max_count, Transaction *txn,
+                    LockManager *lock_manager, bool &is_blocked);
+
   /**
    * Tuple iterator
    */
@@ -77,13 +139,25 @@ private:
    */
   int32_t GetTupleOffset(int slot_num);
   int32_t GetTupleSize(int slot_num);
+  // keeps the overflow flag of the slot
   void SetTupleOffset(int slot_num, int32_t offset);
+  bool IsOverflowTuple(int slot_num);
+  // set the offset and the overflow flag of a slot in use
+  void SetTupleOffset(int slot_num, int32_t offset, bool is_overflow);
+  // empty slots link to the next empty slot through the offset field
+  int32_t GetNextFreeSlot(int slot_num);
+  void SetNextFreeSlot(int slot_num, int32_t next_slot_num);
   void SetTupleSize(int slot_num, int32_t offset);
   int32_t GetFreeSpacePointer(); // offset of the beginning of free space
   void SetFreeSpacePointer(int32_t free_space_pointer);
   int32_t GetTupleCount(); // Note that this tuple count may be larger than # of
                            // actual tuples because some slots may be empty
   void SetTupleCount(int32_t tuple_count);
-  int32_t GetFreeSpaceSize();
+  int32_t GetFirstFreeSlot(); // -1 if there is no empty slot
+  void SetFirstFreeSlot(int32_t slot_num);
+  int32_t GetFragmentedSize(); // bytes of holes among tuples
+  void SetFragmentedSize(int32_t fragmented_size);
+  // free space between slot array and tuples, without holes
+  int32_t GetContiguousFreeSpaceSize();
 };
 } // namespace scudb
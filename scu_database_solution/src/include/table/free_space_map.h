@@ -0,0 +1,63 @@
+/**
+ * free_space_map.h
+ *
+ * Free space map of a table heap, so that an insert jumps to a page with
+ * enough room instead of walking the page chain. Free space of every heap
+ * page is rounded down to one of 16 fill classes and kept in a chain of
+ * FreeSpaceMapPage. The map is a hint: it is updated after every change of a
+ * heap page, an insert still checks the page it is sent to. A change of a
+ * map page (a fill class, the tail, a new map page) is logged as an
+ * operation of its own (see page_logger.h), so that recovery brings the map
+ * back with the heap pages; a map page left behind would send inserts to
+ * pages of another table.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "logging/log_manager.h"
+#include "page/free_space_map_page.h"
+
+namespace scudb {
+
+class FreeSpaceMap {
+public:
+  // open the map whose first page is root_page_id, or create an empty one
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, LogManager *log_manager,
+               page_id_t root_page_id = INVALID_PAGE_ID);
+
+  inline page_id_t GetRootPageId() const { return root_page_id_; }
+
+  // record free space (in bytes) of a heap page
+  void Update(page_id_t page_id, int free_space);
+
+  // a heap page with at least size bytes free, INVALID_PAGE_ID if none
+  page_id_t FindPage(int size);
+
+  // tail of the heap's page chain
+  page_id_t GetLastPageId();
+  void SetLastPageId(page_id_t page_id);
+
+private:
+  FreeSpaceMapPage *FetchMapPage(size_t index);
+  // append map pages until the one of index exists
+  void Extend(size_t index);
+
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  page_id_t root_page_id_;
+  // page ids of the chain, map page i describes heap pages
+  // [i * FSM_ENTRY_COUNT, (i + 1) * FSM_ENTRY_COUNT)
+  std::vector<page_id_t> page_ids_;
+  // upper bound of the fill classes of every map page, so that map pages
+  // without a fitting heap page are skipped without being read
+  std::vector<int> max_classes_;
+  // map page where the last search succeeded
+  size_t search_hint_;
+  std::mutex latch_;
+};
+
+} // namespace scudb
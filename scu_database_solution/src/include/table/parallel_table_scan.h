@@ -0,0 +1,101 @@
+/**
+ * parallel_table_scan.h
+ *
+ * Morsel driven parallel seq scan of table heap. A shared dispenser cuts the
+ * page chain into morsels of up to morsel size pages, every worker thread
+ * takes a morsel into its own queue and scans it a page at a time. A worker
+ * whose queue is empty once the dispenser ran dry steals half of the pages
+ * left in the queue of another worker, so that a few expensive pages do not
+ * keep one thread busy while the others are idle.
+ * Tuples are handed to the scan function along with the id of the worker,
+ * so that results are gathered per worker without sharing, and combined once
+ * all workers are done. Like table iterators, a scan does not run along with
+ * vacuum.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "concurrency/transaction.h"
+#include "table/tuple_view.h"
+
+namespace scudb {
+
+#define MORSEL_SIZE 16 // max pages in a morsel
+
+class TableHeap;
+
+class ParallelTableScan {
+public:
+  // called for every tuple, the view is valid during the call only
+  typedef std::function<void(size_t worker_id, const TupleView &view)>
+      ScanFunction;
+
+  ParallelTableScan(TableHeap *table_heap, Transaction *txn,
+                    size_t thread_count, size_t morsel_size = MORSEL_SIZE);
+
+  // scan the whole table, the calling thread is worker 0
+  void Run(const ScanFunction &scan);
+
+  /*
+   * Scan into one result per worker, scan(result, view), and fold them into
+   * init with combine(init, result)
+   */
+  template <typename ResultType, typename Scan, typename Combine>
+  ResultType Reduce(ResultType init, Scan scan, Combine combine) {
+    // own allocation per worker, so that results don't share cache lines
+    std::vector<std::unique_ptr<ResultType>> results;
+    for (size_t i = 0; i < thread_count_; i++)
+      results.emplace_back(new ResultType(init));
+    Run([&](size_t worker_id, const TupleView &view) {
+      scan(*results[worker_id], view);
+    });
+    for (auto &result : results)
+      combine(init, *result);
+    return init;
+  }
+
+  inline size_t GetThreadCount() const { return thread_count_; }
+
+  // pages scanned and pages stolen during the last run
+  inline size_t GetPageCount() const { return page_count_; }
+  inline size_t GetStealCount() const { return steal_count_; }
+
+private:
+  struct Worker {
+    std::deque<page_id_t> pages;
+    std::mutex latch;
+  };
+
+  void Work(size_t worker_id, const ScanFunction &scan);
+  void ScanPage(page_id_t page_id, std::vector<TupleView> &views,
+                size_t worker_id, const ScanFunction &scan);
+
+  // page for a worker, from its own queue, a new morsel or another worker
+  // @return: false if the table is done
+  bool NextPage(size_t worker_id, page_id_t &page_id);
+  // walk the page chain for the next morsel
+  bool NextMorsel(std::deque<page_id_t> &pages);
+  bool Steal(size_t worker_id, page_id_t &page_id);
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  size_t thread_count_;
+  size_t morsel_size_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // first page of the next morsel
+  page_id_t next_page_id_;
+  std::mutex dispenser_latch_;
+  // lock sets of the transaction are not thread safe
+  std::mutex txn_latch_;
+  std::atomic<size_t> page_count_;
+  std::atomic<size_t> steal_count_;
+};
+
+} // namespace scudb
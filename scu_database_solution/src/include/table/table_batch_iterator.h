@@ -0,0 +1,73 @@
+/**
+ * table_batch_iterator.h
+ *
+ * Batch at a time seq scan of table heap. Every batch holds views of up to
+ * batch size tuples of one page, which stays pinned and read latched until
+ * the next batch is asked for, so the buffer pool and the latch are visited
+ * once per page instead of once per tuple. Columns of a batch can also be
+ * decoded into a vector of values at once.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/page_guard.h"
+#include "concurrency/transaction.h"
+#include "table/tuple_view.h"
+
+namespace scudb {
+
+#define TABLE_BATCH_SIZE 64 // max tuples in a batch
+
+class PaxPage;
+class TableHeap;
+
+class TableBatchIterator {
+public:
+  TableBatchIterator(TableHeap *table_heap, Transaction *txn,
+                     size_t batch_size = TABLE_BATCH_SIZE);
+
+  // read the next batch, the views of the last one are no longer valid
+  // @return: false at the end of table or once the transaction is aborted,
+  // the batch is empty then
+  bool Next();
+
+  inline const std::vector<TupleView> &GetBatch() const { return batch_; }
+
+  inline size_t GetBatchSize() const { return batch_.size(); }
+
+  inline const TupleView &operator[](size_t index) const {
+    return batch_[index];
+  }
+
+  inline bool IsEnd() const { return is_end_; }
+
+  // values of one column over the batch, varchar values borrow the page
+  void GetColumn(Schema *schema, int column_id,
+                 std::vector<Value> &values) const;
+
+  // page of the batch if it is in PAX format, nullptr otherwise. Its
+  // minipages hold the values of the batch at the slots of their rids
+  PaxPage *GetPaxPage() const;
+
+  // unpin the page before the end of table
+  inline void Close() {
+    guard_.Release();
+    batch_.clear();
+    is_end_ = true;
+  }
+
+private:
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  size_t batch_size_;
+  ReadPageGuard guard_;
+  // page of the next batch and slot it starts from
+  page_id_t page_id_;
+  int slot_num_ = 0;
+  std::vector<TupleView> batch_;
+  bool is_end_ = false;
+};
+
+} // namespace scudb
@@ -6,9 +6,17 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/page_guard.h"
+#include "common/rwmutex.h"
 #include "logging/log_manager.h"
 #include "page/table_page.h"
+#include "table/free_space_map.h"
+#include "table/parallel_table_scan.h"
+#include "table/table_batch_iterator.h"
 #include "table/table_iterator.h"
 #include "table/tuple.h"
 
@@ -17,20 +25,35 @@ namespace scudb {
 class TableHeap {
   friend class TableIterator;
 
+  friend class TableBatchIterator;
+
+  friend class ParallelTableScan;
+
 public:
-  ~TableHeap() {}
+  // called with a tuple moved by vacuum or compress, and its old & new rid
+  typedef std::function<void(const Tuple &tuple, const RID &old_rid,
+                             const RID &new_rid)>
+      RelocateCallback;
+
+  ~TableHeap() { delete free_space_map_; }
 
   // open a table heap
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
             LogManager *log_manager, page_id_t first_page_id);
 
-  // create table heap
+  // create table heap, in PAX format (see pax_page.h) if a schema is given
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
-            LogManager *log_manager, Transaction *txn);
+            LogManager *log_manager, Transaction *txn,
+            Schema *pax_schema = nullptr);
 
-  // for insert, if tuple is too large (>~page_size), return false
+  // for insert, a tuple larger than TUPLE_OVERFLOW_THRESHOLD is stored with
+  // overflow pages, such tuples are rejected by a table in PAX format
   bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn);
 
+  // insert tuples in order, filling every page under one latch acquisition
+  bool InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> &rids,
+                    Transaction *txn);
+
   bool MarkDelete(const RID &rid, Transaction *txn); // for delete
 
   // if the new tuple is too large to fit in the old page, return false (will
@@ -38,21 +61,70 @@ public:
   bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
 
   // commit/abort time
-  void ApplyDelete(const RID &rid,
-                   Transaction *txn); // when commit delete or rollback insert
+  // when commit delete or rollback insert. Overflow pages of the tuple are
+  // left to DeleteOverflowPages, called with the first one returned here
+  // once the end of the transaction is logged: until then recovery may undo
+  // the delete and bring the tuple back
+  page_id_t ApplyDelete(const RID &rid, Transaction *txn);
   void RollbackDelete(const RID &rid, Transaction *txn); // when rollback delete
+  // give a chain of overflow pages back to the buffer pool
+  void DeleteOverflowPages(page_id_t page_id);
 
   bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn);
 
+  // view a tuple in place, its page stays pinned and latched by guard
+  bool GetTupleView(const RID &rid, TupleView &view, ReadPageGuard &guard,
+                    Transaction *txn);
+
   bool DeleteTableHeap();
 
+  // compact pages, move tuples of a sparse page into its previous page, and
+  // unlink & delete pages left empty. Runs along with inserts and deletes,
+  // but not with table iterators, which may stand on a deleted page
+  void Vacuum(Transaction *txn, const RelocateCallback &relocate = nullptr);
+
+  // encode the pages of a table in PAX format by their columns, and pull the
+  // tuples of following pages into a page as long as they fit. Tuples are
+  // rewritten without locks, so no other transaction may use the table, as
+  // after a bulk load
+  void Compress(Transaction *txn, const RelocateCallback &relocate = nullptr);
+
   TableIterator begin(Transaction *txn);
 
   TableIterator end();
 
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  inline bool IsPax() const { return is_pax_; }
+
+  // transactions writing only asynchronous tables commit asynchronously
+  inline bool IsAsyncCommit() const { return is_async_commit_; }
+  inline void SetAsyncCommit(bool is_async_commit) {
+    is_async_commit_ = is_async_commit;
+  }
+
 private:
+  // lock rid for txn unless it holds the lock already, waiting if need be.
+  // No page latch may be held
+  bool LockTuple(const RID &rid, Transaction *txn, bool is_exclusive);
+
+  // last page of the chain and a new page behind it, both write latched
+  TablePage *FetchLastPage();
+  TablePage *AppendPage(TablePage *last_page, Transaction *txn);
+  void FillPage(TablePage *page, const std::vector<Tuple> &tuples,
+                std::vector<RID> &rids, size_t &next, Transaction *txn);
+
+  // move as many tuples of src as fit into dst, unlogged
+  void MoveTuples(TablePage *src, TablePage *dst, Transaction *txn,
+                  std::vector<Tuple> &tuples, std::vector<RID> &new_rids);
+  // copy the tuples of a page out, along with their rids
+  bool ReadTuples(TablePage *page, std::vector<Tuple> &tuples,
+                  std::vector<RID> &rids, Transaction *txn);
+
+  // write bytes of tuple behind its head into a chain of overflow pages
+  // @return: first page of the chain, INVALID_PAGE_ID if out of memory
+  page_id_t WriteOverflowPages(const Tuple &tuple);
+
   /**
    * Members
    */
@@ -60,6 +132,14 @@ private:
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_;
+  // free space of every page, inserts go straight to a page with room
+  FreeSpaceMap *free_space_map_;
+  // pages are in PAX format
+  bool is_pax_;
+  bool is_async_commit_;
+  // page chain latch, inserts share it and vacuum holds it exclusively while
+  // it may unlink a page, so that no insert lands on a deleted page
+  RWMutex latch_;
 };
 
 } // namespace scudb
@@ -1,15 +1,19 @@
 /**
  * table_iterator.h
  *
- * For seq scan of table heap
+ * For seq scan of table heap. The iterator keeps the page of the current
+ * tuple pinned and read latched, and hands out a view of the tuple in the
+ * page instead of a copy. A view, and varchar values read from it, are
+ * valid until the iterator moves on.
  */
 
 #pragma once
 
 #include <cassert>
 
+#include "buffer/page_guard.h"
 #include "common/rid.h"
-#include "table/tuple.h"
+#include "table/tuple_view.h"
 
 namespace scudb {
 
@@ -18,31 +22,43 @@ class TableHeap;
 class TableIterator {
   friend class Cursor;
 
+  friend class TableHeap;
+
 public:
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
-  ~TableIterator() { delete tuple_; }
+  // a copy pins and latches the page once more
+  TableIterator(const TableIterator &other);
+  TableIterator &operator=(const TableIterator &other);
+
+  TableIterator(TableIterator &&other) = default;
+  TableIterator &operator=(TableIterator &&other) = default;
 
   inline bool operator==(const TableIterator &itr) const {
-    return tuple_->rid_.Get() == itr.tuple_->rid_.Get();
+    return rid_.Get() == itr.rid_.Get();
   }
 
   inline bool operator!=(const TableIterator &itr) const {
     return !(*this == itr);
   }
 
-  const Tuple &operator*();
+  const TupleView &operator*();
 
-  Tuple *operator->();
+  const TupleView *operator->();
 
   TableIterator &operator++();
 
   TableIterator operator++(int);
 
 private:
+  // latch the page of rid_ and point the view at the tuple
+  void Load();
+
   TableHeap *table_heap_;
-  Tuple *tuple_;
+  RID rid_;
   Transaction *txn_;
+  ReadPageGuard guard_;
+  TupleView tuple_;
 };
 
-} // namespace scudb
\ No newline at end of file
+} // namespace scudb
@@ -5,6 +5,11 @@
  *  ------------------------------------------------------------------
  * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD|
  *  ------------------------------------------------------------------
+ *
+ * A tuple larger than TUPLE_OVERFLOW_THRESHOLD keeps only its first
+ * TUPLE_INLINE_SIZE bytes in the table page, the rest goes to a chain of
+ * overflow pages. Such a tuple read from the table heap holds the head only,
+ * the rest is read when a column outside of the head is asked for.
  */
 
 #pragma once
@@ -15,6 +20,11 @@
 
 namespace scudb {
 
+#define TUPLE_OVERFLOW_THRESHOLD (PAGE_SIZE / 4)
+#define TUPLE_INLINE_SIZE (PAGE_SIZE / 8)
+
+class BufferPoolManager;
+
 class Tuple {
   friend class TablePage;
 
@@ -22,12 +32,16 @@ class Tuple {
 
   friend class TableIterator;
 
+  friend class TupleView;
+
+  friend class PaxPage;
+
 public:
   // Default constructor (to create a dummy tuple)
   inline Tuple() : allocated_(false), rid_(RID()), size_(0), data_(nullptr) {}
 
   // constructor for table heap tuple
-  Tuple(RID rid) : allocated_(false), rid_(rid) {}
+  Tuple(RID rid) : allocated_(false), rid_(rid), size_(0), data_(nullptr) {}
 
   // constructor for creating a new tuple based on input value
   Tuple(std::vector<Value> values, Schema *schema);
@@ -38,6 +52,10 @@ public:
   // assign operator, deep copy
   Tuple &operator=(const Tuple &other);
 
+  // move constructor and assign operator, take over the data of other
+  Tuple(Tuple &&other);
+  Tuple &operator=(Tuple &&other);
+
   ~Tuple() {
     if (allocated_)
       delete[] data_;
@@ -50,6 +68,12 @@ public:
   // deserialize tuple data(deep copy)
   void DeserializeFrom(const char *storage);
 
+  // the tuple as written to the log, the head only if it has overflow
+  // pages, see log_record.h. Length is of the bytes after the size
+  int32_t GetLogLength() const;
+  void SerializeLogTo(char *storage) const;
+  void DeserializeLogFrom(const char *storage);
+
   // return RID of current tuple
   inline RID GetRid() const { return rid_; }
 
@@ -76,10 +100,30 @@ private:
   // Get the starting storage address of specific column
   const char *GetDataPtr(Schema *schema, const int column_id) const;
 
+  // make sure bytes before end are read from overflow pages
+  inline void ReadUntil(int32_t end) const {
+    if (end > TUPLE_INLINE_SIZE && overflow_page_id_ != INVALID_PAGE_ID &&
+        !is_overflow_read_)
+      ReadOverflow();
+  }
+  void ReadOverflow() const;
+  // bytes of data_ holding valid data
+  inline int32_t GetReadSize() const {
+    return overflow_page_id_ == INVALID_PAGE_ID || is_overflow_read_
+               ? size_
+               : TUPLE_INLINE_SIZE;
+  }
+
   bool allocated_; // is allocated?
   RID rid_;        // if pointing to the table heap, the rid is valid
   int32_t size_;
   char *data_;
+  // first overflow page if the tuple is stored with overflow pages
+  page_id_t overflow_page_id_ = INVALID_PAGE_ID;
+  // are the bytes behind the head read into data_ yet
+  mutable bool is_overflow_read_ = false;
+  // where overflow pages are read from
+  BufferPoolManager *buffer_pool_manager_ = nullptr;
 };
 
 } // namespace scudb
@@ -0,0 +1,86 @@
+/**
+ * tuple_view.h
+ *
+ * Read only view of a tuple stored in a table page. The view points into the
+ * page frame instead of copying the tuple, so it is only valid while the page
+ * stays pinned and read latched (see ReadPageGuard), and so are varchar
+ * values read from it.
+ * A tuple stored with overflow pages is viewed by its head, columns behind
+ * the head are read from an owned copy made on first use. A tuple of a PAX
+ * page is read from the minipages of its columns.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "table/tuple.h"
+#include "type/value.h"
+
+namespace scudb {
+
+class PaxPage;
+
+class TupleView {
+  friend class TablePage;
+
+  friend class PaxPage;
+
+public:
+  TupleView() = default;
+
+  TupleView(const TupleView &other)
+      : rid_(other.rid_), data_(other.data_), size_(other.size_),
+        overflow_page_id_(other.overflow_page_id_),
+        buffer_pool_manager_(other.buffer_pool_manager_),
+        pax_page_(other.pax_page_) {}
+
+  TupleView &operator=(const TupleView &other) {
+    rid_ = other.rid_;
+    data_ = other.data_;
+    size_ = other.size_;
+    overflow_page_id_ = other.overflow_page_id_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    pax_page_ = other.pax_page_;
+    overflow_tuple_.reset();
+    return *this;
+  }
+
+  inline RID GetRid() const { return rid_; }
+
+  // length of the whole tuple, the view may hold its head only
+  inline int32_t GetLength() const { return size_; }
+
+  // value of a column, a varchar value borrows the bytes of the page
+  Value GetValue(Schema *schema, const int column_id) const;
+
+  inline bool IsNull(Schema *schema, const int column_id) const {
+    return GetValue(schema, column_id).IsNull();
+  }
+
+  // deep copy, valid after the page is released
+  Tuple ToTuple() const;
+
+  // where the rest of a tuple with overflow pages is read from
+  inline void SetBufferPoolManager(BufferPoolManager *buffer_pool_manager) {
+    buffer_pool_manager_ = buffer_pool_manager;
+  }
+
+private:
+  // start of the column if it is within the bytes of the view
+  const char *GetDataPtr(Schema *schema, const int column_id) const;
+
+  RID rid_;
+  const char *data_ = nullptr;
+  int32_t size_ = 0;
+  page_id_t overflow_page_id_ = INVALID_PAGE_ID;
+  BufferPoolManager *buffer_pool_manager_ = nullptr;
+  // the whole tuple, once a column behind the head is asked for
+  mutable std::unique_ptr<Tuple> overflow_tuple_;
+  // page of a tuple in PAX format, data_ is not used then
+  PaxPage *pax_page_ = nullptr;
+};
+
+} // namespace scudb
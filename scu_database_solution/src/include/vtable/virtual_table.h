@@ -8,7 +8,12 @@
 #include "catalog/schema.h"
 #include "concurrency/transaction_manager.h"
 #include "index/b_plus_tree_index.h"
+#include "index/be_tree_index.h"
+#include "index/extendible_hash_index.h"
+#include "logging/checkpoint_manager.h"
 #include "logging/log_manager.h"
+#include "logging/log_recovery.h"
+#include "logging/log_replica.h"
 #include "sqlite/sqlite3ext.h"
 #include "table/table_heap.h"
 #include "table/tuple.h"
@@ -26,9 +31,24 @@ Tuple ConstructTuple(Schema *schema, sqlite3_value **argv);
 
 Index *ConstructIndex(IndexMetadata *metadata,
                       BufferPoolManager *buffer_pool_manager,
-                      page_id_t root_id = INVALID_PAGE_ID);
+                      page_id_t root_id = INVALID_PAGE_ID,
+                      LogManager *log_manager = nullptr);
 Transaction *GetTransaction();
 
+bool IsIndexCovering(Index *index, sqlite3_uint64 column_mask);
+
+// flags of idxNum, passed from VtabBestIndex to VtabFilter
+#define INDEX_SCAN_EQUAL 1 // equality on all indexed columns
+#define INDEX_SCAN_LOWER 2 // lower bound on the indexed column
+#define INDEX_SCAN_UPPER 4 // upper bound on the indexed column
+#define INDEX_ONLY_SCAN 8  // all needed columns are stored in the index
+
+// rows buffered by a table before they are written as one batch
+#define INSERT_BATCH_SIZE 256
+
+// threads redoing the log when the database is opened
+#define REDO_WORKER_COUNT 4
+
 /* API declaration */
 int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
                sqlite3_vtab **ppVtab, char **pzErr);
@@ -62,7 +82,7 @@ int VtabBegin(sqlite3_vtab *pVTab);
 // storage engine
 class StorageEngine {
 public:
-  StorageEngine(std::string db_file_name) {
+  StorageEngine(std::string db_file_name) : replica_(nullptr) {
     ENABLE_LOGGING = false;
 
     // storage related
@@ -77,9 +97,31 @@ public:
     // txn related
     lock_manager_ = new LockManager(true); // S2PL
     transaction_manager_ = new TransactionManager(lock_manager_, log_manager_);
+    checkpoint_manager_ =
+        new CheckpointManager(transaction_manager_, log_manager_,
+                              buffer_pool_manager_, disk_manager_);
+  }
+
+  // read-only replica of the database in primary_db_file_name, bootstrapped
+  // into db_file_name; logging stays off, the log is the primary's
+  StorageEngine(std::string db_file_name, std::string primary_db_file_name) {
+    ENABLE_LOGGING = false;
+
+    disk_manager_ = new DiskManager(db_file_name, primary_db_file_name);
+    log_manager_ = new LogManager(disk_manager_);
+    // pages get the lsns of the primary's log, none to wait for
+    buffer_pool_manager_ =
+        new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_);
+    lock_manager_ = new LockManager(true); // S2PL
+    transaction_manager_ = new TransactionManager(lock_manager_, log_manager_);
+    checkpoint_manager_ = nullptr;
+    replica_ = new LogReplica(disk_manager_, buffer_pool_manager_);
+    replica_->Bootstrap();
   }
 
   ~StorageEngine() {
+    delete replica_;
+    delete checkpoint_manager_;
     if (ENABLE_LOGGING)
       log_manager_->StopFlushThread();
     delete disk_manager_;
@@ -94,11 +136,19 @@ public:
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
+  CheckpointManager *checkpoint_manager_;
+  // nullptr unless this is a replica
+  LogReplica *replica_;
 };
 
 StorageEngine *storage_engine_;
 // global transaction, sqlite does not support concurrent transaction
 Transaction *global_transaction_ = nullptr;
+// tables holding buffered inserts, flushed before anything reads them and
+// before the transaction commits
+class VirtualTable;
+std::vector<VirtualTable *> pending_tables_;
+bool FlushInserts();
 
 class VirtualTable {
   friend class Cursor;
@@ -106,7 +156,7 @@ class VirtualTable {
 public:
   VirtualTable(Schema *schema, BufferPoolManager *buffer_pool_manager,
                LockManager *lock_manager, LogManager *log_manager, Index *index,
-               page_id_t first_page_id = INVALID_PAGE_ID)
+               page_id_t first_page_id = INVALID_PAGE_ID, bool is_pax = false)
       : schema_(schema), index_(index) {
     if (first_page_id != INVALID_PAGE_ID) {
       // reopen an exist table
@@ -115,8 +165,8 @@ public:
     } else {
       // create table for the first time
       Transaction *txn = storage_engine_->transaction_manager_->Begin();
-      table_heap_ =
-          new TableHeap(buffer_pool_manager, lock_manager, log_manager, txn);
+      table_heap_ = new TableHeap(buffer_pool_manager, lock_manager,
+                                  log_manager, txn, is_pax ? schema : nullptr);
       storage_engine_->transaction_manager_->Commit(txn);
     }
   }
@@ -136,13 +186,63 @@ public:
   inline void InsertEntry(const Tuple &tuple, const RID &rid) {
     if (index_ == nullptr)
       return;
-    // construct indexed key tuple
-    std::vector<Value> key_values;
+    // construct index entry tuple, key columns followed by included columns
+    std::vector<Value> entry_values;
 
-    for (auto &i : index_->GetKeyAttrs())
-      key_values.push_back(tuple.GetValue(schema_, i));
-    Tuple key(key_values, index_->GetKeySchema());
-    index_->InsertEntry(key, rid, GetTransaction());
+    for (auto &i : index_->GetEntryAttrs())
+      entry_values.push_back(tuple.GetValue(schema_, i));
+    Tuple entry(entry_values, index_->GetEntrySchema());
+    index_->InsertEntry(entry, rid, GetTransaction());
+  }
+
+  // whether the entry of tuple would be cut off in an index that keeps its
+  // entries whole, i.e. a varchar of the entry is longer than declared
+  inline bool IsEntryTooLong(const Tuple &tuple) {
+    if (index_ == nullptr || !index_->GetMetadata()->IsEntryWhole())
+      return false;
+    for (auto &i : index_->GetEntryAttrs()) {
+      if (!schema_->IsInlined(i) &&
+          (int)tuple.GetValue(schema_, i).GetLength() >
+              schema_->GetVariableLength(i) + 1)
+        return true;
+    }
+    return false;
+  }
+
+  // buffer a row, rows are inserted into table heap and index in batches
+  // @return: false if a batch written along failed, see FlushInserts
+  inline bool BufferInsert(const Tuple &tuple) {
+    if (pending_tuples_.empty())
+      pending_tables_.push_back(this);
+    pending_tuples_.push_back(tuple);
+    if (pending_tuples_.size() >= INSERT_BATCH_SIZE)
+      return FlushInserts();
+    return true;
+  }
+
+  // insert buffered rows
+  // @return: false if the transaction is aborted, the rows are dropped then
+  // and those of the batch already in table heap are left to the rollback
+  inline bool Flush() {
+    if (pending_tuples_.empty())
+      return true;
+    std::vector<RID> rids;
+    // on failure the transaction is aborted and nothing gets indexed
+    bool is_inserted =
+        GetTransaction()->GetState() != TransactionState::ABORTED &&
+        table_heap_->InsertTuples(pending_tuples_, rids, GetTransaction());
+    if (is_inserted && index_ != nullptr) {
+      std::vector<Tuple> entries;
+      for (auto &tuple : pending_tuples_) {
+        std::vector<Value> entry_values;
+        for (auto &i : index_->GetEntryAttrs())
+          entry_values.push_back(tuple.GetValue(schema_, i));
+        entries.emplace_back(entry_values, index_->GetEntrySchema());
+      }
+      index_->InsertEntries(entries, rids, GetTransaction());
+    }
+    pending_tuples_.clear();
+    return is_inserted;
   }
 
   // delete from table heap
@@ -163,7 +263,7 @@ public:
     for (auto &i : index_->GetKeyAttrs())
       key_values.push_back(deleted_tuple.GetValue(schema_, i));
     Tuple key(key_values, index_->GetKeySchema());
-    index_->DeleteEntry(key, GetTransaction());
+    index_->DeleteEntry(key, rid, GetTransaction());
   }
 
   // update table heap tuple
@@ -192,13 +292,15 @@ private:
   TableHeap *table_heap_;
   // to insert/delete index entry
   Index *index_ = nullptr;
+  // rows inserted but not written yet
+  std::vector<Tuple> pending_tuples_;
 };
 
 class Cursor {
 public:
   Cursor(VirtualTable *virtual_table)
-      : table_iterator_(virtual_table->begin()), virtual_table_(virtual_table) {
-  }
+      : batch_iterator_(virtual_table->table_heap_, GetTransaction()),
+        virtual_table_(virtual_table) {}
 
   inline void SetScanFlag(bool is_index_scan) {
     is_index_scan_ = is_index_scan;
@@ -206,6 +308,18 @@ public:
 
   inline bool IsIndexScan() { return is_index_scan_; }
 
+  // answer columns from index entries instead of the table heap
+  inline void SetIndexOnly(bool is_index_only) {
+    is_index_only_ = is_index_only;
+    entry_columns_.assign(virtual_table_->schema_->GetColumnCount(), -1);
+    if (!is_index_only)
+      return;
+    const std::vector<int> &entry_attrs =
+        virtual_table_->index_->GetEntryAttrs();
+    for (int i = 0; i < (int)entry_attrs.size(); i++)
+      entry_columns_[entry_attrs[i]] = i;
+  }
+
   inline VirtualTable *GetVirtualTable() { return virtual_table_; }
 
   inline Schema *GetKeySchema() {
@@ -216,40 +330,87 @@ public:
     if (is_index_scan_)
       return results[offset_].Get();
     else
-      return (*table_iterator_).GetRid().Get();
+      return batch_iterator_[batch_offset_].GetRid().Get();
   }
 
+  // columns are read in place, without copying the row
+
   // return tuple at which cursor is currently pointed
   inline Value GetCurrentValue(Schema *schema, int column) {
-    if (is_index_scan_) {
-      RID rid = results[offset_];
-      Tuple tuple(rid);
-      virtual_table_->table_heap_->GetTuple(rid, tuple, GetTransaction());
-      return tuple.GetValue(schema, column);
+    if (is_index_scan_ && is_index_only_) {
+      assert(entry_columns_[column] != -1);
+      return entries_[offset_][entry_columns_[column]];
+    } else if (is_index_scan_) {
+      // latch the page once per row, columns are then read from the view
+      if (row_offset_ != offset_) {
+        // refused for its lock, the transaction is aborted then
+        if (!virtual_table_->table_heap_->GetTupleView(
+                results[offset_], row_, row_guard_, GetTransaction()))
+          return Value(schema->GetType(column));
+        row_offset_ = offset_;
+      }
+      return row_.GetValue(schema, column);
     } else {
-      return table_iterator_->GetValue(schema, column);
+      return batch_iterator_[batch_offset_].GetValue(schema, column);
     }
   }
 
   // move cursor up to next
   Cursor &operator++() {
-    if (is_index_scan_)
+    if (is_index_scan_) {
+      // the page is not held while sqlite works on other rows
+      row_guard_.Release();
       ++offset_;
-    else
-      ++table_iterator_;
+    } else if (++batch_offset_ == batch_iterator_.GetBatchSize()) {
+      batch_iterator_.Next();
+      batch_offset_ = 0;
+    }
     return *this;
   }
+  // a scan that lost a lock ends early, the transaction has to be rolled back
+  inline bool IsAborted() {
+    return GetTransaction()->GetState() == TransactionState::ABORTED;
+  }
+
   // is end of cursor(no more tuple)
   inline bool isEof() {
     if (is_index_scan_)
       return offset_ == static_cast<int>(results.size());
     else
-      return table_iterator_ == virtual_table_->end();
+      return batch_iterator_.GetBatchSize() == 0;
+  }
+
+  // sequential scan from the first tuple
+  inline void ScanTable() {
+    batch_iterator_ =
+        TableBatchIterator(virtual_table_->table_heap_, GetTransaction());
+    batch_iterator_.Next();
+    batch_offset_ = 0;
   }
 
   // wrapper around poit scan methods
   inline void ScanKey(const Tuple &key) {
-    virtual_table_->index_->ScanKey(key, results);
+    if (is_index_only_) {
+      ScanRange(&key, &key);
+      return;
+    }
+    results.clear();
+    offset_ = 0;
+    row_offset_ = -1;
+    row_guard_.Release();
+    virtual_table_->index_->ScanKey(key, results, GetTransaction());
+  }
+
+  // wrapper around range scan methods
+  inline void ScanRange(const Tuple *low_key, const Tuple *high_key) {
+    results.clear();
+    entries_.clear();
+    offset_ = 0;
+    row_offset_ = -1;
+    row_guard_.Release();
+    virtual_table_->index_->ScanRange(low_key, high_key, results,
+                                      is_index_only_ ? &entries_ : nullptr,
+                                      GetTransaction());
   }
 
 private:
@@ -257,8 +418,18 @@ private:
   // for index scan
   std::vector<RID> results;
   int offset_ = 0;
-  // for sequential scan
-  TableIterator table_iterator_;
+  // view of results[row_offset_], and the latched page it points into
+  ReadPageGuard row_guard_;
+  TupleView row_;
+  int row_offset_ = -1;
+  // for index only scan, entry of each result and position of every table
+  // column inside an entry
+  bool is_index_only_ = false;
+  std::vector<std::vector<Value>> entries_;
+  std::vector<int> entry_columns_;
+  // for sequential scan, rows are read a page at a time
+  TableBatchIterator batch_iterator_;
+  size_t batch_offset_ = 0;
   // flag to indicate which scan method is currently used
   bool is_index_scan_ = false;
   VirtualTable *virtual_table_;
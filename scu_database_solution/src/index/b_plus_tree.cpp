@@ -2,12 +2,14 @@
  * b_plus_tree.cpp
  */
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
 #include "index/b_plus_tree.h"
+#include "logging/page_logger.h"
 #include "page/header_page.h"
 
 namespace scudb {
@@ -16,15 +18,19 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(const std::string &name,
                                 BufferPoolManager *buffer_pool_manager,
                                 const KeyComparator &comparator,
-                                page_id_t root_page_id)
+                                page_id_t root_page_id,
+                                LogManager *log_manager)
     : index_name_(name), root_page_id_(root_page_id),
-      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator) {}
+      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+      log_manager_(log_manager) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const {
+  return root_page_id_ == INVALID_PAGE_ID;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -37,7 +43,45 @@ INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
                               std::vector<ValueType> &result,
                               Transaction *transaction) {
-  return false;
+  latch_.RLock();
+  if (IsEmpty()) {
+    latch_.RUnlock();
+    return false;
+  }
+  auto *leaf = FindLeafPage(key);
+  ValueType value;
+  bool found = leaf->Lookup(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  latch_.RUnlock();
+  if (found)
+    result.push_back(value);
+  return found;
+}
+
+/*
+ * Replace the value of an existing key in place, the structure of the tree
+ * never changes so no split or merge is involved
+ * @return: false if key does not exist
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Update(const KeyType &key, const ValueType &value,
+                            Transaction *transaction) {
+  latch_.WLock();
+  if (IsEmpty()) {
+    latch_.WUnlock();
+    return false;
+  }
+  PageLogger page_logger(log_manager_);
+  auto *leaf = FindLeafPage(key);
+  int index = leaf->KeyIndex(key, comparator_);
+  bool found = index < leaf->GetSize() &&
+               comparator_(leaf->KeyAt(index), key) == 0;
+  if (found)
+    leaf->SetValueAt(index, value);
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), found);
+  page_logger.Commit();
+  latch_.WUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -53,8 +97,67 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value,
                             Transaction *transaction) {
-  return false;
+  latch_.WLock();
+  PageLogger page_logger(log_manager_);
+  bool res = true;
+  if (IsEmpty())
+    StartNewTree(key, value);
+  else
+    res = InsertIntoLeaf(key, value, transaction);
+  page_logger.Commit();
+  latch_.WUnlock();
+  return res;
 }
+/*
+ * Insert sorted key & value pairs under one acquisition of the tree latch.
+ * The leaf of a key is searched once and then takes every following key
+ * below the separator of the leaf, so a run of close keys costs one descent.
+ * After a split the search starts over from the root for the next key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertBatch(
+    const std::vector<std::pair<KeyType, ValueType>> &items,
+    std::vector<bool> &inserted, Transaction *transaction) {
+  inserted.assign(items.size(), false);
+  if (items.empty())
+    return;
+  latch_.WLock();
+  PageLogger page_logger(log_manager_);
+  size_t next = 0;
+  if (IsEmpty()) {
+    StartNewTree(items[0].first, items[0].second);
+    inserted[next++] = true;
+  }
+  while (next < items.size()) {
+    KeyType high_key;
+    bool has_high_key = false;
+    auto *leaf = FindLeafPage(items[next].first, high_key, has_high_key);
+    bool is_dirty = false;
+    do {
+      const KeyType &key = items[next].first;
+      ValueType existing;
+      if (leaf->Lookup(key, existing, comparator_)) {
+        next++;
+        continue;
+      }
+      is_dirty = true;
+      inserted[next] = true;
+      int size = leaf->Insert(key, items[next].second, comparator_);
+      next++;
+      if (size > leaf->GetMaxSize()) {
+        auto *new_leaf = Split(leaf);
+        InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+        buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+        break;
+      }
+    } while (next < items.size() &&
+             (!has_high_key || comparator_(items[next].first, high_key) < 0));
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), is_dirty);
+  }
+  page_logger.Commit();
+  latch_.WUnlock();
+}
+
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -62,7 +165,18 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value,
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  auto *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory");
+  auto *root = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+  root->Init(page_id, INVALID_PAGE_ID);
+  root_page_id_ = page_id;
+  UpdateRootPageId(true);
+  root->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -75,7 +189,19 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
                                     Transaction *transaction) {
-  return false;
+  auto *leaf = FindLeafPage(key);
+  ValueType existing;
+  if (leaf->Lookup(key, existing, comparator_)) {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    return false;
+  }
+  if (leaf->Insert(key, value, comparator_) > leaf->GetMaxSize()) {
+    auto *new_leaf = Split(leaf);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  return true;
 }
 
 /*
@@ -86,7 +212,16 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * of key & value pairs from input page to newly created page
  */
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N> N *BPLUSTREE_TYPE::Split(N *node) { return nullptr; }
+template <typename N> N *BPLUSTREE_TYPE::Split(N *node) {
+  page_id_t page_id;
+  auto *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory");
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  new_node->Init(page_id, node->GetParentPageId());
+  node->MoveHalfTo(new_node, buffer_pool_manager_);
+  return new_node;
+}
 
 /*
  * Insert key & value pair into internal page after split
@@ -101,7 +236,40 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
                                       const KeyType &key,
                                       BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    page_id_t page_id;
+    auto *page = buffer_pool_manager_->NewPage(page_id);
+    if (page == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX, "out of memory");
+    auto *root = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
+        page->GetData());
+    root->Init(page_id, INVALID_PAGE_ID);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(page_id);
+    new_node->SetParentPageId(page_id);
+    root_page_id_ = page_id;
+    UpdateRootPageId(false);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return;
+  }
+
+  auto *page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while inserting");
+  auto *parent = reinterpret_cast<
+      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
+      page->GetData());
+  new_node->SetParentPageId(parent->GetPageId());
+  if (parent->InsertNodeAfter(old_node->GetPageId(), key,
+                              new_node->GetPageId()) > parent->GetMaxSize()) {
+    auto *new_parent = Split(parent);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -114,7 +282,26 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  latch_.WLock();
+  if (IsEmpty()) {
+    latch_.WUnlock();
+    return;
+  }
+  PageLogger page_logger(log_manager_);
+  auto *leaf = FindLeafPage(key);
+  page_id_t leaf_id = leaf->GetPageId();
+  int old_size = leaf->GetSize();
+  bool deleted = false;
+  if (leaf->RemoveAndDeleteRecord(key, comparator_) < old_size &&
+      leaf->GetSize() < leaf->GetMinSize())
+    deleted = CoalesceOrRedistribute(leaf, transaction);
+  buffer_pool_manager_->UnpinPage(leaf_id, true);
+  if (deleted)
+    buffer_pool_manager_->DeletePage(leaf_id);
+  page_logger.Commit();
+  latch_.WUnlock();
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -126,7 +313,46 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+  if (node->IsRootPage())
+    return AdjustRoot(node);
+
+  auto *page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while removing");
+  auto *parent = reinterpret_cast<
+      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
+      page->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  // prefer the left sibling, the leftmost child borrows from its right one
+  int sibling_index = index == 0 ? 1 : index - 1;
+  page = buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_index));
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while removing");
+  auto *neighbor = reinterpret_cast<N *>(page->GetData());
+
+  if (neighbor->GetSize() + node->GetSize() > node->GetMaxSize()) {
+    Redistribute(neighbor, node, index);
+    buffer_pool_manager_->UnpinPage(neighbor->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+    return false;
+  }
+
+  // always merge the right page into the left one
+  bool node_deleted = index != 0;
+  N *left = node_deleted ? neighbor : node;
+  N *right = node_deleted ? node : neighbor;
+  page_id_t right_id = right->GetPageId();
+  page_id_t parent_id = parent->GetPageId();
+  bool parent_deleted = Coalesce(left, right, parent,
+                                 node_deleted ? index : sibling_index,
+                                 transaction);
+  buffer_pool_manager_->UnpinPage(neighbor->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(parent_id, true);
+  if (!node_deleted)
+    buffer_pool_manager_->DeletePage(right_id);
+  if (parent_deleted)
+    buffer_pool_manager_->DeletePage(parent_id);
+  return node_deleted;
 }
 
 /*
@@ -147,6 +373,11 @@ bool BPLUSTREE_TYPE::Coalesce(
     N *&neighbor_node, N *&node,
     BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *&parent,
     int index, Transaction *transaction) {
+  // "node" is the right page at position "index" of parent
+  node->MoveAllTo(neighbor_node, index, buffer_pool_manager_);
+  parent->Remove(index);
+  if (parent->GetSize() < parent->GetMinSize())
+    return CoalesceOrRedistribute(parent, transaction);
   return false;
 }
 
@@ -161,7 +392,13 @@ bool BPLUSTREE_TYPE::Coalesce(
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  if (index == 0) {
+    neighbor_node->MoveFirstToEndOf(node, buffer_pool_manager_);
+  } else {
+    neighbor_node->MoveLastToFrontOf(node, index, buffer_pool_manager_);
+  }
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +411,29 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
-  return false;
+  // case 2: the whole tree is empty
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0)
+      return false;
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(false);
+    return true;
+  }
+  // case 1: promote the last child to be the new root
+  if (old_root_node->GetSize() > 1)
+    return false;
+  auto *root = reinterpret_cast<
+      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
+      old_root_node);
+  root_page_id_ = root->RemoveAndReturnOnlyChild();
+  auto *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while removing");
+  auto *new_root = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  new_root->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  UpdateRootPageId(false);
+  return true;
 }
 
 /*****************************************************************************
@@ -186,7 +445,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
+  if (IsEmpty())
+    return INDEXITERATOR_TYPE(nullptr, 0, buffer_pool_manager_);
+  KeyType unused;
+  return INDEXITERATOR_TYPE(FindLeafPage(unused, true), 0,
+                            buffer_pool_manager_);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -195,7 +460,11 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  return INDEXITERATOR_TYPE();
+  if (IsEmpty())
+    return INDEXITERATOR_TYPE(nullptr, 0, buffer_pool_manager_);
+  auto *leaf = FindLeafPage(key);
+  return INDEXITERATOR_TYPE(leaf, leaf->KeyIndex(key, comparator_),
+                            buffer_pool_manager_);
 }
 
 /*****************************************************************************
@@ -208,7 +477,58 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
                                                          bool leftMost) {
-  return nullptr;
+  if (IsEmpty())
+    return nullptr;
+  page_id_t page_id = root_page_id_;
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while searching");
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
+    page_id_t child_id = leftMost ? internal->ValueAt(0)
+                                  : internal->Lookup(key, comparator_);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = child_id;
+    page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "all page are pinned while searching");
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(node);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
+                                                         KeyType &high_key,
+                                                         bool &has_high_key) {
+  has_high_key = false;
+  page_id_t page_id = root_page_id_;
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while searching");
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
+    page_id_t child_id = internal->Lookup(key, comparator_);
+    // the key right of the child is the tightest bound seen so far
+    int index = internal->ValueIndex(child_id);
+    if (index + 1 < internal->GetSize()) {
+      high_key = internal->KeyAt(index + 1);
+      has_high_key = true;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = child_id;
+    page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "all page are pinned while searching");
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(node);
 }
 
 /*
@@ -223,11 +543,9 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(
       buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record)
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  else
-    // update root_page_id in header_page
+  // create a new record<index_name + root_page_id> in header_page, or
+  // update root_page_id in header_page if the record already exists
+  if (!insert_record || !header_page->InsertRecord(index_name_, root_page_id_))
     header_page->UpdateRecord(index_name_, root_page_id_);
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
@@ -237,7 +555,42 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
  * print out whole b+tree sturcture, rank by rank
  */
 INDEX_TEMPLATE_ARGUMENTS
-std::string BPLUSTREE_TYPE::ToString(bool verbose) { return "Empty tree"; }
+std::string BPLUSTREE_TYPE::ToString(bool verbose) {
+  if (IsEmpty())
+    return "Empty tree";
+  std::ostringstream os;
+  std::queue<BPlusTreePage *> cur, next;
+  auto *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while printing");
+  cur.push(reinterpret_cast<BPlusTreePage *>(page->GetData()));
+  bool first = true;
+  while (!cur.empty()) {
+    BPlusTreePage *node = cur.front();
+    cur.pop();
+    if (first)
+      first = false;
+    else
+      os << " | ";
+    if (node->IsLeafPage()) {
+      os << reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(node)->ToString(
+          verbose);
+    } else {
+      auto *internal = reinterpret_cast<
+          BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
+      os << internal->ToString(verbose);
+      internal->QueueUpChildren(&next, buffer_pool_manager_);
+    }
+    buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+    if (cur.empty() && !next.empty()) {
+      // one rank per line
+      os << "\n";
+      first = true;
+      std::swap(cur, next);
+    }
+  }
+  return os.str();
+}
 
 /*
  * This method is used for test only
@@ -2,7 +2,10 @@
  * b_plus_tree_index.cpp
  */
 
+#include <algorithm>
+
 #include "index/b_plus_tree_index.h"
+#include "logging/page_logger.h"
 
 namespace scudb {
 /*
@@ -11,10 +14,12 @@ namespace scudb {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata,
                                      BufferPoolManager *buffer_pool_manager,
-                                     page_id_t root_page_id)
+                                     page_id_t root_page_id,
+                                     LogManager *log_manager)
     : Index(metadata), comparator_(metadata->GetKeySchema()),
       container_(metadata->GetName(), buffer_pool_manager, comparator_,
-                 root_page_id) {}
+                 root_page_id, log_manager),
+      posting_list_(buffer_pool_manager), log_manager_(log_manager) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
@@ -23,17 +28,80 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Insert(index_key, rid, transaction);
+  latch_.WLock();
+  if (GetMetadata()->IsUnique()) {
+    container_.Insert(index_key, rid, transaction);
+    latch_.WUnlock();
+    return;
+  }
+  PageLogger page_logger(log_manager_);
+  InsertNonUnique(index_key, rid, transaction);
+  page_logger.Commit();
+  latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<Tuple> &keys,
+                                         const std::vector<RID> &rids,
+                                         Transaction *transaction) {
+  std::vector<std::pair<KeyType, RID>> items(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    items[i].first.SetFromKey(keys[i]);
+    items[i].second = rids[i];
+  }
+  std::stable_sort(items.begin(), items.end(),
+                   [this](const std::pair<KeyType, RID> &lhs,
+                          const std::pair<KeyType, RID> &rhs) {
+                     return comparator_(lhs.first, rhs.first) < 0;
+                   });
+  std::vector<bool> inserted;
+  latch_.WLock();
+  if (GetMetadata()->IsUnique()) {
+    container_.InsertBatch(items, inserted, transaction);
+    latch_.WUnlock();
+    return;
+  }
+  // new keys go in as a batch, keys already present get posting lists
+  PageLogger page_logger(log_manager_);
+  container_.InsertBatch(items, inserted, transaction);
+  for (size_t i = 0; i < items.size(); i++) {
+    if (!inserted[i])
+      InsertNonUnique(items[i].first, items[i].second, transaction);
+  }
+  page_logger.Commit();
+  latch_.WUnlock();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key,
+void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid,
                                        Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Remove(index_key, transaction);
+  latch_.WLock();
+  if (GetMetadata()->IsUnique()) {
+    container_.Remove(index_key, transaction);
+    latch_.WUnlock();
+    return;
+  }
+  PageLogger page_logger(log_manager_);
+  std::vector<RID> values;
+  if (container_.GetValue(index_key, values, transaction)) {
+    if (PostingList::IsPostingList(values[0])) {
+      RID value = posting_list_.Remove(values[0].GetPageId(), rid);
+      if (!(value == values[0])) {
+        if (value.GetPageId() == INVALID_PAGE_ID)
+          container_.Remove(index_key, transaction);
+        else
+          container_.Update(index_key, value, transaction);
+      }
+    } else if (values[0] == rid) {
+      container_.Remove(index_key, transaction);
+    }
+  }
+  page_logger.Commit();
+  latch_.WUnlock();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -43,8 +111,77 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result,
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.GetValue(index_key, result, transaction);
+  if (GetMetadata()->IsUnique()) {
+    container_.GetValue(index_key, result, transaction);
+    return;
+  }
+  latch_.RLock();
+  std::vector<RID> values;
+  if (container_.GetValue(index_key, values, transaction)) {
+    if (PostingList::IsPostingList(values[0]))
+      posting_list_.Scan(values[0].GetPageId(), result);
+    else
+      result.push_back(values[0]);
+  }
+  latch_.RUnlock();
 }
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low_key,
+                                     const Tuple *high_key,
+                                     std::vector<RID> &result,
+                                     std::vector<std::vector<Value>> *entries,
+                                     Transaction *transaction) {
+  KeyType low_index_key, high_index_key;
+  if (low_key != nullptr)
+    low_index_key.SetFromKey(*low_key);
+  if (high_key != nullptr)
+    high_index_key.SetFromKey(*high_key);
+  Schema *entry_schema = GetEntrySchema();
+  int column_count = entry_schema->GetColumnCount();
+
+  bool is_unique = GetMetadata()->IsUnique();
+  // the iterator walks the leaves without the tree latch, this one keeps
+  // writers from splitting or merging them under it
+  latch_.RLock();
+  auto iterator = (low_key == nullptr) ? container_.Begin()
+                                       : container_.Begin(low_index_key);
+  for (; !iterator.isEnd(); ++iterator) {
+    auto &item = *iterator;
+    if (high_key != nullptr && comparator_(item.first, high_index_key) > 0)
+      break;
+    size_t old_size = result.size();
+    if (PostingList::IsPostingList(item.second) && !is_unique)
+      posting_list_.Scan(item.second.GetPageId(), result);
+    else
+      result.push_back(item.second);
+    if (entries == nullptr)
+      continue;
+    // every rid of a posting list shares the same entry
+    std::vector<Value> entry;
+    for (int i = 0; i < column_count; i++)
+      entry.push_back(item.first.ToValue(entry_schema, i));
+    for (size_t i = old_size; i < result.size(); i++)
+      entries->push_back(entry);
+  }
+  latch_.RUnlock();
+}
+
+// non-unique key: first rid is kept inline, more rids go to a posting list
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertNonUnique(const KeyType &key, RID rid,
+                                           Transaction *transaction) {
+  std::vector<RID> values;
+  if (!container_.GetValue(key, values, transaction)) {
+    container_.Insert(key, rid, transaction);
+  } else if (PostingList::IsPostingList(values[0])) {
+    posting_list_.Insert(values[0].GetPageId(), rid);
+  } else if (!(values[0] == rid)) {
+    page_id_t head_page_id = posting_list_.Create(values[0], rid);
+    container_.Update(key, PostingList::MakeReference(head_page_id),
+                      transaction);
+  }
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
@@ -0,0 +1,360 @@
+/**
+ * be_tree.cpp
+ */
+#include <string>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "index/be_tree.h"
+#include "logging/page_logger.h"
+#include "page/header_page.h"
+
+namespace scudb {
+
+INDEX_TEMPLATE_ARGUMENTS
+BETREE_TYPE::BETree(const std::string &name,
+                    BufferPoolManager *buffer_pool_manager,
+                    const KeyComparator &comparator, page_id_t root_page_id,
+                    LogManager *log_manager)
+    : index_name_(name), root_page_id_(root_page_id),
+      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+      log_manager_(log_manager) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BETREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Walk from root to leaf, the first message on key met on the way is the
+ * most recent update of key and decides the result
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BETREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result,
+                           Transaction *transaction) {
+  latch_.RLock();
+  bool found = false;
+  page_id_t page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    BETREE_PAGE_TYPE *node = FetchNode(page_id);
+    ValueType value;
+    const BETreeMessageType *message = nullptr;
+    if (node->IsLeafPage()) {
+      found = node->Lookup(key, value, comparator_);
+      page_id = INVALID_PAGE_ID;
+    } else if ((message = node->FindMessage(key, comparator_)) != nullptr) {
+      found = message->op == BETreeMessageOp::INSERT;
+      value = message->value;
+      page_id = INVALID_PAGE_ID;
+    } else {
+      page_id = node->ChildAt(node->ChildIndex(key, comparator_));
+    }
+    buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+    if (found)
+      result.push_back(value);
+  }
+  latch_.RUnlock();
+  return found;
+}
+
+/*
+ * Collect leaf entries in range, together with the messages in range of
+ * every level, then replay messages from the deepest level up since a
+ * message is always newer than the ones below it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_TYPE::GetRange(const KeyType *low_key, const KeyType *high_key,
+                           std::vector<MappingType> &result,
+                           Transaction *transaction) {
+  latch_.RLock();
+  std::vector<MappingType> entries;
+  std::vector<std::vector<BETreeMessageType>> levels;
+  if (!IsEmpty())
+    CollectRange(root_page_id_, low_key, high_key, entries, levels, 0);
+  latch_.RUnlock();
+  for (size_t depth = levels.size(); depth-- > 0;) {
+    for (auto &message : levels[depth])
+      ApplyMessage(entries, message);
+  }
+  result.insert(result.end(), entries.begin(), entries.end());
+}
+
+/*****************************************************************************
+ * INSERTION & DELETION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_TYPE::Insert(const KeyType &key, const ValueType &value,
+                         Transaction *transaction) {
+  Upsert({key, value, BETreeMessageOp::INSERT});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  Upsert({key, ValueType(), BETreeMessageOp::DELETE});
+}
+
+/*
+ * Send one message into the root, if the root splits grow the tree by one
+ * (or more when the new root splits again) level
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_TYPE::Upsert(const BETreeMessageType &message) {
+  latch_.WLock();
+  PageLogger page_logger(log_manager_);
+  if (IsEmpty()) {
+    BETREE_PAGE_TYPE *root = NewNode(IndexPageType::LEAF_PAGE);
+    root_page_id_ = root->GetPageId();
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    UpdateRootPageId(true);
+  }
+  std::vector<BETreeMessageType> messages{message};
+  std::vector<ChildType> splits = Apply(root_page_id_, messages);
+  if (!splits.empty()) {
+    while (!splits.empty()) {
+      std::vector<ChildType> children{ChildType(KeyType(), root_page_id_)};
+      children.insert(children.end(), splits.begin(), splits.end());
+      BETREE_PAGE_TYPE *root = NewNode(IndexPageType::INTERNAL_PAGE);
+      root_page_id_ = root->GetPageId();
+      splits = SplitInternal(root, children, {});
+      buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    }
+    UpdateRootPageId();
+  }
+  page_logger.Commit();
+  latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<typename BETREE_TYPE::ChildType>
+BETREE_TYPE::Apply(page_id_t page_id,
+                   std::vector<BETreeMessageType> &messages) {
+  BETREE_PAGE_TYPE *node = FetchNode(page_id);
+  std::vector<ChildType> splits = node->IsLeafPage()
+                                      ? ApplyToLeaf(node, messages)
+                                      : ApplyToInternal(node, messages);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  return splits;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<typename BETREE_TYPE::ChildType>
+BETREE_TYPE::ApplyToLeaf(BETREE_PAGE_TYPE *node,
+                         std::vector<BETreeMessageType> &messages) {
+  std::vector<MappingType> entries;
+  node->ReadEntries(entries);
+  for (auto &message : messages)
+    ApplyMessage(entries, message);
+
+  // split into parts of at most max size
+  std::vector<ChildType> splits;
+  int size = entries.size();
+  int parts = (size + node->GetMaxSize() - 1) / node->GetMaxSize();
+  for (int i = 1; i < parts; i++) {
+    int begin = i * size / parts, end = (i + 1) * size / parts;
+    BETREE_PAGE_TYPE *sibling = NewNode(IndexPageType::LEAF_PAGE);
+    sibling->WriteEntries(entries, begin, end);
+    splits.emplace_back(entries[begin].first, sibling->GetPageId());
+    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+  }
+  node->WriteEntries(entries, 0, parts > 1 ? size / parts : size);
+  return splits;
+}
+
+/*
+ * Messages are appended to the buffer if there is room. Otherwise flush:
+ * move all the messages of the child that has most of them into that child,
+ * until the buffer fits again. Children split by the flush are added as
+ * new pivots, which may in turn split this node.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<typename BETREE_TYPE::ChildType>
+BETREE_TYPE::ApplyToInternal(BETREE_PAGE_TYPE *node,
+                             std::vector<BETreeMessageType> &messages) {
+  if (node->GetMessageCount() + (int)messages.size() <=
+      node->GetMaxMessageCount()) {
+    for (auto &message : messages)
+      node->AppendMessage(message);
+    return std::vector<ChildType>();
+  }
+
+  std::vector<ChildType> children;
+  std::vector<BETreeMessageType> buffer;
+  node->ReadChildren(children);
+  node->ReadMessages(buffer);
+  buffer.insert(buffer.end(), messages.begin(), messages.end());
+  while ((int)buffer.size() > node->GetMaxMessageCount()) {
+    std::vector<int> targets(buffer.size());
+    std::vector<int> counts(children.size(), 0);
+    int child = 0;
+    for (size_t i = 0; i < buffer.size(); i++) {
+      targets[i] = ChildIndex(children, buffer[i].key);
+      if (++counts[targets[i]] > counts[child])
+        child = targets[i];
+    }
+    std::vector<BETreeMessageType> batch, rest;
+    for (size_t i = 0; i < buffer.size(); i++)
+      (targets[i] == child ? batch : rest).push_back(buffer[i]);
+    buffer.swap(rest);
+    std::vector<ChildType> splits = Apply(children[child].second, batch);
+    children.insert(children.begin() + child + 1, splits.begin(),
+                    splits.end());
+  }
+  return SplitInternal(node, children, buffer);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<typename BETREE_TYPE::ChildType>
+BETREE_TYPE::SplitInternal(BETREE_PAGE_TYPE *node,
+                           const std::vector<ChildType> &children,
+                           const std::vector<BETreeMessageType> &messages) {
+  int size = children.size();
+  int parts = (size + node->GetMaxSize() - 1) / node->GetMaxSize();
+  // messages of every part
+  std::vector<std::vector<BETreeMessageType>> buffers(parts);
+  for (auto &message : messages) {
+    int index = ChildIndex(children, message.key);
+    buffers[index * parts / size].push_back(message);
+  }
+
+  std::vector<ChildType> splits;
+  for (int i = 1; i < parts; i++) {
+    int begin = (i * size + parts - 1) / parts;
+    int end = ((i + 1) * size + parts - 1) / parts;
+    BETREE_PAGE_TYPE *sibling = NewNode(IndexPageType::INTERNAL_PAGE);
+    sibling->WriteChildren(children, begin, end);
+    sibling->WriteMessages(buffers[i]);
+    splits.emplace_back(children[begin].first, sibling->GetPageId());
+    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+  }
+  node->WriteChildren(children, 0, (size + parts - 1) / parts);
+  node->WriteMessages(buffers[0]);
+  return splits;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_TYPE::ApplyMessage(std::vector<MappingType> &entries,
+                               const BETreeMessageType &message) {
+  int low = 0, high = entries.size();
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (comparator_(entries[mid].first, message.key) < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  bool found = low < (int)entries.size() &&
+               comparator_(entries[low].first, message.key) == 0;
+  if (message.op == BETreeMessageOp::INSERT) {
+    if (found)
+      entries[low].second = message.value;
+    else
+      entries.insert(entries.begin() + low,
+                     MappingType(message.key, message.value));
+  } else if (found) {
+    entries.erase(entries.begin() + low);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BETREE_TYPE::ChildIndex(const std::vector<ChildType> &children,
+                            const KeyType &key) const {
+  int low = 1, high = children.size();
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (comparator_(children[mid].first, key) <= 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_TYPE::CollectRange(
+    page_id_t page_id, const KeyType *low_key, const KeyType *high_key,
+    std::vector<MappingType> &entries,
+    std::vector<std::vector<BETreeMessageType>> &levels, size_t depth) {
+  BETREE_PAGE_TYPE *node = FetchNode(page_id);
+  if (node->IsLeafPage()) {
+    int begin = low_key == nullptr ? 0 : node->KeyIndex(*low_key, comparator_);
+    for (int i = begin; i < node->GetSize(); i++) {
+      const MappingType &item = node->GetItem(i);
+      if (high_key != nullptr && comparator_(item.first, *high_key) > 0)
+        break;
+      entries.push_back(item);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return;
+  }
+
+  if (levels.size() <= depth)
+    levels.resize(depth + 1);
+  for (int i = 0; i < node->GetMessageCount(); i++) {
+    const BETreeMessageType &message = node->MessageAt(i);
+    if (InRange(message.key, low_key, high_key))
+      levels[depth].push_back(message);
+  }
+  int first = low_key == nullptr ? 0 : node->ChildIndex(*low_key, comparator_);
+  int last = high_key == nullptr ? node->GetSize() - 1
+                                 : node->ChildIndex(*high_key, comparator_);
+  std::vector<page_id_t> children;
+  for (int i = first; i <= last; i++)
+    children.push_back(node->ChildAt(i));
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  for (page_id_t child : children)
+    CollectRange(child, low_key, high_key, entries, levels, depth + 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BETREE_TYPE::InRange(const KeyType &key, const KeyType *low_key,
+                          const KeyType *high_key) const {
+  return (low_key == nullptr || comparator_(key, *low_key) >= 0) &&
+         (high_key == nullptr || comparator_(key, *high_key) <= 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BETREE_PAGE_TYPE *BETREE_TYPE::FetchNode(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned");
+  return reinterpret_cast<BETREE_PAGE_TYPE *>(page->GetData());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BETREE_PAGE_TYPE *BETREE_TYPE::NewNode(IndexPageType page_type) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory");
+  auto *node = reinterpret_cast<BETREE_PAGE_TYPE *>(page->GetData());
+  node->Init(page_id, page_type);
+  return node;
+}
+
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h)
+ * @parameter: insert_record default value is false. When set to true,
+ * insert a record <index_name, root_page_id> into header page instead of
+ * updating it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_TYPE::UpdateRootPageId(bool insert_record) {
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (!insert_record || !header_page->InsertRecord(index_name_, root_page_id_))
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+template class BETree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BETree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BETree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BETree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BETree<GenericKey<64>, RID, GenericComparator<64>>;
+
+} // namespace scudb
@@ -0,0 +1,84 @@
+/**
+ * be_tree_index.cpp
+ */
+
+#include "index/be_tree_index.h"
+
+namespace scudb {
+/*
+ * Constructor
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BETREE_INDEX_TYPE::BETreeIndex(IndexMetadata *metadata,
+                               BufferPoolManager *buffer_pool_manager,
+                               page_id_t root_page_id,
+                               LogManager *log_manager)
+    : Index(metadata), comparator_(metadata->GetKeySchema()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_,
+                 root_page_id, log_manager) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
+                                    Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Insert(index_key, rid, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID,
+                                    Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Remove(index_key, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result,
+                                Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.GetValue(index_key, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_INDEX_TYPE::ScanRange(const Tuple *low_key, const Tuple *high_key,
+                                  std::vector<RID> &result,
+                                  std::vector<std::vector<Value>> *entries,
+                                  Transaction *transaction) {
+  KeyType low_index_key, high_index_key;
+  if (low_key != nullptr)
+    low_index_key.SetFromKey(*low_key);
+  if (high_key != nullptr)
+    high_index_key.SetFromKey(*high_key);
+
+  std::vector<MappingType> items;
+  container_.GetRange(low_key == nullptr ? nullptr : &low_index_key,
+                      high_key == nullptr ? nullptr : &high_index_key, items,
+                      transaction);
+  Schema *entry_schema = GetEntrySchema();
+  int column_count = entry_schema->GetColumnCount();
+  for (auto &item : items) {
+    result.push_back(item.second);
+    if (entries == nullptr)
+      continue;
+    std::vector<Value> entry;
+    for (int i = 0; i < column_count; i++)
+      entry.push_back(item.first.ToValue(entry_schema, i));
+    entries->push_back(entry);
+  }
+}
+
+template class BETreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class BETreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class BETreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class BETreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class BETreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+} // namespace scudb
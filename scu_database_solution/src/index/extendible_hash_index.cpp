@@ -0,0 +1,107 @@
+/**
+ * extendible_hash_index.cpp
+ */
+
+#include <algorithm>
+
+#include "index/extendible_hash_index.h"
+
+namespace scudb {
+/*
+ * Constructor
+ */
+HASH_TABLE_TEMPLATE_ARGUMENTS
+EXTENDIBLE_HASH_INDEX_TYPE::ExtendibleHashIndex(
+    IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+    page_id_t root_page_id, LogManager *log_manager)
+    : Index(metadata), comparator_(metadata->GetKeySchema()),
+      hash_fn_(metadata->GetKeySchema()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_,
+                 hash_fn_, root_page_id, log_manager) {}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
+                                             Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Insert(index_key, rid, transaction);
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_INDEX_TYPE::DeleteEntry(const Tuple &key, RID,
+                                             Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Remove(index_key, transaction);
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_INDEX_TYPE::ScanKey(const Tuple &key,
+                                         std::vector<RID> &result,
+                                         Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.GetValue(index_key, result, transaction);
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_INDEX_TYPE::ScanRange(
+    const Tuple *low_key, const Tuple *high_key, std::vector<RID> &result,
+    std::vector<std::vector<Value>> *entries, Transaction *transaction) {
+  KeyType low_index_key, high_index_key;
+  if (low_key != nullptr)
+    low_index_key.SetFromKey(*low_key);
+  if (high_key != nullptr)
+    high_index_key.SetFromKey(*high_key);
+
+  std::vector<MappingType> items;
+  if (low_key != nullptr && high_key != nullptr &&
+      comparator_(low_index_key, high_index_key) == 0) {
+    MappingType item;
+    if (container_.GetEntry(low_index_key, item, transaction))
+      items.push_back(item);
+  } else {
+    std::vector<MappingType> all;
+    container_.GetAll(all, transaction);
+    for (auto &item : all) {
+      if ((low_key == nullptr || comparator_(item.first, low_index_key) >= 0) &&
+          (high_key == nullptr || comparator_(item.first, high_index_key) <= 0))
+        items.push_back(item);
+    }
+    std::sort(items.begin(), items.end(),
+              [this](const MappingType &a, const MappingType &b) {
+                return comparator_(a.first, b.first) < 0;
+              });
+  }
+
+  Schema *entry_schema = GetEntrySchema();
+  int column_count = entry_schema->GetColumnCount();
+  for (auto &item : items) {
+    result.push_back(item.second);
+    if (entries == nullptr)
+      continue;
+    std::vector<Value> entry;
+    for (int i = 0; i < column_count; i++)
+      entry.push_back(item.first.ToValue(entry_schema, i));
+    entries->push_back(entry);
+  }
+}
+
+template class ExtendibleHashIndex<GenericKey<4>, RID, GenericComparator<4>,
+                                   GenericHashFunction<4>>;
+template class ExtendibleHashIndex<GenericKey<8>, RID, GenericComparator<8>,
+                                   GenericHashFunction<8>>;
+template class ExtendibleHashIndex<GenericKey<16>, RID, GenericComparator<16>,
+                                   GenericHashFunction<16>>;
+template class ExtendibleHashIndex<GenericKey<32>, RID, GenericComparator<32>,
+                                   GenericHashFunction<32>>;
+template class ExtendibleHashIndex<GenericKey<64>, RID, GenericComparator<64>,
+                                   GenericHashFunction<64>>;
+
+} // namespace scudb
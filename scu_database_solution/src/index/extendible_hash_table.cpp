@@ -0,0 +1,326 @@
+/**
+ * extendible_hash_table.cpp
+ */
+#include <string>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "index/extendible_hash_table.h"
+#include "logging/page_logger.h"
+#include "page/header_page.h"
+
+namespace scudb {
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(
+    const std::string &name, BufferPoolManager *buffer_pool_manager,
+    const KeyComparator &comparator, const KeyHasher &hash_fn,
+    page_id_t directory_page_id, LogManager *log_manager)
+    : index_name_(name), directory_page_id_(directory_page_id),
+      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+      hash_fn_(hash_fn), log_manager_(log_manager), global_depth_(0) {
+  // rebuild the in-memory view of the directory chain
+  page_id_t page_id = directory_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    HashDirectoryPage *directory = FetchDirectory(page_id);
+    if (page_id == directory_page_id_)
+      global_depth_ = directory->GetGlobalDepth();
+    directory_page_ids_.push_back(page_id);
+    page_id = directory->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(directory->GetPageId(), false);
+  }
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::IsEmpty() const {
+  return directory_page_id_ == INVALID_PAGE_ID;
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() const {
+  return global_depth_;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+HASH_TABLE_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(const KeyType &key,
+                                          std::vector<ValueType> &result,
+                                          Transaction *transaction) {
+  MappingType entry;
+  if (!GetEntry(key, entry, transaction))
+    return false;
+  result.push_back(entry.second);
+  return true;
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetEntry(const KeyType &key,
+                                          MappingType &entry,
+                                          Transaction *transaction) {
+  latch_.RLock();
+  bool found = false;
+  if (!IsEmpty()) {
+    uint32_t local_depth;
+    uint32_t slot = hash_fn_(key) & ((1u << global_depth_) - 1);
+    BucketPage *bucket = FetchBucket(GetSlot(slot, local_depth));
+    int index = bucket->KeyIndex(key, comparator_);
+    if (index != -1) {
+      entry = bucket->GetItem(index);
+      found = true;
+    }
+    buffer_pool_manager_->UnpinPage(bucket->GetPageId(), false);
+  }
+  latch_.RUnlock();
+  return found;
+}
+
+/*
+ * Every bucket is pointed to by the slots that share its low local depth
+ * bits, the smallest of them is below 2^local_depth
+ */
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::GetAll(std::vector<MappingType> &result,
+                                        Transaction *transaction) {
+  latch_.RLock();
+  uint32_t slot_count = IsEmpty() ? 0 : 1u << global_depth_;
+  std::vector<MappingType> entries;
+  for (uint32_t slot = 0; slot < slot_count; slot++) {
+    uint32_t local_depth;
+    page_id_t bucket_page_id = GetSlot(slot, local_depth);
+    if (slot >= (1u << local_depth))
+      continue;
+    BucketPage *bucket = FetchBucket(bucket_page_id);
+    bucket->ReadEntries(entries);
+    result.insert(result.end(), entries.begin(), entries.end());
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  }
+  latch_.RUnlock();
+}
+
+/*****************************************************************************
+ * INSERTION & DELETION
+ *****************************************************************************/
+HASH_TABLE_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(const KeyType &key,
+                                        const ValueType &value,
+                                        Transaction *transaction) {
+  latch_.WLock();
+  PageLogger page_logger(log_manager_);
+  if (IsEmpty()) {
+    // one directory slot pointing to one empty bucket
+    page_id_t bucket_page_id;
+    Page *page = NewPage(bucket_page_id);
+    reinterpret_cast<BucketPage *>(page->GetData())->Init(bucket_page_id, 0);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    HashDirectoryPage *directory =
+        static_cast<HashDirectoryPage *>(NewPage(directory_page_id_));
+    directory->Init(directory_page_id_);
+    directory->SetBucketPageId(0, bucket_page_id);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    directory_page_ids_.push_back(directory_page_id_);
+    global_depth_ = 0;
+    UpdateRootPageId(true);
+  }
+
+  uint32_t hash = hash_fn_(key);
+  bool inserted = false;
+  while (true) {
+    uint32_t local_depth;
+    uint32_t slot = hash & ((1u << global_depth_) - 1);
+    page_id_t bucket_page_id = GetSlot(slot, local_depth);
+    BucketPage *bucket = FetchBucket(bucket_page_id);
+    if (bucket->KeyIndex(key, comparator_) != -1) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    if (bucket->Append(key, value)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      inserted = true;
+      break;
+    }
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    Split(slot, bucket_page_id, local_depth);
+  }
+  page_logger.Commit();
+  latch_.WUnlock();
+  return inserted;
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::Remove(const KeyType &key,
+                                        Transaction *transaction) {
+  latch_.WLock();
+  PageLogger page_logger(log_manager_);
+  if (!IsEmpty()) {
+    uint32_t local_depth;
+    uint32_t slot = hash_fn_(key) & ((1u << global_depth_) - 1);
+    BucketPage *bucket = FetchBucket(GetSlot(slot, local_depth));
+    int index = bucket->KeyIndex(key, comparator_);
+    if (index != -1)
+      bucket->RemoveAt(index);
+    buffer_pool_manager_->UnpinPage(bucket->GetPageId(), index != -1);
+  }
+  page_logger.Commit();
+  latch_.WUnlock();
+}
+
+/*
+ * Keys whose hash has bit local_depth set move to a new bucket, and so do
+ * the directory slots with that bit set among the ones of the old bucket
+ */
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::Split(uint32_t slot, page_id_t bucket_page_id,
+                                       uint32_t local_depth) {
+  if (local_depth == global_depth_) {
+    if (global_depth_ == HASH_MAX_GLOBAL_DEPTH)
+      throw Exception(EXCEPTION_TYPE_INDEX, "hash directory is full");
+    Grow();
+  }
+
+  page_id_t image_page_id;
+  BucketPage *image =
+      reinterpret_cast<BucketPage *>(NewPage(image_page_id)->GetData());
+  image->Init(image_page_id, local_depth + 1);
+  BucketPage *bucket = FetchBucket(bucket_page_id);
+  bucket->SetLocalDepth(local_depth + 1);
+  std::vector<MappingType> entries, stay, move;
+  bucket->ReadEntries(entries);
+  for (auto &entry : entries) {
+    if ((hash_fn_(entry.first) >> local_depth) & 1)
+      move.push_back(entry);
+    else
+      stay.push_back(entry);
+  }
+  bucket->WriteEntries(stay);
+  image->WriteEntries(move);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+
+  uint32_t step = 1u << local_depth;
+  for (uint32_t i = slot & (step - 1); i < (1u << global_depth_); i += step) {
+    SetSlot(i, ((i >> local_depth) & 1) ? image_page_id : bucket_page_id,
+            local_depth + 1);
+  }
+}
+
+/*
+ * The new upper half of the directory is a copy of the lower half. Inside
+ * the first page while it has room, otherwise every page gets a copy
+ * appended to the chain
+ */
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::Grow() {
+  uint32_t slot_count = 1u << global_depth_;
+  if (slot_count < DIRECTORY_SLOT_COUNT) {
+    HashDirectoryPage *directory = FetchDirectory(directory_page_id_);
+    directory->CopySlots(directory, 0, slot_count, slot_count);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  } else {
+    size_t page_count = directory_page_ids_.size();
+    page_id_t last_page_id = directory_page_ids_.back();
+    for (size_t i = 0; i < page_count; i++) {
+      page_id_t page_id;
+      HashDirectoryPage *copy = static_cast<HashDirectoryPage *>(
+          NewPage(page_id));
+      copy->Init(page_id);
+      HashDirectoryPage *directory = FetchDirectory(directory_page_ids_[i]);
+      copy->CopySlots(directory, 0, DIRECTORY_SLOT_COUNT, 0);
+      buffer_pool_manager_->UnpinPage(directory_page_ids_[i], false);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      HashDirectoryPage *last = FetchDirectory(last_page_id);
+      last->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(last_page_id, true);
+      directory_page_ids_.push_back(page_id);
+      last_page_id = page_id;
+    }
+  }
+  global_depth_++;
+  HashDirectoryPage *directory = FetchDirectory(directory_page_id_);
+  directory->SetGlobalDepth(global_depth_);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+HASH_TABLE_TEMPLATE_ARGUMENTS
+page_id_t EXTENDIBLE_HASH_TABLE_TYPE::GetSlot(uint32_t slot,
+                                              uint32_t &local_depth) {
+  page_id_t page_id = directory_page_ids_[slot / DIRECTORY_SLOT_COUNT];
+  HashDirectoryPage *directory = FetchDirectory(page_id);
+  int index = slot % DIRECTORY_SLOT_COUNT;
+  page_id_t bucket_page_id = directory->GetBucketPageId(index);
+  local_depth = directory->GetLocalDepth(index);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return bucket_page_id;
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::SetSlot(uint32_t slot,
+                                         page_id_t bucket_page_id,
+                                         uint32_t local_depth) {
+  page_id_t page_id = directory_page_ids_[slot / DIRECTORY_SLOT_COUNT];
+  HashDirectoryPage *directory = FetchDirectory(page_id);
+  int index = slot % DIRECTORY_SLOT_COUNT;
+  directory->SetBucketPageId(index, bucket_page_id);
+  directory->SetLocalDepth(index, local_depth);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+HashDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::FetchDirectory(
+    page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned");
+  return static_cast<HashDirectoryPage *>(page);
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+typename EXTENDIBLE_HASH_TABLE_TYPE::BucketPage *
+EXTENDIBLE_HASH_TABLE_TYPE::FetchBucket(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned");
+  return reinterpret_cast<BucketPage *>(page->GetData());
+}
+
+HASH_TABLE_TEMPLATE_ARGUMENTS
+Page *EXTENDIBLE_HASH_TABLE_TYPE::NewPage(page_id_t &page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory");
+  return page;
+}
+
+/*
+ * Update/Insert directory page id in header page(where page_id = 0,
+ * header_page is defined under include/page/header_page.h)
+ * @parameter: insert_record default value is false. When set to true,
+ * insert a record <index_name, directory_page_id> into header page instead
+ * of updating it.
+ */
+HASH_TABLE_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::UpdateRootPageId(bool insert_record) {
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (!insert_record ||
+      !header_page->InsertRecord(index_name_, directory_page_id_))
+    header_page->UpdateRecord(index_name_, directory_page_id_);
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>,
+                                   GenericHashFunction<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>,
+                                   GenericHashFunction<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>,
+                                   GenericHashFunction<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>,
+                                   GenericHashFunction<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>,
+                                   GenericHashFunction<64>>;
+
+} // namespace scudb
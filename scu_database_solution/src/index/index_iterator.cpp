@@ -12,10 +12,49 @@ namespace scudb {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator() {}
+INDEXITERATOR_TYPE::IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index,
+                                  BufferPoolManager *buffer_pool_manager)
+    : leaf_(leaf), index_(index), buffer_pool_manager_(buffer_pool_manager) {
+  SkipToValid();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {}
+INDEXITERATOR_TYPE::~IndexIterator() {
+  if (leaf_ != nullptr)
+    buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::isEnd() { return leaf_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  assert(!isEnd());
+  return leaf_->GetItem(index_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  assert(!isEnd());
+  ++index_;
+  SkipToValid();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipToValid() {
+  while (leaf_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
+    leaf_ = nullptr;
+    index_ = 0;
+    if (next_page_id != INVALID_PAGE_ID) {
+      auto *page = buffer_pool_manager_->FetchPage(next_page_id);
+      assert(page != nullptr);
+      leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+    }
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
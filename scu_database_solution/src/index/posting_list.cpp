@@ -0,0 +1,215 @@
+/**
+ * posting_list.cpp
+ */
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "index/posting_list.h"
+
+namespace scudb {
+
+/*
+ * Create a new list and put both rids into its head page
+ */
+page_id_t PostingList::Create(const RID &first, const RID &second) {
+  PostingListPage *head = NewPage();
+  page_id_t head_page_id = head->GetPageId();
+  if (first.Get() < second.Get()) {
+    head->Append(first);
+    head->Append(second);
+  } else {
+    head->Append(second);
+    head->Append(first);
+  }
+  buffer_pool_manager_->UnpinPage(head_page_id, true);
+  return head_page_id;
+}
+
+/*
+ * Rids larger than the current maximum are appended to the tail page, which
+ * is found through the head page without walking the chain. Otherwise find
+ * the first page whose last rid is not smaller than the new one, decode it,
+ * insert the rid and encode it again; whatever does not fit any more spills
+ * into new pages linked right behind it.
+ */
+bool PostingList::Insert(page_id_t head_page_id, const RID &rid) {
+  PostingListPage *head = FetchPage(head_page_id);
+  PostingListPage *tail = FetchPage(head->GetTailPageId());
+  if (rid.Get() > tail->GetLastRid().Get()) {
+    if (!tail->Append(rid)) {
+      std::vector<RID> rids{rid};
+      head->SetTailPageId(SpillAfter(tail, rids, 0, 1));
+    }
+    buffer_pool_manager_->UnpinPage(tail->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(head_page_id, true);
+    return true;
+  }
+  buffer_pool_manager_->UnpinPage(tail->GetPageId(), false);
+
+  PostingListPage *page = FetchPage(head_page_id);
+  while (rid.Get() > page->GetLastRid().Get()) {
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = FetchPage(next_page_id);
+  }
+  std::vector<RID> rids;
+  page->Decode(rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid,
+                             [](const RID &a, const RID &b) {
+                               return a.Get() < b.Get();
+                             });
+  if (it != rids.end() && *it == rid) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
+    return false;
+  }
+  rids.insert(it, rid);
+  int size = static_cast<int>(rids.size());
+  int encoded = page->Encode(rids, 0, size);
+  if (encoded < size) {
+    bool is_tail = page->GetNextPageId() == INVALID_PAGE_ID;
+    page_id_t last_page_id = SpillAfter(page, rids, encoded, size);
+    if (is_tail)
+      head->SetTailPageId(last_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(head_page_id, true);
+  return true;
+}
+
+/*
+ * Remove rid from the page holding it. A page that becomes empty is unlinked
+ * and deleted; if it is the head page, the content of the second page is
+ * pulled into it instead so that the reference kept in the leaf stays valid.
+ */
+RID PostingList::Remove(page_id_t head_page_id, const RID &rid) {
+  PostingListPage *head = FetchPage(head_page_id);
+  PostingListPage *prev = nullptr;
+  PostingListPage *page = FetchPage(head_page_id);
+  while (rid.Get() > page->GetLastRid().Get() &&
+         page->GetNextPageId() != INVALID_PAGE_ID) {
+    if (prev != nullptr)
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), false);
+    prev = page;
+    page = FetchPage(page->GetNextPageId());
+  }
+  std::vector<RID> rids;
+  page->Decode(rids);
+  auto it = std::find(rids.begin(), rids.end(), rid);
+  if (it == rids.end()) {
+    // rid is not in the list, nothing to do
+    if (prev != nullptr)
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), false);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
+    return MakeReference(head_page_id);
+  }
+  rids.erase(it);
+  page->Encode(rids, 0, static_cast<int>(rids.size()));
+
+  page_id_t page_id = page->GetPageId();
+  if (page->GetRidCount() == 0) {
+    if (prev == nullptr && head->GetNextPageId() == INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    } else if (prev == nullptr) {
+      // head page is empty, pull the second page into it
+      page_id_t next_page_id = head->GetNextPageId();
+      PostingListPage *next = FetchPage(next_page_id);
+      rids.clear();
+      next->Decode(rids);
+      head->Encode(rids, 0, static_cast<int>(rids.size()));
+      head->SetNextPageId(next->GetNextPageId());
+      if (head->GetTailPageId() == next_page_id)
+        head->SetTailPageId(head_page_id);
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      buffer_pool_manager_->DeletePage(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    } else {
+      prev->SetNextPageId(page->GetNextPageId());
+      if (head->GetTailPageId() == page_id)
+        head->SetTailPageId(prev->GetPageId());
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+  } else {
+    if (prev != nullptr)
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), false);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+
+  // a single rid goes back inline into the leaf
+  if (head->GetRidCount() <= 1 && head->GetNextPageId() == INVALID_PAGE_ID) {
+    RID last = head->GetRidCount() == 1 ? head->GetFirstRid() : RID();
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
+    buffer_pool_manager_->DeletePage(head_page_id);
+    return last;
+  }
+  buffer_pool_manager_->UnpinPage(head_page_id, true);
+  return MakeReference(head_page_id);
+}
+
+void PostingList::Scan(page_id_t head_page_id, std::vector<RID> &result) {
+  page_id_t page_id = head_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    PostingListPage *page = FetchPage(page_id);
+    page->Decode(result);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void PostingList::Destroy(page_id_t head_page_id) {
+  page_id_t page_id = head_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    PostingListPage *page = FetchPage(page_id);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+/*
+ * helper functions
+ */
+PostingListPage *PostingList::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned");
+  return reinterpret_cast<PostingListPage *>(page);
+}
+
+PostingListPage *PostingList::NewPage() {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory");
+  auto *posting_page = reinterpret_cast<PostingListPage *>(page);
+  posting_page->Init(page_id);
+  return posting_page;
+}
+
+page_id_t PostingList::SpillAfter(PostingListPage *page,
+                                  const std::vector<RID> &rids, int begin,
+                                  int end) {
+  page_id_t old_next_page_id = page->GetNextPageId();
+  PostingListPage *prev = page;
+  while (begin < end) {
+    PostingListPage *new_page = NewPage();
+    begin += new_page->Encode(rids, begin, end);
+    prev->SetNextPageId(new_page->GetPageId());
+    if (prev != page)
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+    prev = new_page;
+  }
+  prev->SetNextPageId(old_next_page_id);
+  page_id_t last_page_id = prev->GetPageId();
+  if (prev != page)
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+  return last_page_id;
+}
+
+} // namespace scudb
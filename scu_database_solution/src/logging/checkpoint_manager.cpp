@@ -0,0 +1,99 @@
+/**
+ * checkpoint_manager.cpp
+ */
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "logging/checkpoint_manager.h"
+#include "logging/page_logger.h"
+
+namespace scudb {
+
+/*
+ * Neither table is read atomically with the log: a transaction or a page
+ * changed while they are read shows up after BEGIN in the log as well, and
+ * analysis keeps the older of the two.
+ * Pages dirty since before the previous checkpoint are written out first
+ * and left out of END, unless they are pinned: a pinned page may hold a
+ * change not logged yet, it stays in END with its recLSN. Then the log before the oldest lsn recovery may
+ * read, the smallest recLSN or the oldest BEGIN of an active transaction
+ * (index operations included), is truncated, unless a replica still reads
+ * it. The replica slot is read after the master record is written: a
+ * replica that set its slot later starts from this checkpoint or a newer
+ * one
+ */
+lsn_t CheckpointManager::Checkpoint() {
+  if (!ENABLE_LOGGING)
+    return INVALID_LSN;
+  std::lock_guard<std::mutex> guard(checkpoint_latch_);
+  LogRecord begin_record(INVALID_TXN_ID, INVALID_LSN,
+                         LogRecordType::CHECKPOINT_BEGIN);
+  lsn_t begin_lsn = log_manager_->AppendLogRecord(begin_record);
+
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  transaction_manager_->GetActiveTransactionTable(active_txns);
+  PageLogger::GetActiveOperations(active_txns);
+  buffer_pool_manager_->GetDirtyPageTable(dirty_pages);
+  // keep the redo of the next restart behind the previous checkpoint
+  lsn_t keep_lsn = begin_lsn;
+  auto it = dirty_pages.begin();
+  while (it != dirty_pages.end()) {
+    if (it->second < last_checkpoint_lsn_ &&
+        buffer_pool_manager_->FlushUnpinnedPage(it->first)) {
+      it = dirty_pages.erase(it);
+    } else {
+      keep_lsn = std::min(keep_lsn, it->second);
+      ++it;
+    }
+  }
+  LogRecord end_record(INVALID_TXN_ID, INVALID_LSN,
+                       LogRecordType::CHECKPOINT_END, begin_lsn, active_txns,
+                       dirty_pages);
+  lsn_t end_lsn = log_manager_->AppendLogRecord(end_record);
+  log_manager_->Flush(end_lsn);
+  disk_manager_->WriteMasterRecord(begin_lsn);
+  last_checkpoint_lsn_ = begin_lsn;
+
+  for (lsn_t oldest_lsn : {transaction_manager_->GetOldestBeginLSN(),
+                           PageLogger::GetOldestBeginLSN(),
+                           disk_manager_->ReadReplicaLSN()}) {
+    if (oldest_lsn != INVALID_LSN)
+      keep_lsn = std::min(keep_lsn, oldest_lsn);
+  }
+  disk_manager_->TruncateLog(keep_lsn);
+  return begin_lsn;
+}
+
+void CheckpointManager::RunCheckpointThread(
+    std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (checkpoint_thread_ != nullptr)
+    return;
+  is_running_ = true;
+  checkpoint_thread_ = new std::thread([this, interval] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!cv_.wait_for(lock, interval, [this] { return !is_running_; })) {
+      lock.unlock();
+      Checkpoint();
+      lock.lock();
+    }
+  });
+}
+
+void CheckpointManager::StopCheckpointThread() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (checkpoint_thread_ == nullptr)
+      return;
+    is_running_ = false;
+  }
+  cv_.notify_one();
+  checkpoint_thread_->join();
+  delete checkpoint_thread_;
+  checkpoint_thread_ = nullptr;
+}
+
+} // namespace scudb
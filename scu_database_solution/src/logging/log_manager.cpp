@@ -2,6 +2,9 @@
  * log_manager.cpp
  */
 
+#include <cstring>
+#include <vector>
+
 #include "logging/log_manager.h"
 
 namespace scudb {
@@ -12,35 +15,300 @@ namespace scudb {
  * manager wants to force flush (it only happens when the flushed page has a
  * larger LSN than persistent LSN)
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (flush_thread_ != nullptr)
+    return;
+  ENABLE_LOGGING = true;
+  is_running_ = true;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (is_running_) {
+      // woken early by a flush request, or by the first asynchronous commit
+      // to wait, which may be due before the timeout
+      std::chrono::steady_clock::time_point wake_time =
+          std::chrono::steady_clock::now() + LOG_TIMEOUT;
+      while (is_running_ && !is_flush_requested_) {
+        std::chrono::steady_clock::time_point time = wake_time;
+        if (async_lsn_ > persistent_lsn_)
+          time = std::min(time, async_since_ + DURABILITY_WINDOW);
+        if (cv_.wait_until(lock, time) == std::cv_status::timeout)
+          break;
+      }
+      FlushBuffer(lock);
+    }
+    // whatever was appended before stop
+    FlushBuffer(lock);
+  });
+}
+
 /*
  * Stop and join the flush thread, set ENABLE_LOGGING = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (flush_thread_ == nullptr)
+      return;
+    is_running_ = false;
+  }
+  cv_.notify_one();
+  flush_thread_->join();
+  delete flush_thread_;
+  flush_thread_ = nullptr;
+  ENABLE_LOGGING = false;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
  *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
+ * Reserving the bytes gives the lsn. Only an append that finds the log
+ * buffer full takes the latch, to wait for the swap.
  */
 lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
+  int32_t size = log_record.size_;
+  if (size > LOG_BUFFER_SIZE) {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (is_flushing_)
+      flushed_cv_.wait(lock);
+    FlushBuffer(lock, &log_record);
+    return log_record.lsn_;
+  }
+
+  uint64_t reservation = reservation_.load();
+  while (true) {
+    int32_t offset = GetOffset(reservation);
+    if (offset + size > LOG_BUFFER_SIZE) {
+      std::unique_lock<std::mutex> lock(latch_);
+      // the swap is made under the latch, no wake up is missed
+      if (reservation_.load() == reservation)
+        WaitForRoom(lock);
+      reservation = reservation_.load();
+      continue;
+    }
+    if (reservation_.compare_exchange_weak(
+            reservation,
+            MakeReservation(GetSwapCount(reservation), offset + size)))
+      break;
+  }
+
+  log_record.lsn_ = GetLSN(reservation) + GetOffset(reservation);
+  int index = GetBufferIndex(reservation);
+  SerializeLogRecord(log_record, buffers_[index] + GetOffset(reservation));
+  copied_[index].fetch_add(size);
+  return log_record.lsn_;
+}
+
+/*
+ * Committers that come while a write is going on pile up behind it, and the
+ * next write takes all of their records at once
+ */
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_ != nullptr) {
+      is_flush_requested_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(lock);
+    } else {
+      FlushBuffer(lock);
+    }
+  }
+}
+
+/*
+ * The window runs from the first asynchronous commit not yet on disk, later
+ * ones are written along with it
+ */
+void LogManager::FlushAsync(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (flush_thread_ == nullptr) {
+    while (persistent_lsn_ < lsn)
+      FlushBuffer(lock);
+    return;
+  }
+  if (persistent_lsn_ >= lsn)
+    return;
+  if (async_lsn_ <= persistent_lsn_) {
+    async_since_ = std::chrono::steady_clock::now();
+    cv_.notify_one();
+  }
+  async_lsn_ = std::max(async_lsn_, lsn);
+}
+
+void LogManager::RequestFlush(lsn_t lsn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (flush_thread_ == nullptr || persistent_lsn_ >= lsn)
+    return;
+  is_flush_requested_ = true;
+  cv_.notify_one();
+}
+
+std::chrono::microseconds LogManager::GetAsyncCommitLag() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (async_lsn_ <= persistent_lsn_)
+    return std::chrono::microseconds(0);
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - async_since_);
+}
+
+/*
+ * header first, then the fields of the record type, see log_record.h. The
+ * header fields are copied one by one, the record has padding between them
+ */
+void LogManager::SerializeLogRecord(const LogRecord &log_record,
+                                    char *data) {
+  memcpy(data, &log_record.size_, sizeof(int32_t));
+  memcpy(data + 4, &log_record.lsn_, sizeof(lsn_t));
+  memcpy(data + 12, &log_record.txn_id_, sizeof(txn_id_t));
+  memcpy(data + 16, &log_record.prev_lsn_, sizeof(lsn_t));
+  memcpy(data + 24, &log_record.log_record_type_, sizeof(LogRecordType));
+  int32_t pos = LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    memcpy(data + pos, &log_record.insert_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.insert_tuple_.SerializeLogTo(data + pos);
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    memcpy(data + pos, &log_record.delete_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.delete_tuple_.SerializeLogTo(data + pos);
+    break;
+  case LogRecordType::UPDATE:
+    memcpy(data + pos, &log_record.update_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.old_tuple_.SerializeLogTo(data + pos);
+    pos += sizeof(int32_t) + log_record.old_tuple_.GetLogLength();
+    log_record.new_tuple_.SerializeLogTo(data + pos);
+    break;
+  case LogRecordType::DELTAUPDATE: {
+    memcpy(data + pos, &log_record.update_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    memcpy(data + pos, &log_record.delta_tuple_size_, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    int32_t delta_size = log_record.delta_.size();
+    memcpy(data + pos, &delta_size, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(data + pos, log_record.delta_.data(), delta_size);
+    break;
+  }
+  case LogRecordType::INDEXPAGE: {
+    memcpy(data + pos, &log_record.page_id_, sizeof(page_id_t));
+    pos += sizeof(page_id_t);
+    memcpy(data + pos, &log_record.page_flags_, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    int32_t data_size = log_record.delta_.size();
+    memcpy(data + pos, &data_size, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    memcpy(data + pos, log_record.delta_.data(), data_size);
+    break;
+  }
+  case LogRecordType::NEWPAGE:
+    memcpy(data + pos, &log_record.prev_page_id_, sizeof(page_id_t));
+    pos += sizeof(page_id_t);
+    memcpy(data + pos, &log_record.page_id_, sizeof(page_id_t));
+    break;
+  case LogRecordType::CLR:
+    memcpy(data + pos, &log_record.undo_next_lsn_, sizeof(lsn_t));
+    pos += sizeof(lsn_t);
+    memcpy(data + pos, &log_record.action_, sizeof(LogRecordType));
+    pos += sizeof(LogRecordType);
+    memcpy(data + pos, &log_record.clr_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.clr_tuple_.SerializeLogTo(data + pos);
+    break;
+  case LogRecordType::CHECKPOINT_END: {
+    memcpy(data + pos, &log_record.begin_lsn_, sizeof(lsn_t));
+    pos += sizeof(lsn_t);
+    int32_t count = log_record.active_txns_.size();
+    memcpy(data + pos, &count, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    for (auto &entry : log_record.active_txns_) {
+      memcpy(data + pos, &entry.first, sizeof(txn_id_t));
+      memcpy(data + pos + sizeof(txn_id_t), &entry.second, sizeof(lsn_t));
+      pos += sizeof(txn_id_t) + sizeof(lsn_t);
+    }
+    count = log_record.dirty_pages_.size();
+    memcpy(data + pos, &count, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    for (auto &entry : log_record.dirty_pages_) {
+      memcpy(data + pos, &entry.first, sizeof(page_id_t));
+      memcpy(data + pos + sizeof(page_id_t), &entry.second, sizeof(lsn_t));
+      pos += sizeof(page_id_t) + sizeof(lsn_t);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void LogManager::WaitForRoom(std::unique_lock<std::mutex> &lock) {
+  if (flush_thread_ != nullptr) {
+    is_flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  } else {
+    FlushBuffer(lock);
+  }
+}
+
+/*
+ * Only one write at a time: the disk manager wants the buffers to take
+ * turns, and the flush buffer is in use until the write is done
+ */
+void LogManager::FlushBuffer(std::unique_lock<std::mutex> &lock,
+                             LogRecord *log_record) {
+  if (is_flushing_) {
+    flushed_cv_.wait(lock);
+    return;
+  }
+  is_flush_requested_ = false;
+  uint64_t reservation = reservation_.load();
+  if (GetOffset(reservation) == 0 && log_record == nullptr) {
+    flushed_cv_.notify_all();
+    return;
+  }
+  // the next log buffer is free, its last write is done
+  int index = GetBufferIndex(reservation);
+  copied_[1 - index] = 0;
+  int32_t extra = log_record == nullptr ? 0 : log_record->size_;
+  // appends go on until the swap, the next buffer starts after the last
+  do {
+    start_lsns_[1 - index] =
+        GetLSN(reservation) + GetOffset(reservation) + extra;
+  } while (!reservation_.compare_exchange_weak(
+      reservation, MakeReservation(GetSwapCount(reservation) + 1, 0)));
+  int32_t size = GetOffset(reservation);
+  // last byte written
+  lsn_t lsn = GetLSN(reservation) + size - 1;
+  is_flushing_ = true;
+  lock.unlock();
+  // appenders wait for is_flushing_ only if the new log buffer fills up
+  flushed_cv_.notify_all();
+
+  // appends that reserved bytes before the swap may still be copying
+  while (copied_[index].load() != size)
+    std::this_thread::yield();
+  if (size > 0)
+    disk_manager_->WriteLog(buffers_[index], size);
+  if (log_record != nullptr) {
+    log_record->lsn_ = lsn + 1;
+    lsn += log_record->size_;
+    std::vector<char> data(log_record->size_);
+    SerializeLogRecord(*log_record, data.data());
+    disk_manager_->WriteLog(data.data(), log_record->size_);
+  }
 
-  return INVALID_LSN;
+  lock.lock();
+  is_flushing_ = false;
+  persistent_lsn_ = lsn;
+  flushed_cv_.notify_all();
 }
 
 } // namespace scudb
@@ -0,0 +1,91 @@
+/**
+ * log_record.cpp
+ */
+
+#include <cstring>
+
+#include "logging/log_record.h"
+
+namespace scudb {
+
+/*
+ * Runs of changed bytes closer than the head of a range (offset and length)
+ * are logged as one range, unchanged bytes in between XOR to zero
+ */
+void LogRecord::MakeDelta(const Tuple &old_tuple, const Tuple &new_tuple,
+                          std::vector<char> &delta) {
+  MakeDelta(old_tuple.GetData(), new_tuple.GetData(), old_tuple.GetLength(),
+            delta);
+}
+
+void LogRecord::MakeDelta(const char *old_data, const char *new_data,
+                          int32_t size, std::vector<char> &delta) {
+  const int16_t range_head_size = 2 * sizeof(int16_t);
+  delta.clear();
+  int32_t i = 0;
+  while (i < size) {
+    if (old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+    int16_t offset = i;
+    int32_t end = i + 1;
+    for (int32_t j = end; j < size && j <= end + range_head_size; j++) {
+      if (old_data[j] != new_data[j])
+        end = j + 1;
+    }
+    int16_t length = end - offset;
+    size_t pos = delta.size();
+    delta.resize(pos + range_head_size + length);
+    memcpy(&delta[pos], &offset, sizeof(int16_t));
+    memcpy(&delta[pos + sizeof(int16_t)], &length, sizeof(int16_t));
+    for (int16_t k = 0; k < length; k++)
+      delta[pos + range_head_size + k] =
+          old_data[offset + k] ^ new_data[offset + k];
+    i = end;
+  }
+}
+
+bool LogRecord::ApplyDelta(char *tuple_data, int32_t tuple_size) const {
+  if (tuple_size != delta_tuple_size_)
+    return false;
+  ApplyDelta(delta_.data(), delta_.size(), tuple_data);
+  return true;
+}
+
+void LogRecord::ApplyDelta(const char *delta, int32_t delta_size,
+                           char *data) {
+  int32_t pos = 0;
+  while (pos < delta_size) {
+    int16_t offset, length;
+    memcpy(&offset, delta + pos, sizeof(int16_t));
+    memcpy(&length, delta + pos + sizeof(int16_t), sizeof(int16_t));
+    pos += 2 * sizeof(int16_t);
+    for (int16_t k = 0; k < length; k++)
+      data[offset + k] ^= delta[pos + k];
+    pos += length;
+  }
+}
+
+/*
+ * A page without LSN keeps both sides, a delta could not tell whether the
+ * page has it. So does a page logged whole
+ */
+LogRecord::LogRecord(txn_id_t txn_id, lsn_t prev_lsn,
+                     LogRecordType log_record_type, page_id_t page_id,
+                     int32_t page_flags, const char *old_data,
+                     const char *new_data)
+    : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
+      log_record_type_(log_record_type), page_id_(page_id),
+      page_flags_(page_flags) {
+  if (page_flags & (INDEX_PAGE_IMAGE | INDEX_PAGE_WHOLE)) {
+    delta_.assign(old_data, old_data + PAGE_SIZE);
+    delta_.insert(delta_.end(), new_data, new_data + PAGE_SIZE);
+  } else {
+    MakeDelta(old_data, new_data, PAGE_SIZE, delta_);
+  }
+  size_ = HEADER_SIZE + sizeof(page_id_t) + 2 * sizeof(int32_t) +
+          delta_.size();
+}
+
+} // namespace scudb
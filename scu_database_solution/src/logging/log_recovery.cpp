@@ -2,33 +2,739 @@
  * log_recovey.cpp
  */
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
 #include "logging/log_recovery.h"
 #include "page/table_page.h"
 
 namespace scudb {
 /*
- * deserialize a log record from log buffer
+ * deserialize a log record from log buffer, the whole record (size_ bytes)
+ * must be in data
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
 bool LogRecovery::DeserializeLogRecord(const char *data,
                                              LogRecord &log_record) {
-  return false;
+  log_record.size_ = *reinterpret_cast<const int32_t *>(data);
+  log_record.lsn_ = *reinterpret_cast<const lsn_t *>(data + 4);
+  log_record.txn_id_ = *reinterpret_cast<const txn_id_t *>(data + 12);
+  log_record.prev_lsn_ = *reinterpret_cast<const lsn_t *>(data + 16);
+  log_record.log_record_type_ =
+      *reinterpret_cast<const LogRecordType *>(data + 24);
+  if (log_record.size_ < LogRecord::HEADER_SIZE ||
+      log_record.log_record_type_ <= LogRecordType::INVALID ||
+      log_record.log_record_type_ > LogRecordType::INDEXPAGE)
+    return false;
+  int32_t pos = LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    log_record.insert_rid_ = *reinterpret_cast<const RID *>(data + pos);
+    pos += sizeof(RID);
+    log_record.insert_tuple_.DeserializeLogFrom(data + pos);
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    log_record.delete_rid_ = *reinterpret_cast<const RID *>(data + pos);
+    pos += sizeof(RID);
+    log_record.delete_tuple_.DeserializeLogFrom(data + pos);
+    break;
+  case LogRecordType::UPDATE:
+    log_record.update_rid_ = *reinterpret_cast<const RID *>(data + pos);
+    pos += sizeof(RID);
+    log_record.old_tuple_.DeserializeLogFrom(data + pos);
+    pos += sizeof(int32_t) + log_record.old_tuple_.GetLogLength();
+    log_record.new_tuple_.DeserializeLogFrom(data + pos);
+    break;
+  case LogRecordType::DELTAUPDATE: {
+    log_record.update_rid_ = *reinterpret_cast<const RID *>(data + pos);
+    pos += sizeof(RID);
+    log_record.delta_tuple_size_ =
+        *reinterpret_cast<const int32_t *>(data + pos);
+    pos += sizeof(int32_t);
+    int32_t delta_size = *reinterpret_cast<const int32_t *>(data + pos);
+    pos += sizeof(int32_t);
+    log_record.delta_.assign(data + pos, data + pos + delta_size);
+    break;
+  }
+  case LogRecordType::INDEXPAGE: {
+    log_record.page_id_ = *reinterpret_cast<const page_id_t *>(data + pos);
+    pos += sizeof(page_id_t);
+    log_record.page_flags_ = *reinterpret_cast<const int32_t *>(data + pos);
+    pos += sizeof(int32_t);
+    int32_t data_size = *reinterpret_cast<const int32_t *>(data + pos);
+    pos += sizeof(int32_t);
+    log_record.delta_.assign(data + pos, data + pos + data_size);
+    break;
+  }
+  case LogRecordType::NEWPAGE:
+    log_record.prev_page_id_ = *reinterpret_cast<const page_id_t *>(data + pos);
+    pos += sizeof(page_id_t);
+    log_record.page_id_ = *reinterpret_cast<const page_id_t *>(data + pos);
+    break;
+  case LogRecordType::CLR:
+    log_record.undo_next_lsn_ = *reinterpret_cast<const lsn_t *>(data + pos);
+    pos += sizeof(lsn_t);
+    log_record.action_ = *reinterpret_cast<const LogRecordType *>(data + pos);
+    pos += sizeof(LogRecordType);
+    log_record.clr_rid_ = *reinterpret_cast<const RID *>(data + pos);
+    pos += sizeof(RID);
+    log_record.clr_tuple_.DeserializeLogFrom(data + pos);
+    break;
+  case LogRecordType::CHECKPOINT_END: {
+    log_record.begin_lsn_ = *reinterpret_cast<const lsn_t *>(data + pos);
+    pos += sizeof(lsn_t);
+    int32_t count = *reinterpret_cast<const int32_t *>(data + pos);
+    pos += sizeof(int32_t);
+    log_record.active_txns_.clear();
+    for (int32_t i = 0; i < count; i++) {
+      log_record.active_txns_.emplace_back(
+          *reinterpret_cast<const txn_id_t *>(data + pos),
+          *reinterpret_cast<const lsn_t *>(data + pos + sizeof(txn_id_t)));
+      pos += sizeof(txn_id_t) + sizeof(lsn_t);
+    }
+    count = *reinterpret_cast<const int32_t *>(data + pos);
+    pos += sizeof(int32_t);
+    log_record.dirty_pages_.clear();
+    for (int32_t i = 0; i < count; i++) {
+      log_record.dirty_pages_.emplace_back(
+          *reinterpret_cast<const page_id_t *>(data + pos),
+          *reinterpret_cast<const lsn_t *>(data + pos + sizeof(page_id_t)));
+      pos += sizeof(page_id_t) + sizeof(lsn_t);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  return true;
+}
+
+/*
+ * The log buffer is refilled from lsn when the record is not all in it; a
+ * record larger than the log buffer is read on its own.
+ * The log ends at the first record that doesn't fit in the log file or
+ * doesn't carry its own offset as lsn (torn write)
+ */
+bool LogRecovery::ReadLogRecord(lsn_t lsn, LogRecord &log_record) {
+  if (lsn < 0 || lsn + LogRecord::HEADER_SIZE > log_size_)
+    return false;
+  if (lsn < offset_ || lsn + LogRecord::HEADER_SIZE > offset_ + buffer_size_) {
+    if (!disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, lsn))
+      return false;
+    offset_ = lsn;
+    buffer_size_ = std::min<lsn_t>(LOG_BUFFER_SIZE, log_size_ - lsn);
+  }
+  int32_t size = *reinterpret_cast<int32_t *>(log_buffer_ + lsn - offset_);
+  if (size < LogRecord::HEADER_SIZE || lsn + size > log_size_)
+    return false;
+  bool ok;
+  if (lsn + size <= offset_ + buffer_size_) {
+    ok = DeserializeLogRecord(log_buffer_ + lsn - offset_, log_record);
+  } else if (size > LOG_BUFFER_SIZE) {
+    std::vector<char> data(size);
+    disk_manager_->ReadLog(data.data(), size, lsn);
+    ok = DeserializeLogRecord(data.data(), log_record);
+  } else {
+    disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, lsn);
+    offset_ = lsn;
+    buffer_size_ = std::min<lsn_t>(LOG_BUFFER_SIZE, log_size_ - lsn);
+    ok = DeserializeLogRecord(log_buffer_, log_record);
+  }
+  if (!ok || log_record.lsn_ != lsn)
+    return false;
+  read_count_++;
+  return true;
+}
+
+/*
+ * Analysis: scan from the begin record of the last complete checkpoint (the
+ * master record), or from the beginning of log if there is none. Every
+ * transaction seen is active until its COMMIT/ABORT, every page changed is
+ * dirty from its first record on. The END record of the checkpoint adds
+ * what happened before BEGIN: transactions not ended since, and older
+ * recLSNs of dirty pages
+ */
+lsn_t LogRecovery::Analyze(lsn_t checkpoint_lsn) {
+  active_txn_.clear();
+  dirty_page_.clear();
+  log_size_ = disk_manager_->GetLogSize();
+  LogRecord log_record;
+  lsn_t start = checkpoint_lsn;
+  if (!ReadLogRecord(start, log_record) ||
+      log_record.log_record_type_ != LogRecordType::CHECKPOINT_BEGIN)
+    start = disk_manager_->GetLogStart();
+  std::set<txn_id_t> ended_txns;
+  for (end_lsn_ = start; ReadLogRecord(end_lsn_, log_record);
+       end_lsn_ += log_record.size_) {
+    lsn_t lsn = end_lsn_;
+    LogRecordType type = log_record.log_record_type_;
+    if (log_record.txn_id_ != INVALID_TXN_ID) {
+      if (type == LogRecordType::COMMIT || type == LogRecordType::ABORT) {
+        active_txn_.erase(log_record.txn_id_);
+        ended_txns.insert(log_record.txn_id_);
+      } else {
+        active_txn_[log_record.txn_id_] = lsn;
+      }
+    }
+    switch (type) {
+    case LogRecordType::INSERT:
+      dirty_page_.emplace(log_record.insert_rid_.GetPageId(), lsn);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      dirty_page_.emplace(log_record.delete_rid_.GetPageId(), lsn);
+      break;
+    case LogRecordType::UPDATE:
+    case LogRecordType::DELTAUPDATE:
+      dirty_page_.emplace(log_record.update_rid_.GetPageId(), lsn);
+      break;
+    case LogRecordType::INDEXPAGE:
+      dirty_page_.emplace(log_record.page_id_, lsn);
+      break;
+    case LogRecordType::NEWPAGE:
+      dirty_page_.emplace(log_record.page_id_, lsn);
+      if (log_record.prev_page_id_ != INVALID_PAGE_ID)
+        dirty_page_.emplace(log_record.prev_page_id_, lsn);
+      break;
+    case LogRecordType::CLR:
+      dirty_page_.emplace(log_record.clr_rid_.GetPageId(), lsn);
+      break;
+    case LogRecordType::CHECKPOINT_END:
+      if (log_record.begin_lsn_ != start)
+        break;
+      for (auto &entry : log_record.active_txns_) {
+        if (ended_txns.find(entry.first) == ended_txns.end())
+          active_txn_.emplace(entry.first, entry.second);
+      }
+      for (auto &entry : log_record.dirty_pages_) {
+        auto it = dirty_page_.find(entry.first);
+        if (it == dirty_page_.end())
+          dirty_page_.emplace(entry.first, entry.second);
+        else
+          it->second = std::min(it->second, entry.second);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return start;
+}
+
+/*
+ * redo phase on TABLE PAGE level(table/table_page.h)
+ * analysis first, then repeat history from the smallest recLSN of the dirty
+ * page table to the end of log, CLRs included. A record is skipped if its
+ * page was written after it: not dirty, dirty since a later record, or
+ * with a page LSN not below the record's.
+ * With more than one worker, this thread only reads the log and hands each
+ * record to the worker of its page (page id modulo worker count); records of
+ * a page stay in lsn order, and pages are independent of each other
+ */
+void LogRecovery::Redo(int worker_count) {
+  RedoFrom(disk_manager_->ReadMasterRecord(), worker_count);
+}
+
+void LogRecovery::RedoFrom(lsn_t checkpoint_lsn, int worker_count) {
+  Analyze(checkpoint_lsn);
+  if (dirty_page_.empty())
+    return;
+  lsn_t redo_lsn = dirty_page_.begin()->second;
+  for (auto &entry : dirty_page_)
+    redo_lsn = std::min(redo_lsn, entry.second);
+  worker_count = std::max(worker_count, 1);
+
+  std::vector<std::unique_ptr<RedoQueue>> queues;
+  std::vector<std::thread> workers;
+  if (worker_count > 1) {
+    for (int i = 0; i < worker_count; i++) {
+      queues.emplace_back(new RedoQueue);
+      workers.emplace_back([this, i, worker_count, &queues] {
+        RedoQueue &queue = *queues[i];
+        std::vector<LogRecord> records;
+        std::unique_lock<std::mutex> lock(queue.latch_);
+        while (true) {
+          queue.cv_.wait(lock, [&queue] {
+            return !queue.records_.empty() || queue.is_done_;
+          });
+          if (queue.records_.empty())
+            break;
+          records.swap(queue.records_);
+          lock.unlock();
+          RedoLogRecords(records, i, worker_count);
+          records.clear();
+          lock.lock();
+        }
+      });
+    }
+  }
+
+  // records are handed over in batches, to keep the latch of a queue cold
+  std::vector<std::vector<LogRecord>> batches(worker_count);
+  LogRecord log_record;
+  for (lsn_t lsn = redo_lsn; ReadLogRecord(lsn, log_record);
+       lsn += log_record.size_) {
+    ReservePage(log_record);
+    if (log_record.log_record_type_ == LogRecordType::NEWPAGE) {
+      page_id_t prev_page_id = log_record.prev_page_id_;
+      if (prev_page_id != INVALID_PAGE_ID &&
+          prev_page_id % worker_count !=
+              log_record.page_id_ % worker_count)
+        batches[prev_page_id % worker_count].push_back(log_record);
+    }
+    page_id_t page_id = GetRedoPageId(log_record);
+    if (page_id == INVALID_PAGE_ID)
+      continue;
+    int i = page_id % worker_count;
+    batches[i].push_back(log_record);
+    if (worker_count > 1 && batches[i].size() >= REDO_BATCH_SIZE) {
+      std::lock_guard<std::mutex> guard(queues[i]->latch_);
+      queues[i]->records_.insert(queues[i]->records_.end(),
+                                 batches[i].begin(), batches[i].end());
+      queues[i]->cv_.notify_one();
+      batches[i].clear();
+    } else if (worker_count == 1 && batches[0].size() >= REDO_BATCH_SIZE) {
+      RedoLogRecords(batches[0], 0, 1);
+      batches[0].clear();
+    }
+  }
+  if (worker_count == 1) {
+    RedoLogRecords(batches[0], 0, 1);
+    return;
+  }
+  for (int i = 0; i < worker_count; i++) {
+    std::lock_guard<std::mutex> guard(queues[i]->latch_);
+    queues[i]->records_.insert(queues[i]->records_.end(),
+                               batches[i].begin(), batches[i].end());
+    queues[i]->is_done_ = true;
+    queues[i]->cv_.notify_one();
+  }
+  for (auto &worker : workers)
+    worker.join();
+}
+
+/*
+ * The records read are redone up to the end of the log as it is now; the
+ * log may be cut short in a record being written, the next call reads it
+ * again from there
+ */
+lsn_t LogRecovery::ReadLogRecords(lsn_t lsn, std::vector<LogRecord> &records) {
+  log_size_ = disk_manager_->GetLogSize();
+  LogRecord log_record;
+  for (; ReadLogRecord(lsn, log_record); lsn += log_record.size_)
+    records.push_back(log_record);
+  return lsn;
 }
 
 /*
- *redo phase on TABLE PAGE level(table/table_page.h)
- *read log file from the beginning to end (you must prefetch log records into
- *log buffer to reduce unnecessary I/O operations), remember to compare page's
- *LSN with log_record's sequence number, and also build active_txn_ table &
- *lsn_mapping_ table
+ * Every page is up to date with the records before, so each one is dirty
+ * from its first record on
  */
-void LogRecovery::Redo() {}
+void LogRecovery::RedoNext(std::vector<LogRecord> &records) {
+  dirty_page_.clear();
+  for (auto &log_record : records) {
+    ReservePage(log_record);
+    page_id_t page_id = GetRedoPageId(log_record);
+    if (page_id != INVALID_PAGE_ID)
+      dirty_page_.emplace(page_id, log_record.lsn_);
+    if (log_record.log_record_type_ == LogRecordType::NEWPAGE &&
+        log_record.prev_page_id_ != INVALID_PAGE_ID)
+      dirty_page_.emplace(log_record.prev_page_id_, log_record.lsn_);
+  }
+  RedoLogRecords(records, 0, 1);
+}
+
+// the page may have been allocated but never written
+void LogRecovery::ReservePage(LogRecord &log_record) {
+  if (log_record.log_record_type_ == LogRecordType::NEWPAGE ||
+      (log_record.log_record_type_ == LogRecordType::INDEXPAGE &&
+       (log_record.page_flags_ & LogRecord::INDEX_PAGE_NEW)))
+    disk_manager_->ReservePage(log_record.page_id_);
+}
+
+page_id_t LogRecovery::GetRedoPageId(LogRecord &log_record) {
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    return log_record.insert_rid_.GetPageId();
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    return log_record.delete_rid_.GetPageId();
+  case LogRecordType::UPDATE:
+  case LogRecordType::DELTAUPDATE:
+    return log_record.update_rid_.GetPageId();
+  case LogRecordType::CLR:
+    return log_record.clr_rid_.GetPageId();
+  case LogRecordType::NEWPAGE:
+  case LogRecordType::INDEXPAGE:
+    return log_record.page_id_;
+  default:
+    return INVALID_PAGE_ID;
+  }
+}
 
 /*
- *undo phase on TABLE PAGE level(table/table_page.h)
- *iterate through active txn map and undo each operation
+ * A run of records of the same page is redone with one fetch of the page.
+ * A worker pins one page at a time, so that workers outnumbering the
+ * buffer pool frames wait for a frame instead of for each other
  */
-void LogRecovery::Undo() {}
+void LogRecovery::RedoLogRecords(std::vector<LogRecord> &records, int worker,
+                                 int worker_count) {
+  // the page id of an index page is not where a table page has it
+  TablePage *page = nullptr;
+  page_id_t pinned_page_id = INVALID_PAGE_ID;
+  bool is_dirty = false;
+  for (auto &log_record : records) {
+    page_id_t page_id = GetRedoPageId(log_record);
+    auto it = dirty_page_.find(page_id);
+    if (page_id % worker_count == worker && it != dirty_page_.end() &&
+        log_record.lsn_ >= it->second) {
+      if (page != nullptr && pinned_page_id != page_id) {
+        buffer_pool_manager_->UnpinPage(pinned_page_id, is_dirty);
+        page = nullptr;
+      }
+      if (page == nullptr) {
+        page = FetchTablePage(page_id);
+        pinned_page_id = page_id;
+        is_dirty = false;
+      }
+      is_dirty = RedoLogRecord(page, page_id, log_record) || is_dirty;
+    }
+    if (log_record.log_record_type_ != LogRecordType::NEWPAGE ||
+        log_record.prev_page_id_ == INVALID_PAGE_ID ||
+        log_record.prev_page_id_ % worker_count != worker)
+      continue;
+    // link the new page behind its previous one, which got the LSN of the
+    // record. A previous page with a later LSN has been relinked since
+    it = dirty_page_.find(log_record.prev_page_id_);
+    if (it == dirty_page_.end() || log_record.lsn_ < it->second)
+      continue;
+    if (page != nullptr) {
+      buffer_pool_manager_->UnpinPage(pinned_page_id, is_dirty);
+      page = nullptr;
+    }
+    auto prev_page = FetchTablePage(log_record.prev_page_id_);
+    bool is_linked = prev_page->GetLSN() < log_record.lsn_;
+    if (is_linked) {
+      prev_page->SetNextPageId(log_record.page_id_);
+      prev_page->SetLSN(log_record.lsn_);
+    }
+    buffer_pool_manager_->UnpinPage(log_record.prev_page_id_, is_linked);
+  }
+  if (page != nullptr)
+    buffer_pool_manager_->UnpinPage(pinned_page_id, is_dirty);
+}
+
+bool LogRecovery::RedoLogRecord(TablePage *page, page_id_t page_id,
+                                LogRecord &log_record) {
+  LogRecordType type = log_record.log_record_type_;
+  RID rid;
+  Tuple *tuple = nullptr;
+  Tuple delta_tuple;
+  switch (type) {
+  case LogRecordType::INSERT:
+    rid = log_record.insert_rid_;
+    tuple = &log_record.insert_tuple_;
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    rid = log_record.delete_rid_;
+    tuple = &log_record.delete_tuple_;
+    break;
+  case LogRecordType::UPDATE:
+    rid = log_record.update_rid_;
+    tuple = &log_record.new_tuple_;
+    break;
+  case LogRecordType::DELTAUPDATE:
+    // the page holds the old tuple, unless it has the record
+    if (page->GetLSN() >= log_record.lsn_ ||
+        !ReadDeltaTuple(page, log_record, delta_tuple))
+      return false;
+    type = LogRecordType::UPDATE;
+    rid = log_record.update_rid_;
+    tuple = &delta_tuple;
+    break;
+  case LogRecordType::CLR:
+    type = log_record.action_;
+    rid = log_record.clr_rid_;
+    tuple = &log_record.clr_tuple_;
+    if (type == LogRecordType::INDEXPAGE)
+      return RedoIndexPage(page, rid.GetSlotNum(), tuple->GetData(),
+                           tuple->GetLength(), log_record.lsn_);
+    break;
+  case LogRecordType::INDEXPAGE:
+    return RedoIndexPage(page, log_record.page_flags_,
+                         log_record.delta_.data(), log_record.delta_.size(),
+                         log_record.lsn_);
+  case LogRecordType::NEWPAGE:
+    // a page never written has no valid page id
+    if (page->GetLSN() >= log_record.lsn_ && page->GetPageId() == page_id)
+      return false;
+    page->Init(page_id, PAGE_SIZE, log_record.prev_page_id_, nullptr,
+               nullptr);
+    page->SetLSN(log_record.lsn_);
+    return true;
+  default:
+    return false;
+  }
+  if (page->GetLSN() >= log_record.lsn_)
+    return false;
+  Apply(page, type, rid, *tuple);
+  page->SetLSN(log_record.lsn_);
+  return true;
+}
+
+/*
+ * An image is redone even if the page has it already, setting bytes to the
+ * new side twice is harmless. A whole page is copied over, however the
+ * records before it laid the page out
+ */
+bool LogRecovery::RedoIndexPage(Page *page, int32_t page_flags,
+                                const char *data, int32_t data_size,
+                                lsn_t lsn) {
+  if (page_flags & LogRecord::INDEX_PAGE_IMAGE) {
+    SetImageBytes(page, data, data + PAGE_SIZE);
+    return true;
+  }
+  if (page->GetLSN() >= lsn)
+    return false;
+  if (page_flags & LogRecord::INDEX_PAGE_WHOLE) {
+    memcpy(page->GetData(), data + PAGE_SIZE, PAGE_SIZE);
+  } else {
+    if (page_flags & LogRecord::INDEX_PAGE_NEW)
+      memset(page->GetData(), 0, PAGE_SIZE);
+    LogRecord::ApplyDelta(data, data_size, page->GetData());
+  }
+  page->SetLSN(lsn);
+  return true;
+}
+
+/*
+ * Only the bytes the record changed are set: the header page is shared by
+ * every index, another one may have changed its own root since
+ */
+void LogRecovery::SetImageBytes(Page *page, const char *from,
+                                const char *to) {
+  char *page_data = page->GetData();
+  for (int i = 0; i < PAGE_SIZE; i++) {
+    if (from[i] != to[i])
+      page_data[i] = to[i];
+  }
+}
+
+bool LogRecovery::ReadDeltaTuple(TablePage *page, LogRecord &log_record,
+                                 Tuple &tuple) {
+  return page->GetTuple(log_record.update_rid_, tuple, nullptr, nullptr) &&
+         log_record.ApplyDelta(tuple.GetData(), tuple.GetLength());
+}
+
+// frames may all be pinned by other redo workers for a moment
+TablePage *LogRecovery::FetchTablePage(page_id_t page_id) {
+  Page *page;
+  while ((page = buffer_pool_manager_->FetchPage(page_id)) == nullptr)
+    std::this_thread::yield();
+  return static_cast<TablePage *>(page);
+}
+
+/*
+ * A tuple is inserted into the slot it had, a tuple with overflow pages as
+ * its head. Overflow pages are redone from their own records; those of an
+ * insert undone here are left behind, like new pages of the table heap
+ */
+void LogRecovery::Apply(TablePage *page, LogRecordType type, const RID &rid,
+                        const Tuple &tuple) {
+  switch (type) {
+  case LogRecordType::INSERT:
+    page->RestoreTuple(tuple, rid);
+    break;
+  case LogRecordType::MARKDELETE:
+    page->MarkDelete(rid, nullptr, nullptr, nullptr);
+    break;
+  case LogRecordType::APPLYDELETE:
+    page->ApplyDelete(rid, nullptr, nullptr);
+    break;
+  case LogRecordType::ROLLBACKDELETE:
+    page->RollbackDelete(rid, nullptr, nullptr);
+    break;
+  case LogRecordType::UPDATE: {
+    Tuple old_tuple;
+    page->UpdateTuple(tuple, old_tuple, rid, nullptr, nullptr, nullptr);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+/*
+ * undo phase on TABLE PAGE level(table/table_page.h)
+ * roll back the transactions left active after redo, all of them together:
+ * the record with the largest lsn is undone first. A CLR tells where its
+ * transaction continues, so records already undone before a crash are
+ * skipped. A transaction is ended with an ABORT record when its BEGIN is
+ * reached
+ */
+void LogRecovery::Undo() {
+  log_size_ = disk_manager_->GetLogSize();
+  std::map<lsn_t, txn_id_t> undo_lsns;
+  for (auto &entry : active_txn_)
+    undo_lsns[entry.second] = entry.first;
+  lsn_t last_lsn = INVALID_LSN;
+  LogRecord log_record;
+  while (!undo_lsns.empty()) {
+    auto it = std::prev(undo_lsns.end());
+    txn_id_t txn_id = it->second;
+    lsn_t next_lsn = INVALID_LSN;
+    if (ReadLogRecord(it->first, log_record)) {
+      switch (log_record.log_record_type_) {
+      case LogRecordType::CLR:
+        next_lsn = log_record.undo_next_lsn_;
+        break;
+      case LogRecordType::BEGIN:
+        break;
+      default:
+        UndoLogRecord(log_record);
+        next_lsn = log_record.prev_lsn_;
+        break;
+      }
+    }
+    undo_lsns.erase(it);
+    if (next_lsn != INVALID_LSN) {
+      undo_lsns[next_lsn] = txn_id;
+      continue;
+    }
+    if (log_manager_ != nullptr) {
+      LogRecord abort_record(txn_id, active_txn_[txn_id],
+                             LogRecordType::ABORT);
+      last_lsn = log_manager_->AppendLogRecord(abort_record);
+    }
+    active_txn_.erase(txn_id);
+  }
+  if (last_lsn != INVALID_LSN)
+    log_manager_->Flush(last_lsn);
+}
+
+void LogRecovery::UndoLogRecord(LogRecord &log_record) {
+  LogRecordType action;
+  RID rid;
+  Tuple *tuple;
+  Tuple delta_tuple;
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    action = LogRecordType::APPLYDELETE;
+    rid = log_record.insert_rid_;
+    tuple = &log_record.insert_tuple_;
+    break;
+  case LogRecordType::MARKDELETE:
+    action = LogRecordType::ROLLBACKDELETE;
+    rid = log_record.delete_rid_;
+    tuple = &log_record.delete_tuple_;
+    break;
+  case LogRecordType::ROLLBACKDELETE:
+    action = LogRecordType::MARKDELETE;
+    rid = log_record.delete_rid_;
+    tuple = &log_record.delete_tuple_;
+    break;
+  case LogRecordType::APPLYDELETE:
+    action = LogRecordType::INSERT;
+    rid = log_record.delete_rid_;
+    tuple = &log_record.delete_tuple_;
+    break;
+  case LogRecordType::UPDATE:
+    action = LogRecordType::UPDATE;
+    rid = log_record.update_rid_;
+    tuple = &log_record.old_tuple_;
+    break;
+  case LogRecordType::DELTAUPDATE: {
+    // after redo the page holds the new tuple, the CLR gets the old one
+    action = LogRecordType::UPDATE;
+    rid = log_record.update_rid_;
+    tuple = &delta_tuple;
+    auto page = static_cast<TablePage *>(
+        buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    if (page == nullptr)
+      return;
+    bool is_read = ReadDeltaTuple(page, log_record, delta_tuple);
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    if (!is_read)
+      return;
+    break;
+  }
+  case LogRecordType::INDEXPAGE:
+    UndoIndexPage(log_record);
+    return;
+  default:
+    // a new page stays, empty, in the table heap
+    return;
+  }
+  lsn_t clr_lsn = INVALID_LSN;
+  if (log_manager_ != nullptr) {
+    LogRecord clr(log_record.txn_id_, active_txn_[log_record.txn_id_],
+                  LogRecordType::CLR, log_record.prev_lsn_, action, rid,
+                  *tuple);
+    clr_lsn = log_manager_->AppendLogRecord(clr);
+    active_txn_[log_record.txn_id_] = clr_lsn;
+  }
+  auto page = static_cast<TablePage *>(
+      buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr)
+    return;
+  Apply(page, action, rid, *tuple);
+  if (clr_lsn != INVALID_LSN)
+    page->SetLSN(clr_lsn);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+}
+
+/*
+ * Redo left the page as the operation did, so the delta takes it back; a new
+ * page stays allocated, zeroed
+ */
+void LogRecovery::UndoIndexPage(LogRecord &log_record) {
+  page_id_t page_id = log_record.page_id_;
+  std::vector<char> data(log_record.delta_);
+  int32_t page_flags = log_record.page_flags_ & (LogRecord::INDEX_PAGE_IMAGE |
+                                                 LogRecord::INDEX_PAGE_WHOLE);
+  if (page_flags != 0)
+    std::swap_ranges(data.begin(), data.begin() + PAGE_SIZE,
+                     data.begin() + PAGE_SIZE);
+  lsn_t clr_lsn = INVALID_LSN;
+  if (log_manager_ != nullptr) {
+    int32_t data_size = data.size();
+    std::vector<char> storage(sizeof(int32_t) + data_size);
+    memcpy(storage.data(), &data_size, sizeof(int32_t));
+    memcpy(storage.data() + sizeof(int32_t), data.data(), data_size);
+    Tuple tuple;
+    tuple.DeserializeFrom(storage.data());
+    LogRecord clr(log_record.txn_id_, active_txn_[log_record.txn_id_],
+                  LogRecordType::CLR, log_record.prev_lsn_,
+                  LogRecordType::INDEXPAGE, RID(page_id, page_flags), tuple);
+    clr_lsn = log_manager_->AppendLogRecord(clr);
+    active_txn_[log_record.txn_id_] = clr_lsn;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    return;
+  if (page_flags & LogRecord::INDEX_PAGE_IMAGE) {
+    SetImageBytes(page, data.data(), data.data() + PAGE_SIZE);
+  } else {
+    if (page_flags & LogRecord::INDEX_PAGE_WHOLE)
+      memcpy(page->GetData(), data.data() + PAGE_SIZE, PAGE_SIZE);
+    else
+      LogRecord::ApplyDelta(data.data(), data.size(), page->GetData());
+    if (clr_lsn != INVALID_LSN)
+      page->SetLSN(clr_lsn);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 } // namespace scudb
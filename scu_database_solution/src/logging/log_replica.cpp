@@ -0,0 +1,156 @@
+/**
+ * log_replica.cpp
+ */
+
+#include "logging/log_replica.h"
+
+namespace scudb {
+
+LogReplica::~LogReplica() {
+  StopApplyThread();
+  disk_manager_->WriteReplicaLSN(INVALID_LSN);
+}
+
+/*
+ * The slot is set before the master record is read: a checkpoint that
+ * truncates the log without seeing it wrote its master record before, and
+ * keeps the log redo from that one reads
+ */
+void LogReplica::Bootstrap() {
+  std::lock_guard<std::mutex> guard(catch_up_latch_);
+  disk_manager_->RefreshLog();
+  slot_lsn_ = disk_manager_->GetLogStart();
+  disk_manager_->WriteReplicaLSN(slot_lsn_);
+  lsn_t checkpoint_lsn = disk_manager_->ReadMasterRecord();
+  disk_manager_->CopyPrimaryPages();
+  disk_manager_->RefreshLog();
+  consistent_lsn_ = disk_manager_->GetLogSize();
+
+  log_recovery_.reset(new LogRecovery(disk_manager_, buffer_pool_manager_));
+  log_recovery_->RedoFrom(checkpoint_lsn);
+  read_lsn_ = log_recovery_->GetEndLSN();
+  pending_records_.clear();
+  active_txns_.clear();
+  for (auto &entry : log_recovery_->GetActiveTransactions())
+    active_txns_.insert(entry.first);
+  {
+    std::lock_guard<std::mutex> metrics_guard(metrics_latch_);
+    if (active_txns_.empty() && read_lsn_ >= consistent_lsn_)
+      applied_lsn_ = read_lsn_;
+  }
+  UpdateLogEnd();
+}
+
+/*
+ * Records past the last point no transaction is active stay pending, the
+ * next catch up redoes them with the ones ending their transactions
+ */
+lsn_t LogReplica::CatchUp() {
+  std::lock_guard<std::mutex> guard(catch_up_latch_);
+  disk_manager_->RefreshLog();
+  size_t begin = pending_records_.size();
+  read_lsn_ = log_recovery_->ReadLogRecords(read_lsn_, pending_records_);
+  size_t batch_size = 0;
+  lsn_t batch_lsn = INVALID_LSN;
+  for (size_t i = begin; i < pending_records_.size(); i++) {
+    LogRecord &log_record = pending_records_[i];
+    LogRecordType type = log_record.GetLogRecordType();
+    if (log_record.GetTxnId() != INVALID_TXN_ID) {
+      if (type == LogRecordType::COMMIT || type == LogRecordType::ABORT)
+        active_txns_.erase(log_record.GetTxnId());
+      else
+        active_txns_.insert(log_record.GetTxnId());
+    }
+    if (active_txns_.empty()) {
+      batch_size = i + 1;
+      batch_lsn = log_record.GetLSN() + log_record.GetSize();
+    }
+  }
+  if (batch_size > 0) {
+    std::vector<LogRecord> batch(pending_records_.begin(),
+                                 pending_records_.begin() + batch_size);
+    pending_records_.erase(pending_records_.begin(),
+                           pending_records_.begin() + batch_size);
+    replica_latch_.WLock();
+    log_recovery_->RedoNext(batch);
+    if (batch_lsn >= consistent_lsn_) {
+      std::lock_guard<std::mutex> metrics_guard(metrics_latch_);
+      applied_lsn_ = batch_lsn;
+    }
+    replica_latch_.WUnlock();
+  }
+  if (read_lsn_ != slot_lsn_) {
+    slot_lsn_ = read_lsn_;
+    disk_manager_->WriteReplicaLSN(slot_lsn_);
+  }
+  UpdateLogEnd();
+  return GetAppliedLSN();
+}
+
+void LogReplica::RunApplyThread(std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (apply_thread_ != nullptr)
+    return;
+  is_running_ = true;
+  apply_thread_ = new std::thread([this, interval] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!cv_.wait_for(lock, interval, [this] { return !is_running_; })) {
+      lock.unlock();
+      CatchUp();
+      lock.lock();
+    }
+  });
+}
+
+void LogReplica::StopApplyThread() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (apply_thread_ == nullptr)
+      return;
+    is_running_ = false;
+  }
+  cv_.notify_one();
+  apply_thread_->join();
+  delete apply_thread_;
+  apply_thread_ = nullptr;
+}
+
+lsn_t LogReplica::GetAppliedLSN() {
+  std::lock_guard<std::mutex> guard(metrics_latch_);
+  return applied_lsn_;
+}
+
+/*
+ * The end of log is read from the segment headers, the lag is as of now.
+ * The lag in time is the age of the oldest log not applied, counted from
+ * when the replica first saw the end of log past it
+ */
+void LogReplica::UpdateLogEnd() {
+  disk_manager_->RefreshLog();
+  lsn_t log_end = disk_manager_->GetLogSize();
+  std::lock_guard<std::mutex> guard(metrics_latch_);
+  if (log_end_seen_.empty() || log_end > log_end_seen_.back().first)
+    log_end_seen_.emplace_back(log_end, std::chrono::steady_clock::now());
+  while (applied_lsn_ != INVALID_LSN && !log_end_seen_.empty() &&
+         log_end_seen_.front().first <= applied_lsn_)
+    log_end_seen_.pop_front();
+}
+
+lsn_t LogReplica::GetLagBytes() {
+  UpdateLogEnd();
+  std::lock_guard<std::mutex> guard(metrics_latch_);
+  if (log_end_seen_.empty())
+    return 0;
+  return log_end_seen_.back().first - std::max<lsn_t>(applied_lsn_, 0);
+}
+
+std::chrono::milliseconds LogReplica::GetLagTime() {
+  UpdateLogEnd();
+  std::lock_guard<std::mutex> guard(metrics_latch_);
+  if (log_end_seen_.empty())
+    return std::chrono::milliseconds(0);
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - log_end_seen_.front().second);
+}
+
+} // namespace scudb
@@ -0,0 +1,116 @@
+/**
+ * page_logger.cpp
+ */
+
+#include <cstring>
+
+#include "buffer/buffer_pool_manager.h"
+#include "logging/page_logger.h"
+
+namespace scudb {
+
+std::mutex PageLogger::latch_;
+std::unordered_map<txn_id_t, std::pair<lsn_t, lsn_t>> PageLogger::active_ops_;
+txn_id_t PageLogger::next_txn_id_ = INVALID_TXN_ID - 1;
+
+PageLogger::PageLogger(LogManager *log_manager)
+    : log_manager_(nullptr), txn_id_(INVALID_TXN_ID), prev_lsn_(INVALID_LSN) {
+  if (log_manager == nullptr || !ENABLE_LOGGING ||
+      BufferPoolManager::GetPageLogger() != nullptr)
+    return;
+  log_manager_ = log_manager;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    txn_id_ = next_txn_id_--;
+  }
+  BufferPoolManager::SetPageLogger(this);
+}
+
+PageLogger::~PageLogger() {
+  if (log_manager_ != nullptr)
+    BufferPoolManager::SetPageLogger(nullptr);
+}
+
+void PageLogger::Commit() {
+  if (log_manager_ == nullptr || prev_lsn_ == INVALID_LSN)
+    return;
+  LogRecord commit_record(txn_id_, prev_lsn_, LogRecordType::COMMIT);
+  std::lock_guard<std::mutex> guard(latch_);
+  log_manager_->AppendLogRecord(commit_record);
+  active_ops_.erase(txn_id_);
+  prev_lsn_ = INVALID_LSN;
+}
+
+// the page may have been fetched before its latch was taken
+void PageLogger::LogWhole(Page *page) {
+  auto it = pages_.find(page->GetPageId());
+  if (it == pages_.end())
+    return;
+  it->second.first |= LogRecord::INDEX_PAGE_WHOLE;
+  it->second.second.assign(page->GetData(), page->GetData() + PAGE_SIZE);
+}
+
+// a page fetched again keeps the data of its last record
+void PageLogger::OnFetch(Page *page, bool is_new) {
+  auto it = pages_.find(page->GetPageId());
+  if (it != pages_.end() && !is_new)
+    return;
+  auto &entry = pages_[page->GetPageId()];
+  entry.first = is_new ? LogRecord::INDEX_PAGE_NEW : 0;
+  entry.second.assign(page->GetData(), page->GetData() + PAGE_SIZE);
+}
+
+/*
+ * The header page has no LSN to hold its writes back, so the log is written
+ * right away, while the page is still pinned
+ */
+void PageLogger::OnChange(Page *page) {
+  auto it = pages_.find(page->GetPageId());
+  if (it == pages_.end())
+    return;
+  std::vector<char> &data = it->second.second;
+  if (memcmp(data.data(), page->GetData(), PAGE_SIZE) == 0)
+    return;
+  bool has_lsn = page->GetPageId() != HEADER_PAGE_ID;
+  int32_t page_flags =
+      has_lsn ? it->second.first : LogRecord::INDEX_PAGE_IMAGE;
+  LogRecord log_record(txn_id_, prev_lsn_, LogRecordType::INDEXPAGE,
+                       page->GetPageId(), page_flags, data.data(),
+                       page->GetData());
+  lsn_t lsn;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    lsn = log_manager_->AppendLogRecord(log_record);
+    auto op = active_ops_.find(txn_id_);
+    if (op == active_ops_.end())
+      active_ops_.emplace(txn_id_, std::make_pair(lsn, lsn));
+    else
+      op->second.second = lsn;
+  }
+  prev_lsn_ = lsn;
+  if (has_lsn)
+    page->SetLSN(lsn);
+  else
+    log_manager_->Flush(lsn);
+  it->second.first &= ~LogRecord::INDEX_PAGE_NEW;
+  memcpy(data.data(), page->GetData(), PAGE_SIZE);
+}
+
+void PageLogger::GetActiveOperations(
+    std::vector<std::pair<txn_id_t, lsn_t>> &active_ops) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto &entry : active_ops_)
+    active_ops.emplace_back(entry.first, entry.second.second);
+}
+
+lsn_t PageLogger::GetOldestBeginLSN() {
+  std::lock_guard<std::mutex> guard(latch_);
+  lsn_t oldest_lsn = INVALID_LSN;
+  for (auto &entry : active_ops_) {
+    if (oldest_lsn == INVALID_LSN || entry.second.first < oldest_lsn)
+      oldest_lsn = entry.second.first;
+  }
+  return oldest_lsn;
+}
+
+} // namespace scudb
@@ -18,20 +18,31 @@ namespace scudb {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
-                                          page_id_t parent_id) {}
+                                          page_id_t parent_id) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  // keep one spare slot so that a full page can hold the entry causing split
+  int capacity =
+      (PAGE_SIZE - sizeof(BPlusTreeInternalPage)) / sizeof(MappingType);
+  SetMaxSize(capacity - 1);
+}
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key;
-  return key;
+  assert(index >= 0 && index < GetSize());
+  return array[index].first;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  assert(index >= 0 && index < GetSize());
+  array[index].first = key;
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
@@ -39,7 +50,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
-  return 0;
+  for (int i = 0; i < GetSize(); i++) {
+    if (array[i].second == value)
+      return i;
+  }
+  return -1;
 }
 
 /*
@@ -47,7 +62,10 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  assert(index >= 0 && index < GetSize());
+  return array[index].second;
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -61,7 +79,17 @@ INDEX_TEMPLATE_ARGUMENTS
 ValueType
 B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key,
                                        const KeyComparator &comparator) const {
-  return INVALID_PAGE_ID;
+  assert(GetSize() > 1);
+  // find the last index i so that K(i) <= key, ignoring the first key
+  int lo = 1, hi = GetSize();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (comparator(array[mid].first, key) <= 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return array[lo - 1].second;
 }
 
 /*****************************************************************************
@@ -76,7 +104,12 @@ B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key,
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(
     const ValueType &old_value, const KeyType &new_key,
-    const ValueType &new_value) {}
+    const ValueType &new_value) {
+  array[0].second = old_value;
+  array[1].first = new_key;
+  array[1].second = new_value;
+  SetSize(2);
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -86,7 +119,14 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
     const ValueType &old_value, const KeyType &new_key,
     const ValueType &new_value) {
-  return 0;
+  int index = ValueIndex(old_value) + 1;
+  assert(index > 0);
+  memmove(static_cast<void *>(array + index + 1), array + index,
+          (GetSize() - index) * sizeof(MappingType));
+  array[index].first = new_key;
+  array[index].second = new_value;
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -98,11 +138,22 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
     BPlusTreeInternalPage *recipient,
-    BufferPoolManager *buffer_pool_manager) {}
+    BufferPoolManager *buffer_pool_manager) {
+  int half = GetSize() / 2;
+  recipient->CopyHalfFrom(array + half, GetSize() - half, buffer_pool_manager);
+  SetSize(half);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(
-    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+  assert(GetSize() == 0);
+  memcpy(static_cast<void *>(array), items, size * sizeof(MappingType));
+  SetSize(size);
+  // moved children now have a new parent
+  for (int i = 0; i < size; i++)
+    AdoptChild(array[i].second, buffer_pool_manager);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -113,7 +164,12 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  assert(index >= 0 && index < GetSize());
+  memmove(static_cast<void *>(array + index), array + index + 1,
+          (GetSize() - index - 1) * sizeof(MappingType));
+  IncreaseSize(-1);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
@@ -121,7 +177,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
-  return INVALID_PAGE_ID;
+  assert(GetSize() == 1);
+  SetSize(0);
+  return array[0].second;
 }
 /*****************************************************************************
  * MERGE
@@ -133,11 +191,28 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
     BPlusTreeInternalPage *recipient, int index_in_parent,
-    BufferPoolManager *buffer_pool_manager) {}
+    BufferPoolManager *buffer_pool_manager) {
+  // pull the separator down from parent into the (invalid) first key
+  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while merging");
+  auto *parent = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+  array[0].first = parent->KeyAt(index_in_parent);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), false);
+
+  recipient->CopyAllFrom(array, GetSize(), buffer_pool_manager);
+  SetSize(0);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyAllFrom(
-    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+  memcpy(static_cast<void *>(array + GetSize()), items,
+         size * sizeof(MappingType));
+  for (int i = 0; i < size; i++)
+    AdoptChild(items[i].second, buffer_pool_manager);
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -149,11 +224,28 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyAllFrom(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
     BPlusTreeInternalPage *recipient,
-    BufferPoolManager *buffer_pool_manager) {}
+    BufferPoolManager *buffer_pool_manager) {
+  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while moving");
+  auto *parent = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+  int index = parent->ValueIndex(GetPageId());
+  // separator moves down to recipient, our first valid key moves up
+  MappingType pair(parent->KeyAt(index), array[0].second);
+  parent->SetKeyAt(index, array[1].first);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+
+  Remove(0);
+  recipient->CopyLastFrom(pair, buffer_pool_manager);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(
-    const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+    const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+  array[GetSize()] = pair;
+  IncreaseSize(1);
+  AdoptChild(pair.second, buffer_pool_manager);
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient"
@@ -162,12 +254,45 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
     BPlusTreeInternalPage *recipient, int parent_index,
-    BufferPoolManager *buffer_pool_manager) {}
+    BufferPoolManager *buffer_pool_manager) {
+  MappingType last = array[GetSize() - 1];
+  IncreaseSize(-1);
+  recipient->CopyFirstFrom(last, parent_index, buffer_pool_manager);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(
     const MappingType &pair, int parent_index,
-    BufferPoolManager *buffer_pool_manager) {}
+    BufferPoolManager *buffer_pool_manager) {
+  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while moving");
+  auto *parent = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+  // separator moves down to our first valid key, borrowed key moves up
+  memmove(static_cast<void *>(array + 1), array,
+          GetSize() * sizeof(MappingType));
+  array[1].first = parent->KeyAt(parent_index);
+  array[0].second = pair.second;
+  parent->SetKeyAt(parent_index, pair.first);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+  IncreaseSize(1);
+  AdoptChild(pair.second, buffer_pool_manager);
+}
+
+/*
+ * Helper method to point the parent id of a child page at this page, used
+ * whenever a child pointer is moved into this page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::AdoptChild(
+    const ValueType &child, BufferPoolManager *buffer_pool_manager) {
+  auto *page = buffer_pool_manager->FetchPage(child);
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while moving");
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  node->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child, true);
+}
 
 /*****************************************************************************
  * DEBUG
@@ -0,0 +1,220 @@
+/**
+ * be_tree_page.cpp
+ */
+
+#include <algorithm>
+
+#include "page/be_tree_page.h"
+
+namespace scudb {
+
+#define BETREE_PAGE_HEADER_SIZE 32
+
+/*
+ * Init method after creating a new page. Leaf page uses all the space for
+ * entries; internal page gives about an eighth of it to pivots (at least 3
+ * children) and the rest to the message buffer, so that a flush moves many
+ * messages to one child at a time
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_PAGE_TYPE::Init(page_id_t page_id, IndexPageType page_type) {
+  int space = PAGE_SIZE - BETREE_PAGE_HEADER_SIZE;
+  page_type_ = page_type;
+  lsn_t lsn = INVALID_LSN;
+  memcpy(lsn_, &lsn, sizeof(lsn_t));
+  size_ = 0;
+  page_id_ = page_id;
+  message_count_ = 0;
+  if (page_type == IndexPageType::LEAF_PAGE) {
+    max_size_ = space / sizeof(MappingType);
+    max_message_count_ = 0;
+  } else {
+    int child_size = sizeof(std::pair<KeyType, page_id_t>);
+    max_size_ = std::max(3, space / 8 / child_size);
+    max_message_count_ =
+        (space - max_size_ * child_size) / sizeof(BETreeMessageType);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BETREE_PAGE_TYPE::IsLeafPage() const {
+  return page_type_ == IndexPageType::LEAF_PAGE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BETREE_PAGE_TYPE::GetSize() const { return size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int BETREE_PAGE_TYPE::GetMaxSize() const { return max_size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BETREE_PAGE_TYPE::GetPageId() const { return page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int BETREE_PAGE_TYPE::GetMessageCount() const { return message_count_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int BETREE_PAGE_TYPE::GetMaxMessageCount() const { return max_message_count_; }
+
+/*****************************************************************************
+ * LEAF PAGE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BETREE_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value,
+                              const KeyComparator &comparator) const {
+  int index = KeyIndex(key, comparator);
+  const MappingType *array = reinterpret_cast<const MappingType *>(data_);
+  if (index < size_ && comparator(array[index].first, key) == 0) {
+    value = array[index].second;
+    return true;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BETREE_PAGE_TYPE::KeyIndex(const KeyType &key,
+                               const KeyComparator &comparator) const {
+  const MappingType *array = reinterpret_cast<const MappingType *>(data_);
+  int low = 0, high = size_;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (comparator(array[mid].first, key) < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &BETREE_PAGE_TYPE::GetItem(int index) const {
+  assert(index >= 0 && index < size_);
+  return reinterpret_cast<const MappingType *>(data_)[index];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_PAGE_TYPE::ReadEntries(std::vector<MappingType> &entries) const {
+  const MappingType *array = reinterpret_cast<const MappingType *>(data_);
+  entries.assign(array, array + size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_PAGE_TYPE::WriteEntries(const std::vector<MappingType> &entries,
+                                    int begin, int end) {
+  assert(end - begin <= max_size_);
+  MappingType *array = reinterpret_cast<MappingType *>(data_);
+  std::copy(entries.begin() + begin, entries.begin() + end, array);
+  size_ = end - begin;
+}
+
+/*****************************************************************************
+ * INTERNAL PAGE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+int BETREE_PAGE_TYPE::ChildIndex(const KeyType &key,
+                                 const KeyComparator &comparator) const {
+  const std::pair<KeyType, page_id_t> *children = Children();
+  // last index i such that children[i].first <= key, key at 0 is invalid
+  int low = 1, high = size_;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (comparator(children[mid].first, key) <= 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BETREE_PAGE_TYPE::ChildAt(int index) const {
+  assert(index >= 0 && index < size_);
+  return Children()[index].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_PAGE_TYPE::ReadChildren(
+    std::vector<std::pair<KeyType, page_id_t>> &children) const {
+  children.assign(Children(), Children() + size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_PAGE_TYPE::WriteChildren(
+    const std::vector<std::pair<KeyType, page_id_t>> &children, int begin,
+    int end) {
+  assert(end - begin <= max_size_);
+  std::copy(children.begin() + begin, children.begin() + end, Children());
+  size_ = end - begin;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BETREE_PAGE_TYPE::AppendMessage(const BETreeMessageType &message) {
+  if (message_count_ >= max_message_count_)
+    return false;
+  Messages()[message_count_++] = message;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const BETreeMessageType *
+BETREE_PAGE_TYPE::FindMessage(const KeyType &key,
+                              const KeyComparator &comparator) const {
+  const BETreeMessageType *messages = Messages();
+  for (int i = message_count_ - 1; i >= 0; i--) {
+    if (comparator(messages[i].key, key) == 0)
+      return &messages[i];
+  }
+  return nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const BETreeMessageType &BETREE_PAGE_TYPE::MessageAt(int index) const {
+  assert(index >= 0 && index < message_count_);
+  return Messages()[index];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_PAGE_TYPE::ReadMessages(
+    std::vector<BETreeMessageType> &messages) const {
+  messages.assign(Messages(), Messages() + message_count_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BETREE_PAGE_TYPE::WriteMessages(
+    const std::vector<BETreeMessageType> &messages) {
+  assert((int)messages.size() <= max_message_count_);
+  std::copy(messages.begin(), messages.end(), Messages());
+  message_count_ = messages.size();
+}
+
+/*
+ * helper functions
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::pair<KeyType, page_id_t> *BETREE_PAGE_TYPE::Children() {
+  return reinterpret_cast<std::pair<KeyType, page_id_t> *>(data_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const std::pair<KeyType, page_id_t> *BETREE_PAGE_TYPE::Children() const {
+  return reinterpret_cast<const std::pair<KeyType, page_id_t> *>(data_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BETreeMessageType *BETREE_PAGE_TYPE::Messages() {
+  return reinterpret_cast<BETreeMessageType *>(
+      data_ + max_size_ * sizeof(std::pair<KeyType, page_id_t>));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const BETreeMessageType *BETREE_PAGE_TYPE::Messages() const {
+  return reinterpret_cast<const BETreeMessageType *>(
+      data_ + max_size_ * sizeof(std::pair<KeyType, page_id_t>));
+}
+
+template class BETreePage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BETreePage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BETreePage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BETreePage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BETreePage<GenericKey<64>, RID, GenericComparator<64>>;
+} // namespace scudb
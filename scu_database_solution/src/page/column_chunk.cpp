@@ -0,0 +1,451 @@
+/**
+ * column_chunk.cpp
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "page/column_chunk.h"
+
+namespace scudb {
+
+// codes wider than this may not fit 8 bytes once shifted
+#define MAX_CODE_WIDTH 56
+
+static bool IsInteger(TypeId type) {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT ||
+         type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+static int64_t ToInteger(const Value &value) {
+  switch (value.GetTypeId()) {
+  case TypeId::TINYINT:
+    return value.GetAs<int8_t>();
+  case TypeId::SMALLINT:
+    return value.GetAs<int16_t>();
+  case TypeId::INTEGER:
+    return value.GetAs<int32_t>();
+  default:
+    return value.GetAs<int64_t>();
+  }
+}
+
+static Value FromInteger(TypeId type, int64_t integer) {
+  switch (type) {
+  case TypeId::TINYINT:
+    return Value(type, (int8_t)integer);
+  case TypeId::SMALLINT:
+    return Value(type, (int16_t)integer);
+  case TypeId::INTEGER:
+    return Value(type, (int32_t)integer);
+  default:
+    return Value(type, integer);
+  }
+}
+
+// bits of the largest code
+static int GetCodeWidth(uint64_t max_code) {
+  return max_code == 0 ? 0 : 64 - __builtin_clzll(max_code);
+}
+
+static int32_t GetPackedSize(size_t count, int code_width) {
+  return (count * code_width + 7) / 8;
+}
+
+// codes must be zeroed before packing
+static void Pack(char *codes, int code_width, int index, uint64_t code) {
+  uint64_t bit = (uint64_t)index * code_width;
+  unsigned char *bytes = reinterpret_cast<unsigned char *>(codes) + bit / 8;
+  int shift = bit % 8;
+  code <<= shift;
+  for (int i = 0; i < (shift + code_width + 7) / 8; i++)
+    bytes[i] |= (unsigned char)(code >> (8 * i));
+}
+
+static inline uint64_t Unpack(const char *codes, int code_width, int index) {
+  if (code_width == 0)
+    return 0;
+  uint64_t bit = (uint64_t)index * code_width;
+  auto bytes = reinterpret_cast<const unsigned char *>(codes) + bit / 8;
+  int shift = bit % 8;
+  uint64_t code = 0;
+  for (int i = 0; i < (shift + code_width + 7) / 8; i++)
+    code |= (uint64_t)bytes[i] << (8 * i);
+  return (code >> shift) & ((1ULL << code_width) - 1);
+}
+
+static inline uint16_t ReadUInt16(const char *data) {
+  uint16_t value;
+  memcpy(&value, data, 2);
+  return value;
+}
+
+static inline void WriteUInt16(char *data, int32_t value) {
+  uint16_t word = value;
+  memcpy(data, &word, 2);
+}
+
+bool ColumnChunk::Compare(const Value &left, CompareOp op,
+                          const Value &right) {
+  switch (op) {
+  case CompareOp::EQUAL:
+    return left.CompareEquals(right) == CMP_TRUE;
+  case CompareOp::NOT_EQUAL:
+    return left.CompareNotEquals(right) == CMP_TRUE;
+  case CompareOp::LESS_THAN:
+    return left.CompareLessThan(right) == CMP_TRUE;
+  case CompareOp::LESS_THAN_EQUAL:
+    return left.CompareLessThanEquals(right) == CMP_TRUE;
+  case CompareOp::GREATER_THAN:
+    return left.CompareGreaterThan(right) == CMP_TRUE;
+  default:
+    return left.CompareGreaterThanEquals(right) == CMP_TRUE;
+  }
+}
+
+/*
+ * Size every encoding that applies, and write the smallest one unless data
+ * is null. Ties go to the encoding that is cheaper to read.
+ */
+static int32_t EncodeValues(TypeId type, const std::vector<Value> &values,
+                            char *data) {
+  int32_t count = values.size();
+  bool is_varchar = type == TypeId::VARCHAR;
+  int32_t width = is_varchar ? 0 : Type::GetTypeSize(type);
+
+  // values as in a tuple, and the dictionary entry of each one
+  std::vector<std::string> bytes(count);
+  std::unordered_map<std::string, uint32_t> entry_codes;
+  std::vector<int32_t> entries; // index of the first value of every entry
+  std::vector<uint32_t> codes(count);
+  int32_t value_size = 0, entry_size = 0, run_count = 0;
+  bool is_for = IsInteger(type) && count > 0;
+  int64_t min = LLONG_MAX, max = LLONG_MIN;
+  for (int32_t i = 0; i < count; i++) {
+    const Value &value = values[i];
+    uint32_t length = is_varchar ? value.GetLength() : 0;
+    if (length == PELOTON_VALUE_NULL)
+      length = 0;
+    bytes[i].resize(is_varchar ? 4 + length : width);
+    value.SerializeTo(&bytes[i][0]);
+    value_size += bytes[i].size();
+    auto result = entry_codes.emplace(bytes[i], entries.size());
+    if (result.second) {
+      entries.push_back(i);
+      entry_size += bytes[i].size();
+    }
+    codes[i] = result.first->second;
+    if (i == 0 || bytes[i] != bytes[i - 1])
+      run_count++;
+    if (is_for) {
+      // a null is a sentinel integer, keep it out of the frame
+      is_for = !value.IsNull();
+      min = std::min(min, ToInteger(value));
+      max = std::max(max, ToInteger(value));
+    }
+  }
+
+  int32_t entry_count = entries.size();
+  int dictionary_width = GetCodeWidth(std::max(entry_count - 1, 0));
+  int for_width = is_for ? GetCodeWidth((uint64_t)max - (uint64_t)min) : 0;
+  is_for = is_for && for_width <= MAX_CODE_WIDTH;
+
+  ColumnChunk::Encoding encoding = ColumnChunk::PLAIN;
+  int32_t size = 1 + (is_varchar ? 2 * count : 0) + value_size;
+  if (entry_count <= UINT16_MAX) {
+    int32_t dictionary_size = 4 + (is_varchar ? 2 * entry_count : 0) +
+                              entry_size +
+                              GetPackedSize(count, dictionary_width);
+    if (dictionary_size <= size) {
+      encoding = ColumnChunk::DICTIONARY;
+      size = dictionary_size;
+    }
+  }
+  if (!is_varchar && count <= UINT16_MAX) {
+    int32_t rle_size = 3 + run_count * (2 + width);
+    if (rle_size <= size) {
+      encoding = ColumnChunk::RLE;
+      size = rle_size;
+    }
+  }
+  if (is_for) {
+    int32_t for_size = 10 + GetPackedSize(count, for_width);
+    if (for_size <= size) {
+      encoding = ColumnChunk::FOR;
+      size = for_size;
+    }
+  }
+  if (data == nullptr)
+    return size;
+
+  data[0] = encoding;
+  switch (encoding) {
+  case ColumnChunk::PLAIN: {
+    int32_t offset = 1 + (is_varchar ? 2 * count : 0);
+    for (int32_t i = 0; i < count; i++) {
+      if (is_varchar)
+        WriteUInt16(data + 1 + 2 * i, offset);
+      memcpy(data + offset, bytes[i].data(), bytes[i].size());
+      offset += bytes[i].size();
+    }
+    break;
+  }
+  case ColumnChunk::DICTIONARY: {
+    WriteUInt16(data + 1, entry_count);
+    data[3] = dictionary_width;
+    int32_t offset = 4 + (is_varchar ? 2 * entry_count : 0);
+    for (int32_t i = 0; i < entry_count; i++) {
+      const std::string &entry = bytes[entries[i]];
+      if (is_varchar)
+        WriteUInt16(data + 4 + 2 * i, offset);
+      memcpy(data + offset, entry.data(), entry.size());
+      offset += entry.size();
+    }
+    memset(data + offset, 0, GetPackedSize(count, dictionary_width));
+    for (int32_t i = 0; i < count; i++)
+      Pack(data + offset, dictionary_width, i, codes[i]);
+    break;
+  }
+  case ColumnChunk::RLE: {
+    WriteUInt16(data + 1, run_count);
+    int32_t run = 0;
+    for (int32_t i = 0; i < count; i++) {
+      if (i > 0 && bytes[i] == bytes[i - 1])
+        continue;
+      if (run > 0)
+        WriteUInt16(data + 3 + 2 * (run - 1), i);
+      memcpy(data + 3 + 2 * run_count + width * run, bytes[i].data(), width);
+      run++;
+    }
+    WriteUInt16(data + 3 + 2 * (run_count - 1), count);
+    break;
+  }
+  case ColumnChunk::FOR: {
+    data[1] = for_width;
+    memcpy(data + 2, &min, 8);
+    memset(data + 10, 0, GetPackedSize(count, for_width));
+    for (int32_t i = 0; i < count; i++)
+      Pack(data + 10, for_width, i,
+           (uint64_t)ToInteger(values[i]) - (uint64_t)min);
+    break;
+  }
+  }
+  return size;
+}
+
+int32_t ColumnChunk::GetEncodedSize(TypeId type,
+                                    const std::vector<Value> &values) {
+  return EncodeValues(type, values, nullptr);
+}
+
+int32_t ColumnChunk::Encode(TypeId type, const std::vector<Value> &values,
+                            char *data) {
+  return EncodeValues(type, values, data);
+}
+
+ColumnChunk::ColumnChunk(TypeId type, const char *data)
+    : type_(type), data_(data), codes_(nullptr), code_width_(0) {
+  if (GetEncoding() == DICTIONARY) {
+    int32_t entry_count = ReadUInt16(data_ + 1);
+    code_width_ = data_[3];
+    if (type_ != TypeId::VARCHAR) {
+      codes_ = data_ + 4 + entry_count * Type::GetTypeSize(type_);
+    } else if (entry_count == 0) {
+      codes_ = data_ + 4;
+    } else {
+      // behind the last entry
+      const char *entry =
+          data_ + ReadUInt16(data_ + 4 + 2 * (entry_count - 1));
+      uint32_t length;
+      memcpy(&length, entry, 4);
+      codes_ = entry + 4 + (length == PELOTON_VALUE_NULL ? 0 : length);
+    }
+  } else if (GetEncoding() == FOR) {
+    code_width_ = data_[1];
+    codes_ = data_ + 10;
+  }
+}
+
+Value ColumnChunk::GetValue(int index) const {
+  if (GetEncoding() == FOR)
+    return FromInteger(type_, GetInteger(index));
+  const char *entry = GetEntry(index);
+  if (type_ != TypeId::VARCHAR)
+    return Value::DeserializeFrom(entry, type_);
+  uint32_t length;
+  memcpy(&length, entry, 4);
+  if (length == PELOTON_VALUE_NULL)
+    return Value(type_, nullptr, length, false);
+  return Value(type_, entry + 4, length, false);
+}
+
+int32_t ColumnChunk::CopyValue(int index, char *data) const {
+  if (GetEncoding() == FOR) {
+    // little endian, the low bytes are the value
+    int64_t integer = GetInteger(index);
+    int32_t width = Type::GetTypeSize(type_);
+    memcpy(data, &integer, width);
+    return width;
+  }
+  int32_t size = type_ == TypeId::VARCHAR ? GetVarcharSize(index)
+                                          : Type::GetTypeSize(type_);
+  memcpy(data, GetEntry(index), size);
+  return size;
+}
+
+int32_t ColumnChunk::GetVarcharSize(int index) const {
+  uint32_t length;
+  memcpy(&length, GetEntry(index), 4);
+  return 4 + (length == PELOTON_VALUE_NULL ? 0 : length);
+}
+
+void ColumnChunk::Filter(CompareOp op, const Value &constant, int count,
+                         std::vector<char> &matches) const {
+  assert((int)matches.size() >= count);
+  if (constant.IsNull()) {
+    std::fill(matches.begin(), matches.begin() + count, 0);
+    return;
+  }
+  switch (GetEncoding()) {
+  case DICTIONARY: {
+    int32_t entry_count = ReadUInt16(data_ + 1);
+    const char *entries = data_ + 4;
+    std::vector<char> entry_matches(entry_count);
+    for (int32_t i = 0; i < entry_count; i++) {
+      if (type_ != TypeId::VARCHAR) {
+        Value entry = Value::DeserializeFrom(
+            entries + i * Type::GetTypeSize(type_), type_);
+        entry_matches[i] = Compare(entry, op, constant);
+        continue;
+      }
+      const char *value = data_ + ReadUInt16(entries + 2 * i);
+      uint32_t length;
+      memcpy(&length, value, 4);
+      if (length != PELOTON_VALUE_NULL)
+        entry_matches[i] =
+            Compare(Value(type_, value + 4, length, false), op, constant);
+    }
+    for (int i = 0; i < count; i++) {
+      if (matches[i] && !entry_matches[Unpack(codes_, code_width_, i)])
+        matches[i] = 0;
+    }
+    break;
+  }
+  case RLE: {
+    int32_t run_count = ReadUInt16(data_ + 1);
+    int32_t width = Type::GetTypeSize(type_);
+    int run_begin = 0;
+    for (int32_t i = 0; i < run_count && run_begin < count; i++) {
+      int run_end = std::min((int)ReadUInt16(data_ + 3 + 2 * i), count);
+      Value value = Value::DeserializeFrom(
+          data_ + 3 + 2 * run_count + width * i, type_);
+      if (!Compare(value, op, constant))
+        std::fill(matches.begin() + run_begin, matches.begin() + run_end, 0);
+      run_begin = run_end;
+    }
+    break;
+  }
+  case FOR: {
+    if (!IsInteger(constant.GetTypeId())) {
+      for (int i = 0; i < count; i++) {
+        if (matches[i] && !Compare(GetValue(i), op, constant))
+          matches[i] = 0;
+      }
+      break;
+    }
+    // the predicate as a range of values, compared on base + code
+    int64_t integer = ToInteger(constant);
+    int64_t low = LLONG_MIN, high = LLONG_MAX;
+    bool is_negated = false;
+    switch (op) {
+    case CompareOp::NOT_EQUAL:
+      is_negated = true;
+      low = high = integer;
+      break;
+    case CompareOp::EQUAL:
+      low = high = integer;
+      break;
+    case CompareOp::LESS_THAN:
+      if (integer == LLONG_MIN)
+        low = 0, high = -1; // nothing
+      else
+        high = integer - 1;
+      break;
+    case CompareOp::LESS_THAN_EQUAL:
+      high = integer;
+      break;
+    case CompareOp::GREATER_THAN:
+      if (integer == LLONG_MAX)
+        low = 0, high = -1;
+      else
+        low = integer + 1;
+      break;
+    default:
+      low = integer;
+      break;
+    }
+    int64_t base;
+    memcpy(&base, data_ + 2, 8);
+    for (int i = 0; i < count; i++) {
+      if (!matches[i])
+        continue;
+      int64_t value = base + (int64_t)Unpack(codes_, code_width_, i);
+      if ((value >= low && value <= high) == is_negated)
+        matches[i] = 0;
+    }
+    break;
+  }
+  default:
+    for (int i = 0; i < count; i++) {
+      if (matches[i] && !Compare(GetValue(i), op, constant))
+        matches[i] = 0;
+    }
+    break;
+  }
+}
+
+/**
+ * helper functions
+ */
+const char *ColumnChunk::GetEntry(int index) const {
+  switch (GetEncoding()) {
+  case PLAIN:
+    if (type_ == TypeId::VARCHAR)
+      return data_ + ReadUInt16(data_ + 1 + 2 * index);
+    return data_ + 1 + index * Type::GetTypeSize(type_);
+  case DICTIONARY: {
+    uint64_t code = Unpack(codes_, code_width_, index);
+    if (type_ == TypeId::VARCHAR)
+      return data_ + ReadUInt16(data_ + 4 + 2 * code);
+    return data_ + 4 + code * Type::GetTypeSize(type_);
+  }
+  case RLE: {
+    // first run that ends behind index
+    int32_t run_count = ReadUInt16(data_ + 1);
+    int32_t low = 0, high = run_count - 1;
+    while (low < high) {
+      int32_t mid = (low + high) / 2;
+      if (ReadUInt16(data_ + 3 + 2 * mid) > index)
+        high = mid;
+      else
+        low = mid + 1;
+    }
+    return data_ + 3 + 2 * run_count + low * Type::GetTypeSize(type_);
+  }
+  default:
+    assert(false);
+    return nullptr;
+  }
+}
+
+int64_t ColumnChunk::GetInteger(int index) const {
+  int64_t base;
+  memcpy(&base, data_ + 2, 8);
+  return base + (int64_t)Unpack(codes_, code_width_, index);
+}
+
+} // namespace scudb
@@ -0,0 +1,78 @@
+/**
+ * free_space_map_page.cpp
+ */
+
+#include <cassert>
+
+#include "page/free_space_map_page.h"
+
+namespace scudb {
+
+#define FSM_HEADER_SIZE 20
+
+/**
+ * Header related
+ */
+void FreeSpaceMapPage::Init(page_id_t page_id) {
+  memcpy(GetData(), &page_id, 4); // set page_id
+  SetNextPageId(INVALID_PAGE_ID);
+  SetLastHeapPageId(INVALID_PAGE_ID);
+  memset(GetData() + FSM_HEADER_SIZE, 0, PAGE_SIZE - FSM_HEADER_SIZE);
+}
+
+page_id_t FreeSpaceMapPage::GetPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData());
+}
+
+page_id_t FreeSpaceMapPage::GetNextPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 12);
+}
+
+void FreeSpaceMapPage::SetNextPageId(page_id_t next_page_id) {
+  memcpy(GetData() + 12, &next_page_id, 4);
+}
+
+page_id_t FreeSpaceMapPage::GetLastHeapPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 16);
+}
+
+void FreeSpaceMapPage::SetLastHeapPageId(page_id_t last_heap_page_id) {
+  memcpy(GetData() + 16, &last_heap_page_id, 4);
+}
+
+/**
+ * Entry related, two entries per byte, even index in the low nibble
+ */
+int FreeSpaceMapPage::GetFillClass(int index) {
+  assert(index >= 0 && index < FSM_ENTRY_COUNT);
+  uint8_t byte = GetData()[FSM_HEADER_SIZE + index / 2];
+  return (index % 2 == 0) ? (byte & 0xF) : (byte >> 4);
+}
+
+void FreeSpaceMapPage::SetFillClass(int index, int fill_class) {
+  assert(index >= 0 && index < FSM_ENTRY_COUNT);
+  assert(fill_class >= 0 && fill_class < 16);
+  uint8_t &byte =
+      reinterpret_cast<uint8_t &>(GetData()[FSM_HEADER_SIZE + index / 2]);
+  if (index % 2 == 0)
+    byte = (byte & 0xF0) | fill_class;
+  else
+    byte = (byte & 0x0F) | (fill_class << 4);
+}
+
+int FreeSpaceMapPage::FindEntry(int fill_class, int begin) {
+  const uint8_t *bytes =
+      reinterpret_cast<const uint8_t *>(GetData() + FSM_HEADER_SIZE);
+  for (int i = begin; i < FSM_ENTRY_COUNT; i++) {
+    // skip a whole byte of full pages at once
+    if (i % 2 == 0 && bytes[i / 2] == 0) {
+      i++;
+      continue;
+    }
+    if (GetFillClass(i) >= fill_class)
+      return i;
+  }
+  return -1;
+}
+
+} // namespace scudb
@@ -0,0 +1,90 @@
+/**
+ * hash_bucket_page.cpp
+ */
+
+#include <algorithm>
+
+#include "page/hash_bucket_page.h"
+
+namespace scudb {
+
+#define HASH_BUCKET_PAGE_HEADER_SIZE 24
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_BUCKET_PAGE_TYPE::Init(page_id_t page_id, uint32_t local_depth) {
+  page_id_ = page_id;
+  lsn_t lsn = INVALID_LSN;
+  memcpy(lsn_, &lsn, sizeof(lsn_t));
+  local_depth_ = local_depth;
+  size_ = 0;
+  max_size_ = (PAGE_SIZE - HASH_BUCKET_PAGE_HEADER_SIZE) / sizeof(MappingType);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t HASH_BUCKET_PAGE_TYPE::GetPageId() const { return page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t HASH_BUCKET_PAGE_TYPE::GetLocalDepth() const { return local_depth_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_BUCKET_PAGE_TYPE::SetLocalDepth(uint32_t local_depth) {
+  local_depth_ = local_depth;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_BUCKET_PAGE_TYPE::GetSize() const { return size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_BUCKET_PAGE_TYPE::IsFull() const { return size_ >= max_size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_BUCKET_PAGE_TYPE::KeyIndex(const KeyType &key,
+                                    const KeyComparator &comparator) const {
+  for (int i = 0; i < size_; i++) {
+    if (comparator(array_[i].first, key) == 0)
+      return i;
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &HASH_BUCKET_PAGE_TYPE::GetItem(int index) const {
+  assert(index >= 0 && index < size_);
+  return array_[index];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_BUCKET_PAGE_TYPE::Append(const KeyType &key,
+                                   const ValueType &value) {
+  if (IsFull())
+    return false;
+  array_[size_++] = MappingType(key, value);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_BUCKET_PAGE_TYPE::RemoveAt(int index) {
+  assert(index >= 0 && index < size_);
+  array_[index] = array_[--size_];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_BUCKET_PAGE_TYPE::ReadEntries(
+    std::vector<MappingType> &entries) const {
+  entries.assign(array_, array_ + size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_BUCKET_PAGE_TYPE::WriteEntries(
+    const std::vector<MappingType> &entries) {
+  assert((int)entries.size() <= max_size_);
+  std::copy(entries.begin(), entries.end(), array_);
+  size_ = entries.size();
+}
+
+template class HashBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+} // namespace scudb
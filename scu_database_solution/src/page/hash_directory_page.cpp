@@ -0,0 +1,84 @@
+/**
+ * hash_directory_page.cpp
+ */
+
+#include <cassert>
+
+#include "page/hash_directory_page.h"
+
+namespace scudb {
+
+#define DIRECTORY_HEADER_SIZE 20
+#define DIRECTORY_DEPTH_OFFSET                                                 \
+  (DIRECTORY_HEADER_SIZE + DIRECTORY_SLOT_COUNT * sizeof(page_id_t))
+
+/**
+ * Header related
+ */
+void HashDirectoryPage::Init(page_id_t page_id) {
+  memcpy(GetData(), &page_id, 4); // set page_id
+  SetNextPageId(INVALID_PAGE_ID);
+  SetGlobalDepth(0);
+  for (int i = 0; i < DIRECTORY_SLOT_COUNT; i++) {
+    SetBucketPageId(i, INVALID_PAGE_ID);
+    SetLocalDepth(i, 0);
+  }
+}
+
+page_id_t HashDirectoryPage::GetPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData());
+}
+
+page_id_t HashDirectoryPage::GetNextPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 12);
+}
+
+void HashDirectoryPage::SetNextPageId(page_id_t next_page_id) {
+  memcpy(GetData() + 12, &next_page_id, 4);
+}
+
+uint32_t HashDirectoryPage::GetGlobalDepth() {
+  return *reinterpret_cast<uint32_t *>(GetData() + 16);
+}
+
+void HashDirectoryPage::SetGlobalDepth(uint32_t global_depth) {
+  memcpy(GetData() + 16, &global_depth, 4);
+}
+
+/**
+ * Slot related
+ */
+page_id_t HashDirectoryPage::GetBucketPageId(int index) {
+  assert(index >= 0 && index < DIRECTORY_SLOT_COUNT);
+  return *reinterpret_cast<page_id_t *>(GetData() + DIRECTORY_HEADER_SIZE +
+                                        index * sizeof(page_id_t));
+}
+
+void HashDirectoryPage::SetBucketPageId(int index, page_id_t bucket_page_id) {
+  assert(index >= 0 && index < DIRECTORY_SLOT_COUNT);
+  memcpy(GetData() + DIRECTORY_HEADER_SIZE + index * sizeof(page_id_t),
+         &bucket_page_id, sizeof(page_id_t));
+}
+
+uint32_t HashDirectoryPage::GetLocalDepth(int index) {
+  assert(index >= 0 && index < DIRECTORY_SLOT_COUNT);
+  return *reinterpret_cast<uint8_t *>(GetData() + DIRECTORY_DEPTH_OFFSET +
+                                      index);
+}
+
+void HashDirectoryPage::SetLocalDepth(int index, uint32_t local_depth) {
+  assert(index >= 0 && index < DIRECTORY_SLOT_COUNT);
+  GetData()[DIRECTORY_DEPTH_OFFSET + index] = (uint8_t)local_depth;
+}
+
+void HashDirectoryPage::CopySlots(HashDirectoryPage *other, int begin,
+                                  int end, int to) {
+  assert(begin >= 0 && end <= DIRECTORY_SLOT_COUNT);
+  assert(to >= 0 && to + end - begin <= DIRECTORY_SLOT_COUNT);
+  for (int i = begin; i < end; i++) {
+    SetBucketPageId(to + i - begin, other->GetBucketPageId(i));
+    SetLocalDepth(to + i - begin, other->GetLocalDepth(i));
+  }
+}
+
+} // namespace scudb
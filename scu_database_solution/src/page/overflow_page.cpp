@@ -0,0 +1,52 @@
+/**
+ * overflow_page.cpp
+ */
+
+#include <cassert>
+
+#include "page/overflow_page.h"
+
+namespace scudb {
+
+#define OVERFLOW_HEADER_SIZE 20
+
+/**
+ * Header related
+ */
+void OverflowPage::Init(page_id_t page_id) {
+  memcpy(GetData(), &page_id, 4); // set page_id
+  SetNextPageId(INVALID_PAGE_ID);
+  int32_t data_size = 0;
+  memcpy(GetData() + 16, &data_size, 4);
+}
+
+page_id_t OverflowPage::GetPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData());
+}
+
+page_id_t OverflowPage::GetNextPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 12);
+}
+
+void OverflowPage::SetNextPageId(page_id_t next_page_id) {
+  memcpy(GetData() + 12, &next_page_id, 4);
+}
+
+int32_t OverflowPage::GetDataSize() {
+  return *reinterpret_cast<int32_t *>(GetData() + 16);
+}
+
+/**
+ * Data related
+ */
+void OverflowPage::WriteData(const char *data, int32_t size) {
+  assert(size >= 0 && size <= OVERFLOW_PAGE_CAPACITY);
+  memcpy(GetData() + OVERFLOW_HEADER_SIZE, data, size);
+  memcpy(GetData() + 16, &size, 4);
+}
+
+void OverflowPage::ReadData(char *data) {
+  memcpy(data, GetData() + OVERFLOW_HEADER_SIZE, GetDataSize());
+}
+
+} // namespace scudb
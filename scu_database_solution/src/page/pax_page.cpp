@@ -0,0 +1,745 @@
+/**
+ * pax_page.cpp
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include "page/pax_page.h"
+
+namespace scudb {
+
+#define PAX_HEADER_SIZE 47
+#define PAX_ALIGN(offset, width) (((offset) + (width)-1) / (width) * (width))
+
+static int32_t GetWidth(TypeId type) {
+  return type == TypeId::VARCHAR ? 4 : Type::GetTypeSize(type);
+}
+
+/*
+ * Lay out minipages of slot_count slots behind the header and slot states
+ * @return: end of the last minipage
+ */
+static int32_t LayoutMinipages(const std::vector<TypeId> &types,
+                               int32_t slot_count, char *data = nullptr) {
+  int32_t column_count = types.size();
+  int32_t offset = PAX_HEADER_SIZE + 3 * column_count + slot_count;
+  for (int i = 0; i < column_count; i++) {
+    int32_t width = GetWidth(types[i]);
+    offset = PAX_ALIGN(offset, width);
+    if (data != nullptr) {
+      uint16_t minipage_offset = offset;
+      data[PAX_HEADER_SIZE + 3 * i] = types[i];
+      memcpy(data + PAX_HEADER_SIZE + 3 * i + 1, &minipage_offset, 2);
+    }
+    offset += slot_count * width;
+  }
+  return offset;
+}
+
+/*
+ * Room for the fixed length part of every slot and the varchar bytes planned
+ * for them
+ */
+static int32_t GetPlainSlotCount(const std::vector<TypeId> &types) {
+  int32_t inline_size = 0, varchar_size = 0;
+  for (auto type : types) {
+    inline_size += GetWidth(type);
+    if (type == TypeId::VARCHAR)
+      varchar_size += PAX_VARCHAR_RESERVE;
+  }
+  int32_t slot_size = 1 + inline_size + varchar_size;
+  int32_t space = PAGE_SIZE - PAX_HEADER_SIZE - 3 * (int32_t)types.size();
+  int32_t slot_count = std::max(0, space / slot_size);
+  // minipages may need padding
+  while (slot_count > 0 &&
+         LayoutMinipages(types, slot_count) + slot_count * varchar_size >
+             PAGE_SIZE)
+    slot_count--;
+  return slot_count;
+}
+
+static std::vector<TypeId> GetSchemaTypes(Schema *schema) {
+  std::vector<TypeId> types;
+  for (int i = 0; i < schema->GetColumnCount(); i++)
+    types.push_back(schema->GetType(i));
+  return types;
+}
+
+/**
+ * Header related
+ */
+void PaxPage::Init(page_id_t page_id, page_id_t prev_page_id,
+                   Schema *schema) {
+  Init(page_id, prev_page_id, GetSchemaTypes(schema));
+}
+
+// an encoded page has its own slot count, lay out afresh
+void PaxPage::Init(page_id_t page_id, page_id_t prev_page_id,
+                   PaxPage *layout_page) {
+  Init(page_id, prev_page_id, layout_page->GetColumnTypes());
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_page_id,
+                   const std::vector<TypeId> &types) {
+  int32_t slot_count = GetPlainSlotCount(types);
+  assert(slot_count > 0);
+  memcpy(GetData(), &page_id, 4);
+  memcpy(GetData() + 12, &prev_page_id, 4);
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  memcpy(GetData() + 16, &next_page_id, 4);
+  memcpy(GetData() + 24, &slot_count, 4);
+  memcpy(GetData() + 28, &next_page_id, 4); // no free space map page
+  int32_t magic = PAX_PAGE_MAGIC;
+  memcpy(GetData() + 32, &magic, 4);
+  SetFragmentedSize(0);
+  uint16_t column_count = types.size();
+  uint16_t inline_size = 0;
+  uint16_t varchar_count = 0;
+  for (auto type : types) {
+    inline_size += GetWidth(type);
+    varchar_count += type == TypeId::VARCHAR;
+  }
+  memcpy(GetData() + 40, &column_count, 2);
+  memcpy(GetData() + 42, &inline_size, 2);
+  memcpy(GetData() + 44, &varchar_count, 2);
+  GetData()[46] = false; // not encoded
+  LayoutMinipages(types, slot_count, GetData());
+  memset(GetData() + PAX_HEADER_SIZE + 3 * column_count, EMPTY, slot_count);
+  SetFreeSpacePointer(PAGE_SIZE);
+}
+
+page_id_t PaxPage::GetPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData());
+}
+
+int32_t PaxPage::GetSlotCount() {
+  return *reinterpret_cast<int32_t *>(GetData() + 24);
+}
+
+int32_t PaxPage::GetSlotCount(Schema *schema) {
+  return GetPlainSlotCount(GetSchemaTypes(schema));
+}
+
+/*
+ * A tuple of inline size + varchar bytes fits if it gets a slot and its
+ * varchar bytes fit, so tell the free space map the varchar space plus the
+ * inline size and a slot (8 bytes, as the heap asks for tuple size + 8)
+ */
+int32_t PaxPage::GetFreeSpaceSize() {
+  if (IsEncoded())
+    return 0;
+  int32_t slot_count = GetSlotCount();
+  for (int i = 0; i < slot_count; i++) {
+    if (GetSlotState(i) == EMPTY)
+      return GetContiguousFreeSpaceSize() + GetFragmentedSize() +
+             GetInlineSize() + 8;
+  }
+  return 0;
+}
+
+/**
+ * Encoding related
+ */
+bool PaxPage::IsEncoded() { return GetData()[46]; }
+
+int32_t PaxPage::GetEncodedSize(const std::vector<Tuple> &tuples) {
+  int32_t size = PAX_HEADER_SIZE + 3 * GetColumnCount() + tuples.size();
+  std::vector<Value> values;
+  for (int i = 0; i < GetColumnCount(); i++) {
+    GetColumnValues(tuples, i, values);
+    size += ColumnChunk::GetEncodedSize(GetColumnType(i), values);
+  }
+  return size;
+}
+
+/*
+ * The page is built aside, the tuples may have been read from it
+ */
+bool PaxPage::Encode(const std::vector<Tuple> &tuples) {
+  int32_t slot_count = GetSlotCount();
+  for (int i = 0; i < slot_count; i++) {
+    if (GetSlotState(i) == DELETED)
+      return false;
+  }
+  if (GetEncodedSize(tuples) > PAGE_SIZE)
+    return false;
+
+  char data[PAGE_SIZE];
+  int32_t column_count = GetColumnCount();
+  int32_t header_size = PAX_HEADER_SIZE + 3 * column_count;
+  memcpy(data, GetData(), header_size);
+  int32_t free_space_pointer = PAGE_SIZE, fragmented_size = 0;
+  memcpy(data + 20, &free_space_pointer, 4);
+  slot_count = tuples.size();
+  memcpy(data + 24, &slot_count, 4);
+  memcpy(data + 36, &fragmented_size, 4);
+  data[46] = true;
+  memset(data + header_size, TUPLE, slot_count);
+  int32_t offset = header_size + slot_count;
+  std::vector<Value> values;
+  for (int i = 0; i < column_count; i++) {
+    uint16_t chunk_offset = offset;
+    memcpy(data + PAX_HEADER_SIZE + 3 * i + 1, &chunk_offset, 2);
+    GetColumnValues(tuples, i, values);
+    offset += ColumnChunk::Encode(GetColumnType(i), values, data + offset);
+  }
+  assert(offset <= PAGE_SIZE);
+  memcpy(GetData(), data, offset);
+  return true;
+}
+
+/**
+ * Tuple related
+ */
+bool PaxPage::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
+                          LockManager *lock_manager,
+                          LogManager *log_manager) {
+  assert(tuple.size_ > 0);
+  if (IsEncoded() || tuple.overflow_page_id_ != INVALID_PAGE_ID)
+    return false; // row format only
+  int32_t varchar_size = tuple.size_ - GetInlineSize();
+  if (GetContiguousFreeSpaceSize() + GetFragmentedSize() < varchar_size)
+    return false; // not enough space
+  int slot_num = 0;
+  int32_t slot_count = GetSlotCount();
+  while (slot_num < slot_count && GetSlotState(slot_num) != EMPTY)
+    slot_num++;
+  if (slot_num == slot_count)
+    return false; // no slot left
+  if (GetContiguousFreeSpaceSize() < varchar_size)
+    Compact(); // holes left by deleted tuples are big enough
+
+  rid.Set(GetPageId(), slot_num);
+  // acquire the exclusive lock first, an empty slot may still be locked by
+  // the transaction that deleted its tuple. The insert is given up then
+  if (ENABLE_LOGGING &&
+      txn->GetExclusiveLockSet()->find(rid) ==
+          txn->GetExclusiveLockSet()->end() &&
+      !lock_manager->TryLockExclusive(txn, rid)) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  WriteTuple(slot_num, tuple);
+  SetSlotState(slot_num, TUPLE);
+  if (ENABLE_LOGGING && log_manager != nullptr) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::INSERT, rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
+  }
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RID &rid, Transaction *txn,
+                         LockManager *lock_manager, LogManager *log_manager) {
+  int slot_num = rid.GetSlotNum();
+  if (slot_num >= GetSlotCount() || GetSlotState(slot_num) != TUPLE) {
+    if (ENABLE_LOGGING) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  if (ENABLE_LOGGING) {
+    // acquire exclusive lock, upgrade a shared one. Never waited for under
+    // the page latch
+    if (txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end()) {
+      if (!lock_manager->TryLockUpgrade(txn, rid))
+        return false;
+    } else if (txn->GetExclusiveLockSet()->find(rid) ==
+                   txn->GetExclusiveLockSet()->end() &&
+               !lock_manager->TryLockExclusive(txn, rid)) {
+      return false;
+    }
+  }
+  if (ENABLE_LOGGING && log_manager != nullptr)
+    LogDelete(LogRecordType::MARKDELETE, rid, txn, log_manager);
+  SetSlotState(slot_num, DELETED);
+  return true;
+}
+
+/*
+ * Fixed size columns are overwritten in place, varchar values of the old
+ * tuple become holes and the new ones are appended
+ */
+bool PaxPage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
+                          const RID &rid, Transaction *txn,
+                          LockManager *lock_manager,
+                          LogManager *log_manager) {
+  int slot_num = rid.GetSlotNum();
+  if (slot_num >= GetSlotCount() || GetSlotState(slot_num) != TUPLE) {
+    if (ENABLE_LOGGING) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  if (IsEncoded() || new_tuple.overflow_page_id_ != INVALID_PAGE_ID)
+    return false; // should delete/insert
+  int32_t tuple_size = GetTupleSize(slot_num);
+  if (GetContiguousFreeSpaceSize() + GetFragmentedSize() <
+      new_tuple.size_ - tuple_size)
+    return false; // should delete/insert because not enough space
+
+  // copy out old value
+  if (old_tuple.allocated_)
+    delete[] old_tuple.data_;
+  old_tuple.size_ = tuple_size;
+  old_tuple.data_ = new char[old_tuple.size_];
+  ReadTuple(slot_num, old_tuple.data_);
+  old_tuple.overflow_page_id_ = INVALID_PAGE_ID;
+  old_tuple.rid_ = rid;
+  old_tuple.allocated_ = true;
+
+  if (ENABLE_LOGGING) {
+    // acquire exclusive lock, upgrade a shared one. Never waited for under
+    // the page latch
+    if (txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end()) {
+      if (!lock_manager->TryLockUpgrade(txn, rid))
+        return false;
+    } else if (txn->GetExclusiveLockSet()->find(rid) ==
+                   txn->GetExclusiveLockSet()->end() &&
+               !lock_manager->TryLockExclusive(txn, rid)) {
+      return false;
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::UPDATE, rid, old_tuple, new_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
+  }
+
+  // the slot is empty while its varchars are compacted away
+  ReleaseVarchars(slot_num);
+  SetSlotState(slot_num, EMPTY);
+  if (GetContiguousFreeSpaceSize() < new_tuple.size_ - GetInlineSize())
+    Compact();
+  WriteTuple(slot_num, new_tuple);
+  SetSlotState(slot_num, TUPLE);
+  return true;
+}
+
+// commit delete or rollback insert, the slot can be taken again
+void PaxPage::ApplyDelete(const RID &rid, Transaction *txn,
+                          LogManager *log_manager) {
+  int slot_num = rid.GetSlotNum();
+  assert(slot_num < GetSlotCount());
+  assert(GetSlotState(slot_num) != EMPTY);
+  // must already grab the exclusive lock
+  assert(!ENABLE_LOGGING || txn->GetExclusiveLockSet()->find(rid) !=
+                                txn->GetExclusiveLockSet()->end());
+  if (ENABLE_LOGGING && log_manager != nullptr)
+    LogDelete(LogRecordType::APPLYDELETE, rid, txn, log_manager);
+  ReleaseVarchars(slot_num);
+  SetSlotState(slot_num, EMPTY);
+}
+
+void PaxPage::RollbackDelete(const RID &rid, Transaction *txn,
+                             LogManager *log_manager) {
+  if (ENABLE_LOGGING) {
+    // must have already grab the exclusive lock
+    assert(txn->GetExclusiveLockSet()->find(rid) !=
+           txn->GetExclusiveLockSet()->end());
+  }
+  int slot_num = rid.GetSlotNum();
+  assert(slot_num < GetSlotCount());
+  if (GetSlotState(slot_num) == DELETED) {
+    if (ENABLE_LOGGING)
+      LogDelete(LogRecordType::ROLLBACKDELETE, rid, txn, log_manager);
+    SetSlotState(slot_num, TUPLE);
+  }
+}
+
+bool PaxPage::RestoreTuple(const Tuple &tuple, const RID &rid) {
+  int slot_num = rid.GetSlotNum();
+  int32_t varchar_size = tuple.size_ - GetInlineSize();
+  if (IsEncoded() || slot_num >= GetSlotCount() ||
+      GetSlotState(slot_num) != EMPTY ||
+      GetContiguousFreeSpaceSize() + GetFragmentedSize() < varchar_size)
+    return false;
+  if (GetContiguousFreeSpaceSize() < varchar_size)
+    Compact();
+  WriteTuple(slot_num, tuple);
+  SetSlotState(slot_num, TUPLE);
+  return true;
+}
+
+void PaxPage::LogDelete(LogRecordType type, const RID &rid, Transaction *txn,
+                        LogManager *log_manager) {
+  Tuple tuple;
+  tuple.size_ = GetTupleSize(rid.GetSlotNum());
+  tuple.data_ = new char[tuple.size_];
+  ReadTuple(rid.GetSlotNum(), tuple.data_);
+  tuple.allocated_ = true;
+  LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), type, rid,
+                       tuple);
+  lsn_t lsn = log_manager->AppendLogRecord(log_record);
+  txn->SetPrevLSN(lsn);
+  SetLSN(lsn);
+}
+
+// slide varchar values to the end of page, from the highest one down
+void PaxPage::Compact() {
+  if (GetFragmentedSize() == 0)
+    return;
+  // (offset, minipage entry)
+  std::pair<int32_t, int32_t> values[PAGE_SIZE / 4];
+  int count = 0;
+  int32_t slot_count = GetSlotCount();
+  for (int j = 0; j < GetColumnCount(); j++) {
+    if (GetColumnType(j) != TypeId::VARCHAR)
+      continue;
+    for (int i = 0; i < slot_count; i++) {
+      if (GetSlotState(i) == EMPTY)
+        continue;
+      int32_t entry = GetMinipageOffset(j) + 4 * i;
+      values[count++] = std::make_pair(
+          *reinterpret_cast<int32_t *>(GetData() + entry), entry);
+    }
+  }
+  std::sort(values, values + count,
+            std::greater<std::pair<int32_t, int32_t>>());
+  int32_t free_space_pointer = PAGE_SIZE;
+  for (int i = 0; i < count; ++i) {
+    uint32_t length =
+        *reinterpret_cast<uint32_t *>(GetData() + values[i].first);
+    int32_t size = 4 + (length == PELOTON_VALUE_NULL ? 0 : length);
+    free_space_pointer -= size;
+    if (free_space_pointer != values[i].first) {
+      memmove(GetData() + free_space_pointer, GetData() + values[i].first,
+              size);
+      memcpy(GetData() + values[i].second, &free_space_pointer, 4);
+    }
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetFragmentedSize(0);
+}
+
+bool PaxPage::IsEmpty() {
+  int32_t slot_count = GetSlotCount();
+  for (int i = 0; i < slot_count; ++i) {
+    if (GetSlotState(i) != EMPTY)
+      return false;
+  }
+  return true;
+}
+
+bool PaxPage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
+                       LockManager *lock_manager) {
+  TupleView view;
+  if (!GetTupleView(rid, view, txn, lock_manager))
+    return false;
+  // the buffer of tuple is reused if it is large enough
+  if (!tuple.allocated_ || tuple.size_ < view.size_) {
+    if (tuple.allocated_)
+      delete[] tuple.data_;
+    tuple.data_ = new char[view.size_];
+  }
+  tuple.size_ = view.size_;
+  tuple.overflow_page_id_ = INVALID_PAGE_ID;
+  tuple.is_overflow_read_ = false;
+  ReadTuple(rid.GetSlotNum(), tuple.data_);
+  tuple.rid_ = rid;
+  tuple.allocated_ = true;
+  return true;
+}
+
+bool PaxPage::GetTupleView(const RID &rid, TupleView &view, Transaction *txn,
+                           LockManager *lock_manager) {
+  int slot_num = rid.GetSlotNum();
+  if (slot_num >= GetSlotCount() || GetSlotState(slot_num) != TUPLE) {
+    if (ENABLE_LOGGING)
+      txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+
+  if (ENABLE_LOGGING) {
+    // acquire shared lock, without waiting under the page latch
+    if (txn->GetExclusiveLockSet()->find(rid) ==
+            txn->GetExclusiveLockSet()->end() &&
+        txn->GetSharedLockSet()->find(rid) == txn->GetSharedLockSet()->end() &&
+        !lock_manager->TryLockShared(txn, rid)) {
+      return false;
+    }
+  }
+
+  view.pax_page_ = this;
+  view.data_ = nullptr;
+  view.size_ = GetTupleSize(slot_num);
+  view.overflow_page_id_ = INVALID_PAGE_ID;
+  view.rid_ = rid;
+  view.overflow_tuple_.reset();
+  return true;
+}
+
+int PaxPage::GetTupleViews(int first_slot, std::vector<TupleView> &views,
+                           size_t max_count, Transaction *txn,
+                           LockManager *lock_manager, bool &is_blocked) {
+  int32_t slot_count = GetSlotCount();
+  size_t view_count = views.size() + max_count;
+  int slot_num = first_slot;
+  RID rid;
+  is_blocked = false;
+  for (; slot_num < slot_count && views.size() < view_count; ++slot_num) {
+    if (GetSlotState(slot_num) != TUPLE)
+      continue;
+    rid.Set(GetPageId(), slot_num);
+    views.emplace_back();
+    if (!GetTupleView(rid, views.back(), txn, lock_manager)) {
+      views.pop_back();
+      is_blocked = txn->GetState() != TransactionState::ABORTED;
+      break;
+    }
+  }
+  return slot_num;
+}
+
+bool PaxPage::GetFirstTupleRid(RID &first_rid) {
+  int32_t slot_count = GetSlotCount();
+  for (int i = 0; i < slot_count; ++i) {
+    if (GetSlotState(i) == TUPLE) {
+      first_rid.Set(GetPageId(), i);
+      return true;
+    }
+  }
+  first_rid.Set(INVALID_PAGE_ID, -1);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
+  assert(cur_rid.GetPageId() == GetPageId());
+  int32_t slot_count = GetSlotCount();
+  for (auto i = cur_rid.GetSlotNum() + 1; i < slot_count; ++i) {
+    if (GetSlotState(i) == TUPLE) {
+      next_rid.Set(GetPageId(), i);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Column related
+ */
+Value PaxPage::GetValue(int slot_num, int column_id) {
+  TypeId type = GetColumnType(column_id);
+  if (IsEncoded())
+    return ColumnChunk(type, GetData() + GetMinipageOffset(column_id))
+        .GetValue(slot_num);
+  const char *entry = GetData() + GetMinipageOffset(column_id) +
+                      GetColumnWidth(column_id) * slot_num;
+  if (type != TypeId::VARCHAR)
+    return Value::DeserializeFrom(entry, type);
+  const char *value = GetData() + *reinterpret_cast<const int32_t *>(entry);
+  uint32_t length = *reinterpret_cast<const uint32_t *>(value);
+  if (length == PELOTON_VALUE_NULL)
+    return Value(type, nullptr, length, false);
+  return Value(type, value + sizeof(uint32_t), length, false);
+}
+
+void PaxPage::Filter(int column_id, CompareOp op, const Value &value,
+                     std::vector<char> &matches) {
+  int32_t slot_count = GetSlotCount();
+  if (matches.empty()) {
+    matches.resize(slot_count);
+    for (int i = 0; i < slot_count; i++)
+      matches[i] = GetSlotState(i) == TUPLE;
+  }
+  if (IsEncoded()) {
+    ColumnChunk(GetColumnType(column_id),
+                GetData() + GetMinipageOffset(column_id))
+        .Filter(op, value, slot_count, matches);
+    return;
+  }
+  for (int i = 0; i < slot_count; i++) {
+    if (matches[i] &&
+        !ColumnChunk::Compare(GetValue(i, column_id), op, value))
+      matches[i] = 0;
+  }
+}
+
+/**
+ * helper functions
+ */
+PaxPage::SlotState PaxPage::GetSlotState(int slot_num) {
+  return static_cast<SlotState>(
+      GetData()[PAX_HEADER_SIZE + 3 * GetColumnCount() + slot_num]);
+}
+
+void PaxPage::SetSlotState(int slot_num, SlotState state) {
+  GetData()[PAX_HEADER_SIZE + 3 * GetColumnCount() + slot_num] = state;
+}
+
+std::vector<TypeId> PaxPage::GetColumnTypes() {
+  std::vector<TypeId> types;
+  for (int i = 0; i < GetColumnCount(); i++)
+    types.push_back(GetColumnType(i));
+  return types;
+}
+
+// a varchar borrows its tuple
+void PaxPage::GetColumnValues(const std::vector<Tuple> &tuples, int column_id,
+                              std::vector<Value> &values) {
+  TypeId type = GetColumnType(column_id);
+  int32_t inline_offset = 0;
+  for (int i = 0; i < column_id; i++)
+    inline_offset += GetColumnWidth(i);
+  values.clear();
+  for (auto &tuple : tuples) {
+    assert(tuple.overflow_page_id_ == INVALID_PAGE_ID);
+    const char *entry = tuple.data_ + inline_offset;
+    if (type != TypeId::VARCHAR) {
+      values.push_back(Value::DeserializeFrom(entry, type));
+      continue;
+    }
+    const char *value =
+        tuple.data_ + *reinterpret_cast<const int32_t *>(entry);
+    uint32_t length = *reinterpret_cast<const uint32_t *>(value);
+    if (length == PELOTON_VALUE_NULL)
+      values.emplace_back(type, nullptr, length, false);
+    else
+      values.emplace_back(type, value + sizeof(uint32_t), length, false);
+  }
+}
+
+int32_t PaxPage::GetColumnCount() {
+  return *reinterpret_cast<uint16_t *>(GetData() + 40);
+}
+
+int32_t PaxPage::GetInlineSize() {
+  return *reinterpret_cast<uint16_t *>(GetData() + 42);
+}
+
+int32_t PaxPage::GetVarcharCount() {
+  return *reinterpret_cast<uint16_t *>(GetData() + 44);
+}
+
+TypeId PaxPage::GetColumnType(int column_id) {
+  return static_cast<TypeId>(GetData()[PAX_HEADER_SIZE + 3 * column_id]);
+}
+
+int32_t PaxPage::GetMinipageOffset(int column_id) {
+  uint16_t offset;
+  memcpy(&offset, GetData() + PAX_HEADER_SIZE + 3 * column_id + 1, 2);
+  return offset;
+}
+
+int32_t PaxPage::GetColumnWidth(int column_id) {
+  TypeId type = GetColumnType(column_id);
+  return type == TypeId::VARCHAR ? 4 : Type::GetTypeSize(type);
+}
+
+int32_t PaxPage::GetVarcharSize(int slot_num, int column_id) {
+  if (IsEncoded())
+    return ColumnChunk(TypeId::VARCHAR,
+                       GetData() + GetMinipageOffset(column_id))
+        .GetVarcharSize(slot_num);
+  int32_t offset = *reinterpret_cast<int32_t *>(
+      GetData() + GetMinipageOffset(column_id) + 4 * slot_num);
+  uint32_t length = *reinterpret_cast<uint32_t *>(GetData() + offset);
+  return 4 + (length == PELOTON_VALUE_NULL ? 0 : length);
+}
+
+int32_t PaxPage::GetTupleSize(int slot_num) {
+  int32_t size = GetInlineSize();
+  if (GetVarcharCount() == 0)
+    return size;
+  for (int i = 0; i < GetColumnCount(); i++) {
+    if (GetColumnType(i) == TypeId::VARCHAR)
+      size += GetVarcharSize(slot_num, i);
+  }
+  return size;
+}
+
+// same layout as Tuple(values, schema)
+void PaxPage::ReadTuple(int slot_num, char *data) {
+  int32_t inline_offset = 0;
+  int32_t varchar_offset = GetInlineSize();
+  for (int i = 0; i < GetColumnCount(); i++) {
+    int32_t width = GetColumnWidth(i);
+    if (IsEncoded()) {
+      ColumnChunk chunk(GetColumnType(i), GetData() + GetMinipageOffset(i));
+      if (GetColumnType(i) == TypeId::VARCHAR) {
+        memcpy(data + inline_offset, &varchar_offset, 4);
+        varchar_offset += chunk.CopyValue(slot_num, data + varchar_offset);
+      } else {
+        chunk.CopyValue(slot_num, data + inline_offset);
+      }
+      inline_offset += width;
+      continue;
+    }
+    const char *entry =
+        GetData() + GetMinipageOffset(i) + width * slot_num;
+    if (GetColumnType(i) == TypeId::VARCHAR) {
+      int32_t size = GetVarcharSize(slot_num, i);
+      memcpy(data + inline_offset, &varchar_offset, 4);
+      memcpy(data + varchar_offset,
+             GetData() + *reinterpret_cast<const int32_t *>(entry), size);
+      varchar_offset += size;
+    } else {
+      memcpy(data + inline_offset, entry, width);
+    }
+    inline_offset += width;
+  }
+}
+
+void PaxPage::WriteTuple(int slot_num, const Tuple &tuple) {
+  int32_t inline_offset = 0;
+  for (int i = 0; i < GetColumnCount(); i++) {
+    int32_t width = GetColumnWidth(i);
+    char *entry = GetData() + GetMinipageOffset(i) + width * slot_num;
+    if (GetColumnType(i) == TypeId::VARCHAR) {
+      const char *value =
+          tuple.data_ +
+          *reinterpret_cast<const int32_t *>(tuple.data_ + inline_offset);
+      uint32_t length = *reinterpret_cast<const uint32_t *>(value);
+      int32_t size = 4 + (length == PELOTON_VALUE_NULL ? 0 : length);
+      assert(size <= GetContiguousFreeSpaceSize());
+      int32_t free_space_pointer = GetFreeSpacePointer() - size;
+      memcpy(GetData() + free_space_pointer, value, size);
+      memcpy(entry, &free_space_pointer, 4);
+      SetFreeSpacePointer(free_space_pointer);
+    } else {
+      memcpy(entry, tuple.data_ + inline_offset, width);
+    }
+    inline_offset += width;
+  }
+}
+
+void PaxPage::ReleaseVarchars(int slot_num) {
+  if (IsEncoded() || GetVarcharCount() == 0)
+    return;
+  int32_t size = 0;
+  for (int i = 0; i < GetColumnCount(); i++) {
+    if (GetColumnType(i) == TypeId::VARCHAR)
+      size += GetVarcharSize(slot_num, i);
+  }
+  SetFragmentedSize(GetFragmentedSize() + size);
+}
+
+int32_t PaxPage::GetFreeSpacePointer() {
+  return *reinterpret_cast<int32_t *>(GetData() + 20);
+}
+
+void PaxPage::SetFreeSpacePointer(int32_t free_space_pointer) {
+  memcpy(GetData() + 20, &free_space_pointer, 4);
+}
+
+int32_t PaxPage::GetFragmentedSize() {
+  return *reinterpret_cast<int32_t *>(GetData() + 36);
+}
+
+void PaxPage::SetFragmentedSize(int32_t fragmented_size) {
+  memcpy(GetData() + 36, &fragmented_size, 4);
+}
+
+int32_t PaxPage::GetContiguousFreeSpaceSize() {
+  int32_t last_column = GetColumnCount() - 1;
+  int32_t minipage_end = GetMinipageOffset(last_column) +
+                         GetSlotCount() * GetColumnWidth(last_column);
+  return GetFreeSpacePointer() - minipage_end;
+}
+
+} // namespace scudb
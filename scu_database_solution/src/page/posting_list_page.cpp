@@ -0,0 +1,160 @@
+/**
+ * posting_list_page.cpp
+ */
+
+#include <cassert>
+
+#include "page/posting_list_page.h"
+
+namespace scudb {
+
+#define POSTING_LIST_HEADER_SIZE 36
+
+/**
+ * Header related
+ */
+void PostingListPage::Init(page_id_t page_id) {
+  memcpy(GetData(), &page_id, 4); // set page_id
+  SetNextPageId(INVALID_PAGE_ID);
+  SetTailPageId(page_id);
+  SetRidCount(0);
+  SetPayloadSize(0);
+  SetLastRid(RID());
+}
+
+page_id_t PostingListPage::GetPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData());
+}
+
+page_id_t PostingListPage::GetNextPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 12);
+}
+
+void PostingListPage::SetNextPageId(page_id_t next_page_id) {
+  memcpy(GetData() + 12, &next_page_id, 4);
+}
+
+page_id_t PostingListPage::GetTailPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 16);
+}
+
+void PostingListPage::SetTailPageId(page_id_t tail_page_id) {
+  memcpy(GetData() + 16, &tail_page_id, 4);
+}
+
+int32_t PostingListPage::GetRidCount() {
+  return *reinterpret_cast<int32_t *>(GetData() + 20);
+}
+
+RID PostingListPage::GetLastRid() {
+  return RID(*reinterpret_cast<int64_t *>(GetData() + 28));
+}
+
+/**
+ * RID related
+ */
+bool PostingListPage::Append(const RID &rid) {
+  uint64_t delta = rid.Get();
+  if (GetRidCount() > 0) {
+    assert(rid.Get() > GetLastRid().Get());
+    delta -= GetLastRid().Get();
+  }
+  if (VarintSize(delta) > GetFreeSpaceSize())
+    return false;
+  int32_t payload_size = GetPayloadSize();
+  payload_size += WriteVarint(
+      GetData() + POSTING_LIST_HEADER_SIZE + payload_size, delta);
+  SetPayloadSize(payload_size);
+  SetRidCount(GetRidCount() + 1);
+  SetLastRid(rid);
+  return true;
+}
+
+void PostingListPage::Decode(std::vector<RID> &result) {
+  const char *pos = GetData() + POSTING_LIST_HEADER_SIZE;
+  int64_t value = 0;
+  for (int i = 0; i < GetRidCount(); i++) {
+    uint64_t delta;
+    pos += ReadVarint(pos, delta);
+    value += delta;
+    result.emplace_back(value);
+  }
+}
+
+RID PostingListPage::GetFirstRid() {
+  assert(GetRidCount() > 0);
+  uint64_t value;
+  ReadVarint(GetData() + POSTING_LIST_HEADER_SIZE, value);
+  return RID(static_cast<int64_t>(value));
+}
+
+int PostingListPage::Encode(const std::vector<RID> &rids, int begin,
+                            int end) {
+  SetRidCount(0);
+  SetPayloadSize(0);
+  SetLastRid(RID());
+  int i;
+  for (i = begin; i < end; i++) {
+    if (!Append(rids[i]))
+      break;
+  }
+  return i - begin;
+}
+
+/**
+ * helper functions
+ */
+int32_t PostingListPage::GetPayloadSize() {
+  return *reinterpret_cast<int32_t *>(GetData() + 24);
+}
+
+void PostingListPage::SetPayloadSize(int32_t payload_size) {
+  memcpy(GetData() + 24, &payload_size, 4);
+}
+
+void PostingListPage::SetRidCount(int32_t rid_count) {
+  memcpy(GetData() + 20, &rid_count, 4);
+}
+
+void PostingListPage::SetLastRid(const RID &rid) {
+  int64_t value = rid.Get();
+  memcpy(GetData() + 28, &value, 8);
+}
+
+int32_t PostingListPage::GetFreeSpaceSize() {
+  return PAGE_SIZE - POSTING_LIST_HEADER_SIZE - GetPayloadSize();
+}
+
+int PostingListPage::VarintSize(uint64_t value) {
+  int size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+int PostingListPage::WriteVarint(char *dst, uint64_t value) {
+  int size = 0;
+  while (value >= 0x80) {
+    dst[size++] = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  dst[size++] = static_cast<char>(value);
+  return size;
+}
+
+int PostingListPage::ReadVarint(const char *src, uint64_t &value) {
+  int size = 0;
+  int shift = 0;
+  value = 0;
+  uint8_t byte;
+  do {
+    byte = static_cast<uint8_t>(src[size++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return size;
+}
+
+} // namespace scudb
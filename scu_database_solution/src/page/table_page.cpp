@@ -2,11 +2,20 @@
  * header_page.cpp
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <functional>
 
 #include "page/table_page.h"
 
 namespace scudb {
+
+// set in the offset field of a slot whose tuple has overflow pages
+#define TUPLE_OVERFLOW_FLAG 0x40000000
+// size of the head of such a tuple before its first bytes
+#define TUPLE_OVERFLOW_HEADER_SIZE 8
+
 /**
  * Header related
  */
@@ -15,12 +24,19 @@ void TablePage::Init(page_id_t page_id, size_t page_size,
                      Transaction *txn) {
   memcpy(GetData(), &page_id, 4); // set page_id
   if (ENABLE_LOGGING) {
-    // TODO: add your logging logic here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::NEWPAGE, prev_page_id, page_id);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
   }
   SetPrevPageId(prev_page_id);
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(page_size);
   SetTupleCount(0);
+  SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+  SetFirstFreeSlot(-1);
+  SetFragmentedSize(0);
 }
 
 page_id_t TablePage::GetPageId() {
@@ -28,66 +44,97 @@ page_id_t TablePage::GetPageId() {
 }
 
 page_id_t TablePage::GetPrevPageId() {
-  return *reinterpret_cast<page_id_t *>(GetData() + 8);
+  return *reinterpret_cast<page_id_t *>(GetData() + 12);
 }
 
 page_id_t TablePage::GetNextPageId() {
-  return *reinterpret_cast<page_id_t *>(GetData() + 12);
+  return *reinterpret_cast<page_id_t *>(GetData() + 16);
 }
 
 void TablePage::SetPrevPageId(page_id_t prev_page_id) {
-  memcpy(GetData() + 8, &prev_page_id, 4);
+  memcpy(GetData() + 12, &prev_page_id, 4);
 }
 
 void TablePage::SetNextPageId(page_id_t next_page_id) {
-  memcpy(GetData() + 12, &next_page_id, 4);
+  memcpy(GetData() + 16, &next_page_id, 4);
 }
 
+page_id_t TablePage::GetFreeSpaceMapPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 28);
+}
+
+void TablePage::SetFreeSpaceMapPageId(page_id_t free_space_map_page_id) {
+  memcpy(GetData() + 28, &free_space_map_page_id, 4);
+}
+
+bool TablePage::IsPaxPage() { return GetFirstFreeSlot() == PAX_PAGE_MAGIC; }
+
 /**
  * Tuple related
  */
 bool TablePage::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
                             LockManager *lock_manager,
                             LogManager *log_manager) {
+  if (IsPaxPage())
+    return AsPaxPage()->InsertTuple(tuple, rid, txn, lock_manager, log_manager);
   assert(tuple.size_ > 0);
-  if (GetFreeSpaceSize() < tuple.size_) {
+  // only the head of a tuple with overflow pages is kept here
+  bool is_overflow = tuple.overflow_page_id_ != INVALID_PAGE_ID;
+  int32_t tuple_size = is_overflow
+                           ? TUPLE_OVERFLOW_HEADER_SIZE + TUPLE_INLINE_SIZE
+                           : tuple.size_;
+  // reuse the first empty slot, or append a new one
+  int i = GetFirstFreeSlot();
+  int32_t slot_size = i == -1 ? 8 : 0;
+  if (GetFreeSpaceSize() < tuple_size + slot_size) {
     return false; // not enough space
   }
-
-  // try to reuse a free slot first
-  int i;
-  for (i = 0; i < GetTupleCount(); ++i) {
-    rid.Set(GetPageId(), i);
-    if (GetTupleSize(i) == 0) { // empty slot
-      if (ENABLE_LOGGING) {
-        assert(txn->GetSharedLockSet()->find(rid) ==
-                   txn->GetSharedLockSet()->end() &&
-               txn->GetExclusiveLockSet()->find(rid) ==
-                   txn->GetExclusiveLockSet()->end());
-      }
-      break;
-    }
+  if (GetContiguousFreeSpaceSize() < tuple_size + slot_size) {
+    Compact(); // holes left by deleted tuples are big enough
   }
 
-  // no free slot left
-  if (i == GetTupleCount() && GetFreeSpaceSize() < tuple.size_ + 8) {
-    return false; // not enough space
+  bool is_new_slot = i == -1;
+  if (is_new_slot) {
+    i = GetTupleCount();
+    SetTupleCount(GetTupleCount() + 1);
+  } else {
+    SetFirstFreeSlot(GetNextFreeSlot(i)); // pop the empty slot
+  }
+  rid.Set(GetPageId(), i);
+  // acquire the exclusive lock. An empty slot may still be locked by the
+  // transaction that deleted its tuple, the insert is given up then
+  if (ENABLE_LOGGING &&
+      txn->GetExclusiveLockSet()->find(rid) ==
+          txn->GetExclusiveLockSet()->end() &&
+      !lock_manager->TryLockExclusive(txn, rid)) {
+    if (is_new_slot)
+      SetTupleCount(i);
+    else
+      SetFirstFreeSlot(i); // push the slot back
+    txn->SetState(TransactionState::ABORTED);
+    return false;
   }
 
   SetFreeSpacePointer(GetFreeSpacePointer() -
-                      tuple.size_); // update free space pointer first
-  memcpy(GetData() + GetFreeSpacePointer(), tuple.data_, tuple.size_);
-  SetTupleOffset(i, GetFreeSpacePointer());
-  SetTupleSize(i, tuple.size_);
-  if (i == GetTupleCount()) {
-    rid.Set(GetPageId(), i);
-    SetTupleCount(GetTupleCount() + 1);
+                      tuple_size); // update free space pointer first
+  char *storage = GetData() + GetFreeSpacePointer();
+  if (is_overflow) {
+    memcpy(storage, &tuple.size_, 4);
+    memcpy(storage + 4, &tuple.overflow_page_id_, 4);
+    memcpy(storage + TUPLE_OVERFLOW_HEADER_SIZE, tuple.data_,
+           TUPLE_INLINE_SIZE);
+  } else {
+    memcpy(storage, tuple.data_, tuple.size_);
   }
+  SetTupleOffset(i, GetFreeSpacePointer(), is_overflow);
+  SetTupleSize(i, tuple_size);
   // write the log after set rid
-  if (ENABLE_LOGGING) {
-    // acquire the exclusive lock
-    assert(lock_manager->LockExclusive(txn, rid.Get()));
-    // TODO: add your logging logic here
+  if (ENABLE_LOGGING && log_manager != nullptr) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::INSERT, rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
   }
   // LOG_DEBUG("Tuple inserted");
   return true;
@@ -101,6 +148,8 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
  */
 bool TablePage::MarkDelete(const RID &rid, Transaction *txn,
                            LockManager *lock_manager, LogManager *log_manager) {
+  if (IsPaxPage())
+    return AsPaxPage()->MarkDelete(rid, txn, lock_manager, log_manager);
   int slot_num = rid.GetSlotNum();
   if (slot_num >= GetTupleCount()) {
     if (ENABLE_LOGGING) {
@@ -118,17 +167,27 @@ bool TablePage::MarkDelete(const RID &rid, Transaction *txn,
   }
 
   if (ENABLE_LOGGING) {
-    // acquire exclusive lock
+    // acquire exclusive lock without waiting under the page latch, see
+    // TableHeap::LockTuple
     // if has shared lock
     if (txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end()) {
-      if (!lock_manager->LockUpgrade(txn, rid))
+      if (!lock_manager->TryLockUpgrade(txn, rid))
         return false;
     } else if (txn->GetExclusiveLockSet()->find(rid) ==
                    txn->GetExclusiveLockSet()->end() &&
-               !lock_manager->LockExclusive(txn, rid)) { // no shared lock
+               !lock_manager->TryLockExclusive(txn, rid)) { // no shared lock
       return false;
     }
-    // TODO: add your logging logic here
+  }
+  if (ENABLE_LOGGING && log_manager != nullptr) {
+    Tuple tuple;
+    tuple.size_ = tuple_size;
+    tuple.data_ = GetData() + GetTupleOffset(slot_num);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::MARKDELETE, rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
   }
 
   // set tuple size to negative value
@@ -141,6 +200,9 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
                             const RID &rid, Transaction *txn,
                             LockManager *lock_manager,
                             LogManager *log_manager) {
+  if (IsPaxPage())
+    return AsPaxPage()->UpdateTuple(new_tuple, old_tuple, rid, txn,
+                                    lock_manager, log_manager);
   int slot_num = rid.GetSlotNum();
   if (slot_num >= GetTupleCount()) {
     if (ENABLE_LOGGING) {
@@ -155,6 +217,11 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
     }
     return false;
   }
+  if (IsOverflowTuple(slot_num) ||
+      new_tuple.overflow_page_id_ != INVALID_PAGE_ID) {
+    // should delete/insert, overflow pages are not updated in place
+    return false;
+  }
   if (GetFreeSpaceSize() < new_tuple.size_ - tuple_size) {
     // should delete/insert because not enough space
     return false;
@@ -172,17 +239,27 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
   old_tuple.allocated_ = true;
 
   if (ENABLE_LOGGING) {
-    // acquire exclusive lock
+    // acquire exclusive lock without waiting under the page latch, see
+    // TableHeap::LockTuple
     // if has shared lock
     if (txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end()) {
-      if (!lock_manager->LockUpgrade(txn, rid))
+      if (!lock_manager->TryLockUpgrade(txn, rid))
         return false;
     } else if (txn->GetExclusiveLockSet()->find(rid) ==
                    txn->GetExclusiveLockSet()->end() &&
-               !lock_manager->LockExclusive(txn, rid)) { // no shared lock
+               !lock_manager->TryLockExclusive(txn, rid)) { // no shared lock
       return false;
     }
-    // TODO: add your logging logic here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::UPDATE, rid, old_tuple, new_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
+  }
+
+  if (GetContiguousFreeSpaceSize() < new_tuple.size_ - tuple_size) {
+    Compact();
+    tuple_offset = GetTupleOffset(slot_num);
   }
 
   // update
@@ -199,7 +276,8 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
   for (int i = 0; i < GetTupleCount();
        ++i) { // update tuple offsets (including the updated one)
     int32_t tuple_offset_i = GetTupleOffset(i);
-    if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
+    // deleted but not yet applied tuples move along as well
+    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset + tuple_size) {
       SetTupleOffset(i, tuple_offset_i + tuple_size - new_tuple.size_);
     }
   }
@@ -209,10 +287,16 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
 /*
  * ApplyDelete function truly delete a tuple from table page, and make the slot
  * available for use again.
+ * The tuple bytes are left as a hole until Compact, so that deleting is not
+ * paying for moving the other tuples.
  * This function is called when a transaction commits or when you undo insert
  */
 void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
                             LogManager *log_manager) {
+  if (IsPaxPage()) {
+    AsPaxPage()->ApplyDelete(rid, txn, log_manager);
+    return;
+  }
   int slot_num = rid.GetSlotNum();
   assert(slot_num < GetTupleCount());
   // the tuple offset of the deleted tuple
@@ -222,35 +306,45 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
     tuple_size = -tuple_size;
   } // else: rollback insert op
 
-  // copy out delete value, for undo purpose
+  // copy out delete value, for undo purpose. The head of a tuple with
+  // overflow pages is enough, they are freed after the transaction ends
   Tuple delete_tuple;
-  delete_tuple.size_ = tuple_size;
+  const char *tuple_data = GetData() + tuple_offset;
+  if (IsOverflowTuple(slot_num)) {
+    delete_tuple.size_ = *reinterpret_cast<const int32_t *>(tuple_data);
+    delete_tuple.overflow_page_id_ =
+        *reinterpret_cast<const page_id_t *>(tuple_data + 4);
+    tuple_data += TUPLE_OVERFLOW_HEADER_SIZE;
+  } else {
+    delete_tuple.size_ = tuple_size;
+  }
   delete_tuple.data_ = new char[delete_tuple.size_];
-  memcpy(delete_tuple.data_, GetData() + tuple_offset, delete_tuple.size_);
+  memcpy(delete_tuple.data_, tuple_data, delete_tuple.GetReadSize());
   delete_tuple.rid_ = rid;
   delete_tuple.allocated_ = true;
 
-  if (ENABLE_LOGGING) {
-    // must already grab the exclusive lock
-    assert(txn->GetExclusiveLockSet()->find(rid) !=
-           txn->GetExclusiveLockSet()->end());
-    // TODO: add your logging logic here
+  // must already grab the exclusive lock
+  assert(!ENABLE_LOGGING || txn->GetExclusiveLockSet()->find(rid) !=
+                                txn->GetExclusiveLockSet()->end());
+  if (ENABLE_LOGGING && log_manager != nullptr) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::APPLYDELETE, rid, delete_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
   }
 
-  int32_t free_space_pointer =
-      GetFreeSpacePointer(); // old pointer to the free space
-  assert(tuple_offset >= free_space_pointer);
-  memmove(GetData() + free_space_pointer + tuple_size,
-          GetData() + free_space_pointer, tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
-  SetTupleSize(slot_num, 0);
-  SetTupleOffset(slot_num, 0); // invalid offset
-  for (int i = 0; i < GetTupleCount(); ++i) {
-    int32_t tuple_offset_i = GetTupleOffset(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffset(i, tuple_offset_i + tuple_size);
-    }
+  assert(tuple_offset >= GetFreeSpacePointer());
+  if (tuple_offset == GetFreeSpacePointer()) {
+    // the lowest tuple, give it back to the free space directly
+    SetFreeSpacePointer(tuple_offset + tuple_size);
+  } else {
+    SetFragmentedSize(GetFragmentedSize() + tuple_size);
   }
+  // push the slot onto the empty slot list
+  SetTupleSize(slot_num, 0);
+  SetNextFreeSlot(slot_num, GetFirstFreeSlot());
+  SetFirstFreeSlot(slot_num);
 }
 
 /*
@@ -261,25 +355,162 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
  */
 void TablePage::RollbackDelete(const RID &rid, Transaction *txn,
                                LogManager *log_manager) {
+  if (IsPaxPage()) {
+    AsPaxPage()->RollbackDelete(rid, txn, log_manager);
+    return;
+  }
   if (ENABLE_LOGGING) {
     // must have already grab the exclusive lock
     assert(txn->GetExclusiveLockSet()->find(rid) !=
            txn->GetExclusiveLockSet()->end());
-
-    // TODO: add your logging logic here
   }
 
   int slot_num = rid.GetSlotNum();
   assert(slot_num < GetTupleCount());
   int32_t tuple_size = GetTupleSize(slot_num);
+  if (ENABLE_LOGGING) {
+    Tuple tuple;
+    tuple.size_ = tuple_size < 0 ? -tuple_size : tuple_size;
+    tuple.data_ = GetData() + GetTupleOffset(slot_num);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::ROLLBACKDELETE, rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    SetLSN(lsn);
+  }
 
   // set tuple size to positive value
   if (tuple_size < 0)
     SetTupleSize(slot_num, -tuple_size);
 }
 
+bool TablePage::RestoreTuple(const Tuple &tuple, const RID &rid) {
+  if (IsPaxPage())
+    return AsPaxPage()->RestoreTuple(tuple, rid);
+  // the head of a tuple with overflow pages, as InsertTuple keeps it
+  bool is_overflow = tuple.overflow_page_id_ != INVALID_PAGE_ID;
+  int32_t tuple_size = is_overflow
+                           ? TUPLE_OVERFLOW_HEADER_SIZE + TUPLE_INLINE_SIZE
+                           : tuple.size_;
+  int slot_num = rid.GetSlotNum();
+  // new slots are appended, as InsertTuple does, the ones before the slot
+  // are left empty
+  int32_t slot_size = std::max(slot_num + 1 - GetTupleCount(), 0) * 8;
+  if (GetFreeSpaceSize() < tuple_size + slot_size)
+    return false;
+  if (slot_size == 0 && GetTupleSize(slot_num) != 0)
+    return false;
+  if (GetContiguousFreeSpaceSize() < tuple_size + slot_size)
+    Compact();
+  if (slot_size > 0) {
+    int slot_count = GetTupleCount();
+    SetTupleCount(slot_num + 1);
+    for (int i = slot_count; i < slot_num; i++) {
+      SetTupleSize(i, 0);
+      SetNextFreeSlot(i, GetFirstFreeSlot());
+      SetFirstFreeSlot(i);
+    }
+    SetTupleSize(slot_num, 0);
+  } else if (GetFirstFreeSlot() == slot_num) {
+    // unlink the slot from the empty slot list
+    SetFirstFreeSlot(GetNextFreeSlot(slot_num));
+  } else {
+    int i = GetFirstFreeSlot();
+    while (GetNextFreeSlot(i) != slot_num)
+      i = GetNextFreeSlot(i);
+    SetNextFreeSlot(i, GetNextFreeSlot(slot_num));
+  }
+  SetFreeSpacePointer(GetFreeSpacePointer() - tuple_size);
+  char *storage = GetData() + GetFreeSpacePointer();
+  if (is_overflow) {
+    memcpy(storage, &tuple.size_, 4);
+    memcpy(storage + 4, &tuple.overflow_page_id_, 4);
+    memcpy(storage + TUPLE_OVERFLOW_HEADER_SIZE, tuple.data_,
+           TUPLE_INLINE_SIZE);
+  } else {
+    memcpy(storage, tuple.data_, tuple.size_);
+  }
+  SetTupleOffset(slot_num, GetFreeSpacePointer(), is_overflow);
+  SetTupleSize(slot_num, tuple_size);
+  return true;
+}
+
+void TablePage::Compact() {
+  if (IsPaxPage()) {
+    AsPaxPage()->Compact();
+    return;
+  }
+  if (GetFragmentedSize() == 0)
+    return;
+  // slide tuples to the end of page, from the highest one down
+  std::pair<int32_t, int> tuples[PAGE_SIZE / 8]; // (offset, slot)
+  int count = 0;
+  for (int i = 0; i < GetTupleCount(); ++i) {
+    if (GetTupleSize(i) != 0)
+      tuples[count++] = std::make_pair(GetTupleOffset(i), i);
+  }
+  std::sort(tuples, tuples + count, std::greater<std::pair<int32_t, int>>());
+  int32_t free_space_pointer = PAGE_SIZE;
+  for (int i = 0; i < count; ++i) {
+    int32_t tuple_size = std::abs(GetTupleSize(tuples[i].second));
+    free_space_pointer -= tuple_size;
+    if (free_space_pointer != tuples[i].first) {
+      memmove(GetData() + free_space_pointer, GetData() + tuples[i].first,
+              tuple_size);
+      SetTupleOffset(tuples[i].second, free_space_pointer);
+    }
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetFragmentedSize(0);
+}
+
+bool TablePage::IsEmpty() {
+  if (IsPaxPage())
+    return AsPaxPage()->IsEmpty();
+  for (int i = 0; i < GetTupleCount(); ++i) {
+    if (GetTupleSize(i) != 0)
+      return false;
+  }
+  return true;
+}
+
+page_id_t TablePage::GetOverflowPageId(const RID &rid) {
+  if (IsPaxPage())
+    return INVALID_PAGE_ID;
+  int slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetTupleSize(slot_num) == 0 ||
+      !IsOverflowTuple(slot_num))
+    return INVALID_PAGE_ID;
+  return *reinterpret_cast<page_id_t *>(GetData() + GetTupleOffset(slot_num) +
+                                        4);
+}
+
 bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
                          LockManager *lock_manager) {
+  if (IsPaxPage())
+    return AsPaxPage()->GetTuple(rid, tuple, txn, lock_manager);
+  TupleView view;
+  if (!GetTupleView(rid, view, txn, lock_manager))
+    return false;
+  // the buffer of tuple is reused if it is large enough
+  if (!tuple.allocated_ || tuple.size_ < view.size_) {
+    if (tuple.allocated_)
+      delete[] tuple.data_;
+    tuple.data_ = new char[view.size_];
+  }
+  tuple.size_ = view.size_;
+  tuple.overflow_page_id_ = view.overflow_page_id_;
+  tuple.is_overflow_read_ = false;
+  memcpy(tuple.data_, view.data_, tuple.GetReadSize());
+  tuple.rid_ = rid;
+  tuple.allocated_ = true;
+  return true;
+}
+
+bool TablePage::GetTupleView(const RID &rid, TupleView &view, Transaction *txn,
+                             LockManager *lock_manager) {
+  if (IsPaxPage())
+    return AsPaxPage()->GetTupleView(rid, view, txn, lock_manager);
   int slot_num = rid.GetSlotNum();
   if (slot_num >= GetTupleCount()) {
     if (ENABLE_LOGGING)
@@ -294,30 +525,64 @@ bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
   }
 
   if (ENABLE_LOGGING) {
-    // acquire shared lock
+    // acquire shared lock, without waiting under the page latch
     if (txn->GetExclusiveLockSet()->find(rid) ==
             txn->GetExclusiveLockSet()->end() &&
         txn->GetSharedLockSet()->find(rid) == txn->GetSharedLockSet()->end() &&
-        !lock_manager->LockShared(txn, rid)) {
+        !lock_manager->TryLockShared(txn, rid)) {
       return false;
     }
   }
 
   int32_t tuple_offset = GetTupleOffset(slot_num);
-  tuple.size_ = tuple_size;
-  if (tuple.allocated_)
-    delete[] tuple.data_;
-  tuple.data_ = new char[tuple.size_];
-  memcpy(tuple.data_, GetData() + tuple_offset, tuple.size_);
-  tuple.rid_ = rid;
-  tuple.allocated_ = true;
+  view.overflow_page_id_ = INVALID_PAGE_ID;
+  view.size_ = tuple_size;
+  if (IsOverflowTuple(slot_num)) {
+    // the head only, the rest is read from overflow pages on demand
+    view.size_ = *reinterpret_cast<int32_t *>(GetData() + tuple_offset);
+    view.overflow_page_id_ =
+        *reinterpret_cast<page_id_t *>(GetData() + tuple_offset + 4);
+    tuple_offset += TUPLE_OVERFLOW_HEADER_SIZE;
+  }
+  view.data_ = GetData() + tuple_offset;
+  view.rid_ = rid;
+  view.overflow_tuple_.reset();
   return true;
 }
 
+int TablePage::GetTupleViews(int first_slot, std::vector<TupleView> &views,
+                             size_t max_count, Transaction *txn,
+                             LockManager *lock_manager, bool &is_blocked) {
+  if (IsPaxPage())
+    return AsPaxPage()->GetTupleViews(first_slot, views, max_count, txn,
+                                       lock_manager, is_blocked);
+  int tuple_count = GetTupleCount();
+  size_t view_count = views.size() + max_count;
+  int slot_num = first_slot;
+  RID rid;
+  is_blocked = false;
+  for (; slot_num < tuple_count && views.size() < view_count; ++slot_num) {
+    if (GetTupleSize(slot_num) <= 0)
+      continue;
+    rid.Set(GetPageId(), slot_num);
+    views.emplace_back();
+    if (!GetTupleView(rid, views.back(), txn, lock_manager)) {
+      views.pop_back();
+      // a live tuple is only refused for its lock, no tuple is read past
+      // it. The transaction may have to die instead of waiting for it
+      is_blocked = txn->GetState() != TransactionState::ABORTED;
+      break;
+    }
+  }
+  return slot_num;
+}
+
 /**
  * Tuple iterator
  */
 bool TablePage::GetFirstTupleRid(RID &first_rid) {
+  if (IsPaxPage())
+    return AsPaxPage()->GetFirstTupleRid(first_rid);
   for (int i = 0; i < GetTupleCount(); ++i) {
     if (GetTupleSize(i) > 0) { // valid tuple
       first_rid.Set(GetPageId(), i);
@@ -330,6 +595,8 @@ bool TablePage::GetFirstTupleRid(RID &first_rid) {
 }
 
 bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
+  if (IsPaxPage())
+    return AsPaxPage()->GetNextTupleRid(cur_rid, next_rid);
   assert(cur_rid.GetPageId() == GetPageId());
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
     if (GetTupleSize(i) > 0) { // valid tuple
@@ -346,41 +613,86 @@ bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
 
 // tuple slots
 int32_t TablePage::GetTupleOffset(int slot_num) {
-  return *reinterpret_cast<int32_t *>(GetData() + 24 + 8 * slot_num);
+  return *reinterpret_cast<int32_t *>(GetData() + 40 + 8 * slot_num) &
+         ~TUPLE_OVERFLOW_FLAG;
 }
 
 int32_t TablePage::GetTupleSize(int slot_num) {
-  return *reinterpret_cast<int32_t *>(GetData() + 28 + 8 * slot_num);
+  return *reinterpret_cast<int32_t *>(GetData() + 44 + 8 * slot_num);
 }
 
 void TablePage::SetTupleOffset(int slot_num, int32_t offset) {
-  memcpy(GetData() + 24 + 8 * slot_num, &offset, 4);
+  SetTupleOffset(slot_num, offset, IsOverflowTuple(slot_num));
+}
+
+bool TablePage::IsOverflowTuple(int slot_num) {
+  return *reinterpret_cast<int32_t *>(GetData() + 40 + 8 * slot_num) &
+         TUPLE_OVERFLOW_FLAG;
+}
+
+void TablePage::SetTupleOffset(int slot_num, int32_t offset,
+                               bool is_overflow) {
+  if (is_overflow)
+    offset |= TUPLE_OVERFLOW_FLAG;
+  memcpy(GetData() + 40 + 8 * slot_num, &offset, 4);
+}
+
+int32_t TablePage::GetNextFreeSlot(int slot_num) {
+  return *reinterpret_cast<int32_t *>(GetData() + 40 + 8 * slot_num);
+}
+
+void TablePage::SetNextFreeSlot(int slot_num, int32_t next_slot_num) {
+  memcpy(GetData() + 40 + 8 * slot_num, &next_slot_num, 4);
 }
 
 void TablePage::SetTupleSize(int slot_num, int32_t offset) {
-  memcpy(GetData() + 28 + 8 * slot_num, &offset, 4);
+  memcpy(GetData() + 44 + 8 * slot_num, &offset, 4);
 }
 
 // free space
 int32_t TablePage::GetFreeSpacePointer() {
-  return *reinterpret_cast<int32_t *>(GetData() + 16);
+  return *reinterpret_cast<int32_t *>(GetData() + 20);
 }
 
 void TablePage::SetFreeSpacePointer(int32_t free_space_pointer) {
-  memcpy(GetData() + 16, &free_space_pointer, 4);
+  memcpy(GetData() + 20, &free_space_pointer, 4);
 }
 
 // tuple count
 int32_t TablePage::GetTupleCount() {
-  return *reinterpret_cast<int32_t *>(GetData() + 20);
+  return *reinterpret_cast<int32_t *>(GetData() + 24);
 }
 
 void TablePage::SetTupleCount(int32_t tuple_count) {
-  memcpy(GetData() + 20, &tuple_count, 4);
+  memcpy(GetData() + 24, &tuple_count, 4);
+}
+
+// empty slot list
+int32_t TablePage::GetFirstFreeSlot() {
+  return *reinterpret_cast<int32_t *>(GetData() + 32);
+}
+
+void TablePage::SetFirstFreeSlot(int32_t slot_num) {
+  memcpy(GetData() + 32, &slot_num, 4);
+}
+
+// holes among tuples
+int32_t TablePage::GetFragmentedSize() {
+  return *reinterpret_cast<int32_t *>(GetData() + 36);
+}
+
+void TablePage::SetFragmentedSize(int32_t fragmented_size) {
+  memcpy(GetData() + 36, &fragmented_size, 4);
 }
 
 // for free space calculation
+int32_t TablePage::GetContiguousFreeSpaceSize() {
+  return GetFreeSpacePointer() - 40 - GetTupleCount() * 8;
+}
+
 int32_t TablePage::GetFreeSpaceSize() {
-  return GetFreeSpacePointer() - 24 - GetTupleCount() * 8;
+  if (IsPaxPage())
+    return AsPaxPage()->GetFreeSpaceSize();
+  return GetContiguousFreeSpaceSize() + GetFragmentedSize();
 }
 } // namespace scudb
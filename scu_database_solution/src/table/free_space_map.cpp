@@ -0,0 +1,142 @@
+/**
+ * free_space_map.cpp
+ */
+
+#include <cassert>
+
+#include "common/exception.h"
+#include "logging/page_logger.h"
+#include "table/free_space_map.h"
+
+namespace scudb {
+
+// free space covered by one fill class
+#define FSM_CLASS_WIDTH (PAGE_SIZE / 16)
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager,
+                           LogManager *log_manager, page_id_t root_page_id)
+    : buffer_pool_manager_(buffer_pool_manager), log_manager_(log_manager),
+      root_page_id_(root_page_id), search_hint_(0) {
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    PageLogger page_logger(log_manager_);
+    Extend(0);
+    page_logger.Commit();
+    return;
+  }
+  // rebuild the in-memory view of the chain, fill classes are unknown
+  page_id_t page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids_.push_back(page_id);
+    max_classes_.push_back(15);
+    auto map_page = FetchMapPage(page_ids_.size() - 1);
+    page_id = map_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(map_page->GetPageId(), false);
+  }
+}
+
+/*
+ * Most updates keep the fill class, the map page is read without a page
+ * logger then, which would copy it
+ */
+void FreeSpaceMap::Update(page_id_t page_id, int free_space) {
+  int fill_class = std::min(15, std::max(0, free_space) / FSM_CLASS_WIDTH);
+  size_t index = page_id / FSM_ENTRY_COUNT;
+  std::lock_guard<std::mutex> lock(latch_);
+  if (index < page_ids_.size()) {
+    auto map_page = FetchMapPage(index);
+    bool is_same = map_page->GetFillClass(page_id % FSM_ENTRY_COUNT) ==
+                   fill_class;
+    buffer_pool_manager_->UnpinPage(map_page->GetPageId(), false);
+    if (is_same)
+      return;
+  }
+  PageLogger page_logger(log_manager_);
+  Extend(index);
+  auto map_page = FetchMapPage(index);
+  map_page->SetFillClass(page_id % FSM_ENTRY_COUNT, fill_class);
+  buffer_pool_manager_->UnpinPage(map_page->GetPageId(), true);
+  page_logger.Commit();
+  max_classes_[index] = std::max(max_classes_[index], fill_class);
+}
+
+/*
+ * Search map pages round robin from the one of the last success, so that
+ * consecutive inserts keep filling the same heap page
+ */
+page_id_t FreeSpaceMap::FindPage(int size) {
+  int fill_class = (size + FSM_CLASS_WIDTH - 1) / FSM_CLASS_WIDTH;
+  if (fill_class > 15)
+    return INVALID_PAGE_ID;
+  std::lock_guard<std::mutex> lock(latch_);
+  for (size_t n = 0; n < page_ids_.size(); n++) {
+    size_t index = (search_hint_ + n) % page_ids_.size();
+    if (max_classes_[index] < fill_class)
+      continue;
+    auto map_page = FetchMapPage(index);
+    int entry = map_page->FindEntry(fill_class, 0);
+    if (entry == -1) {
+      // tighten the bound while the page is at hand
+      int max_class = 0;
+      for (int i = 0; i < FSM_ENTRY_COUNT; i++)
+        max_class = std::max(max_class, map_page->GetFillClass(i));
+      max_classes_[index] = max_class;
+    }
+    buffer_pool_manager_->UnpinPage(map_page->GetPageId(), false);
+    if (entry != -1) {
+      search_hint_ = index;
+      return index * FSM_ENTRY_COUNT + entry;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+page_id_t FreeSpaceMap::GetLastPageId() {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto map_page = FetchMapPage(0);
+  page_id_t last_page_id = map_page->GetLastHeapPageId();
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  return last_page_id;
+}
+
+void FreeSpaceMap::SetLastPageId(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  PageLogger page_logger(log_manager_);
+  auto map_page = FetchMapPage(0);
+  map_page->SetLastHeapPageId(page_id);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  page_logger.Commit();
+}
+
+/*
+ * helper functions
+ */
+FreeSpaceMapPage *FreeSpaceMap::FetchMapPage(size_t index) {
+  assert(index < page_ids_.size());
+  Page *page = buffer_pool_manager_->FetchPage(page_ids_[index]);
+  if (page == nullptr)
+    throw Exception("all page are pinned");
+  return static_cast<FreeSpaceMapPage *>(page);
+}
+
+void FreeSpaceMap::Extend(size_t index) {
+  while (page_ids_.size() <= index) {
+    page_id_t page_id;
+    auto map_page =
+        static_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(page_id));
+    if (map_page == nullptr)
+      throw Exception("out of memory");
+    map_page->Init(page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    if (page_ids_.empty()) {
+      root_page_id_ = page_id;
+    } else {
+      auto last = FetchMapPage(page_ids_.size() - 1);
+      last->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(last->GetPageId(), true);
+    }
+    page_ids_.push_back(page_id);
+    max_classes_.push_back(0);
+  }
+}
+
+} // namespace scudb
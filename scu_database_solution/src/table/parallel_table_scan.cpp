@@ -0,0 +1,148 @@
+/**
+ * parallel_table_scan.cpp
+ */
+
+#include <cassert>
+#include <thread>
+
+#include "table/parallel_table_scan.h"
+#include "table/table_batch_iterator.h"
+#include "table/table_heap.h"
+
+namespace scudb {
+
+ParallelTableScan::ParallelTableScan(TableHeap *table_heap, Transaction *txn,
+                                     size_t thread_count, size_t morsel_size)
+    : table_heap_(table_heap), txn_(txn), thread_count_(thread_count),
+      morsel_size_(morsel_size), next_page_id_(INVALID_PAGE_ID),
+      page_count_(0), steal_count_(0) {
+  assert(thread_count_ > 0);
+  assert(morsel_size_ > 0);
+  for (size_t i = 0; i < thread_count_; i++)
+    workers_.emplace_back(new Worker);
+}
+
+void ParallelTableScan::Run(const ScanFunction &scan) {
+  next_page_id_ = table_heap_->GetFirstPageId();
+  page_count_ = 0;
+  steal_count_ = 0;
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count_; i++)
+    threads.emplace_back(&ParallelTableScan::Work, this, i, std::cref(scan));
+  Work(0, scan);
+  for (auto &thread : threads)
+    thread.join();
+}
+
+void ParallelTableScan::Work(size_t worker_id, const ScanFunction &scan) {
+  std::vector<TupleView> views;
+  views.reserve(TABLE_BATCH_SIZE);
+  page_id_t page_id;
+  while (NextPage(worker_id, page_id)) {
+    ScanPage(page_id, views, worker_id, scan);
+    page_count_++;
+  }
+}
+
+void ParallelTableScan::ScanPage(page_id_t page_id,
+                                 std::vector<TupleView> &views,
+                                 size_t worker_id, const ScanFunction &scan) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  ReadPageGuard guard(buffer_pool_manager, page_id);
+  assert(guard.IsValid()); // all pages are pinned
+  int slot_num = 0;
+  bool is_blocked;
+  do {
+    views.clear();
+    if (ENABLE_LOGGING) {
+      // the worker holding the latch may be waiting for a tuple lock, that
+      // is not waited for with the page latched
+      std::unique_lock<std::mutex> lock(txn_latch_, std::try_to_lock);
+      if (!lock.owns_lock()) {
+        guard.Release();
+        lock.lock();
+        guard = ReadPageGuard(buffer_pool_manager, page_id);
+        assert(guard.IsValid());
+      }
+      slot_num = guard.As<TablePage>()->GetTupleViews(
+          slot_num, views, TABLE_BATCH_SIZE, txn_, table_heap_->lock_manager_,
+          is_blocked);
+      if (views.empty() && is_blocked) {
+        // waited for holding txn_latch_, the lock sets of txn are shared
+        guard.Release();
+        table_heap_->LockTuple(RID(page_id, slot_num), txn_, false);
+        guard = ReadPageGuard(buffer_pool_manager, page_id);
+        assert(guard.IsValid());
+        continue;
+      }
+    } else {
+      slot_num = guard.As<TablePage>()->GetTupleViews(
+          slot_num, views, TABLE_BATCH_SIZE, txn_, table_heap_->lock_manager_,
+          is_blocked);
+    }
+    for (auto &view : views) {
+      view.SetBufferPoolManager(buffer_pool_manager);
+      scan(worker_id, view);
+    }
+  } while (!views.empty() || is_blocked);
+}
+
+bool ParallelTableScan::NextPage(size_t worker_id, page_id_t &page_id) {
+  Worker &worker = *workers_[worker_id];
+  {
+    std::lock_guard<std::mutex> lock(worker.latch);
+    if (worker.pages.empty())
+      NextMorsel(worker.pages);
+    if (!worker.pages.empty()) {
+      page_id = worker.pages.front();
+      worker.pages.pop_front();
+      return true;
+    }
+  }
+  return Steal(worker_id, page_id);
+}
+
+/*
+ * The chain is a linked list, so the dispenser reads the header of every
+ * page it hands out. The page is likely still cached when a worker scans it
+ */
+bool ParallelTableScan::NextMorsel(std::deque<page_id_t> &pages) {
+  std::lock_guard<std::mutex> lock(dispenser_latch_);
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  while (next_page_id_ != INVALID_PAGE_ID && pages.size() < morsel_size_) {
+    pages.push_back(next_page_id_);
+    ReadPageGuard guard(buffer_pool_manager, next_page_id_);
+    assert(guard.IsValid());
+    next_page_id_ = guard.As<TablePage>()->GetNextPageId();
+  }
+  return !pages.empty();
+}
+
+/*
+ * Take half of the pages of the first worker that has any left, from the
+ * back of its queue while it keeps working on the front
+ */
+bool ParallelTableScan::Steal(size_t worker_id, page_id_t &page_id) {
+  Worker &thief = *workers_[worker_id];
+  for (size_t i = 1; i < thread_count_; i++) {
+    Worker &victim = *workers_[(worker_id + i) % thread_count_];
+    std::unique_lock<std::mutex> victim_lock(victim.latch);
+    if (victim.pages.empty())
+      continue;
+    size_t count = (victim.pages.size() + 1) / 2;
+    std::deque<page_id_t> stolen(victim.pages.end() - count,
+                                 victim.pages.end());
+    victim.pages.erase(victim.pages.end() - count, victim.pages.end());
+    victim_lock.unlock();
+
+    steal_count_ += count;
+    page_id = stolen.front();
+    stolen.pop_front();
+    std::lock_guard<std::mutex> lock(thief.latch);
+    thief.pages.insert(thief.pages.end(), stolen.begin(), stolen.end());
+    return true;
+  }
+  return false;
+}
+
+} // namespace scudb
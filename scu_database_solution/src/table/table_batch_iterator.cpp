@@ -0,0 +1,82 @@
+/**
+ * table_batch_iterator.cpp
+ */
+
+#include <cassert>
+
+#include "table/table_batch_iterator.h"
+#include "table/table_heap.h"
+
+namespace scudb {
+
+TableBatchIterator::TableBatchIterator(TableHeap *table_heap,
+                                       Transaction *txn, size_t batch_size)
+    : table_heap_(table_heap), txn_(txn), batch_size_(batch_size),
+      page_id_(table_heap->GetFirstPageId()) {
+  assert(batch_size_ > 0);
+  batch_.reserve(batch_size_);
+}
+
+/*
+ * Continue on the page of the last batch, or move to the next page with a
+ * tuple. The next page is latched before the current one is released. A
+ * transaction aborted for a lock ends the scan, the tuples behind the lock
+ * are not skipped over
+ */
+bool TableBatchIterator::Next() {
+  batch_.clear();
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  while (!is_end_) {
+    if (txn_->GetState() == TransactionState::ABORTED) {
+      Close();
+      break;
+    }
+    if (!guard_.IsValid()) {
+      guard_ = ReadPageGuard(buffer_pool_manager, page_id_);
+      assert(guard_.IsValid()); // all pages are pinned
+    }
+    auto page = guard_.As<TablePage>();
+    bool is_blocked;
+    slot_num_ = page->GetTupleViews(slot_num_, batch_, batch_size_, txn_,
+                                    table_heap_->lock_manager_, is_blocked);
+    if (!batch_.empty())
+      break;
+    if (is_blocked) {
+      // wait for the lock with the page unlatched, then read the slot again
+      guard_.Release();
+      if (!table_heap_->LockTuple(RID(page_id_, slot_num_), txn_, false))
+        Close();
+      continue;
+    }
+    if (txn_->GetState() == TransactionState::ABORTED)
+      continue;
+    page_id_ = page->GetNextPageId();
+    slot_num_ = 0;
+    if (page_id_ == INVALID_PAGE_ID) {
+      guard_.Release();
+      is_end_ = true;
+    } else {
+      guard_ = ReadPageGuard(buffer_pool_manager, page_id_);
+      assert(guard_.IsValid());
+    }
+  }
+  for (auto &view : batch_)
+    view.SetBufferPoolManager(buffer_pool_manager);
+  return !batch_.empty();
+}
+
+void TableBatchIterator::GetColumn(Schema *schema, int column_id,
+                                   std::vector<Value> &values) const {
+  values.clear();
+  for (auto &view : batch_)
+    values.push_back(view.GetValue(schema, column_id));
+}
+
+PaxPage *TableBatchIterator::GetPaxPage() const {
+  if (batch_.empty())
+    return nullptr;
+  auto page = guard_.As<TablePage>();
+  return page->IsPaxPage() ? page->AsPaxPage() : nullptr;
+}
+
+} // namespace scudb
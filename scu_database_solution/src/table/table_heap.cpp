@@ -2,9 +2,13 @@
  * table_heap.cpp
  */
 
+#include <algorithm>
 #include <cassert>
 
+#include "common/exception.h"
 #include "common/logger.h"
+#include "logging/page_logger.h"
+#include "page/overflow_page.h"
 #include "table/table_heap.h"
 
 namespace scudb {
@@ -14,77 +18,254 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
                      page_id_t first_page_id)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-      log_manager_(log_manager), first_page_id_(first_page_id) {}
+      log_manager_(log_manager), first_page_id_(first_page_id),
+      is_async_commit_(false) {
+  auto first_page =
+      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  assert(first_page != nullptr);
+  is_pax_ = first_page->IsPaxPage();
+  page_id_t free_space_map_page_id = first_page->GetFreeSpaceMapPageId();
+  if (free_space_map_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    free_space_map_ =
+        new FreeSpaceMap(buffer_pool_manager_, log_manager_,
+                         free_space_map_page_id);
+    return;
+  }
+  // table written without a free space map, build it with one pass
+  free_space_map_ = new FreeSpaceMap(buffer_pool_manager_, log_manager_);
+  first_page->SetFreeSpaceMapPageId(free_space_map_->GetRootPageId());
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    free_space_map_->Update(page_id, page->GetFreeSpaceSize());
+    free_space_map_->SetLastPageId(page_id);
+    page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
 
 // create table
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
+                     Transaction *txn, Schema *pax_schema)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager), is_pax_(pax_schema != nullptr),
+      is_async_commit_(false) {
+  if (is_pax_ && PaxPage::GetSlotCount(pax_schema) == 0)
+    throw Exception("tuples of the schema don't fit in a PAX page");
+  // a PAX page has no NEWPAGE record, it is logged whole by an operation
+  PageLogger page_logger(is_pax_ ? log_manager_ : nullptr);
   auto first_page =
       static_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
   assert(first_page != nullptr); // todo: abort table creation?
   first_page->WLatch();
   LOG_DEBUG("new table page created %d", first_page_id_);
 
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  if (is_pax_) {
+    page_logger.LogWhole(first_page);
+    first_page->AsPaxPage()->Init(first_page_id_, INVALID_PAGE_ID, pax_schema);
+  } else {
+    first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_,
+                     txn);
+  }
+  free_space_map_ = new FreeSpaceMap(buffer_pool_manager_, log_manager_);
+  free_space_map_->Update(first_page_id_, first_page->GetFreeSpaceSize());
+  free_space_map_->SetLastPageId(first_page_id_);
+  first_page->SetFreeSpaceMapPageId(free_space_map_->GetRootPageId());
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  page_logger.Commit();
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
-    txn->SetState(TransactionState::ABORTED);
-    return false;
+/*
+ * Ask the free space map for a page that fits the tuple and a new slot. The
+ * map is only a hint, it is corrected with the real free space of every page
+ * tried. When no page has room a new page is linked behind the tail.
+ * A large tuple is written to overflow pages first, then its head is inserted
+ * like a small tuple.
+ */
+bool TableHeap::InsertTuple(const Tuple &large_tuple, RID &rid,
+                            Transaction *txn) {
+  Tuple head_tuple;
+  if (large_tuple.size_ > TUPLE_OVERFLOW_THRESHOLD) {
+    if (is_pax_) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    head_tuple.overflow_page_id_ = WriteOverflowPages(large_tuple);
+    if (head_tuple.overflow_page_id_ == INVALID_PAGE_ID) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    // shallow copy, table page only reads the head of data, the log takes
+    // all of it
+    head_tuple.size_ = large_tuple.size_;
+    head_tuple.data_ = large_tuple.data_;
+    head_tuple.is_overflow_read_ = true;
   }
+  const Tuple &tuple =
+      head_tuple.overflow_page_id_ == INVALID_PAGE_ID ? large_tuple
+                                                      : head_tuple;
+  int32_t tuple_size = tuple.overflow_page_id_ == INVALID_PAGE_ID
+                           ? tuple.size_
+                           : 8 + TUPLE_INLINE_SIZE;
 
-  auto cur_page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  latch_.RLock();
+  page_id_t page_id;
+  while ((page_id = free_space_map_->FindPage(tuple_size + 8)) !=
+         INVALID_PAGE_ID) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      latch_.RUnlock();
+      DeleteOverflowPages(head_tuple.overflow_page_id_);
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    bool is_inserted =
+        page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    int32_t free_space = page->GetFreeSpaceSize();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, is_inserted);
+    free_space_map_->Update(page_id, free_space);
+    if (is_inserted) {
+      latch_.RUnlock();
+      txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+    if (txn->GetState() == TransactionState::ABORTED) { // slot still locked
+      latch_.RUnlock();
+      DeleteOverflowPages(head_tuple.overflow_page_id_);
+      return false;
+    }
+  }
+
+  auto cur_page = FetchLastPage();
   if (cur_page == nullptr) {
+    latch_.RUnlock();
+    DeleteOverflowPages(head_tuple.overflow_page_id_);
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-
-  cur_page->WLatch();
+  bool is_new_page = false;
   while (!cur_page->InsertTuple(
       tuple, rid, txn, lock_manager_,
       log_manager_)) { // fail to insert due to not enough space
-    auto next_page_id = cur_page->GetNextPageId();
-    if (next_page_id != INVALID_PAGE_ID) { // valid next page
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = static_cast<TablePage *>(
-          buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else { // create new page
-      auto new_page =
-          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
-      if (new_page == nullptr) {
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      new_page->WLatch();
-      // std::cout << "new table page " << next_page_id << " created" <<
-      // std::endl;
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
-                     log_manager_, txn);
+    if (is_new_page ||
+        txn->GetState() == TransactionState::ABORTED) { // or a locked slot
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
-      cur_page = new_page;
+      cur_page = nullptr;
+    } else {
+      cur_page = AppendPage(cur_page, txn);
+      is_new_page = true;
+    }
+    if (cur_page == nullptr) {
+      latch_.RUnlock();
+      DeleteOverflowPages(head_tuple.overflow_page_id_);
+      txn->SetState(TransactionState::ABORTED);
+      return false;
     }
   }
+  page_id = cur_page->GetPageId();
+  int32_t free_space = cur_page->GetFreeSpaceSize();
   cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  free_space_map_->Update(page_id, free_space);
+  latch_.RUnlock();
   txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+/*
+ * Insert a batch of tuples, rids[i] is the rid of tuples[i]. Every page is
+ * latched once and filled with as many of the following tuples as fit, so a
+ * bulk load pays one fetch/latch/unpin per page instead of one per tuple.
+ * Large tuples are inserted one by one, as they need overflow pages anyway.
+ * @return: false if the batch is cut short, tuples before the failed one
+ * stay inserted
+ */
+bool TableHeap::InsertTuples(const std::vector<Tuple> &tuples,
+                             std::vector<RID> &rids, Transaction *txn) {
+  rids.resize(tuples.size());
+  size_t next = 0;
+  while (next < tuples.size()) {
+    if (tuples[next].size_ > TUPLE_OVERFLOW_THRESHOLD) {
+      if (!InsertTuple(tuples[next], rids[next], txn))
+        return false;
+      next++;
+      continue;
+    }
+
+    latch_.RLock();
+    page_id_t page_id = free_space_map_->FindPage(tuples[next].size_ + 8);
+    TablePage *page;
+    if (page_id != INVALID_PAGE_ID) {
+      page =
+          static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      if (page != nullptr)
+        page->WLatch();
+    } else {
+      page = FetchLastPage();
+    }
+    if (page == nullptr) {
+      latch_.RUnlock();
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    size_t first = next;
+    bool is_new_page = false;
+    FillPage(page, tuples, rids, next, txn);
+    if (next == first && page_id == INVALID_PAGE_ID &&
+        txn->GetState() != TransactionState::ABORTED) {
+      // tail page is full, keep filling a new one
+      page = AppendPage(page, txn);
+      is_new_page = true;
+      if (page == nullptr) {
+        latch_.RUnlock();
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+      }
+      FillPage(page, tuples, rids, next, txn);
+    }
+    page_id = page->GetPageId();
+    int32_t free_space = page->GetFreeSpaceSize();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    free_space_map_->Update(page_id, free_space);
+    latch_.RUnlock();
+    if (txn->GetState() == TransactionState::ABORTED)
+      return false; // a slot is still locked by another transaction
+    if (next == first && is_new_page) {
+      // the tuple doesn't fit in an empty page either
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+  return true;
+}
+
+// insert small tuples from next on into a latched page until one doesn't fit
+void TableHeap::FillPage(TablePage *page, const std::vector<Tuple> &tuples,
+                         std::vector<RID> &rids, size_t &next,
+                         Transaction *txn) {
+  for (; next < tuples.size(); next++) {
+    if (tuples[next].size_ > TUPLE_OVERFLOW_THRESHOLD ||
+        !page->InsertTuple(tuples[next], rids[next], txn, lock_manager_,
+                           log_manager_))
+      return;
+    txn->GetWriteSet()->emplace_back(rids[next], WType::INSERT, Tuple{}, this);
+  }
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // todo: remove empty page
+  if (!LockTuple(rid, txn, true))
+    return false;
   auto page = reinterpret_cast<TablePage *>(
       buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) {
@@ -92,15 +273,22 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
     return false;
   }
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  bool is_deleted = page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
-  return true;
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_deleted);
+  // a tuple that is gone, or deleted already, is not ours to apply or roll
+  // back
+  if (is_deleted)
+    txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  return is_deleted;
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
                             Transaction *txn) {
+  if (tuple.size_ > TUPLE_OVERFLOW_THRESHOLD)
+    return false; // needs overflow pages, delete and insert instead
+  if (!LockTuple(rid, txn, true))
+    return false;
   auto page = reinterpret_cast<TablePage *>(
       buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) {
@@ -111,22 +299,29 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
   page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, old_tuple, rid, txn, lock_manager_,
                                       log_manager_);
+  int32_t free_space = page->GetFreeSpaceSize();
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), is_updated);
+  if (is_updated)
+    free_space_map_->Update(rid.GetPageId(), free_space);
   if (is_updated && txn->GetState() != TransactionState::ABORTED)
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
   return is_updated;
 }
 
-void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
+page_id_t TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   auto page = reinterpret_cast<TablePage *>(
       buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
   page->WLatch();
+  page_id_t overflow_page_id = page->GetOverflowPageId(rid);
   page->ApplyDelete(rid, txn, log_manager_);
   lock_manager_->Unlock(txn, rid);
+  int32_t free_space = page->GetFreeSpaceSize();
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  free_space_map_->Update(rid.GetPageId(), free_space);
+  return overflow_page_id;
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -139,8 +334,10 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
 
-// called by tuple iterator
+// deep copy of a tuple, see GetTupleView to read it in place
 bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
+  if (!LockTuple(rid, txn, false))
+    return false;
   auto page = static_cast<TablePage *>(
       buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) {
@@ -149,27 +346,474 @@ bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
   }
   page->RLatch();
   bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  tuple.buffer_pool_manager_ = buffer_pool_manager_;
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
   return res;
 }
 
+// guard keeps the page of rid pinned and latched for as long as view is used
+bool TableHeap::GetTupleView(const RID &rid, TupleView &view,
+                             ReadPageGuard &guard, Transaction *txn) {
+  // let go of the old page first, it may be the same one
+  guard.Release();
+  if (!LockTuple(rid, txn, false))
+    return false;
+  guard = ReadPageGuard(buffer_pool_manager_, rid.GetPageId());
+  if (!guard.IsValid()) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  bool res =
+      guard.As<TablePage>()->GetTupleView(rid, view, txn, lock_manager_);
+  view.SetBufferPoolManager(buffer_pool_manager_);
+  return res;
+}
+
+/*
+ * Take the lock of rid before its page is latched: the lock may be waited
+ * for, and the transaction holding it needs the latch to commit or abort
+ */
+bool TableHeap::LockTuple(const RID &rid, Transaction *txn,
+                          bool is_exclusive) {
+  if (!ENABLE_LOGGING || txn->GetExclusiveLockSet()->find(rid) !=
+                             txn->GetExclusiveLockSet()->end())
+    return true;
+  if (txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end())
+    return !is_exclusive || lock_manager_->LockUpgrade(txn, rid);
+  return is_exclusive ? lock_manager_->LockExclusive(txn, rid)
+                      : lock_manager_->LockShared(txn, rid);
+}
+
+/*
+ * Fetch and write latch the last page of the chain, other inserts may have
+ * linked new pages behind the one the free space map knows of
+ * @return: nullptr if all pages are pinned
+ */
+TablePage *TableHeap::FetchLastPage() {
+  auto page = static_cast<TablePage *>(
+      buffer_pool_manager_->FetchPage(free_space_map_->GetLastPageId()));
+  if (page == nullptr)
+    return nullptr;
+  page->WLatch();
+  while (page->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page_id = page->GetNextPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = static_cast<TablePage *>(
+        buffer_pool_manager_->FetchPage(next_page_id));
+    if (page == nullptr)
+      return nullptr;
+    page->WLatch();
+  }
+  return page;
+}
+
+/*
+ * Link a new page behind the latched last page, which is then unlatched and
+ * unpinned. A PAX page has no NEWPAGE record: both pages are logged whole
+ * by an operation of their own, the pages fetched again to be logged before
+ * the new page is handed out
+ * @return: the new page, write latched. nullptr if out of memory
+ */
+TablePage *TableHeap::AppendPage(TablePage *last_page, Transaction *txn) {
+  PageLogger page_logger(is_pax_ ? log_manager_ : nullptr);
+  page_id_t next_page_id;
+  auto new_page =
+      static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
+  if (new_page == nullptr) {
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
+    return nullptr;
+  }
+  new_page->WLatch();
+  if (is_pax_) {
+    page_logger.LogWhole(buffer_pool_manager_->FetchPage(next_page_id));
+    page_logger.LogWhole(
+        buffer_pool_manager_->FetchPage(last_page->GetPageId()));
+  }
+  last_page->SetNextPageId(next_page_id);
+  if (is_pax_)
+    new_page->AsPaxPage()->Init(next_page_id, last_page->GetPageId(),
+                                last_page->AsPaxPage());
+  else
+    new_page->Init(next_page_id, PAGE_SIZE, last_page->GetPageId(),
+                   log_manager_, txn);
+  // the link is redone with the NEWPAGE record, see LogRecovery
+  if (ENABLE_LOGGING && !is_pax_)
+    last_page->SetLSN(new_page->GetLSN());
+  free_space_map_->SetLastPageId(next_page_id);
+  if (is_pax_) {
+    buffer_pool_manager_->UnpinPage(next_page_id, true);
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+    page_logger.Commit();
+  }
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+  return new_page;
+}
+
+/*
+ * The pages are logged as an operation of their own (see page_logger.h),
+ * committed before the insert of the head is logged
+ */
+page_id_t TableHeap::WriteOverflowPages(const Tuple &tuple) {
+  // a tuple read from a table heap gets pages of its own
+  tuple.ReadUntil(tuple.size_);
+  PageLogger page_logger(log_manager_);
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  OverflowPage *prev_page = nullptr;
+  for (int32_t offset = TUPLE_INLINE_SIZE; offset < tuple.size_;
+       offset += OVERFLOW_PAGE_CAPACITY) {
+    page_id_t page_id;
+    auto page =
+        static_cast<OverflowPage *>(buffer_pool_manager_->NewPage(page_id));
+    if (page == nullptr) { // all pages are pinned, give back the chain
+      if (prev_page != nullptr)
+        buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+      page_logger.Commit();
+      DeleteOverflowPages(first_page_id);
+      return INVALID_PAGE_ID;
+    }
+    page->Init(page_id);
+    page->WriteData(tuple.data_ + offset,
+                    std::min(OVERFLOW_PAGE_CAPACITY, tuple.size_ - offset));
+    if (prev_page == nullptr) {
+      first_page_id = page_id;
+    } else {
+      prev_page->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+    }
+    prev_page = page;
+  }
+  buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+  page_logger.Commit();
+  return first_page_id;
+}
+
+void TableHeap::DeleteOverflowPages(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto page =
+        static_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    assert(page != nullptr);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
 bool TableHeap::DeleteTableHeap() {
   // todo: real delete
   return true;
 }
 
-TableIterator TableHeap::begin(Transaction *txn) {
-  auto page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  page->RLatch();
+/*
+ * Walk the page chain once. Tuples of every page are moved into its previous
+ * page until that one is full, so every tuple moves at most once. A page left
+ * empty is unlinked and given back to the buffer pool, the others are
+ * compacted.
+ * Tuples are locked as transactions lock them, a tuple whose lock can not be
+ * taken keeps its page alive. Each step, the moves into a page along with
+ * the unlink, is an operation of its own that logs the pages it changes
+ * whole (see page_logger.h): the tuples keep their contents, so an abort of
+ * txn leaves them moved, and a page is given back only once the step that
+ * unlinked it is committed. The indexes follow the moves after that
+ */
+void TableHeap::Vacuum(Transaction *txn, const RelocateCallback &relocate) {
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = first_page_id_;
+  std::vector<Tuple> tuples;
+  std::vector<RID> new_rids;
+  while (page_id != INVALID_PAGE_ID &&
+         txn->GetState() != TransactionState::ABORTED) {
+    latch_.WLock();
+    TablePage *prev_page = nullptr;
+    if (prev_page_id != INVALID_PAGE_ID) {
+      prev_page = static_cast<TablePage *>(
+          buffer_pool_manager_->FetchPage(prev_page_id));
+      assert(prev_page != nullptr);
+      prev_page->WLatch();
+    }
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    assert(page != nullptr);
+    page->WLatch();
+    page_id_t next_page_id = page->GetNextPageId();
+
+    bool is_deleted = false;
+    if (prev_page == nullptr) {
+      // the first page only gets compacted, which no record needs
+      page->Compact();
+      prev_page_id = page_id;
+      int32_t free_space = page->GetFreeSpaceSize();
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      free_space_map_->Update(page_id, free_space);
+      latch_.WUnlock();
+      page_id = next_page_id;
+      continue;
+    }
+
+    TablePage *next_page = nullptr;
+    if (next_page_id != INVALID_PAGE_ID) {
+      next_page = static_cast<TablePage *>(
+          buffer_pool_manager_->FetchPage(next_page_id));
+      assert(next_page != nullptr);
+      next_page->WLatch();
+    }
+    {
+      // fetched again once latched, so the page logger sees what the step
+      // starts from
+      PageLogger page_logger(log_manager_);
+      std::vector<page_id_t> page_ids = {prev_page_id, page_id};
+      if (next_page != nullptr)
+        page_ids.push_back(next_page_id);
+      for (page_id_t logged_page_id : page_ids)
+        page_logger.LogWhole(buffer_pool_manager_->FetchPage(logged_page_id));
+
+      MoveTuples(page, prev_page, txn, tuples, new_rids);
+      if (page->IsEmpty()) {
+        prev_page->SetNextPageId(next_page_id);
+        if (next_page != nullptr)
+          next_page->SetPrevPageId(prev_page_id);
+        else
+          free_space_map_->SetLastPageId(prev_page_id);
+        is_deleted = true;
+      } else {
+        page->Compact();
+        prev_page_id = page_id;
+      }
+      prev_page->Compact();
+      for (page_id_t logged_page_id : page_ids)
+        buffer_pool_manager_->UnpinPage(logged_page_id, true);
+      page_logger.Commit();
+    }
+    if (relocate) {
+      for (size_t i = 0; i < tuples.size(); ++i)
+        relocate(tuples[i], tuples[i].rid_, new_rids[i]);
+    }
+
+    int32_t prev_free_space = prev_page->GetFreeSpaceSize();
+    int32_t free_space = is_deleted ? 0 : page->GetFreeSpaceSize();
+    if (next_page != nullptr) {
+      next_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    prev_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), false);
+    free_space_map_->Update(prev_page->GetPageId(), prev_free_space);
+    free_space_map_->Update(page_id, free_space);
+    if (is_deleted)
+      buffer_pool_manager_->DeletePage(page_id);
+    latch_.WUnlock();
+    page_id = next_page_id;
+  }
+}
+
+/*
+ * No record is written, the caller logs both pages whole. Tuples moved get
+ * their old rids
+ */
+void TableHeap::MoveTuples(TablePage *src, TablePage *dst, Transaction *txn,
+                           std::vector<Tuple> &tuples,
+                           std::vector<RID> &new_rids) {
+  tuples.clear();
+  new_rids.clear();
+  RID rid, next_rid, new_rid;
+  Tuple tuple;
+  bool has_next = src->GetFirstTupleRid(rid);
+  while (has_next) {
+    has_next = src->GetNextTupleRid(rid, next_rid);
+    if (!src->GetTuple(rid, tuple, txn, lock_manager_))
+      break;
+    // an index key may lie in the overflow pages
+    tuple.buffer_pool_manager_ = buffer_pool_manager_;
+    if (!dst->InsertTuple(tuple, new_rid, txn, lock_manager_, nullptr))
+      break;
+    if (!src->MarkDelete(rid, txn, lock_manager_, nullptr)) {
+      dst->ApplyDelete(new_rid, txn, nullptr);
+      break;
+    }
+    // overflow pages, if any, now belong to the new head
+    src->ApplyDelete(rid, txn, nullptr);
+    tuple.rid_ = rid;
+    tuples.push_back(tuple);
+    new_rids.push_back(new_rid);
+    rid = next_rid;
+  }
+}
+
+/*
+ * Walk the page chain once. A page is encoded with its own tuples, and then
+ * takes those of the pages behind it, a whole page at a time while they fit
+ * and the largest part that fits of the first page that doesn't. Pages left
+ * empty are unlinked and given back to the buffer pool.
+ * The encode of a page, and each pull of the tuples of a page behind it
+ * along with its unlink, is an operation of its own logging the pages it
+ * changes whole (see page_logger.h), as a step of Vacuum is. The indexes
+ * follow a step once it is committed
+ */
+void TableHeap::Compress(Transaction *txn, const RelocateCallback &relocate) {
+  if (!is_pax_)
+    return;
+  latch_.WLock();
+  std::vector<Tuple> tuples, next_tuples, candidate;
+  std::vector<RID> rids, next_rids;
+  // tuples of the page are packed into its first slots
+  auto relocate_from = [&](page_id_t page_id, size_t first) {
+    RID new_rid;
+    for (size_t i = first; relocate && i < tuples.size(); i++) {
+      new_rid.Set(page_id, i);
+      if (!(new_rid == rids[i]))
+        relocate(tuples[i], rids[i], new_rid);
+    }
+  };
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID &&
+         txn->GetState() != TransactionState::ABORTED) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    assert(page != nullptr);
+    page->WLatch();
+    PaxPage *pax_page = page->AsPaxPage();
+    bool is_encoded;
+    {
+      PageLogger page_logger(log_manager_);
+      page_logger.LogWhole(buffer_pool_manager_->FetchPage(page_id));
+      // a page with a pending delete, a tuple locked by another transaction,
+      // or tuples that do not shrink, stays
+      is_encoded = ReadTuples(page, tuples, rids, txn) &&
+                   pax_page->GetEncodedSize(tuples) <= PAGE_SIZE &&
+                   pax_page->Encode(tuples);
+      buffer_pool_manager_->UnpinPage(page_id, is_encoded);
+      page_logger.Commit();
+    }
+    if (is_encoded)
+      relocate_from(page_id, 0);
+
+    page_id_t next_page_id = page->GetNextPageId();
+    while (is_encoded && next_page_id != INVALID_PAGE_ID) {
+      size_t first = tuples.size();
+      size_t low = 0, moved = 0;
+      bool is_deleted;
+      page_id_t after_page_id;
+      int32_t free_space;
+      {
+        // a page is pinned twice in the step, the pin taken for the page
+        // logger goes first, while the page is still latched
+        PageLogger page_logger(log_manager_);
+        page_logger.LogWhole(buffer_pool_manager_->FetchPage(page_id));
+        auto next_page = static_cast<TablePage *>(
+            buffer_pool_manager_->FetchPage(next_page_id));
+        assert(next_page != nullptr);
+        next_page->WLatch();
+        page_logger.LogWhole(buffer_pool_manager_->FetchPage(next_page_id));
+        ReadTuples(next_page, next_tuples, next_rids, txn);
+        // largest count of tuples that fit along with those of page
+        auto fits = [&](size_t count) {
+          candidate = tuples;
+          candidate.insert(candidate.end(), next_tuples.begin(),
+                           next_tuples.begin() + count);
+          return pax_page->GetEncodedSize(candidate) <= PAGE_SIZE;
+        };
+        size_t high = next_tuples.size();
+        while (low < high) {
+          size_t mid = (low + high + 1) / 2;
+          if (fits(mid))
+            low = mid;
+          else
+            high = mid - 1;
+        }
+        for (; moved < low; moved++) {
+          if (!next_page->MarkDelete(next_rids[moved], txn, lock_manager_,
+                                     nullptr))
+            break;
+          next_page->ApplyDelete(next_rids[moved], txn, nullptr);
+          tuples.push_back(next_tuples[moved]);
+          rids.push_back(next_rids[moved]);
+        }
+        if (moved > 0) {
+          bool is_done = pax_page->Encode(tuples);
+          assert(is_done);
+          (void)is_done;
+        }
+
+        is_deleted = next_page->IsEmpty();
+        after_page_id = next_page->GetNextPageId();
+        if (is_deleted) {
+          page->SetNextPageId(after_page_id);
+          if (after_page_id != INVALID_PAGE_ID) {
+            auto after_page = static_cast<TablePage *>(
+                buffer_pool_manager_->FetchPage(after_page_id));
+            assert(after_page != nullptr);
+            after_page->WLatch();
+            page_logger.LogWhole(
+                buffer_pool_manager_->FetchPage(after_page_id));
+            after_page->SetPrevPageId(page_id);
+            buffer_pool_manager_->UnpinPage(after_page_id, true);
+            after_page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(after_page_id, false);
+          } else {
+            free_space_map_->SetLastPageId(page_id);
+          }
+        }
+        free_space = is_deleted ? 0 : next_page->GetFreeSpaceSize();
+        buffer_pool_manager_->UnpinPage(next_page_id, true);
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        page_logger.Commit();
+        next_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(next_page_id, false);
+      }
+      relocate_from(page_id, first);
+      free_space_map_->Update(next_page_id, free_space);
+      if (is_deleted)
+        buffer_pool_manager_->DeletePage(next_page_id);
+      if (!is_deleted || moved < low)
+        break;
+      next_page_id = after_page_id;
+    }
+
+    int32_t free_space = page->GetFreeSpaceSize();
+    page_id_t following_page_id = page->GetNextPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    free_space_map_->Update(page_id, free_space);
+    page_id = following_page_id;
+  }
+  latch_.WUnlock();
+}
+
+bool TableHeap::ReadTuples(TablePage *page, std::vector<Tuple> &tuples,
+                           std::vector<RID> &rids, Transaction *txn) {
+  tuples.clear();
+  rids.clear();
+  bool is_all_read = true;
   RID rid;
-  // if failed (no tuple), rid will be the result of default
-  // constructor, which means eof
-  page->GetFirstTupleRid(rid);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid, txn);
+  bool has_next = page->GetFirstTupleRid(rid);
+  while (has_next) {
+    tuples.emplace_back();
+    if (page->GetTuple(rid, tuples.back(), txn, lock_manager_)) {
+      rids.push_back(rid);
+    } else {
+      tuples.pop_back();
+      is_all_read = false;
+    }
+    has_next = page->GetNextTupleRid(rid, rid);
+  }
+  return is_all_read;
+}
+
+TableIterator TableHeap::begin(Transaction *txn) {
+  // stand before the first slot, the first page may hold no tuple
+  TableIterator itr(this, RID(), txn);
+  itr.rid_.Set(first_page_id_, -1);
+  itr.guard_ = ReadPageGuard(buffer_pool_manager_, first_page_id_);
+  assert(itr.guard_.IsValid());
+  ++itr;
+  return itr;
 }
 
 TableIterator TableHeap::end() {
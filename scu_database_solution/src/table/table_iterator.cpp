@@ -9,51 +9,76 @@
 namespace scudb {
 
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
-  if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
-  }
-};
+    : table_heap_(table_heap), rid_(rid), txn_(txn) {
+  Load();
+}
 
-const Tuple &TableIterator::operator*() {
-  assert(*this != table_heap_->end());
-  return *tuple_;
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_), rid_(other.rid_), txn_(other.txn_) {
+  Load();
 }
 
-Tuple *TableIterator::operator->() {
+TableIterator &TableIterator::operator=(const TableIterator &other) {
+  if (this == &other)
+    return *this;
+  // let go of the old page first, it may be the same one
+  guard_.Release();
+  table_heap_ = other.table_heap_;
+  rid_ = other.rid_;
+  txn_ = other.txn_;
+  Load();
+  return *this;
+}
+
+const TupleView &TableIterator::operator*() {
   assert(*this != table_heap_->end());
   return tuple_;
 }
 
+const TupleView *TableIterator::operator->() {
+  assert(*this != table_heap_->end());
+  return &tuple_;
+}
+
+/*
+ * Move to the next tuple of the page, or the first tuple of a following
+ * page. The next page is latched before the current one is released
+ */
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(
-      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr); // all pages are pinned
+  auto cur_page = guard_.As<TablePage>();
+  assert(cur_page != nullptr);
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 next_tuple_rid)) { // end of this page
+  if (!cur_page->GetNextTupleRid(rid_, next_tuple_rid)) { // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(
-          buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      ReadPageGuard next_guard(buffer_pool_manager, cur_page->GetNextPageId());
+      assert(next_guard.IsValid()); // all pages are pinned
+      guard_ = std::move(next_guard);
+      cur_page = guard_.As<TablePage>();
       if (cur_page->GetFirstTupleRid(next_tuple_rid))
         break;
     }
   }
-  tuple_->rid_ = next_tuple_rid;
+  rid_ = next_tuple_rid;
 
-  if (*this != table_heap_->end()) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+  if (rid_.GetPageId() == INVALID_PAGE_ID) {
+    guard_.Release();
+    return *this;
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
+  if (!cur_page->GetTupleView(rid_, tuple_, txn_,
+                              table_heap_->lock_manager_) &&
+      ENABLE_LOGGING && txn_->GetState() != TransactionState::ABORTED) {
+    // locked by another transaction, wait with the page unlatched. The
+    // tuple may be gone by then, look for it from the slot before
+    guard_.Release();
+    table_heap_->LockTuple(rid_, txn_, false);
+    guard_ = ReadPageGuard(buffer_pool_manager, rid_.GetPageId());
+    assert(guard_.IsValid());
+    rid_.Set(rid_.GetPageId(), rid_.GetSlotNum() - 1);
+    return ++(*this);
+  }
+  tuple_.SetBufferPoolManager(buffer_pool_manager);
   return *this;
 }
 
@@ -63,4 +88,14 @@ TableIterator TableIterator::operator++(int) {
   return clone;
 }
 
+void TableIterator::Load() {
+  if (rid_.GetPageId() == INVALID_PAGE_ID)
+    return;
+  guard_ = ReadPageGuard(table_heap_->buffer_pool_manager_, rid_.GetPageId());
+  assert(guard_.IsValid()); // all pages are pinned
+  guard_.As<TablePage>()->GetTupleView(rid_, tuple_, txn_,
+                                       table_heap_->lock_manager_);
+  tuple_.SetBufferPoolManager(table_heap_->buffer_pool_manager_);
+}
+
 } // namespace scudb
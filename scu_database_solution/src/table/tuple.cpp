@@ -6,7 +6,10 @@
 #include <cstdlib>
 #include <sstream>
 
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "common/logger.h"
+#include "page/overflow_page.h"
 #include "table/tuple.h"
 
 namespace scudb {
@@ -40,12 +43,15 @@ Tuple::Tuple(std::vector<Value> values, Schema *schema) : allocated_(true) {
 
 // Copy constructor
 Tuple::Tuple(const Tuple &other)
-    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_),
+      overflow_page_id_(other.overflow_page_id_),
+      is_overflow_read_(other.is_overflow_read_),
+      buffer_pool_manager_(other.buffer_pool_manager_) {
   // deep copy
   if (allocated_ == true) {
     // LOG_DEBUG("tuple deep copy");
     data_ = new char[size_];
-    memcpy(data_, other.data_, size_);
+    memcpy(data_, other.data_, other.GetReadSize());
   } else {
     // LOG_DEBUG("tuple shallow copy");
     data_ = other.data_;
@@ -53,14 +59,21 @@ Tuple::Tuple(const Tuple &other)
 }
 
 Tuple &Tuple::operator=(const Tuple &other) {
+  if (this == &other)
+    return *this;
+  if (allocated_)
+    delete[] data_;
   allocated_ = other.allocated_;
   rid_ = other.rid_;
   size_ = other.size_;
+  overflow_page_id_ = other.overflow_page_id_;
+  is_overflow_read_ = other.is_overflow_read_;
+  buffer_pool_manager_ = other.buffer_pool_manager_;
   // deep copy
   if (allocated_ == true) {
     // LOG_DEBUG("tuple deep copy");
     data_ = new char[size_];
-    memcpy(data_, other.data_, size_);
+    memcpy(data_, other.data_, other.GetReadSize());
   } else {
     // LOG_DEBUG("tuple shallow copy");
     data_ = other.data_;
@@ -69,6 +82,32 @@ Tuple &Tuple::operator=(const Tuple &other) {
   return *this;
 }
 
+Tuple::Tuple(Tuple &&other)
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_),
+      data_(other.data_), overflow_page_id_(other.overflow_page_id_),
+      is_overflow_read_(other.is_overflow_read_),
+      buffer_pool_manager_(other.buffer_pool_manager_) {
+  other.allocated_ = false;
+  other.data_ = nullptr;
+}
+
+Tuple &Tuple::operator=(Tuple &&other) {
+  if (this == &other)
+    return *this;
+  if (allocated_)
+    delete[] data_;
+  allocated_ = other.allocated_;
+  rid_ = other.rid_;
+  size_ = other.size_;
+  data_ = other.data_;
+  overflow_page_id_ = other.overflow_page_id_;
+  is_overflow_read_ = other.is_overflow_read_;
+  buffer_pool_manager_ = other.buffer_pool_manager_;
+  other.allocated_ = false;
+  other.data_ = nullptr;
+  return *this;
+}
+
 // Get the value of a specified column (const)
 Value Tuple::GetValue(Schema *schema, const int column_id) const {
   assert(schema);
@@ -83,18 +122,49 @@ const char *Tuple::GetDataPtr(Schema *schema, const int column_id) const {
   assert(schema);
   assert(data_);
   bool is_inlined = schema->IsInlined(column_id);
+  int32_t offset = schema->GetOffset(column_id);
   // for inline type, data are stored where they are
-  if (is_inlined)
-    return (data_ + schema->GetOffset(column_id));
-  else {
+  if (is_inlined) {
+    ReadUntil(offset + Type::GetTypeSize(schema->GetType(column_id)));
+    return (data_ + offset);
+  } else {
     // step1: read relative offset from tuple data
-    int32_t offset =
-        *reinterpret_cast<int32_t *>(data_ + schema->GetOffset(column_id));
+    ReadUntil(offset + sizeof(int32_t));
+    offset = *reinterpret_cast<int32_t *>(data_ + offset);
     // step 2: return beginning address of the real data for VARCHAR type
+    ReadUntil(offset + sizeof(uint32_t));
+    uint32_t length = *reinterpret_cast<uint32_t *>(data_ + offset);
+    if (length != PELOTON_VALUE_NULL)
+      ReadUntil(offset + sizeof(uint32_t) + length);
     return (data_ + offset);
   }
 }
 
+/*
+ * Read the bytes behind the head from the chain of overflow pages, the
+ * pages may be gone if the tuple has been deleted since it was read
+ */
+void Tuple::ReadOverflow() const {
+  assert(buffer_pool_manager_ != nullptr);
+  page_id_t page_id = overflow_page_id_;
+  int32_t offset = TUPLE_INLINE_SIZE;
+  while (offset < size_) {
+    assert(page_id != INVALID_PAGE_ID);
+    auto page =
+        static_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      throw Exception("all page are pinned");
+    page->RLatch();
+    assert(offset + page->GetDataSize() <= size_);
+    page->ReadData(data_ + offset);
+    offset += page->GetDataSize();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = page->GetNextPageId();
+  }
+  is_overflow_read_ = true;
+}
+
 std::string Tuple::ToString(Schema *schema) const {
   std::stringstream os;
 
@@ -121,6 +191,7 @@ std::string Tuple::ToString(Schema *schema) const {
 }
 
 void Tuple::SerializeTo(char *storage) const {
+  ReadUntil(size_);
   memcpy(storage, &size_, sizeof(int32_t));
   memcpy(storage + sizeof(int32_t), data_, size_);
 }
@@ -134,6 +205,48 @@ void Tuple::DeserializeFrom(const char *storage) {
   this->data_ = new char[this->size_];
   memcpy(this->data_, storage + sizeof(int32_t), this->size_);
   this->allocated_ = true;
+  this->overflow_page_id_ = INVALID_PAGE_ID;
+}
+
+int32_t Tuple::GetLogLength() const {
+  return overflow_page_id_ == INVALID_PAGE_ID
+             ? size_
+             : sizeof(page_id_t) + TUPLE_INLINE_SIZE;
+}
+
+/*
+ * A head is told apart by its negated size, the overflow pages are logged
+ * when they are written
+ */
+void Tuple::SerializeLogTo(char *storage) const {
+  if (overflow_page_id_ == INVALID_PAGE_ID) {
+    SerializeTo(storage);
+    return;
+  }
+  int32_t size = -size_;
+  memcpy(storage, &size, sizeof(int32_t));
+  memcpy(storage + sizeof(int32_t), &overflow_page_id_, sizeof(page_id_t));
+  memcpy(storage + sizeof(int32_t) + sizeof(page_id_t), data_,
+         TUPLE_INLINE_SIZE);
+}
+
+void Tuple::DeserializeLogFrom(const char *storage) {
+  int32_t size = *reinterpret_cast<const int32_t *>(storage);
+  if (size >= 0) {
+    DeserializeFrom(storage);
+    return;
+  }
+  if (this->allocated_)
+    delete[] this->data_;
+  // room for the whole tuple, the rest may be read from overflow pages
+  this->size_ = -size;
+  this->data_ = new char[this->size_];
+  this->overflow_page_id_ =
+      *reinterpret_cast<const page_id_t *>(storage + sizeof(int32_t));
+  memcpy(this->data_, storage + sizeof(int32_t) + sizeof(page_id_t),
+         TUPLE_INLINE_SIZE);
+  this->allocated_ = true;
+  this->is_overflow_read_ = false;
 }
 
 } // namespace scudb
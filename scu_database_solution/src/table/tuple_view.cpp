@@ -0,0 +1,76 @@
+/**
+ * tuple_view.cpp
+ */
+
+#include <cassert>
+
+#include "page/pax_page.h"
+#include "table/tuple_view.h"
+
+namespace scudb {
+
+Value TupleView::GetValue(Schema *schema, const int column_id) const {
+  assert(schema);
+  if (pax_page_ != nullptr)
+    return pax_page_->GetValue(rid_.GetSlotNum(), column_id);
+  assert(data_);
+  const TypeId column_type = schema->GetType(column_id);
+  const char *data_ptr = GetDataPtr(schema, column_id);
+  if (data_ptr == nullptr) {
+    if (!overflow_tuple_)
+      overflow_tuple_.reset(new Tuple(ToTuple()));
+    return overflow_tuple_->GetValue(schema, column_id);
+  }
+  if (column_type != TypeId::VARCHAR)
+    return Value::DeserializeFrom(data_ptr, column_type);
+  // borrow the bytes instead of copying them like Value::DeserializeFrom
+  uint32_t length = *reinterpret_cast<const uint32_t *>(data_ptr);
+  if (length == PELOTON_VALUE_NULL)
+    return Value(column_type, nullptr, length, false);
+  return Value(column_type, data_ptr + sizeof(uint32_t), length, false);
+}
+
+Tuple TupleView::ToTuple() const {
+  Tuple tuple;
+  tuple.allocated_ = true;
+  tuple.rid_ = rid_;
+  tuple.size_ = size_;
+  tuple.data_ = new char[size_];
+  if (pax_page_ != nullptr) {
+    pax_page_->ReadTuple(rid_.GetSlotNum(), tuple.data_);
+    return tuple;
+  }
+  tuple.overflow_page_id_ = overflow_page_id_;
+  tuple.buffer_pool_manager_ = buffer_pool_manager_;
+  memcpy(tuple.data_, data_, tuple.GetReadSize());
+  return tuple;
+}
+
+/*
+ * Same layout as Tuple::GetDataPtr, but a column that ends behind the head
+ * of a tuple with overflow pages is not read
+ * @return: nullptr if the column is not in the view
+ */
+const char *TupleView::GetDataPtr(Schema *schema, const int column_id) const {
+  int32_t view_size =
+      overflow_page_id_ == INVALID_PAGE_ID ? size_ : TUPLE_INLINE_SIZE;
+  int32_t offset = schema->GetOffset(column_id);
+  if (schema->IsInlined(column_id)) {
+    if (offset + (int32_t)Type::GetTypeSize(schema->GetType(column_id)) >
+        view_size)
+      return nullptr;
+    return data_ + offset;
+  }
+  if (offset + (int32_t)sizeof(int32_t) > view_size)
+    return nullptr;
+  offset = *reinterpret_cast<const int32_t *>(data_ + offset);
+  if (offset + (int32_t)sizeof(uint32_t) > view_size)
+    return nullptr;
+  uint32_t length = *reinterpret_cast<const uint32_t *>(data_ + offset);
+  if (length != PELOTON_VALUE_NULL &&
+      offset + (int32_t)sizeof(uint32_t) + (int32_t)length > view_size)
+    return nullptr;
+  return data_ + offset;
+}
+
+} // namespace scudb
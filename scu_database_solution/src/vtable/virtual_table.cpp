@@ -10,6 +10,7 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/string_utility.h"
+#include "logging/page_logger.h"
 #include "page/header_page.h"
 #include "vtable/virtual_table.h"
 
@@ -20,10 +21,17 @@ SQLITE_EXTENSION_INIT1
 /* API implementation */
 int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
                sqlite3_vtab **ppVtab, char **pzErr) {
+  if (storage_engine_->replica_ != nullptr) {
+    *pzErr = sqlite3_mprintf("replica is read-only");
+    return SQLITE_READONLY;
+  }
   BufferPoolManager *buffer_pool_manager =
       storage_engine_->buffer_pool_manager_;
   LockManager *lock_manager = storage_engine_->lock_manager_;
   LogManager *log_manager = storage_engine_->log_manager_;
+  // the pages of the new table and its root in the header page are logged,
+  // a replica finds the table in its own pages
+  PageLogger page_logger(log_manager);
 
   // fetch header page from buffer pool
   HeaderPage *header_page =
@@ -36,23 +44,48 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   schema_string = schema_string.substr(1, (schema_string.size() - 2));
   Schema *schema = ParseCreateStatement(schema_string);
 
-  // parse arg[4](string that defines table index)
+  // parse arg[4](string that defines table index), 'pax' in its place or
+  // behind it stores the table in PAX format
   Index *index = nullptr;
-  if (argc > 4) {
-    std::string index_string(argv[4]);
-    index_string = index_string.substr(1, (index_string.size() - 2));
-    // create index object, allocate memory space
-    IndexMetadata *index_metadata =
-        ParseIndexStatement(index_string, std::string(argv[2]), schema);
-    index = ConstructIndex(index_metadata, buffer_pool_manager);
+  bool is_pax = false;
+  for (int i = 4; i < argc; i++) {
+    std::string arg_string(argv[i]);
+    arg_string = arg_string.substr(1, (arg_string.size() - 2));
+    if (arg_string == "pax") {
+      is_pax = true;
+    } else if (index == nullptr) {
+      // create index object, allocate memory space
+      IndexMetadata *index_metadata =
+          ParseIndexStatement(arg_string, std::string(argv[2]), schema);
+      // included columns are only worth keeping whole
+      if (!index_metadata->GetIncludeAttrs().empty() &&
+          !index_metadata->IsEntryWhole()) {
+        *pzErr = sqlite3_mprintf("included columns don't fit in index key");
+        delete index_metadata;
+        delete schema;
+        buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
+        return SQLITE_ERROR;
+      }
+      index = ConstructIndex(index_metadata, buffer_pool_manager,
+                             INVALID_PAGE_ID, log_manager);
+    }
+  }
+  if (is_pax && PaxPage::GetSlotCount(schema) == 0) {
+    *pzErr = sqlite3_mprintf("table too wide for PAX pages");
+    delete index;
+    delete schema;
+    buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
+    return SQLITE_ERROR;
   }
   // create table object, allocate memory space
-  VirtualTable *table = new VirtualTable(schema, buffer_pool_manager,
-                                         lock_manager, log_manager, index);
+  VirtualTable *table =
+      new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
+                       index, INVALID_PAGE_ID, is_pax);
 
   // insert table root page info into header page
   header_page->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
   buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, true);
+  page_logger.Commit();
 
   // register virtual table within sqlite system
   schema_string = "CREATE TABLE X(" + schema_string + ");";
@@ -81,18 +114,24 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
       static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
   page_id_t table_root_id;
   header_page->GetRootId(std::string(argv[2]), table_root_id);
-  // parse arg[4](string that defines table index)
+  // parse arg[4](string that defines table index), pages tell the format.
+  // A replica scans the table, the root of an index moves on the primary
   Index *index = nullptr;
-  if (argc > 4) {
-    std::string index_string(argv[4]);
+  for (int i = 4;
+       i < argc && index == nullptr && storage_engine_->replica_ == nullptr;
+       i++) {
+    std::string index_string(argv[i]);
     index_string = index_string.substr(1, (index_string.size() - 2));
+    if (index_string == "pax")
+      continue;
     // create index object, allocate memory space
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
     // Retrieve index root page info from header page
     page_id_t index_root_id;
     header_page->GetRootId(index_metadata->GetName(), index_root_id);
-    index = ConstructIndex(index_metadata, buffer_pool_manager, index_root_id);
+    index = ConstructIndex(index_metadata, buffer_pool_manager, index_root_id,
+                           log_manager);
   }
   VirtualTable *table =
       new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
@@ -111,45 +150,109 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
  * we only support
  * (1) equlity check. e.g select * from foo where a = 1
  * (2) indexed column == predicated column
+ * (3) range check on a single column tree index. e.g select * from foo
+ *     where a between 1 and 10 (bounds are inclusive, sqlite double checks
+ *     them)
+ * when all the columns the statement uses are stored in the index, the scan
+ * is answered from index entries without reading the table heap
  */
 int VtabBestIndex(sqlite3_vtab *tab, sqlite3_index_info *pIdxInfo) {
   // LOG_DEBUG("VtabBestIndex");
   VirtualTable *table = reinterpret_cast<VirtualTable *>(tab);
-  if (table->GetIndex() == nullptr)
-    return SQLITE_OK;
-  const std::vector<int> key_attrs = table->GetIndex()->GetKeyAttrs();
-  // make sure indexed column == predicate column
-  // e.g select * from foo where a = 1 and b =2; indexed column must be {a,b}
-  if (pIdxInfo->nConstraint != (int)(key_attrs.size()))
+  Index *index = table->GetIndex();
+  if (index == nullptr)
     return SQLITE_OK;
+  const std::vector<int> key_attrs = index->GetKeyAttrs();
+  int idx_num = 0;
 
+  // make sure every indexed column has an equality predicate
+  // e.g select * from foo where a = 1 and b =2; indexed column must be {a,b}
+  // constraint of every indexed column, argv follows key schema order
+  std::vector<int> key_constraints(key_attrs.size(), -1);
   int counter = 0;
-  bool is_index_scan = true;
   for (int i = 0; i < pIdxInfo->nConstraint; i++) {
-    if (pIdxInfo->aConstraint[i].usable == 0)
+    if (pIdxInfo->aConstraint[i].usable == 0 ||
+        pIdxInfo->aConstraint[i].op != SQLITE_INDEX_CONSTRAINT_EQ)
       continue;
     int item = pIdxInfo->aConstraint[i].iColumn;
-    // if predicate column is part of indexed column
-    if (std::find(key_attrs.begin(), key_attrs.end(), item) !=
-        key_attrs.end()) {
-      // equlity check
-      if (pIdxInfo->aConstraint[i].op != SQLITE_INDEX_CONSTRAINT_EQ) {
-        is_index_scan = false;
+    auto it = std::find(key_attrs.begin(), key_attrs.end(), item);
+    int k = it - key_attrs.begin();
+    if (it != key_attrs.end() && key_constraints[k] == -1) {
+      key_constraints[k] = i;
+      counter++;
+    }
+  }
+  if (counter == (int)key_attrs.size()) {
+    for (int k = 0; k < counter; k++)
+      pIdxInfo->aConstraintUsage[key_constraints[k]].argvIndex = (k + 1);
+    idx_num = INDEX_SCAN_EQUAL;
+    pIdxInfo->estimatedCost = 1;
+  }
+
+  if (idx_num == 0 && key_attrs.size() == 1 &&
+      index->GetMetadata()->IsOrdered()) {
+    int lower = -1, upper = -1;
+    for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+      if (pIdxInfo->aConstraint[i].usable == 0 ||
+          pIdxInfo->aConstraint[i].iColumn != key_attrs[0])
+        continue;
+      switch (pIdxInfo->aConstraint[i].op) {
+      case SQLITE_INDEX_CONSTRAINT_GT:
+      case SQLITE_INDEX_CONSTRAINT_GE:
+        lower = (lower == -1) ? i : lower;
+        break;
+      case SQLITE_INDEX_CONSTRAINT_LT:
+      case SQLITE_INDEX_CONSTRAINT_LE:
+        upper = (upper == -1) ? i : upper;
+        break;
+      default:
         break;
       }
-      pIdxInfo->aConstraintUsage[i].argvIndex = (i + 1);
-      counter++;
     }
+    int argv_index = 0;
+    if (lower != -1) {
+      pIdxInfo->aConstraintUsage[lower].argvIndex = ++argv_index;
+      idx_num |= INDEX_SCAN_LOWER;
+    }
+    if (upper != -1) {
+      pIdxInfo->aConstraintUsage[upper].argvIndex = ++argv_index;
+      idx_num |= INDEX_SCAN_UPPER;
+    }
+    if (idx_num != 0)
+      pIdxInfo->estimatedCost = (argv_index == 2) ? 100 : 1000;
   }
 
-  if (counter == (int)key_attrs.size() && is_index_scan) {
-    pIdxInfo->idxNum = 1;
+  if (idx_num != 0 && IsIndexCovering(index, pIdxInfo->colUsed)) {
+    idx_num |= INDEX_ONLY_SCAN;
+    pIdxInfo->estimatedCost /= 2;
   }
+  pIdxInfo->idxNum = idx_num;
   return SQLITE_OK;
 }
 
+// a write of the transaction failed, roll back what it did in table heap
+// and end it
+static int AbortTransaction(sqlite3_vtab *pVTab) {
+  Transaction *transaction = GetTransaction();
+  storage_engine_->transaction_manager_->Abort(transaction);
+  delete transaction;
+  global_transaction_ = nullptr;
+  if (storage_engine_->replica_ != nullptr)
+    storage_engine_->replica_->RUnlock();
+  if (pVTab != nullptr) {
+    sqlite3_free(pVTab->zErrMsg);
+    pVTab->zErrMsg = sqlite3_mprintf("transaction aborted");
+  }
+  return SQLITE_ABORT;
+}
+
 int VtabDisconnect(sqlite3_vtab *pVtab) {
   VirtualTable *virtual_table = reinterpret_cast<VirtualTable *>(pVtab);
+  if (GetTransaction() != nullptr && !FlushInserts())
+    AbortTransaction(nullptr);
+  pending_tables_.erase(std::remove(pending_tables_.begin(),
+                                    pending_tables_.end(), virtual_table),
+                        pending_tables_.end());
   delete virtual_table;
   // delete all the global managers
   delete storage_engine_;
@@ -158,10 +261,22 @@ int VtabDisconnect(sqlite3_vtab *pVtab) {
 
 int VtabOpen(sqlite3_vtab *pVtab, sqlite3_vtab_cursor **ppCursor) {
   // LOG_DEBUG("VtabOpen");
-  // if read operation, begin transaction here
-  if (global_transaction_ == nullptr) {
+  // if read operation, begin transaction here. On a replica it holds the
+  // replica latch, the statement sees one lsn
+  LogReplica *replica = storage_engine_->replica_;
+  if (global_transaction_ == nullptr && replica != nullptr) {
+    replica->RLock();
+    if (replica->GetAppliedLSN() == INVALID_LSN) {
+      replica->RUnlock();
+      return SQLITE_BUSY;
+    }
+    global_transaction_ = storage_engine_->transaction_manager_->Begin();
+  } else if (global_transaction_ == nullptr) {
     VtabBegin(pVtab);
   }
+  // the scan has to see rows inserted so far
+  if (!FlushInserts())
+    return AbortTransaction(pVtab);
   VirtualTable *virtual_table = reinterpret_cast<VirtualTable *>(pVtab);
   Cursor *cursor = new Cursor(virtual_table);
   *ppCursor = reinterpret_cast<sqlite3_vtab_cursor *>(cursor);
@@ -172,9 +287,10 @@ int VtabOpen(sqlite3_vtab *pVtab, sqlite3_vtab_cursor **ppCursor) {
 int VtabClose(sqlite3_vtab_cursor *cur) {
   // LOG_DEBUG("VtabClose");
   Cursor *cursor = reinterpret_cast<Cursor *>(cur);
+  // release the pages held by the cursor before commit writes to them
+  delete cursor;
   // if read operation, commit transaction here
   VtabCommit(nullptr);
-  delete cursor;
   return SQLITE_OK;
 }
 
@@ -190,13 +306,31 @@ int VtabFilter(sqlite3_vtab_cursor *pVtabCursor, int idxNum, const char *idxStr,
   Cursor *cursor = reinterpret_cast<Cursor *>(pVtabCursor);
   Schema *key_schema;
   // if indexed scan
-  if (idxNum == 1) {
+  if (idxNum & INDEX_SCAN_EQUAL) {
     cursor->SetScanFlag(true);
+    cursor->SetIndexOnly(idxNum & INDEX_ONLY_SCAN);
     // Construct the tuple for point query
     key_schema = cursor->GetKeySchema();
     Tuple scan_tuple = ConstructTuple(key_schema, argv);
     cursor->ScanKey(scan_tuple);
+  } else if (idxNum & (INDEX_SCAN_LOWER | INDEX_SCAN_UPPER)) {
+    cursor->SetScanFlag(true);
+    cursor->SetIndexOnly(idxNum & INDEX_ONLY_SCAN);
+    // Construct the tuples for range query, lower bound comes first
+    key_schema = cursor->GetKeySchema();
+    bool has_lower = idxNum & INDEX_SCAN_LOWER;
+    bool has_upper = idxNum & INDEX_SCAN_UPPER;
+    Tuple low_key = has_lower ? ConstructTuple(key_schema, argv) : Tuple();
+    Tuple high_key =
+        has_upper ? ConstructTuple(key_schema, argv + has_lower) : Tuple();
+    cursor->ScanRange(has_lower ? &low_key : nullptr,
+                      has_upper ? &high_key : nullptr);
+  } else {
+    cursor->SetScanFlag(false);
+    cursor->ScanTable();
   }
+  if (cursor->IsAborted())
+    return AbortTransaction(pVtabCursor->pVtab);
   return SQLITE_OK;
 }
 
@@ -204,6 +338,8 @@ int VtabNext(sqlite3_vtab_cursor *cur) {
   // LOG_DEBUG("VtabNext");
   Cursor *cursor = reinterpret_cast<Cursor *>(cur);
   ++(*cursor);
+  if (cursor->IsAborted())
+    return AbortTransaction(cur->pVtab);
   return SQLITE_OK;
 }
 
@@ -219,6 +355,8 @@ int VtabColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int i) {
   // get column type and value
   TypeId type = schema->GetType(i);
   Value v = cursor->GetCurrentValue(schema, i);
+  if (cursor->IsAborted())
+    return AbortTransaction(cur->pVtab);
 
   switch (type) {
   case TypeId::TINYINT:
@@ -254,10 +392,22 @@ int VtabRowid(sqlite3_vtab_cursor *cur, sqlite3_int64 *pRowid) {
   return SQLITE_OK;
 }
 
+// a row whose index entry can't be kept whole is refused
+static int EntryTooLong(sqlite3_vtab *pVTab) {
+  sqlite3_free(pVTab->zErrMsg);
+  pVTab->zErrMsg =
+      sqlite3_mprintf("value longer than declared for a column of the index");
+  return SQLITE_CONSTRAINT;
+}
+
 int VtabUpdate(sqlite3_vtab *pVTab, int argc, sqlite3_value **argv,
                sqlite_int64 *pRowid) {
   // LOG_DEBUG("VtabUpdate");
   VirtualTable *table = reinterpret_cast<VirtualTable *>(pVTab);
+  // deleted and updated rows may still be buffered
+  if ((argc == 1 || sqlite3_value_type(argv[0]) != SQLITE_NULL) &&
+      !FlushInserts())
+    return AbortTransaction(pVTab);
   // The single row with rowid equal to argv[0] is deleted
   if (argc == 1) {
     const RID rid(sqlite3_value_int64(argv[0]));
@@ -272,17 +422,19 @@ int VtabUpdate(sqlite3_vtab *pVTab, int argc, sqlite3_value **argv,
   else if (argc > 1 && sqlite3_value_type(argv[0]) == SQLITE_NULL) {
     Schema *schema = table->GetSchema();
     Tuple tuple = ConstructTuple(schema, (argv + 2));
-    // insert into table heap
-    RID rid;
-    table->InsertTuple(tuple, rid);
-    // insert into index
-    table->InsertEntry(tuple, rid);
+    if (table->IsEntryTooLong(tuple))
+      return EntryTooLong(pVTab);
+    // insert into table heap and index, along with the following rows
+    if (!table->BufferInsert(tuple))
+      return AbortTransaction(pVTab);
   }
   // The row with rowid argv[0] is updated with new values in argv[2] and
   // following parameters.
   else if (argc > 1 && sqlite3_value_type(argv[0]) != SQLITE_NULL) {
     Schema *schema = table->GetSchema();
     Tuple tuple = ConstructTuple(schema, (argv + 2));
+    if (table->IsEntryTooLong(tuple))
+      return EntryTooLong(pVTab);
     RID rid(sqlite3_value_int64(argv[0]));
     // for update, index always delete and insert
     // because you have no clue key has been updated or not
@@ -301,6 +453,13 @@ int VtabUpdate(sqlite3_vtab *pVTab, int argc, sqlite3_value **argv,
 
 int VtabBegin(sqlite3_vtab *pVTab) {
   // LOG_DEBUG("VtabBegin");
+  // sqlite begins a transaction to write only
+  if (storage_engine_->replica_ != nullptr)
+    return SQLITE_READONLY;
+  // sqlite begins once for every table written, and a read may have begun
+  // the transaction already
+  if (global_transaction_ != nullptr)
+    return SQLITE_OK;
   // create new transaction(write operation will call this method)
   global_transaction_ = storage_engine_->transaction_manager_->Begin();
   return SQLITE_OK;
@@ -311,6 +470,9 @@ int VtabCommit(sqlite3_vtab *pVTab) {
   auto transaction = GetTransaction();
   if (transaction == nullptr)
     return SQLITE_OK;
+  // rows of a failed batch are rolled back, none of the transaction commits
+  if (!FlushInserts())
+    return AbortTransaction(pVTab);
   // get global txn manager
   auto transaction_manager = storage_engine_->transaction_manager_;
   // invoke transaction manager to commit(this txn can't fail)
@@ -318,6 +480,8 @@ int VtabCommit(sqlite3_vtab *pVTab) {
   // when commit, delete transaction pointer and set to null
   delete transaction;
   global_transaction_ = nullptr;
+  if (storage_engine_->replica_ != nullptr)
+    storage_engine_->replica_->RUnlock();
 
   return SQLITE_OK;
 }
@@ -358,23 +522,83 @@ __declspec(dllexport)
   struct stat buffer;
   bool is_file_exist = (stat(db_file_name.c_str(), &buffer) == 0);
 
+  // a new database starts a new log, the one of a removed database is not
+  // replayed onto it
+  if (!is_file_exist) {
+    remove("vtable.log");
+    remove("vtable.master");
+    remove("vtable.replica");
+  }
+
   // init storage engine
   storage_engine_ = new StorageEngine(db_file_name);
+  if (is_file_exist) {
+    // the pages on disk are as of the last crash or close, bring the
+    // committed transactions back and roll the others back
+    LogRecovery log_recovery(storage_engine_->disk_manager_,
+                             storage_engine_->buffer_pool_manager_,
+                             storage_engine_->log_manager_);
+    log_recovery.Redo(REDO_WORKER_COUNT);
+    log_recovery.Undo();
+  }
   // start the logging
   storage_engine_->log_manager_->RunFlushThread();
-  // create header page from BufferPoolManager if necessary
+  // create header page from BufferPoolManager if necessary, on disk before
+  // any page is allocated behind it
   if (!is_file_exist) {
     page_id_t header_page_id;
     storage_engine_->buffer_pool_manager_->NewPage(header_page_id);
 
     assert(header_page_id == HEADER_PAGE_ID);
     storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true);
+    storage_engine_->buffer_pool_manager_->FlushPage(header_page_id);
   }
+  // bound the log read by the next restart
+  storage_engine_->checkpoint_manager_->RunCheckpointThread(
+      CHECKPOINT_INTERVAL);
 
   int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
   return rc;
 }
 
+// replica_lag(): bytes of the primary's log the replica has not applied
+static void ReplicaLagFunc(sqlite3_context *ctx, int argc,
+                           sqlite3_value **argv) {
+  sqlite3_result_int64(ctx, storage_engine_->replica_->GetLagBytes());
+}
+
+// replica_lag_ms(): time since the replica had the primary's log applied
+static void ReplicaLagTimeFunc(sqlite3_context *ctx, int argc,
+                               sqlite3_value **argv) {
+  sqlite3_result_int64(ctx, storage_engine_->replica_->GetLagTime().count());
+}
+
+/*
+ * Entry point of a read-only replica of vtable.db, in a process of its own
+ * sharing the directory with the primary's. The replica opens the sqlite
+ * database of the primary for the table schemas, e.g.
+ *   sqlite3 -readonly primary.sqlite
+ *   .load ./libvtable sqlite3_vtablereplica_init
+ */
+#ifdef _WIN32
+__declspec(dllexport)
+#endif
+    extern "C" int sqlite3_vtablereplica_init(
+        sqlite3 *db, char **pzErrMsg, const sqlite3_api_routines *pApi) {
+  SQLITE_EXTENSION_INIT2(pApi);
+  // init storage engine, from a copy of the primary's pages
+  storage_engine_ = new StorageEngine("vtable_replica.db", "vtable.db");
+  // start following the log
+  storage_engine_->replica_->RunApplyThread(REPLICA_POLL_INTERVAL);
+
+  sqlite3_create_function(db, "replica_lag", 0, SQLITE_UTF8, nullptr,
+                          ReplicaLagFunc, nullptr, nullptr);
+  sqlite3_create_function(db, "replica_lag_ms", 0, SQLITE_UTF8, nullptr,
+                          ReplicaLagTimeFunc, nullptr, nullptr);
+  int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
+  return rc;
+}
+
 /* Helpers */
 Schema *ParseCreateStatement(const std::string &sql_base) {
   std::string::size_type n;
@@ -450,6 +674,49 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
   assert(n != std::string::npos);
   index_name = sql.substr(0, n);
   sql = sql.substr(n + 1);
+  // optional keywords in front of indexed column names
+  StringUtility::Trim(sql);
+  IndexType index_type = IndexType::BPLUSTREE;
+  if (StringUtility::StartsWith(sql, "using ")) {
+    sql = sql.substr(std::string("using ").size());
+    StringUtility::Trim(sql);
+    if (StringUtility::StartsWith(sql, "betree "))
+      index_type = IndexType::BETREE;
+    else if (StringUtility::StartsWith(sql, "hash "))
+      index_type = IndexType::HASH;
+    else if (!StringUtility::StartsWith(sql, "btree "))
+      throw Exception(EXCEPTION_TYPE_INDEX, "unknown index type");
+    sql = sql.substr(sql.find_first_of(' ') + 1);
+    StringUtility::Trim(sql);
+  }
+  bool is_unique = true;
+  if (StringUtility::StartsWith(sql, "nonunique ")) {
+    is_unique = false;
+    sql = sql.substr(std::string("nonunique ").size());
+  }
+
+  // optional include(column names) behind indexed column names
+  std::vector<int> include_attrs;
+  n = sql.find("include");
+  if (n != std::string::npos) {
+    std::string::size_type begin = sql.find_first_of('(', n);
+    std::string::size_type end = sql.find_first_of(')', n);
+    if (begin == std::string::npos || end == std::string::npos || end < begin)
+      throw Exception(EXCEPTION_TYPE_INDEX, "can't create index, format error");
+    std::vector<std::string> tok =
+        StringUtility::Split(sql.substr(begin + 1, end - begin - 1), ',');
+    for (std::string &t : tok) {
+      column_id = schema->GetColumnID(t);
+      if (column_id != -1)
+        include_attrs.emplace_back(column_id);
+    }
+    sql = sql.substr(0, n);
+  }
+  if (!is_unique && !include_attrs.empty())
+    throw Exception(EXCEPTION_TYPE_INDEX,
+                    "nonunique index can't include columns");
+  if (!is_unique && index_type != IndexType::BPLUSTREE)
+    throw Exception(EXCEPTION_TYPE_INDEX, "only btree index can be nonunique");
 
   std::vector<std::string> tok = StringUtility::Split(sql, ',');
   // iterate through returned result
@@ -462,8 +729,9 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
   if ((int)key_attrs.size() > schema->GetColumnCount())
     throw Exception(EXCEPTION_TYPE_INDEX, "can't create index, format error");
 
-  IndexMetadata *metadata =
-      new IndexMetadata(index_name, table_name, schema, key_attrs);
+  IndexMetadata *metadata = new IndexMetadata(
+      index_name, table_name, schema, key_attrs, is_unique, include_attrs,
+      index_type);
 
   // LOG_DEBUG("%s", metadata->ToString().c_str());
   return metadata;
@@ -504,34 +772,81 @@ Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
   return tuple;
 }
 
+// construct the index of metadata's type on keys of KeySize bytes
+template <size_t KeySize>
+Index *ConstructIndex(IndexMetadata *metadata,
+                      BufferPoolManager *buffer_pool_manager,
+                      page_id_t root_id, LogManager *log_manager) {
+  typedef GenericKey<KeySize> KeyType;
+  typedef GenericComparator<KeySize> KeyComparator;
+  switch (metadata->GetIndexType()) {
+  case IndexType::BETREE:
+    return new BETreeIndex<KeyType, RID, KeyComparator>(
+        metadata, buffer_pool_manager, root_id, log_manager);
+  case IndexType::HASH:
+    return new ExtendibleHashIndex<KeyType, RID, KeyComparator,
+                                   GenericHashFunction<KeySize>>(
+        metadata, buffer_pool_manager, root_id, log_manager);
+  default:
+    return new BPlusTreeIndex<KeyType, RID, KeyComparator>(
+        metadata, buffer_pool_manager, root_id, log_manager);
+  }
+}
+
 // serve the functionality of index factory
 Index *ConstructIndex(IndexMetadata *metadata,
                       BufferPoolManager *buffer_pool_manager,
-                      page_id_t root_id) {
-  // The size of the key in bytes
-  Schema *key_schema = metadata->GetKeySchema();
-  int key_size = key_schema->GetLength();
-  // for each varchar attribute, we assume the largest size is 16 bytes
-  key_size += 16 * key_schema->GetUnlinedColumnCount();
+                      page_id_t root_id, LogManager *log_manager) {
+  // The size of the key in bytes, included columns are stored in key as well.
+  // Varchar attributes take their declared length, longer entries than
+  // MAX_KEY_SIZE are cut off
+  int key_size = metadata->GetMaxEntryLength();
 
   if (key_size <= 4) {
-    return new BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>(
-        metadata, buffer_pool_manager, root_id);
+    return ConstructIndex<4>(metadata, buffer_pool_manager, root_id,
+                              log_manager);
   } else if (key_size <= 8) {
-    return new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
-        metadata, buffer_pool_manager, root_id);
+    return ConstructIndex<8>(metadata, buffer_pool_manager, root_id,
+                              log_manager);
   } else if (key_size <= 16) {
-    return new BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(
-        metadata, buffer_pool_manager, root_id);
+    return ConstructIndex<16>(metadata, buffer_pool_manager, root_id,
+                               log_manager);
   } else if (key_size <= 32) {
-    return new BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>(
-        metadata, buffer_pool_manager, root_id);
+    return ConstructIndex<32>(metadata, buffer_pool_manager, root_id,
+                               log_manager);
   } else {
-    return new BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>(
-        metadata, buffer_pool_manager, root_id);
+    return ConstructIndex<64>(metadata, buffer_pool_manager, root_id,
+                               log_manager);
   }
 }
 
+// whether all the columns in column_mask(bit i for column i, bit 63 for
+// column 63 and beyond) are stored whole in the entries of index
+bool IsIndexCovering(Index *index, sqlite3_uint64 column_mask) {
+  if (!index->GetMetadata()->IsEntryWhole())
+    return false;
+  const std::vector<int> &entry_attrs = index->GetEntryAttrs();
+  for (int i = 0; i < 64; i++) {
+    if ((column_mask & ((sqlite3_uint64)1 << i)) == 0)
+      continue;
+    if (i == 63 ||
+        std::find(entry_attrs.begin(), entry_attrs.end(), i) ==
+            entry_attrs.end())
+      return false;
+  }
+  return true;
+}
+
 Transaction *GetTransaction() { return global_transaction_; }
 
+// insert the rows buffered by all the tables
+// @return: false if the transaction is aborted, nothing is buffered anymore
+bool FlushInserts() {
+  bool is_flushed = true;
+  for (auto table : pending_tables_)
+    is_flushed = table->Flush() && is_flushed;
+  pending_tables_.clear();
+  return is_flushed;
+}
+
 } // namespace scudb
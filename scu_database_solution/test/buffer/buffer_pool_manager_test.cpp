@@ -2,7 +2,11 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <atomic>
 #include <cstdio>
+#include <cstring>
+#include <future>
+#include <thread>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -99,4 +103,108 @@ namespace scudb {
         remove("test.db");
     }
 
+    /*
+     * A dirty page is not written before its log records: the least recently
+     * used page is passed over while another page can go, and written after
+     * the log when it is the only one left
+     */
+    TEST(BufferPoolManagerTest, WriteAheadLogTest) {
+        DiskManager *disk_manager = new DiskManager("test.db");
+        LogManager *log_manager = new LogManager(disk_manager);
+        BufferPoolManager bpm(2, disk_manager, log_manager);
+        page_id_t page_ids[2];
+        lsn_t lsns[2];
+        for (int i = 0; i < 2; ++i) {
+            Page *page = bpm.NewPage(page_ids[i]);
+            ASSERT_NE(nullptr, page);
+            LogRecord log_record(0, INVALID_LSN, LogRecordType::BEGIN);
+            lsns[i] = log_manager->AppendLogRecord(log_record);
+            page->SetLSN(lsns[i]);
+            if (i == 0)
+                log_manager->Flush(lsns[i]);
+        }
+        // page 1, not logged yet, is the least recently used
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[1], true));
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[0], true));
+
+        page_id_t temp_page_id;
+        EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+        EXPECT_EQ(1, bpm.GetNumWALSkips());
+        EXPECT_EQ(0, bpm.GetNumWALStalls());
+        EXPECT_LT(log_manager->GetPersistentLSN(), lsns[1]);
+
+        // page 1 is the only page to go
+        EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+        EXPECT_EQ(1, bpm.GetNumWALStalls());
+        EXPECT_LE(lsns[1], log_manager->GetPersistentLSN());
+        char data[PAGE_SIZE];
+        disk_manager->ReadPage(page_ids[1], data);
+        EXPECT_EQ(lsns[1], *reinterpret_cast<lsn_t *>(data + 4));
+
+        delete log_manager;
+        delete disk_manager;
+        remove("test.db");
+        remove("test.log");
+    }
+
+    /*
+     * Only a page whose page LSN was set waits for the log, whatever the
+     * bytes of another page are at that offset. A WAL stall lets go of the
+     * latch: pages are fetched while the log is written
+     */
+    TEST(BufferPoolManagerTest, WALStallTest) {
+        DiskManager *disk_manager = new DiskManager("test.db");
+        LogManager *log_manager = new LogManager(disk_manager);
+        BufferPoolManager bpm(2, disk_manager, log_manager);
+        page_id_t page_ids[2];
+        lsn_t lsns[2];
+        for (int i = 0; i < 2; ++i) {
+            Page *page = bpm.NewPage(page_ids[i]);
+            ASSERT_NE(nullptr, page);
+            LogRecord log_record(0, INVALID_LSN, LogRecordType::BEGIN);
+            lsns[i] = log_manager->AppendLogRecord(log_record);
+            if (i == 0)
+                memcpy(page->GetData() + 4, &lsns[i], sizeof(lsn_t));
+            else
+                page->SetLSN(lsns[i]);
+        }
+        // page 0 keeps no page LSN, it goes although its log is not on disk
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[0], true));
+        page_id_t temp_page_id;
+        EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+        EXPECT_EQ(0, bpm.GetNumWALSkips());
+        EXPECT_EQ(0, bpm.GetNumWALStalls());
+        EXPECT_LT(log_manager->GetPersistentLSN(), lsns[0]);
+
+        // page 1 is the only page to go, its log is written by the flush
+        // thread once the promise is kept
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[1], true));
+        std::promise<void> promise;
+        std::future<void> future = promise.get_future();
+        disk_manager->SetFlushLogFuture(&future);
+        log_manager->RunFlushThread();
+        std::atomic<bool> done(false);
+        std::thread stalled([&] {
+            page_id_t page_id;
+            EXPECT_NE(nullptr, bpm.NewPage(page_id));
+            done = true;
+        });
+        while (bpm.GetNumWALStalls() == 0)
+            std::this_thread::yield();
+        EXPECT_NE(nullptr, bpm.FetchPage(temp_page_id));
+        EXPECT_TRUE(bpm.UnpinPage(temp_page_id, false));
+        EXPECT_FALSE(done);
+        promise.set_value();
+        stalled.join();
+        EXPECT_EQ(1, bpm.GetNumWALStalls());
+        EXPECT_LE(lsns[1], log_manager->GetPersistentLSN());
+        log_manager->StopFlushThread();
+        disk_manager->SetFlushLogFuture(nullptr);
+
+        delete log_manager;
+        delete disk_manager;
+        remove("test.db");
+        remove("test.log");
+    }
+
 } // namespace scudb
@@ -40,4 +40,26 @@ TEST(LockManagerTest, BasicTest) {
   t0.join();
   t1.join();
 }
+
+// a lock that can not be granted at once is refused, only a younger
+// transaction is aborted for it
+TEST(LockManagerTest, TryLockTest) {
+  LockManager lock_mgr{true};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid{0, 0};
+  Transaction old_txn(0), txn(1), young_txn(2);
+
+  EXPECT_TRUE(lock_mgr.TryLockShared(&txn, rid));
+  EXPECT_TRUE(lock_mgr.TryLockShared(&old_txn, rid));
+  EXPECT_FALSE(lock_mgr.TryLockUpgrade(&old_txn, rid));
+  EXPECT_EQ(TransactionState::GROWING, old_txn.GetState());
+  txn_mgr.Commit(&txn);
+  EXPECT_TRUE(lock_mgr.TryLockUpgrade(&old_txn, rid));
+
+  EXPECT_FALSE(lock_mgr.TryLockShared(&young_txn, rid));
+  EXPECT_EQ(TransactionState::ABORTED, young_txn.GetState());
+  txn_mgr.Abort(&young_txn);
+  txn_mgr.Commit(&old_txn);
+  EXPECT_TRUE(old_txn.GetExclusiveLockSet()->empty());
+}
 } // namespace scudb
@@ -0,0 +1,256 @@
+/**
+ * b_plus_tree_index_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree_index.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+namespace {
+Tuple MakeKey(int64_t value, Schema *key_schema) {
+  std::vector<Value> values{Value(TypeId::BIGINT, value)};
+  return Tuple(values, key_schema);
+}
+} // namespace
+
+TEST(BPlusTreeIndexTests, NonUniqueTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b int");
+  IndexMetadata *metadata =
+      new IndexMetadata("foo_a", "foo", schema, {0}, false);
+  Schema *key_schema = metadata->GetKeySchema();
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  auto *index = new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      metadata, bpm);
+
+  // 10 keys, 500 rids each, inserted out of order so that posting lists
+  // grow both at the tail and in the middle
+  auto key_of = [](const RID &rid) {
+    return (int64_t)(rid.GetPageId() * 7 + rid.GetSlotNum()) % 10;
+  };
+  std::vector<RID> all;
+  for (int i = 0; i < 5000; i++)
+    all.emplace_back(i / 7, i % 7);
+  std::mt19937 gen(0);
+  std::shuffle(all.begin(), all.end(), gen);
+  for (auto &rid : all)
+    index->InsertEntry(MakeKey(key_of(rid), key_schema), rid);
+  // duplicate entries are ignored
+  index->InsertEntry(MakeKey(key_of(all[0]), key_schema), all[0]);
+
+  std::vector<RID> result;
+  for (int64_t key = 0; key < 10; key++) {
+    result.clear();
+    index->ScanKey(MakeKey(key, key_schema), result);
+    EXPECT_EQ(500, result.size());
+    for (size_t i = 0; i < result.size(); i++) {
+      EXPECT_EQ(key, key_of(result[i]));
+      if (i > 0) {
+        EXPECT_LT(result[i - 1].Get(), result[i].Get());
+      }
+    }
+  }
+
+  // remove all but one rid of every key, the last one goes back inline
+  std::shuffle(all.begin(), all.end(), gen);
+  std::vector<RID> kept(10);
+  for (auto &rid : all) {
+    int64_t key = key_of(rid);
+    if (kept[key].GetPageId() == INVALID_PAGE_ID) {
+      kept[key] = rid;
+      continue;
+    }
+    index->DeleteEntry(MakeKey(key, key_schema), rid);
+  }
+  for (int64_t key = 0; key < 10; key++) {
+    result.clear();
+    index->ScanKey(MakeKey(key, key_schema), result);
+    EXPECT_EQ(1, result.size());
+    EXPECT_EQ(kept[key], result[0]);
+    index->DeleteEntry(MakeKey(key, key_schema), kept[key]);
+    result.clear();
+    index->ScanKey(MakeKey(key, key_schema), result);
+    EXPECT_EQ(0, result.size());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete index;
+  delete schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Range scans of a unique index along with inserts and deletes that split
+ * and merge its leaves. Keys never deleted are seen by every scan, in order
+ */
+TEST(BPlusTreeIndexTests, UniqueRangeScanTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b int");
+  IndexMetadata *metadata =
+      new IndexMetadata("foo_a", "foo", schema, {0}, true);
+  Schema *key_schema = metadata->GetKeySchema();
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  auto *index = new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      metadata, bpm);
+
+  // even keys stay, odd keys come and go
+  const int64_t key_count = 2000;
+  for (int64_t key = 0; key < key_count; key += 2)
+    index->InsertEntry(MakeKey(key, key_schema), RID(key, 0));
+  std::thread writer([&] {
+    for (int round = 0; round < 3; round++) {
+      for (int64_t key = 1; key < key_count; key += 2)
+        index->InsertEntry(MakeKey(key, key_schema), RID(key, 0));
+      for (int64_t key = 1; key < key_count; key += 2)
+        index->DeleteEntry(MakeKey(key, key_schema), RID(key, 0));
+    }
+  });
+  for (int scan = 0; scan < 20; scan++) {
+    std::vector<RID> result;
+    std::vector<std::vector<Value>> entries;
+    index->ScanRange(nullptr, nullptr, result, &entries);
+    int64_t next_even = 0;
+    int64_t prev_key = -1;
+    for (auto &entry : entries) {
+      int64_t key = entry[0].GetAs<int64_t>();
+      EXPECT_LT(prev_key, key);
+      if (key % 2 == 0) {
+        EXPECT_EQ(next_even, key);
+        next_even = key + 2;
+      }
+      prev_key = key;
+    }
+    EXPECT_EQ(key_count, next_even);
+  }
+  writer.join();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete index;
+  delete schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Benchmark: a low cardinality column (100 distinct values) over many rows,
+ * indexed by a non-unique index with posting lists versus a unique B+ tree
+ * on the composite key (value, rid). Reports the number of pages allocated
+ * and the time to scan every key.
+ */
+TEST(BPlusTreeIndexTests, DISABLED_PostingListBenchmark) {
+  const int64_t row_count = 10000000;
+  const int64_t distinct_count = 100;
+  const int slot_per_page = 16;
+
+  Schema *schema = ParseCreateStatement("a bigint, b bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  // non-unique index on a
+  IndexMetadata *metadata =
+      new IndexMetadata("foo_a", "foo", schema, {0}, false);
+  Schema *key_schema = metadata->GetKeySchema();
+  auto *index = new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      metadata, bpm);
+  page_id_t first_page_id;
+  bpm->NewPage(first_page_id);
+  bpm->UnpinPage(first_page_id, false);
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < row_count; i++) {
+    RID rid(i / slot_per_page, i % slot_per_page);
+    index->InsertEntry(MakeKey(i % distinct_count, key_schema), rid);
+  }
+  auto end = std::chrono::steady_clock::now();
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(page_id, false);
+  std::cout << "posting list: " << page_id - first_page_id - 1 << " pages, "
+            << "insert "
+            << std::chrono::duration<double>(end - start).count() << "s, ";
+  std::vector<RID> result;
+  start = std::chrono::steady_clock::now();
+  for (int64_t key = 0; key < distinct_count; key++) {
+    result.clear();
+    index->ScanKey(MakeKey(key, key_schema), result);
+    EXPECT_EQ(row_count / distinct_count, result.size());
+  }
+  end = std::chrono::steady_clock::now();
+  std::cout << "scan " << std::chrono::duration<double>(end - start).count()
+            << "s" << std::endl;
+
+  // unique index on (a, rid)
+  IndexMetadata *composite_metadata =
+      new IndexMetadata("foo_a_rid", "foo", schema, {0, 1});
+  Schema *composite_schema = composite_metadata->GetKeySchema();
+  GenericComparator<16> comparator(composite_schema);
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree(
+      "foo_a_rid", bpm, comparator);
+  first_page_id = page_id;
+  GenericKey<16> index_key;
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < row_count; i++) {
+    RID rid(i / slot_per_page, i % slot_per_page);
+    std::vector<Value> values{Value(TypeId::BIGINT, i % distinct_count),
+                              Value(TypeId::BIGINT, rid.Get())};
+    index_key.SetFromKey(Tuple(values, composite_schema));
+    tree.Insert(index_key, rid);
+  }
+  end = std::chrono::steady_clock::now();
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(page_id, false);
+  std::cout << "composite key: " << page_id - first_page_id - 1 << " pages, "
+            << "insert "
+            << std::chrono::duration<double>(end - start).count() << "s, ";
+  start = std::chrono::steady_clock::now();
+  for (int64_t key = 0; key < distinct_count; key++) {
+    std::vector<Value> values{Value(TypeId::BIGINT, key),
+                              Value(TypeId::BIGINT, (int64_t)0)};
+    index_key.SetFromKey(Tuple(values, composite_schema));
+    size_t count = 0;
+    for (auto it = tree.Begin(index_key); !it.isEnd(); ++it) {
+      RID rid = (*it).second;
+      int64_t row = (int64_t)rid.GetPageId() * slot_per_page +
+                    rid.GetSlotNum();
+      if (row % distinct_count != key)
+        break;
+      count++;
+    }
+    EXPECT_EQ(row_count / distinct_count, count);
+  }
+  end = std::chrono::steady_clock::now();
+  std::cout << "scan " << std::chrono::duration<double>(end - start).count()
+            << "s" << std::endl;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete composite_metadata;
+  delete index;
+  delete schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace scudb
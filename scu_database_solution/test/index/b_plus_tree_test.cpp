@@ -390,4 +390,78 @@ TEST(BPlusTreeTests, ScaleTest) {
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, InsertBatchTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+
+  // odd keys go in one by one, then a sorted batch of all keys with
+  // duplicates of its own
+  for (int64_t key = 1; key < 1000; key += 2) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  std::vector<std::pair<GenericKey<8>, RID>> items;
+  for (int64_t key = 0; key < 1000; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set(1, key);
+    items.emplace_back(index_key, rid);
+    if (key % 100 == 0)
+      items.emplace_back(index_key, rid);
+  }
+  std::vector<bool> inserted;
+  tree.InsertBatch(items, inserted, transaction);
+  ASSERT_EQ(items.size(), inserted.size());
+  size_t inserted_count = 0;
+  for (size_t i = 0; i < items.size(); i++) {
+    if (!inserted[i])
+      continue;
+    inserted_count++;
+    EXPECT_EQ(0, items[i].second.GetSlotNum() % 2);
+  }
+  EXPECT_EQ(500, inserted_count);
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 1000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, rids));
+    ASSERT_EQ(1, rids.size());
+    EXPECT_EQ(key % 2 == 0 ? 1 : 0, rids[0].GetPageId());
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+  }
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); !iterator.isEnd(); ++iterator)
+    EXPECT_EQ(current_key++, (*iterator).second.GetSlotNum());
+  EXPECT_EQ(1000, current_key);
+
+  // a batch starts an empty tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> new_tree("foo_new", bpm,
+                                                               comparator);
+  new_tree.InsertBatch(items, inserted, transaction);
+  current_key = 0;
+  for (auto iterator = new_tree.Begin(); !iterator.isEnd(); ++iterator)
+    EXPECT_EQ(current_key++, (*iterator).second.GetSlotNum());
+  EXPECT_EQ(1000, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 } // namespace scudb
@@ -0,0 +1,147 @@
+/**
+ * be_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "index/be_tree.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(BETreeTests, InsertDeleteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  BETree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                        comparator);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // random inserts, overwrites and deletes checked against std::map
+  std::map<int64_t, RID> expected;
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int64_t> key_dist(0, 4999);
+  GenericKey<8> index_key;
+  for (int i = 0; i < 30000; i++) {
+    int64_t key = key_dist(gen);
+    index_key.SetFromInteger(key);
+    if (i % 3 == 2) {
+      tree.Remove(index_key);
+      expected.erase(key);
+    } else {
+      RID rid(i, key % 100);
+      tree.Insert(index_key, rid);
+      expected[key] = rid;
+    }
+  }
+  EXPECT_FALSE(tree.IsEmpty());
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 5000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    auto it = expected.find(key);
+    EXPECT_EQ(it != expected.end(), tree.GetValue(index_key, rids));
+    if (it != expected.end()) {
+      EXPECT_EQ(1, rids.size());
+      EXPECT_EQ(it->second, rids[0]);
+    }
+  }
+
+  // full scan and bounded range scan
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  tree.GetRange(nullptr, nullptr, entries);
+  EXPECT_EQ(expected.size(), entries.size());
+  auto it = expected.begin();
+  for (size_t i = 0; i < entries.size() && it != expected.end(); i++, it++) {
+    EXPECT_EQ(it->first, entries[i].first.ToValue(key_schema, 0)
+                             .GetAs<int64_t>());
+    EXPECT_EQ(it->second, entries[i].second);
+  }
+  GenericKey<8> low_key, high_key;
+  low_key.SetFromInteger(1000);
+  high_key.SetFromInteger(1999);
+  entries.clear();
+  tree.GetRange(&low_key, &high_key, entries);
+  EXPECT_EQ(std::distance(expected.lower_bound(1000),
+                          expected.upper_bound(1999)),
+            (long)entries.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Benchmark: ingest random keys into a B+ tree and a B-epsilon tree with
+ * buffer pools of several sizes, reports time and pages read/written.
+ */
+TEST(BETreeTests, DISABLED_IngestBenchmark) {
+  const int64_t key_count = 1000000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  std::vector<int64_t> keys(key_count);
+  for (int64_t i = 0; i < key_count; i++)
+    keys[i] = i;
+  std::mt19937 gen(0);
+  std::shuffle(keys.begin(), keys.end(), gen);
+
+  for (size_t pool_size : {16, 64, 256}) {
+    for (int is_betree = 0; is_betree < 2; is_betree++) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+      page_id_t page_id;
+      bpm->NewPage(page_id);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> bplus_tree(
+          "foo_pk", bpm, comparator);
+      BETree<GenericKey<8>, RID, GenericComparator<8>> be_tree(
+          "foo_pk", bpm, comparator);
+      GenericKey<8> index_key;
+      auto start = std::chrono::steady_clock::now();
+      for (int64_t key : keys) {
+        index_key.SetFromInteger(key);
+        RID rid((int32_t)(key >> 32), (int32_t)key);
+        if (is_betree)
+          be_tree.Insert(index_key, rid);
+        else
+          bplus_tree.Insert(index_key, rid);
+      }
+      auto end = std::chrono::steady_clock::now();
+      std::cout << (is_betree ? "betree" : "b+tree") << ", pool " << pool_size
+                << ": insert "
+                << std::chrono::duration<double>(end - start).count()
+                << "s, reads " << disk_manager->GetNumReads() << ", writes "
+                << disk_manager->GetNumWrites() << std::endl;
+
+      // spot check
+      std::vector<RID> rids;
+      index_key.SetFromInteger(keys[0]);
+      EXPECT_TRUE(is_betree ? be_tree.GetValue(index_key, rids)
+                            : bplus_tree.GetValue(index_key, rids));
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+} // namespace scudb
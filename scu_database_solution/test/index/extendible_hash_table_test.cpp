@@ -0,0 +1,158 @@
+/**
+ * extendible_hash_table_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "index/extendible_hash_table.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(ExtendibleHashTableTests, InsertDeleteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  GenericHashFunction<8> hash_fn(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  auto *table =
+      new ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>,
+                              GenericHashFunction<8>>("foo_pk", bpm,
+                                                      comparator, hash_fn);
+  EXPECT_TRUE(table->IsEmpty());
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 20000; key++)
+    keys.push_back(key);
+  std::mt19937 gen(0);
+  std::shuffle(keys.begin(), keys.end(), gen);
+  GenericKey<8> index_key;
+  for (int64_t key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table->Insert(index_key, RID((int32_t)key, 0)));
+  }
+  // duplicate key is rejected
+  index_key.SetFromInteger(keys[0]);
+  EXPECT_FALSE(table->Insert(index_key, RID(0, 1)));
+  // 20000 keys need more than one directory page
+  EXPECT_GT(1u << table->GetGlobalDepth(), DIRECTORY_SLOT_COUNT);
+
+  // remove the odd keys
+  for (int64_t key : keys) {
+    if (key % 2 == 1) {
+      index_key.SetFromInteger(key);
+      table->Remove(index_key);
+    }
+  }
+
+  // reopen from the directory page registered in header page
+  delete table;
+  HeaderPage *header_page =
+      static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  page_id_t directory_page_id;
+  EXPECT_TRUE(header_page->GetRootId("foo_pk", directory_page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  table = new ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>,
+                                  GenericHashFunction<8>>(
+      "foo_pk", bpm, comparator, hash_fn, directory_page_id);
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 20000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 0, table->GetValue(index_key, rids));
+    if (key % 2 == 0) {
+      EXPECT_EQ(1, rids.size());
+      EXPECT_EQ(key, rids[0].GetPageId());
+    }
+  }
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  table->GetAll(entries);
+  EXPECT_EQ(10000, entries.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete table;
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Benchmark: point lookups of random keys on a B+ tree and on an extendible
+ * hash table holding the same keys, reports time and pages read per lookup.
+ */
+TEST(ExtendibleHashTableTests, DISABLED_PointLookupBenchmark) {
+  const int64_t key_count = 1000000;
+  const int lookup_count = 200000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  GenericHashFunction<8> hash_fn(key_schema);
+  std::vector<int64_t> keys(key_count);
+  for (int64_t i = 0; i < key_count; i++)
+    keys[i] = i;
+  std::mt19937 gen(0);
+  std::shuffle(keys.begin(), keys.end(), gen);
+
+  for (int is_hash = 0; is_hash < 2; is_hash++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>,
+                        GenericHashFunction<8>>
+        table("foo_pk", bpm, comparator, hash_fn);
+    GenericKey<8> index_key;
+    for (int64_t key : keys) {
+      index_key.SetFromInteger(key);
+      RID rid((int32_t)(key >> 32), (int32_t)key);
+      if (is_hash)
+        table.Insert(index_key, rid);
+      else
+        tree.Insert(index_key, rid);
+    }
+
+    std::uniform_int_distribution<int64_t> key_dist(0, key_count - 1);
+    int reads = disk_manager->GetNumReads();
+    std::vector<RID> rids;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookup_count; i++) {
+      index_key.SetFromInteger(key_dist(gen));
+      rids.clear();
+      bool found = is_hash ? table.GetValue(index_key, rids)
+                           : tree.GetValue(index_key, rids);
+      EXPECT_TRUE(found);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << (is_hash ? "hash" : "b+tree") << ": "
+              << std::chrono::duration<double, std::micro>(end - start)
+                         .count() /
+                     lookup_count
+              << "us per lookup, "
+              << (double)(disk_manager->GetNumReads() - reads) / lookup_count
+              << " page reads per lookup" << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+} // namespace scudb
@@ -1,14 +1,63 @@
+#include <algorithm>
 #include <chrono>
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
+#include "index/b_plus_tree.h"
+#include "index/be_tree.h"
+#include "index/extendible_hash_table.h"
 #include "logging/common.h"
 #include "logging/log_recovery.h"
+#include "logging/log_replica.h"
+#include "logging/page_logger.h"
+#include "page/header_page.h"
 #include "vtable/virtual_table.h"
 #include "gtest/gtest.h"
 
 namespace scudb {
 
+// types of the records in the log, each must have its offset as lsn.
+// Records of page logger operations (see page_logger.h) are left out
+static void ReadLogRecordTypes(DiskManager *disk_manager,
+                               std::vector<LogRecordType> &types) {
+  const int buffer_size = 2 * LOG_BUFFER_SIZE;
+  char buffer[buffer_size];
+  lsn_t offset = disk_manager->GetLogStart();
+  while (disk_manager->ReadLog(buffer, buffer_size, offset)) {
+    int pos = 0;
+    while (pos + 28 <= buffer_size) {
+      int32_t size = *reinterpret_cast<int32_t *>(buffer + pos);
+      if (size <= 0 || pos + size > buffer_size)
+        break;
+      EXPECT_EQ(offset + pos, *reinterpret_cast<lsn_t *>(buffer + pos + 4));
+      if (*reinterpret_cast<txn_id_t *>(buffer + pos + 12) >= INVALID_TXN_ID)
+        types.push_back(
+            *reinterpret_cast<LogRecordType *>(buffer + pos + 24));
+      pos += size;
+    }
+    if (pos == 0)
+      break;
+    offset += pos;
+  }
+}
+
+// the log and its segment files
+static void RemoveLog(const std::string &log_name) {
+  remove(log_name.c_str());
+  for (int i = 1;; i++) {
+    if (remove((log_name + "." + std::to_string(i)).c_str()) != 0)
+      break;
+  }
+}
+
 TEST(LogManagerTest, BasicLogging) {
   StorageEngine *storage_engine = new StorageEngine("test.db");
 
@@ -54,7 +103,7 @@ TEST(LogManagerTest, BasicLogging) {
   delete storage_engine;
   LOG_DEBUG("Teared down the system");
   remove("test.db");
-  remove("test.log");
+  RemoveLog("test.log");
 }
 
 // actually LogRecovery
@@ -105,6 +154,7 @@ TEST(LogManagerTest, RedoTestWithOneTxn) {
 
   log_recovery->Redo();
   log_recovery->Undo();
+  delete log_recovery;
 
   Tuple old_tuple;
   txn = storage_engine->transaction_manager_->Begin();
@@ -121,7 +171,2003 @@ TEST(LogManagerTest, RedoTestWithOneTxn) {
   delete storage_engine;
   LOG_DEBUG("Teared down the system");
   remove("test.db");
-  remove("test.log");
+  RemoveLog("test.log");
+}
+
+// tuple of "a bigint, b varchar(16)"
+static Tuple MakeTuple(Schema *schema, int64_t a, const std::string &b) {
+  std::vector<Value> values{Value(TypeId::BIGINT, a),
+                            Value(TypeId::VARCHAR, b)};
+  return Tuple(values, schema);
+}
+
+// value of column b of the tuple at rid, "" if there is none
+static std::string ReadTuple(StorageEngine *storage_engine,
+                             page_id_t first_page_id, Schema *schema,
+                             const RID &rid) {
+  TableHeap table(storage_engine->buffer_pool_manager_,
+                  storage_engine->lock_manager_, storage_engine->log_manager_,
+                  first_page_id);
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  Tuple tuple;
+  std::string b;
+  if (table.GetTuple(rid, tuple, txn))
+    b = tuple.GetValue(schema, 1).ToString();
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  return b;
+}
+
+/*
+ * Crash with committed transactions on both sides of a checkpoint and a
+ * transaction active across it, none of their pages written. Recovery
+ * starts from the checkpoint, redoes the committed changes and rolls back
+ * the rest; recovering again after a crash during recovery does the same
+ */
+TEST(LogManagerTest, CheckpointRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(5);
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, i, "old"), rids[i], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  EXPECT_NE(INVALID_LSN, storage_engine->checkpoint_manager_->Checkpoint());
+
+  txn = txn_manager->Begin();
+  EXPECT_TRUE(table->UpdateTuple(MakeTuple(schema, 0, "new"), rids[0], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // the loser, active during the second checkpoint
+  Transaction *loser = txn_manager->Begin();
+  RID loser_rid;
+  EXPECT_TRUE(
+      table->InsertTuple(MakeTuple(schema, 9, "loser"), loser_rid, loser));
+  EXPECT_TRUE(table->UpdateTuple(MakeTuple(schema, 1, "lost"), rids[1], loser));
+  lsn_t checkpoint_lsn = storage_engine->checkpoint_manager_->Checkpoint();
+  EXPECT_EQ(checkpoint_lsn, storage_engine->disk_manager_->ReadMasterRecord());
+  EXPECT_TRUE(table->MarkDelete(rids[2], loser));
+
+  txn = txn_manager->Begin();
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 4, "old"), rids[4], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  storage_engine->log_manager_->Flush(loser->GetPrevLSN());
+  delete loser;
+  delete table;
+  // crash: the buffer pool is not flushed
+  delete storage_engine;
+
+  for (int restart = 0; restart < 2; restart++) {
+    storage_engine = new StorageEngine("test.db");
+    LogRecovery *log_recovery =
+        new LogRecovery(storage_engine->disk_manager_,
+                        storage_engine->buffer_pool_manager_,
+                        storage_engine->log_manager_);
+    log_recovery->Redo();
+    log_recovery->Undo();
+    delete log_recovery;
+
+    EXPECT_EQ("new", ReadTuple(storage_engine, first_page_id, schema, rids[0]));
+    for (int i = 1; i < 5; i++)
+      EXPECT_EQ("old",
+                ReadTuple(storage_engine, first_page_id, schema, rids[i]));
+    EXPECT_EQ("", ReadTuple(storage_engine, first_page_id, schema, loser_rid));
+    // crash again, the changes of undo are in the log only
+    delete storage_engine;
+  }
+
+  // the loser is undone once, with a CLR for each of its changes
+  DiskManager *disk_manager = new DiskManager("test.db");
+  std::vector<LogRecordType> types;
+  ReadLogRecordTypes(disk_manager, types);
+  EXPECT_EQ(3, std::count(types.begin(), types.end(), LogRecordType::CLR));
+  EXPECT_EQ(1, std::count(types.begin(), types.end(), LogRecordType::ABORT));
+  delete disk_manager;
+
+  delete schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * A checkpoint leaves a pinned page alone, it may be in the middle of a
+ * change that is not logged yet. The page stays in the dirty page table, so
+ * recovery still redoes it
+ */
+TEST(LogManagerTest, CheckpointPinnedPageTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  BufferPoolManager *buffer_pool_manager = storage_engine->buffer_pool_manager_;
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table =
+      new TableHeap(buffer_pool_manager, storage_engine->lock_manager_,
+                    storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  RID rid;
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 1, "old"), rid, txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  EXPECT_NE(INVALID_LSN, storage_engine->checkpoint_manager_->Checkpoint());
+
+  // a change in progress, in the free space of the page
+  Page *page = buffer_pool_manager->FetchPage(first_page_id);
+  page->GetData()[PAGE_SIZE / 2] = 'x';
+  EXPECT_NE(INVALID_LSN, storage_engine->checkpoint_manager_->Checkpoint());
+  char data[PAGE_SIZE];
+  storage_engine->disk_manager_->ReadPage(first_page_id, data);
+  EXPECT_NE('x', data[PAGE_SIZE / 2]);
+  page->GetData()[PAGE_SIZE / 2] = 0;
+  buffer_pool_manager->UnpinPage(first_page_id, false);
+
+  // the unpinned page is written by the next one
+  EXPECT_NE(INVALID_LSN, storage_engine->checkpoint_manager_->Checkpoint());
+  storage_engine->disk_manager_->ReadPage(first_page_id, data);
+  EXPECT_EQ(0, memcmp(data, page->GetData(), PAGE_SIZE));
+  delete table;
+  // crash: the buffer pool is not flushed
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  EXPECT_EQ("old", ReadTuple(storage_engine, first_page_id, schema, rid));
+  delete storage_engine;
+
+  delete schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * An update keeping the length of a wide tuple logs the changed bytes only.
+ * Recovery redoes it onto the old tuple and undoes it from the new one
+ */
+TEST(LogManagerTest, DeltaUpdateTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(64)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string wide(60, 'x');
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(2);
+  for (int i = 0; i < 2; i++)
+    EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, i, wide), rids[i], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+
+  txn = txn_manager->Begin();
+  lsn_t lsn = storage_engine->log_manager_->GetNextLSN();
+  EXPECT_TRUE(
+      table->UpdateTuple(MakeTuple(schema, 0, "y" + wide.substr(1)), rids[0],
+                         txn));
+  // header, rid, tuple size, delta size and one range of a byte
+  EXPECT_EQ(28 + 8 + 4 + 4 + 5,
+            storage_engine->log_manager_->GetNextLSN() - lsn);
+  txn_manager->Commit(txn);
+  delete txn;
+
+  Transaction *loser = txn_manager->Begin();
+  EXPECT_TRUE(table->UpdateTuple(MakeTuple(schema, 7, wide), rids[1], loser));
+  storage_engine->log_manager_->Flush(loser->GetPrevLSN());
+  delete loser;
+  delete table;
+  // crash: the buffer pool is not flushed
+  delete storage_engine;
+
+  for (int restart = 0; restart < 2; restart++) {
+    storage_engine = new StorageEngine("test.db");
+    LogRecovery *log_recovery =
+        new LogRecovery(storage_engine->disk_manager_,
+                        storage_engine->buffer_pool_manager_,
+                        storage_engine->log_manager_);
+    log_recovery->Redo();
+    log_recovery->Undo();
+    delete log_recovery;
+
+    EXPECT_EQ("y" + wide.substr(1),
+              ReadTuple(storage_engine, first_page_id, schema, rids[0]));
+    TableHeap table(storage_engine->buffer_pool_manager_,
+                    storage_engine->lock_manager_,
+                    storage_engine->log_manager_, first_page_id);
+    txn_manager = storage_engine->transaction_manager_;
+    txn = txn_manager->Begin();
+    Tuple tuple;
+    EXPECT_TRUE(table.GetTuple(rids[1], tuple, txn));
+    EXPECT_EQ(1, tuple.GetValue(schema, 0).GetAs<int64_t>());
+    txn_manager->Commit(txn);
+    delete txn;
+    // crash again, the changes of undo are in the log only
+    delete storage_engine;
+  }
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  std::vector<LogRecordType> types;
+  ReadLogRecordTypes(disk_manager, types);
+  EXPECT_EQ(2, std::count(types.begin(), types.end(),
+                          LogRecordType::DELTAUPDATE));
+  EXPECT_EQ(1, std::count(types.begin(), types.end(), LogRecordType::CLR));
+  delete disk_manager;
+
+  delete schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * With a checkpoint now and then, the log is kept in a few segment files
+ * reused over and over. After a crash the segments are found again, from
+ * their headers, and recovery starts from the checkpoint in one of them
+ */
+TEST(LogManagerTest, LogSegmentTest) {
+  const int tuple_count = 40;
+  const int txn_count = 6000;
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(tuple_count);
+  for (int i = 0; i < tuple_count; i++)
+    table->InsertTuple(MakeTuple(schema, i, "0"), rids[i], txn);
+  txn_manager->Commit(txn);
+  delete txn;
+  for (int j = 0; j < txn_count; j++) {
+    txn = txn_manager->Begin();
+    EXPECT_TRUE(table->UpdateTuple(MakeTuple(schema, j, std::to_string(j % 10)),
+                                   rids[j % tuple_count], txn));
+    txn_manager->Commit(txn);
+    delete txn;
+    if (j % 500 == 499)
+      storage_engine->checkpoint_manager_->Checkpoint();
+  }
+  DiskManager *disk_manager = storage_engine->disk_manager_;
+  lsn_t log_start = disk_manager->GetLogStart();
+  lsn_t log_size = disk_manager->GetLogSize();
+  EXPECT_LT(4 * LOG_SEGMENT_SIZE, log_size);
+  EXPECT_LT(0, log_start);
+  EXPECT_GE(3, disk_manager->GetLogSegmentCount());
+  delete table;
+  // crash
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  EXPECT_EQ(log_start, storage_engine->disk_manager_->GetLogStart());
+  EXPECT_EQ(log_size, storage_engine->disk_manager_->GetLogSize());
+  LogRecovery *log_recovery =
+      new LogRecovery(storage_engine->disk_manager_,
+                      storage_engine->buffer_pool_manager_,
+                      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  for (int i = 0; i < tuple_count; i++)
+    EXPECT_EQ(std::to_string(i % 10),
+              ReadTuple(storage_engine, first_page_id, schema, rids[i]));
+  delete storage_engine;
+
+  delete schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * Lsns are 64 bits: a log going on past INT32_MAX keeps the offsets as
+ * lsns, and recovery compares them with page LSNs past it
+ */
+TEST(LogManagerTest, LogPastInt32Test) {
+  const int tuple_count = 20;
+  const int txn_count = 1000;
+  // the first segment starts a little before INT32_MAX, as in a log of more
+  // than 2 GiB truncated by checkpoints
+  const lsn_t log_start = INT32_MAX - LOG_SEGMENT_SIZE / 2;
+  {
+    std::ofstream log_io("test.log", std::ios::binary | std::ios::trunc);
+    lsn_t header[3] = {LOG_SEGMENT_MAGIC, log_start, log_start};
+    log_io.write(reinterpret_cast<char *>(header), sizeof(header));
+    std::vector<char> zeros(LOG_SEGMENT_SIZE, 0);
+    log_io.write(zeros.data(), zeros.size());
+  }
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  EXPECT_EQ(log_start, storage_engine->log_manager_->GetNextLSN());
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(tuple_count);
+  for (int i = 0; i < tuple_count; i++)
+    table->InsertTuple(MakeTuple(schema, i, "0"), rids[i], txn);
+  txn_manager->Commit(txn);
+  delete txn;
+  for (int j = 0; j < txn_count; j++) {
+    txn = txn_manager->Begin();
+    EXPECT_TRUE(table->UpdateTuple(MakeTuple(schema, j, std::to_string(j % 10)),
+                                   rids[j % tuple_count], txn));
+    txn_manager->Commit(txn);
+    delete txn;
+    if (j == txn_count / 2) {
+      EXPECT_LT(INT32_MAX, storage_engine->checkpoint_manager_->Checkpoint());
+    }
+  }
+
+  // the loser's change goes to disk, under a page LSN past INT32_MAX
+  Transaction *loser = txn_manager->Begin();
+  EXPECT_TRUE(table->UpdateTuple(MakeTuple(schema, 1, "lost"), rids[1], loser));
+  storage_engine->log_manager_->Flush(loser->GetPrevLSN());
+  EXPECT_TRUE(
+      storage_engine->buffer_pool_manager_->FlushPage(rids[1].GetPageId()));
+  char data[PAGE_SIZE];
+  storage_engine->disk_manager_->ReadPage(rids[1].GetPageId(), data);
+  lsn_t page_lsn;
+  memcpy(&page_lsn, data + 4, sizeof(lsn_t));
+  EXPECT_EQ(loser->GetPrevLSN(), page_lsn);
+  EXPECT_LT(INT32_MAX, page_lsn);
+  delete loser;
+  delete table;
+  // crash
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery =
+      new LogRecovery(storage_engine->disk_manager_,
+                      storage_engine->buffer_pool_manager_,
+                      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  for (int i = 0; i < tuple_count; i++)
+    EXPECT_EQ(std::to_string(i % 10),
+              ReadTuple(storage_engine, first_page_id, schema, rids[i]));
+  delete storage_engine;
+
+  // every record has its offset as lsn, the loser is undone once
+  DiskManager *disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(log_start, disk_manager->GetLogStart());
+  std::vector<LogRecordType> types;
+  ReadLogRecordTypes(disk_manager, types);
+  EXPECT_LT(txn_count, std::count(types.begin(), types.end(),
+                                  LogRecordType::COMMIT));
+  EXPECT_EQ(1, std::count(types.begin(), types.end(), LogRecordType::CLR));
+  delete disk_manager;
+
+  delete schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+static void CopyFile(const std::string &from, const std::string &to) {
+  std::ifstream in(from, std::ios::binary);
+  std::ofstream out(to, std::ios::binary | std::ios::trunc);
+  out << in.rdbuf();
+}
+
+static void CopyLog(const std::string &from, const std::string &to) {
+  RemoveLog(to);
+  CopyFile(from, to);
+  for (int i = 1;; i++) {
+    std::string suffix = "." + std::to_string(i);
+    if (!std::ifstream(from + suffix))
+      break;
+    CopyFile(from + suffix, to + suffix);
+  }
+}
+
+// committed inserts and updates (in place, same size) over many pages,
+// then a crash
+static void CrashWithManyPages(Schema *schema, int tuple_count,
+                               int update_count, page_id_t &first_page_id,
+                               std::vector<RID> &rids) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  first_page_id = table->GetFirstPageId();
+  txn_manager->Commit(txn);
+  delete txn;
+  rids.resize(tuple_count);
+  for (int i = 0; i < tuple_count; i += 10) {
+    txn = txn_manager->Begin();
+    for (int j = i; j < std::min(i + 10, tuple_count); j++)
+      table->InsertTuple(MakeTuple(schema, j, "0"), rids[j], txn);
+    txn_manager->Commit(txn);
+    delete txn;
+  }
+  for (int j = 0; j < update_count; j++) {
+    txn = txn_manager->Begin();
+    table->UpdateTuple(MakeTuple(schema, j, std::to_string(j % 10)),
+                       rids[j * 7 % tuple_count], txn);
+    txn_manager->Commit(txn);
+    delete txn;
+  }
+  delete table;
+  delete storage_engine;
+}
+
+/*
+ * Redo spread over workers brings back the same table as serial redo
+ */
+TEST(LogManagerTest, ParallelRedoTest) {
+  const int tuple_count = 400;
+  const int update_count = 200;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  page_id_t first_page_id;
+  std::vector<RID> rids;
+  CrashWithManyPages(schema, tuple_count, update_count, first_page_id, rids);
+  std::vector<std::string> expected(tuple_count, "0");
+  for (int j = 0; j < update_count; j++)
+    expected[j * 7 % tuple_count] = std::to_string(j % 10);
+  CopyFile("test.db", "test.db.crash");
+  CopyLog("test.log", "test.log.crash");
+
+  for (int worker_count : {1, 4, 16}) {
+    CopyFile("test.db.crash", "test.db");
+    CopyLog("test.log.crash", "test.log");
+    StorageEngine *storage_engine = new StorageEngine("test.db");
+    LogRecovery *log_recovery =
+        new LogRecovery(storage_engine->disk_manager_,
+                        storage_engine->buffer_pool_manager_,
+                        storage_engine->log_manager_);
+    log_recovery->Redo(worker_count);
+    log_recovery->Undo();
+    delete log_recovery;
+    for (int i = 0; i < tuple_count; i++)
+      EXPECT_EQ(expected[i],
+                ReadTuple(storage_engine, first_page_id, schema, rids[i]));
+    delete storage_engine;
+  }
+
+  delete schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.db.crash");
+  RemoveLog("test.log.crash");
+}
+
+/*
+ * Committers of many threads share the writes of the log, and each commit
+ * is on disk when Commit returns
+ */
+TEST(LogManagerTest, GroupCommitTest) {
+  const int thread_count = 8;
+  const int txn_count = 50;
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        storage_engine->log_manager_, txn);
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  int flushes = storage_engine->disk_manager_->GetNumFlushes();
+
+  Schema *schema = ParseCreateStatement("a varchar, b bigint");
+  std::vector<std::thread> threads;
+  std::vector<int> durable(thread_count, 0);
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < txn_count; ++j) {
+        Transaction *txn = storage_engine->transaction_manager_->Begin();
+        RID rid;
+        Tuple tuple = ConstructTuple(schema);
+        test_table->InsertTuple(tuple, rid, txn);
+        storage_engine->transaction_manager_->Commit(txn);
+        if (storage_engine->log_manager_->GetPersistentLSN() >=
+            txn->GetPrevLSN())
+          durable[i]++;
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  for (int i = 0; i < thread_count; ++i)
+    EXPECT_EQ(txn_count, durable[i]);
+  EXPECT_GE(thread_count * txn_count,
+            storage_engine->disk_manager_->GetNumFlushes() - flushes);
+  storage_engine->log_manager_->StopFlushThread();
+
+  // every record made it into the log, in lsn order
+  std::vector<LogRecordType> types;
+  ReadLogRecordTypes(storage_engine->disk_manager_, types);
+  int commits = std::count(types.begin(), types.end(), LogRecordType::COMMIT);
+  EXPECT_EQ(thread_count * txn_count + 1, commits);
+
+  delete schema;
+  delete test_table;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+}
+
+/*
+ * An asynchronous commit returns before its record is on disk, the flush
+ * thread writes it within the durability window, long before its timeout
+ */
+TEST(LogManagerTest, AsyncCommitTest) {
+  auto durability_window = DURABILITY_WINDOW;
+  DURABILITY_WINDOW = std::chrono::milliseconds(200);
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  LogManager *log_manager = storage_engine->log_manager_;
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  log_manager->RunFlushThread();
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *async_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                         storage_engine->lock_manager_,
+                                         log_manager, txn);
+  TableHeap *sync_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                        storage_engine->lock_manager_,
+                                        log_manager, txn);
+  txn_manager->Commit(txn);
+  delete txn;
+  async_table->SetAsyncCommit(true);
+  Schema *schema = ParseCreateStatement("a varchar, b bigint");
+  Tuple tuple = ConstructTuple(schema);
+  RID rid;
+
+  // asked for by the transaction, then by the only table written
+  for (int i = 0; i < 2; i++) {
+    txn = txn_manager->Begin();
+    txn->SetAsyncCommit(i == 0);
+    (i == 0 ? sync_table : async_table)->InsertTuple(tuple, rid, txn);
+    auto start = std::chrono::steady_clock::now();
+    txn_manager->Commit(txn);
+    EXPECT_LT(log_manager->GetPersistentLSN(), txn->GetPrevLSN());
+    EXPECT_LT(0, log_manager->GetPersistentLSNLag());
+    while (log_manager->GetPersistentLSN() < txn->GetPrevLSN())
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_GT(LOG_TIMEOUT, std::chrono::steady_clock::now() - start);
+    EXPECT_EQ(0, log_manager->GetPersistentLSNLag());
+    EXPECT_EQ(0, log_manager->GetAsyncCommitLag().count());
+    delete txn;
+  }
+
+  // a synchronous table written as well makes the commit synchronous
+  txn = txn_manager->Begin();
+  async_table->InsertTuple(tuple, rid, txn);
+  sync_table->InsertTuple(tuple, rid, txn);
+  txn_manager->Commit(txn);
+  EXPECT_LE(txn->GetPrevLSN(), log_manager->GetPersistentLSN());
+  delete txn;
+
+  log_manager->StopFlushThread();
+  delete schema;
+  delete async_table;
+  delete sync_table;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  DURABILITY_WINDOW = durability_window;
+}
+
+/*
+ * Asynchronous commits of threads updating a table larger than the buffer
+ * pool, the log is written when the log buffer fills up or when a page to
+ * evict waits for it. Every page on disk has its last record in the log
+ */
+TEST(LogManagerTest, WriteAheadLogTest) {
+  const int thread_count = 4;
+  const int tuple_count = 200;
+  const int txn_count = 100;
+  auto log_timeout = LOG_TIMEOUT;
+  auto durability_window = DURABILITY_WINDOW;
+  LOG_TIMEOUT = std::chrono::seconds(100);
+  DURABILITY_WINDOW = std::chrono::milliseconds(100000);
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(64)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string wide(60, 'x');
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  table->SetAsyncCommit(true);
+  std::vector<RID> rids(tuple_count);
+  std::set<page_id_t> page_ids;
+  for (int i = 0; i < tuple_count; i++) {
+    EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, i, wide), rids[i], txn));
+    page_ids.insert(rids[i].GetPageId());
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  EXPECT_LT(BUFFER_POOL_SIZE, (int)page_ids.size());
+
+  for (int round = 0; round < 3; round++) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+      threads.emplace_back([&, i] {
+        for (int j = 0; j < txn_count; ++j) {
+          Transaction *txn = txn_manager->Begin();
+          int k = (j * 7 % (tuple_count / thread_count)) * thread_count + i;
+          table->UpdateTuple(MakeTuple(schema, round * txn_count + j, wide),
+                             rids[k], txn);
+          txn_manager->Commit(txn);
+          delete txn;
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+    // only the log grows from now on, after the pages are read
+    std::vector<lsn_t> page_lsns;
+    char data[PAGE_SIZE];
+    for (auto page_id : page_ids) {
+      storage_engine->disk_manager_->ReadPage(page_id, data);
+      page_lsns.push_back(*reinterpret_cast<lsn_t *>(data + 4));
+    }
+    lsn_t log_size = storage_engine->disk_manager_->GetLogSize();
+    for (auto lsn : page_lsns)
+      EXPECT_GT(log_size, lsn);
+  }
+  EXPECT_LT(0, storage_engine->buffer_pool_manager_->GetNumWALSkips() +
+                   storage_engine->buffer_pool_manager_->GetNumWALStalls());
+
+  delete schema;
+  delete table;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  LOG_TIMEOUT = log_timeout;
+  DURABILITY_WINDOW = durability_window;
+}
+
+/*
+ * Appends of many threads reserve their space concurrently, records larger
+ * than the log buffer are written on their own
+ */
+TEST(LogManagerTest, ConcurrentAppendTest) {
+  const int thread_count = 4;
+  const int record_count = 500;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)0),
+                            Value(TypeId::VARCHAR, "small")};
+  Tuple small_tuple(values, schema);
+  values[1] = Value(TypeId::VARCHAR, std::string(LOG_BUFFER_SIZE, 'x'));
+  Tuple large_tuple(values, schema);
+
+  // the appenders write the log themselves, then the flush thread does
+  for (int run = 0; run < 2; run++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    LogManager *log_manager = new LogManager(disk_manager);
+    if (run == 1)
+      log_manager->RunFlushThread();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+      threads.emplace_back([&, i] {
+        RID rid(i, 0);
+        for (int j = 0; j < record_count; ++j) {
+          LogRecord log_record(i, INVALID_LSN, LogRecordType::INSERT, rid,
+                               j % 100 == 99 ? large_tuple : small_tuple);
+          log_manager->AppendLogRecord(log_record);
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+    if (run == 1)
+      log_manager->StopFlushThread();
+    else
+      log_manager->Flush(log_manager->GetNextLSN() - 1);
+    EXPECT_EQ(disk_manager->GetLogSize() - 1,
+              log_manager->GetPersistentLSN());
+
+    std::vector<LogRecordType> types;
+    ReadLogRecordTypes(disk_manager, types);
+    EXPECT_EQ(thread_count * record_count, (int)types.size());
+
+    delete log_manager;
+    delete disk_manager;
+    remove("test.db");
+    RemoveLog("test.log");
+  }
+  delete schema;
+}
+
+/*
+ * Tuple locks are never waited for under a page latch: an older transaction
+ * waiting for a tuple lets the younger holder roll back on the same page,
+ * and an empty slot still locked by its deleter is refused to an insert
+ */
+TEST(LogManagerTest, LockWaitTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  RID rid;
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 0, "a"), rid, txn));
+  txn_manager->Commit(txn);
+  delete txn;
+
+  Transaction *old_txn = txn_manager->Begin();
+  Transaction *young_txn = txn_manager->Begin();
+  EXPECT_TRUE(table->UpdateTuple(MakeTuple(schema, 1, "b"), rid, young_txn));
+  std::thread deleter([&] { EXPECT_TRUE(table->MarkDelete(rid, old_txn)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  txn_manager->Abort(young_txn);
+  deleter.join();
+  EXPECT_EQ(TransactionState::GROWING, old_txn->GetState());
+  // a delete of a deleted tuple is not recorded
+  EXPECT_FALSE(table->MarkDelete(rid, old_txn));
+  EXPECT_EQ(1, (int)old_txn->GetWriteSet()->size());
+  txn_manager->Abort(old_txn);
+  delete old_txn;
+  delete young_txn;
+
+  // the slot of a rolled back insert is empty before its lock is released
+  old_txn = txn_manager->Begin();
+  young_txn = txn_manager->Begin();
+  RID old_rid, young_rid;
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 2, "c"), old_rid, old_txn));
+  table->ApplyDelete(old_rid, old_txn);
+  EXPECT_FALSE(
+      table->InsertTuple(MakeTuple(schema, 3, "d"), young_rid, young_txn));
+  EXPECT_EQ(TransactionState::ABORTED, young_txn->GetState());
+  txn_manager->Abort(young_txn);
+  txn_manager->Commit(old_txn);
+  delete old_txn;
+  delete young_txn;
+
+  // the slot is taken again once the lock is released
+  txn = txn_manager->Begin();
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 4, "e"), young_rid, txn));
+  EXPECT_EQ(old_rid, young_rid);
+  Tuple tuple;
+  EXPECT_TRUE(table->GetTuple(rid, tuple, txn));
+  EXPECT_EQ("a", tuple.GetValue(schema, 1).ToString());
+  txn_manager->Commit(txn);
+  delete txn;
+
+  delete schema;
+  delete table;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+}
+
+/*
+ * Crash with the page holding the head of a large tuple written, and none
+ * of its overflow pages. Recovery writes them again from their records
+ */
+TEST(LogManagerTest, OverflowRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(4096)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string large(3000, 'x');
+  for (size_t i = 0; i < large.size(); i += 7)
+    large[i] = 'a' + i % 26;
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  RID rid, small_rid;
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 0, large), rid, txn));
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 1, "small"), small_rid, txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  EXPECT_TRUE(storage_engine->buffer_pool_manager_->FlushPage(first_page_id));
+  delete table;
+  // crash: only the first page is written
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  EXPECT_EQ(large, ReadTuple(storage_engine, first_page_id, schema, rid));
+  EXPECT_EQ("small",
+            ReadTuple(storage_engine, first_page_id, schema, small_rid));
+
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * Nothing but the log is written before the crash: redo puts the heads of
+ * large tuples back from their insert records, and undo puts back the head
+ * a transaction deleted when the crash came before its commit record
+ */
+TEST(LogManagerTest, OverflowRedoTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(4096)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string large(2000, 'y');
+  for (size_t i = 0; i < large.size(); i += 5)
+    large[i] = 'a' + i % 26;
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  RID rid, small_rid;
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 0, large), rid, txn));
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 1, "small"), small_rid, txn));
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // deleted, the commit record is not written yet
+  txn = txn_manager->Begin();
+  EXPECT_TRUE(table->MarkDelete(rid, txn));
+  EXPECT_NE(INVALID_PAGE_ID, table->ApplyDelete(rid, txn));
+  LogManager *log_manager = storage_engine->log_manager_;
+  log_manager->Flush(log_manager->GetNextLSN() - 1);
+  delete txn;
+  delete table;
+  // crash
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  EXPECT_EQ(large, ReadTuple(storage_engine, first_page_id, schema, rid));
+  EXPECT_EQ("small",
+            ReadTuple(storage_engine, first_page_id, schema, small_rid));
+
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+typedef BPlusTree<GenericKey<8>, RID, GenericComparator<8>> LoggedTree;
+
+/*
+ * Crash with a table filled over several pages and only its first page
+ * written: the free space map of the table comes back from the log, so an
+ * insert after recovery stays in the table instead of going to the page
+ * a map never written names
+ */
+TEST(LogManagerTest, FreeSpaceMapRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(32)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string b(20, 'b');
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *other_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                         storage_engine->lock_manager_,
+                                         storage_engine->log_manager_, txn);
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  page_id_t other_page_id = other_table->GetFirstPageId();
+  page_id_t first_page_id = table->GetFirstPageId();
+  RID rid;
+  for (int i = 0; i < 30; i++)
+    EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, i, b), rid, txn));
+  EXPECT_NE(first_page_id, rid.GetPageId());
+  txn_manager->Commit(txn);
+  delete txn;
+  EXPECT_TRUE(storage_engine->buffer_pool_manager_->FlushPage(first_page_id));
+  delete table;
+  delete other_table;
+  // crash: only the first page of the table is written
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  table = new TableHeap(storage_engine->buffer_pool_manager_,
+                        storage_engine->lock_manager_,
+                        storage_engine->log_manager_, first_page_id);
+  txn = storage_engine->transaction_manager_->Begin();
+  EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, 30, "new"), rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  EXPECT_NE(other_page_id, rid.GetPageId());
+  EXPECT_EQ("new", ReadTuple(storage_engine, first_page_id, schema, rid));
+  int count = 0;
+  txn = storage_engine->transaction_manager_->Begin();
+  for (auto it = table->begin(txn); it != table->end(); ++it)
+    count++;
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+  EXPECT_EQ(31, count);
+
+  delete table;
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+// header page of a new database, on disk before any index records a root
+static void CreateHeaderPage(StorageEngine *storage_engine) {
+  page_id_t header_page_id;
+  auto header_page = static_cast<HeaderPage *>(
+      storage_engine->buffer_pool_manager_->NewPage(header_page_id));
+  EXPECT_EQ(HEADER_PAGE_ID, header_page_id);
+  header_page->Init();
+  storage_engine->buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  storage_engine->buffer_pool_manager_->FlushPage(HEADER_PAGE_ID);
+}
+
+static page_id_t ReadRootId(StorageEngine *storage_engine,
+                            const std::string &index_name) {
+  auto header_page = static_cast<HeaderPage *>(
+      storage_engine->buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  page_id_t root_id = INVALID_PAGE_ID;
+  header_page->GetRootId(index_name, root_id);
+  storage_engine->buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  return root_id;
+}
+
+static void LogAll(LogManager *log_manager) {
+  log_manager->Flush(log_manager->GetNextLSN() - 1);
+}
+
+/*
+ * Crash after an index grew over many pages (splits, new roots) and shrank
+ * again (merges), with only the pages the buffer pool evicted on disk, and
+ * an operation cut off in the middle. Recovery redoes the index from its
+ * page records and rolls the cut off operation back
+ */
+TEST(LogManagerTest, IndexRecoveryTest) {
+  const int key_count = 2000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  CreateHeaderPage(storage_engine);
+  LoggedTree *tree =
+      new LoggedTree("idx", storage_engine->buffer_pool_manager_, comparator,
+                     INVALID_PAGE_ID, storage_engine->log_manager_);
+
+  std::vector<int64_t> keys;
+  for (int i = 1; i <= key_count; i++)
+    keys.push_back(i);
+  std::srand(7);
+  std::random_shuffle(keys.begin(), keys.end(),
+                      [](int n) { return std::rand() % n; });
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree->Insert(index_key, RID(key, 0)));
+  }
+  for (auto key : keys) {
+    if (key % 3 != 0)
+      continue;
+    index_key.SetFromInteger(key);
+    tree->Remove(index_key);
+  }
+  {
+    // inserts that split leaves, made one operation that never commits
+    PageLogger page_logger(storage_engine->log_manager_);
+    for (int64_t key = 1; key <= key_count; key += 3) {
+      index_key.SetFromInteger(key * 10000);
+      tree->Insert(index_key, RID(key, 0));
+    }
+    LogAll(storage_engine->log_manager_);
+  }
+  delete tree;
+  // crash: the buffer pool is not flushed
+  delete storage_engine;
+
+  for (int restart = 0; restart < 2; restart++) {
+    storage_engine = new StorageEngine("test.db");
+    LogRecovery *log_recovery =
+        new LogRecovery(storage_engine->disk_manager_,
+                        storage_engine->buffer_pool_manager_,
+                        storage_engine->log_manager_);
+    log_recovery->Redo();
+    log_recovery->Undo();
+    delete log_recovery;
+
+    tree = new LoggedTree("idx", storage_engine->buffer_pool_manager_,
+                          comparator, ReadRootId(storage_engine, "idx"));
+    std::vector<RID> rids;
+    for (int64_t key = 1; key <= key_count; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(key % 3 != 0, tree->GetValue(index_key, rids)) << key;
+      if (!rids.empty()) {
+        EXPECT_EQ(key, rids[0].GetPageId());
+      }
+    }
+    int64_t count = 0, last_key = 0;
+    for (auto it = tree->Begin(); !it.isEnd(); ++it) {
+      int64_t key = (*it).second.GetPageId();
+      EXPECT_LT(last_key, key);
+      last_key = key;
+      count++;
+    }
+    EXPECT_EQ(key_count - key_count / 3, count);
+    delete tree;
+    // crash again, the changes of undo are in the log only
+    delete storage_engine;
+  }
+
+  delete key_schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+typedef BETree<GenericKey<8>, RID, GenericComparator<8>> LoggedBETree;
+typedef ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>,
+                            GenericHashFunction<8>>
+    LoggedHashTable;
+
+/*
+ * The same crash for a B-epsilon tree (buffers flushed down, nodes split)
+ * and for a hash table (buckets split, the directory grown), side by side
+ */
+TEST(LogManagerTest, OtherIndexRecoveryTest) {
+  const int key_count = 2000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  GenericHashFunction<8> hash_fn(key_schema);
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  CreateHeaderPage(storage_engine);
+  LoggedBETree *tree =
+      new LoggedBETree("tree", storage_engine->buffer_pool_manager_,
+                       comparator, INVALID_PAGE_ID,
+                       storage_engine->log_manager_);
+  LoggedHashTable *table = new LoggedHashTable(
+      "hash", storage_engine->buffer_pool_manager_, comparator, hash_fn,
+      INVALID_PAGE_ID, storage_engine->log_manager_);
+
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= key_count; key++) {
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, RID(key, 0));
+    EXPECT_TRUE(table->Insert(index_key, RID(key, 0)));
+  }
+  for (int64_t key = 3; key <= key_count; key += 3) {
+    index_key.SetFromInteger(key);
+    tree->Remove(index_key);
+    table->Remove(index_key);
+  }
+  {
+    // a few inserts made one operation that never commits
+    PageLogger page_logger(storage_engine->log_manager_);
+    for (int64_t key = 1; key <= 4; key++) {
+      index_key.SetFromInteger(key * 10000);
+      tree->Insert(index_key, RID(key, 0));
+      table->Insert(index_key, RID(key, 0));
+    }
+    LogAll(storage_engine->log_manager_);
+  }
+  delete tree;
+  delete table;
+  // crash: the buffer pool is not flushed
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+
+  tree = new LoggedBETree("tree", storage_engine->buffer_pool_manager_,
+                          comparator, ReadRootId(storage_engine, "tree"));
+  table = new LoggedHashTable("hash", storage_engine->buffer_pool_manager_,
+                              comparator, hash_fn,
+                              ReadRootId(storage_engine, "hash"));
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= key_count; key++) {
+    index_key.SetFromInteger(key);
+    rids.clear();
+    EXPECT_EQ(key % 3 != 0, tree->GetValue(index_key, rids)) << key;
+    rids.clear();
+    EXPECT_EQ(key % 3 != 0, table->GetValue(index_key, rids)) << key;
+  }
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  tree->GetRange(nullptr, nullptr, entries);
+  EXPECT_EQ(key_count - key_count / 3, static_cast<int>(entries.size()));
+  entries.clear();
+  table->GetAll(entries);
+  EXPECT_EQ(key_count - key_count / 3, static_cast<int>(entries.size()));
+  delete tree;
+  delete table;
+  delete storage_engine;
+
+  delete key_schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * Primary of a replica, in a process of its own: makes a table and sends
+ * its first page id, waits for a byte, then runs txn_count transactions of
+ * 10 inserts (of a = 10 * i + j), aborting every 7th one, with a checkpoint
+ * every 20. Crashes with one more transaction active
+ */
+static void RunPrimary(int to_replica, int from_replica, int txn_count,
+                       bool is_paced) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn);
+  txn_manager->Commit(txn);
+  delete txn;
+  page_id_t first_page_id = table->GetFirstPageId();
+  char go;
+  if (write(to_replica, &first_page_id, sizeof(page_id_t)) !=
+          sizeof(page_id_t) ||
+      read(from_replica, &go, 1) != 1)
+    _exit(1);
+
+  RID rid;
+  for (int i = 0; i < txn_count; i++) {
+    txn = txn_manager->Begin();
+    for (int j = 0; j < 10; j++)
+      table->InsertTuple(MakeTuple(schema, 10 * i + j, "row"), rid, txn);
+    if (i % 7 == 6)
+      txn_manager->Abort(txn);
+    else
+      txn_manager->Commit(txn);
+    delete txn;
+    if (i % 20 == 19)
+      storage_engine->checkpoint_manager_->Checkpoint();
+    if (is_paced)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  txn = txn_manager->Begin();
+  for (int j = 0; j < 5; j++)
+    table->InsertTuple(MakeTuple(schema, -1, "lost"), rid, txn);
+  storage_engine->log_manager_->Flush(txn->GetPrevLSN());
+  _exit(0);
+}
+
+// column a of the tuples of the table, page by page
+static void ScanTable(BufferPoolManager *buffer_pool_manager,
+                      page_id_t first_page_id, Schema *schema,
+                      std::vector<int64_t> &values) {
+  values.clear();
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    RID rid;
+    Tuple tuple;
+    for (bool has_tuple = page->GetFirstTupleRid(rid); has_tuple;
+         has_tuple = page->GetNextTupleRid(rid, rid)) {
+      if (page->GetTuple(rid, tuple, nullptr, nullptr))
+        values.push_back(tuple.GetValue(schema, 0).GetAs<int64_t>());
+    }
+    page_id = page->GetNextPageId();
+    buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*
+ * A replica follows the log of a primary in another process. Every state
+ * it shows readers has whole transactions, at an lsn never going back; at
+ * the end it has the committed transactions, the one cut off by the crash
+ * of the primary is left out and counted as lag
+ */
+TEST(LogManagerTest, ReplicaTest) {
+  const int txn_count = 300;
+  remove("replica.db");
+  int to_replica[2], from_replica[2];
+  ASSERT_EQ(0, pipe(to_replica));
+  ASSERT_EQ(0, pipe(from_replica));
+  pid_t pid = fork();
+  ASSERT_LE(0, pid);
+  if (pid == 0)
+    RunPrimary(to_replica[1], from_replica[0], txn_count, true);
+
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  page_id_t first_page_id;
+  ASSERT_EQ((ssize_t)sizeof(page_id_t),
+            read(to_replica[0], &first_page_id, sizeof(page_id_t)));
+  StorageEngine *storage_engine = new StorageEngine("replica.db", "test.db");
+  LogReplica *replica = storage_engine->replica_;
+  EXPECT_FALSE(ENABLE_LOGGING);
+  EXPECT_NE(INVALID_LSN, replica->GetAppliedLSN());
+  EXPECT_NE(INVALID_LSN, storage_engine->disk_manager_->ReadReplicaLSN());
+  replica->RunApplyThread(std::chrono::milliseconds(1));
+  EXPECT_EQ(1, write(from_replica[1], "g", 1));
+
+  std::vector<int64_t> values;
+  lsn_t last_lsn = INVALID_LSN;
+  int status, snapshots = 0;
+  while (waitpid(pid, &status, WNOHANG) == 0) {
+    replica->RLock();
+    lsn_t applied_lsn = replica->GetAppliedLSN();
+    ScanTable(storage_engine->buffer_pool_manager_, first_page_id, schema,
+              values);
+    replica->RUnlock();
+    EXPECT_LE(last_lsn, applied_lsn);
+    EXPECT_EQ(0u, values.size() % 10);
+    last_lsn = applied_lsn;
+    snapshots++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+  EXPECT_LT(1, snapshots);
+
+  replica->StopApplyThread();
+  lsn_t applied_lsn = replica->CatchUp();
+  ScanTable(storage_engine->buffer_pool_manager_, first_page_id, schema,
+            values);
+  std::sort(values.begin(), values.end());
+  std::vector<int64_t> expected;
+  for (int i = 0; i < txn_count; i++) {
+    for (int j = 0; j < 10 && i % 7 != 6; j++)
+      expected.push_back(10 * i + j);
+  }
+  EXPECT_EQ(expected, values);
+  lsn_t log_size = storage_engine->disk_manager_->GetLogSize();
+  EXPECT_LT(applied_lsn, log_size);
+  EXPECT_EQ(log_size - applied_lsn, replica->GetLagBytes());
+  // the replica slot goes with the replica
+  delete storage_engine;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(INVALID_LSN, disk_manager->ReadReplicaLSN());
+  delete disk_manager;
+
+  delete schema;
+  for (int fd : {to_replica[0], to_replica[1], from_replica[0],
+                 from_replica[1]})
+    close(fd);
+  remove("test.db");
+  remove("replica.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+// page ids of the chain of a table
+static void ReadPageChain(BufferPoolManager *buffer_pool_manager,
+                          page_id_t first_page_id,
+                          std::vector<page_id_t> &page_ids) {
+  page_ids.clear();
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    page_ids.push_back(page_id);
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    page_id = page->GetNextPageId();
+    buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*
+ * Crash after a vacuum whose transaction never committed, with the pages it
+ * changed written and the page it unlinked given back. The vacuum steps are
+ * committed on their own: recovery keeps the tuples moved and the chain
+ * short, and every tuple is still in it
+ */
+TEST(LogManagerTest, VacuumRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  // the table pages are not the header page, whose records are images
+  CreateHeaderPage(storage_engine);
+  BufferPoolManager *buffer_pool_manager = storage_engine->buffer_pool_manager_;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(32)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string b(20, 'b');
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table =
+      new TableHeap(buffer_pool_manager, storage_engine->lock_manager_,
+                    storage_engine->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(40);
+  for (int i = 0; i < 40; i++)
+    EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, i, b), rids[i], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  // keep one tuple out of four
+  txn = txn_manager->Begin();
+  for (int i = 0; i < 40; i++) {
+    if (i % 4 != 0) {
+      EXPECT_TRUE(table->MarkDelete(rids[i], txn));
+    }
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  std::vector<page_id_t> page_ids, vacuumed_page_ids;
+  ReadPageChain(buffer_pool_manager, first_page_id, page_ids);
+  EXPECT_LT(2u, page_ids.size());
+
+  txn = txn_manager->Begin();
+  table->Vacuum(txn);
+  ReadPageChain(buffer_pool_manager, first_page_id, vacuumed_page_ids);
+  EXPECT_GT(page_ids.size(), vacuumed_page_ids.size());
+  LogAll(storage_engine->log_manager_);
+  for (page_id_t page_id : page_ids)
+    buffer_pool_manager->FlushPage(page_id);
+  delete table;
+  // crash: the vacuum transaction is left active
+  delete txn;
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  std::vector<int64_t> values;
+  ScanTable(storage_engine->buffer_pool_manager_, first_page_id, schema,
+            values);
+  std::sort(values.begin(), values.end());
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 40; i += 4)
+    expected.push_back(i);
+  EXPECT_EQ(expected, values);
+  // the NEWPAGE records of the pages given back relink none of them
+  ReadPageChain(storage_engine->buffer_pool_manager_, first_page_id,
+                page_ids);
+  EXPECT_EQ(vacuumed_page_ids, page_ids);
+
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * Crash after inserts into a PAX table grew it over many pages, none of
+ * them written. Recovery lays the pages out in PAX format again before it
+ * redoes the inserts
+ */
+TEST(LogManagerTest, PaxRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(32)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string b(20, 'b');
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn, schema);
+  page_id_t first_page_id = table->GetFirstPageId();
+  RID rid;
+  for (int i = 0; i < 40; i++)
+    EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, i, b), rid, txn));
+  EXPECT_NE(first_page_id, rid.GetPageId());
+  txn_manager->Commit(txn);
+  delete txn;
+  delete table;
+  // crash: no page is written
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  auto first_page = static_cast<TablePage *>(
+      storage_engine->buffer_pool_manager_->FetchPage(first_page_id));
+  EXPECT_TRUE(first_page->IsPaxPage());
+  storage_engine->buffer_pool_manager_->UnpinPage(first_page_id, false);
+  std::vector<int64_t> values;
+  ScanTable(storage_engine->buffer_pool_manager_, first_page_id, schema,
+            values);
+  std::sort(values.begin(), values.end());
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 40; i++)
+    expected.push_back(i);
+  EXPECT_EQ(expected, values);
+
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * Crash after a PAX table was compressed, none of its pages written.
+ * Recovery redoes the inserts, and then the encoded pages and unlinks of the
+ * compress, so that every tuple is there once, in the shorter chain
+ */
+TEST(LogManagerTest, CompressRecoveryTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(32)");
+  TransactionManager *txn_manager = storage_engine->transaction_manager_;
+  std::string b(20, 'b');
+
+  Transaction *txn = txn_manager->Begin();
+  TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                   storage_engine->lock_manager_,
+                                   storage_engine->log_manager_, txn, schema);
+  page_id_t first_page_id = table->GetFirstPageId();
+  RID rid;
+  for (int i = 0; i < 40; i++)
+    EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, i, b), rid, txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  auto count_pages = [&]() {
+    int page_count = 0;
+    for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;
+         page_count++) {
+      auto page = static_cast<TablePage *>(
+          storage_engine->buffer_pool_manager_->FetchPage(page_id));
+      page_id = page->GetNextPageId();
+      storage_engine->buffer_pool_manager_->UnpinPage(page->GetPageId(),
+                                                      false);
+    }
+    return page_count;
+  };
+  int page_count = count_pages();
+
+  txn = txn_manager->Begin();
+  table->Compress(txn);
+  txn_manager->Commit(txn);
+  delete txn;
+  int compressed_page_count = count_pages();
+  EXPECT_GT(page_count, compressed_page_count);
+  delete table;
+  // crash: no page is written
+  delete storage_engine;
+
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_,
+      storage_engine->log_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+  std::vector<int64_t> values;
+  ScanTable(storage_engine->buffer_pool_manager_, first_page_id, schema,
+            values);
+  std::sort(values.begin(), values.end());
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 40; i++)
+    expected.push_back(i);
+  EXPECT_EQ(expected, values);
+  EXPECT_EQ(compressed_page_count, count_pages());
+
+  delete schema;
+  delete storage_engine;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.master");
+}
+
+/*
+ * Benchmark: committing threads, each transaction inserts a tuple and
+ * commits
+ */
+TEST(LogManagerTest, DISABLED_CommitBenchmark) {
+  const int txn_count = 20000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)0),
+                            Value(TypeId::VARCHAR, "commit benchmark")};
+  Tuple tuple(values, schema);
+
+  for (int thread_count = 1; thread_count <= 64; thread_count *= 2) {
+    StorageEngine *storage_engine = new StorageEngine("test.db");
+    storage_engine->log_manager_->RunFlushThread();
+    Transaction *txn = storage_engine->transaction_manager_->Begin();
+    TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                     storage_engine->lock_manager_,
+                                     storage_engine->log_manager_, txn);
+    storage_engine->transaction_manager_->Commit(txn);
+    delete txn;
+    int flushes = storage_engine->disk_manager_->GetNumFlushes();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+      threads.emplace_back([&] {
+        for (int j = 0; j < txn_count / thread_count; ++j) {
+          Transaction *txn = storage_engine->transaction_manager_->Begin();
+          RID rid;
+          table->InsertTuple(tuple, rid, txn);
+          storage_engine->transaction_manager_->Commit(txn);
+          delete txn;
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+    auto end = std::chrono::steady_clock::now();
+    flushes = storage_engine->disk_manager_->GetNumFlushes() - flushes;
+    std::cout << thread_count << " threads: "
+              << txn_count / std::chrono::duration<double>(end - start).count()
+              << " commits/s, " << (double)txn_count / flushes
+              << " commits/write" << std::endl;
+
+    delete table;
+    delete storage_engine;
+    remove("test.db");
+    RemoveLog("test.log");
+  }
+  delete schema;
+}
+
+/*
+ * Benchmark: latency percentiles of synchronous and asynchronous commits,
+ * each transaction inserts a tuple
+ */
+TEST(LogManagerTest, DISABLED_AsyncCommitBenchmark) {
+  const int txn_count = 20000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)0),
+                            Value(TypeId::VARCHAR, "commit benchmark")};
+  Tuple tuple(values, schema);
+
+  for (int async = 0; async < 2; async++) {
+    StorageEngine *storage_engine = new StorageEngine("test.db");
+    LogManager *log_manager = storage_engine->log_manager_;
+    log_manager->RunFlushThread();
+    Transaction *txn = storage_engine->transaction_manager_->Begin();
+    TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                     storage_engine->lock_manager_,
+                                     log_manager, txn);
+    storage_engine->transaction_manager_->Commit(txn);
+    delete txn;
+    table->SetAsyncCommit(async == 1);
+
+    std::vector<double> latencies;
+    lsn_t max_lag = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < txn_count; ++i) {
+      txn = storage_engine->transaction_manager_->Begin();
+      RID rid;
+      table->InsertTuple(tuple, rid, txn);
+      auto commit_start = std::chrono::steady_clock::now();
+      storage_engine->transaction_manager_->Commit(txn);
+      latencies.push_back(std::chrono::duration<double, std::micro>(
+                              std::chrono::steady_clock::now() - commit_start)
+                              .count());
+      max_lag = std::max(max_lag, log_manager->GetPersistentLSNLag());
+      delete txn;
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << (async == 1 ? "async" : "sync") << " commit: "
+              << txn_count / std::chrono::duration<double>(end - start).count()
+              << " commits/s, p50 " << latencies[txn_count / 2] << " us, p99 "
+              << latencies[txn_count * 99 / 100] << " us, p99.9 "
+              << latencies[txn_count * 999 / 1000] << " us, max lag "
+              << max_lag << " bytes" << std::endl;
+
+    delete table;
+    delete storage_engine;
+    remove("test.db");
+    RemoveLog("test.log");
+  }
+  delete schema;
+}
+
+/*
+ * Benchmark: transactions update a counter of wide tuples and commit. An
+ * update keeping the length is logged as a delta, one changing it with both
+ * tuples
+ */
+TEST(LogManagerTest, DISABLED_UpdateLogBenchmark) {
+  const int tuple_count = 40;
+  const int txn_count = 20000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(64)");
+  std::string wide(60, 'x');
+
+  for (int delta = 1; delta >= 0; delta--) {
+    StorageEngine *storage_engine = new StorageEngine("test.db");
+    storage_engine->log_manager_->RunFlushThread();
+    TransactionManager *txn_manager = storage_engine->transaction_manager_;
+    Transaction *txn = txn_manager->Begin();
+    TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                     storage_engine->lock_manager_,
+                                     storage_engine->log_manager_, txn);
+    std::vector<RID> rids(tuple_count);
+    for (int i = 0; i < tuple_count; i++)
+      table->InsertTuple(MakeTuple(schema, 0, wide), rids[i], txn);
+    txn_manager->Commit(txn);
+    delete txn;
+
+    lsn_t start_lsn = storage_engine->log_manager_->GetNextLSN();
+    auto start = std::chrono::steady_clock::now();
+    for (int j = 0; j < txn_count; j++) {
+      txn = txn_manager->Begin();
+      // without delta, the length changes every update
+      std::string b = delta == 1 ? wide : wide.substr(j / tuple_count % 2);
+      table->UpdateTuple(MakeTuple(schema, j, b), rids[j % tuple_count], txn);
+      txn_manager->Commit(txn);
+      delete txn;
+    }
+    auto end = std::chrono::steady_clock::now();
+    double log_bytes =
+        storage_engine->log_manager_->GetNextLSN() - start_lsn;
+    std::cout << (delta == 1 ? "delta" : "full") << " update: "
+              << txn_count / std::chrono::duration<double>(end - start).count()
+              << " txns/s, " << log_bytes / txn_count << " log bytes/txn"
+              << std::endl;
+
+    delete table;
+    delete storage_engine;
+    remove("test.db");
+    RemoveLog("test.log");
+  }
+  delete schema;
+}
+
+/*
+ * Benchmark: transactions update tuples of a small table and commit, then
+ * the system crashes and restarts. Without checkpoints recovery reads the
+ * whole log, with a checkpoint every checkpoint_interval transactions it
+ * reads what the last two intervals wrote
+ */
+TEST(LogManagerTest, DISABLED_RestartBenchmark) {
+  const int tuple_count = 40;
+  const int checkpoint_interval = 1000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+
+  for (int txn_count = 2000; txn_count <= 32000; txn_count *= 4) {
+    for (int checkpoint = 0; checkpoint < 2; checkpoint++) {
+      StorageEngine *storage_engine = new StorageEngine("test.db");
+      storage_engine->log_manager_->RunFlushThread();
+      TransactionManager *txn_manager = storage_engine->transaction_manager_;
+      Transaction *txn = txn_manager->Begin();
+      TableHeap *table = new TableHeap(storage_engine->buffer_pool_manager_,
+                                       storage_engine->lock_manager_,
+                                       storage_engine->log_manager_, txn);
+      std::vector<RID> rids(tuple_count);
+      for (int i = 0; i < tuple_count; i++)
+        table->InsertTuple(MakeTuple(schema, i, "0"), rids[i], txn);
+      txn_manager->Commit(txn);
+      delete txn;
+      for (int j = 0; j < txn_count; j++) {
+        txn = txn_manager->Begin();
+        table->UpdateTuple(MakeTuple(schema, j, std::to_string(j % 10)),
+                           rids[j % tuple_count], txn);
+        txn_manager->Commit(txn);
+        delete txn;
+        if (checkpoint && j % checkpoint_interval == checkpoint_interval - 1)
+          storage_engine->checkpoint_manager_->Checkpoint();
+      }
+      delete table;
+      lsn_t log_size = storage_engine->disk_manager_->GetLogSize();
+      delete storage_engine;
+
+      storage_engine = new StorageEngine("test.db");
+      auto start = std::chrono::steady_clock::now();
+      LogRecovery *log_recovery =
+          new LogRecovery(storage_engine->disk_manager_,
+                          storage_engine->buffer_pool_manager_,
+                          storage_engine->log_manager_);
+      log_recovery->Redo();
+      log_recovery->Undo();
+      auto end = std::chrono::steady_clock::now();
+      std::cout << txn_count << " txns, log " << log_size << " bytes, "
+                << (checkpoint ? "checkpoints: " : "no checkpoint: ")
+                << log_recovery->GetReadCount() << " records read, "
+                << storage_engine->disk_manager_->GetLogSegmentCount()
+                << " segment files, "
+                << std::chrono::duration<double, std::milli>(end - start)
+                       .count()
+                << " ms" << std::endl;
+      delete log_recovery;
+      delete storage_engine;
+      remove("test.db");
+      RemoveLog("test.log");
+      remove("test.master");
+    }
+  }
+  delete schema;
+}
+
+/*
+ * Benchmark: restart after a crash with every page of a large table dirty,
+ * redo by one thread or spread over workers
+ */
+TEST(LogManagerTest, DISABLED_ParallelRedoBenchmark) {
+  const int tuple_count = 20000;
+  const int update_count = 20000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  page_id_t first_page_id;
+  std::vector<RID> rids;
+  CrashWithManyPages(schema, tuple_count, update_count, first_page_id, rids);
+  CopyFile("test.db", "test.db.crash");
+  CopyLog("test.log", "test.log.crash");
+
+  for (int worker_count = 1; worker_count <= 16; worker_count *= 2) {
+    CopyFile("test.db.crash", "test.db");
+    CopyLog("test.log.crash", "test.log");
+    StorageEngine *storage_engine = new StorageEngine("test.db");
+    LogRecovery *log_recovery =
+        new LogRecovery(storage_engine->disk_manager_,
+                        storage_engine->buffer_pool_manager_,
+                        storage_engine->log_manager_);
+    int reads = storage_engine->disk_manager_->GetNumReads();
+    auto start = std::chrono::steady_clock::now();
+    log_recovery->Redo(worker_count);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << worker_count << " workers: "
+              << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms, " << log_recovery->GetReadCount() << " records, "
+              << storage_engine->disk_manager_->GetNumReads() - reads
+              << " page reads" << std::endl;
+    delete log_recovery;
+    delete storage_engine;
+  }
+
+  delete schema;
+  remove("test.db");
+  RemoveLog("test.log");
+  remove("test.db.crash");
+  RemoveLog("test.log.crash");
+}
+
+/*
+ * Benchmark: appending threads, insert records of a small tuple, with the
+ * flush thread writing the log behind them
+ */
+TEST(LogManagerTest, DISABLED_AppendBenchmark) {
+  const int record_count = 400000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)0),
+                            Value(TypeId::VARCHAR, "append benchmark")};
+  Tuple tuple(values, schema);
+
+  for (int thread_count = 1; thread_count <= 64; thread_count *= 2) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    LogManager *log_manager = new LogManager(disk_manager);
+    log_manager->RunFlushThread();
+    std::vector<std::vector<double>> latencies(thread_count);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+      threads.emplace_back([&, i] {
+        RID rid(i, 0);
+        lsn_t prev_lsn = INVALID_LSN;
+        latencies[i].reserve(record_count / thread_count);
+        for (int j = 0; j < record_count / thread_count; ++j) {
+          LogRecord log_record(i, prev_lsn, LogRecordType::INSERT, rid,
+                               tuple);
+          auto begin = std::chrono::steady_clock::now();
+          prev_lsn = log_manager->AppendLogRecord(log_record);
+          auto end = std::chrono::steady_clock::now();
+          latencies[i].push_back(
+              std::chrono::duration<double, std::micro>(end - begin).count());
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+    auto end = std::chrono::steady_clock::now();
+    log_manager->StopFlushThread();
+
+    std::vector<double> all;
+    for (auto &latency : latencies)
+      all.insert(all.end(), latency.begin(), latency.end());
+    std::sort(all.begin(), all.end());
+    std::cout << thread_count << " threads: "
+              << all.size() /
+                     std::chrono::duration<double>(end - start).count()
+              << " records/s, p50 " << all[all.size() / 2] << " us, p99 "
+              << all[all.size() * 99 / 100] << " us, p99.9 "
+              << all[all.size() * 999 / 1000] << " us" << std::endl;
+
+    delete log_manager;
+    delete disk_manager;
+    remove("test.db");
+    RemoveLog("test.log");
+  }
+  delete schema;
+}
+
+/*
+ * Benchmark: restart after a crash with a large index, recovered from the
+ * log (without checkpoints, or with one every 1000 inserts) or rebuilt by
+ * inserting its keys into a new tree
+ */
+TEST(LogManagerTest, DISABLED_IndexRestartBenchmark) {
+  const int checkpoint_interval = 1000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  GenericKey<8> index_key;
+
+  for (int key_count = 5000; key_count <= 80000; key_count *= 4) {
+    std::vector<int64_t> keys;
+    for (int i = 0; i < key_count; i++)
+      keys.push_back(i);
+    std::srand(key_count);
+    std::random_shuffle(keys.begin(), keys.end(),
+                        [](int n) { return std::rand() % n; });
+
+    for (int checkpoint = 0; checkpoint < 2; checkpoint++) {
+      StorageEngine *storage_engine = new StorageEngine("test.db");
+      storage_engine->log_manager_->RunFlushThread();
+      CreateHeaderPage(storage_engine);
+      LoggedTree *tree =
+          new LoggedTree("idx", storage_engine->buffer_pool_manager_,
+                         comparator, INVALID_PAGE_ID,
+                         storage_engine->log_manager_);
+      for (int i = 0; i < key_count; i++) {
+        if (checkpoint && i > 0 && i % checkpoint_interval == 0)
+          storage_engine->checkpoint_manager_->Checkpoint();
+        index_key.SetFromInteger(keys[i]);
+        tree->Insert(index_key, RID(keys[i], 0));
+      }
+      LogAll(storage_engine->log_manager_);
+      lsn_t log_size = storage_engine->disk_manager_->GetLogSize();
+      delete tree;
+      delete storage_engine;
+
+      storage_engine = new StorageEngine("test.db");
+      auto start = std::chrono::steady_clock::now();
+      LogRecovery *log_recovery =
+          new LogRecovery(storage_engine->disk_manager_,
+                          storage_engine->buffer_pool_manager_,
+                          storage_engine->log_manager_);
+      log_recovery->Redo();
+      log_recovery->Undo();
+      tree = new LoggedTree("idx", storage_engine->buffer_pool_manager_,
+                            comparator, ReadRootId(storage_engine, "idx"));
+      auto end = std::chrono::steady_clock::now();
+      std::vector<RID> rids;
+      index_key.SetFromInteger(keys[key_count / 2]);
+      EXPECT_TRUE(tree->GetValue(index_key, rids));
+      std::cout << key_count << " keys, log " << log_size << " bytes, "
+                << (checkpoint ? "checkpoints: " : "no checkpoint: ")
+                << log_recovery->GetReadCount() << " records read, recover "
+                << std::chrono::duration<double, std::milli>(end - start)
+                       .count()
+                << " ms" << std::endl;
+      delete tree;
+      delete log_recovery;
+      delete storage_engine;
+      remove("test.db");
+      RemoveLog("test.log");
+      remove("test.master");
+    }
+
+    // rebuild, the keys as a table scan would give them
+    StorageEngine *storage_engine = new StorageEngine("test.db");
+    CreateHeaderPage(storage_engine);
+    auto start = std::chrono::steady_clock::now();
+    LoggedTree *tree = new LoggedTree(
+        "idx", storage_engine->buffer_pool_manager_, comparator);
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree->Insert(index_key, RID(key, 0));
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << key_count << " keys, rebuild "
+              << std::chrono::duration<double, std::milli>(end - start)
+                     .count()
+              << " ms" << std::endl;
+    delete tree;
+    delete storage_engine;
+    remove("test.db");
+    RemoveLog("test.log");
+  }
+  delete key_schema;
+}
+
+/*
+ * Benchmark: replication lag of a replica following a primary that commits
+ * as fast as it can, polling the log every interval: the largest lag seen
+ * while the primary runs, and the time to apply the log it left
+ */
+TEST(LogManagerTest, DISABLED_ReplicaLagBenchmark) {
+  const int txn_count = 2000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  for (int interval : {1, 10, 50}) {
+    remove("replica.db");
+    int to_replica[2], from_replica[2];
+    ASSERT_EQ(0, pipe(to_replica));
+    ASSERT_EQ(0, pipe(from_replica));
+    pid_t pid = fork();
+    ASSERT_LE(0, pid);
+    if (pid == 0)
+      RunPrimary(to_replica[1], from_replica[0], txn_count, false);
+
+    page_id_t first_page_id;
+    ASSERT_EQ((ssize_t)sizeof(page_id_t),
+              read(to_replica[0], &first_page_id, sizeof(page_id_t)));
+    StorageEngine *storage_engine =
+        new StorageEngine("replica.db", "test.db");
+    LogReplica *replica = storage_engine->replica_;
+    replica->RunApplyThread(std::chrono::milliseconds(interval));
+    EXPECT_EQ(1, write(from_replica[1], "g", 1));
+    int status;
+    lsn_t max_lag_bytes = 0;
+    int64_t max_lag_ms = 0;
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+      max_lag_bytes = std::max(max_lag_bytes, replica->GetLagBytes());
+      max_lag_ms = std::max(max_lag_ms, (int64_t)replica->GetLagTime().count());
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    replica->StopApplyThread();
+    auto start = std::chrono::steady_clock::now();
+    replica->CatchUp();
+    auto end = std::chrono::steady_clock::now();
+    std::vector<int64_t> values;
+    ScanTable(storage_engine->buffer_pool_manager_, first_page_id, schema,
+              values);
+    std::cout << "poll every " << interval << " ms: max lag " << max_lag_bytes
+              << " bytes, " << max_lag_ms << " ms; final catch up "
+              << std::chrono::duration<double, std::milli>(end - start)
+                     .count()
+              << " ms, " << values.size() << " rows" << std::endl;
+    delete storage_engine;
+    for (int fd : {to_replica[0], to_replica[1], from_replica[0],
+                   from_replica[1]})
+      close(fd);
+    remove("test.db");
+    remove("replica.db");
+    RemoveLog("test.log");
+    remove("test.master");
+  }
+  delete schema;
 }
 
 } // namespace scudb
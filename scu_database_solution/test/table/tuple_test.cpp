@@ -3,19 +3,58 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <map>
+#include <random>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <sys/stat.h>
+
 #include "buffer/buffer_pool_manager.h"
 #include "logging/common.h"
+#include "page/column_chunk.h"
+#include "page/table_page.h"
 #include "table/table_heap.h"
 #include "table/tuple.h"
 #include "vtable/virtual_table.h"
 #include "gtest/gtest.h"
 
+// every allocation of the test binary is counted, for the scan benchmark
+static std::atomic<int64_t> allocation_count(0);
+
+void *operator new(size_t size) {
+  allocation_count++;
+  void *ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
 namespace scudb {
+// number of pages in the chain of a table heap
+static int CountTablePages(BufferPoolManager *buffer_pool_manager,
+                           page_id_t page_id) {
+  int page_count = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    page_count++;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = page->GetNextPageId();
+  }
+  return page_count;
+}
+
 TEST(TupleTest, TableHeapTest) {
   // test1: parse create sql statement
   std::string createStmt =
@@ -61,4 +100,1746 @@ TEST(TupleTest, TableHeapTest) {
   delete disk_manager;
 }
 
+TEST(TupleTest, TablePageTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(64)");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  page_id_t page_id;
+  auto page =
+      static_cast<TablePage *>(buffer_pool_manager->NewPage(page_id));
+  page->Init(page_id, PAGE_SIZE, INVALID_PAGE_ID, nullptr, transaction);
+
+  auto make_tuple = [&](int64_t key, size_t length) {
+    std::vector<Value> values{Value(TypeId::BIGINT, key),
+                              Value(TypeId::VARCHAR, std::string(length, 'x'))};
+    return Tuple(values, schema);
+  };
+
+  // fill the page with small tuples
+  RID rid;
+  std::vector<RID> rids;
+  int64_t key = 0;
+  while (page->InsertTuple(make_tuple(key, 8), rid, transaction, nullptr,
+                           nullptr)) {
+    EXPECT_EQ(key, rid.GetSlotNum());
+    rids.push_back(rid);
+    key++;
+  }
+  EXPECT_GT(rids.size(), 4);
+
+  // delete every other tuple, the holes are not contiguous
+  for (size_t i = 0; i < rids.size(); i += 2)
+    page->ApplyDelete(rids[i], transaction, nullptr);
+  int32_t free_space = page->GetFreeSpaceSize();
+  Tuple small_tuple = make_tuple(-1, 8);
+  EXPECT_GE(free_space, 2 * small_tuple.GetLength());
+
+  // a tuple bigger than any single hole still fits after compaction, and
+  // reuses the last freed slot
+  Tuple big_tuple = make_tuple(-1, 8 + small_tuple.GetLength());
+  EXPECT_TRUE(page->InsertTuple(big_tuple, rid, transaction, nullptr,
+                                nullptr));
+  EXPECT_EQ(rids[(rids.size() - 1) / 2 * 2], rid);
+  EXPECT_EQ(free_space - (int32_t)big_tuple.GetLength(),
+            page->GetFreeSpaceSize());
+
+  // surviving tuples are intact
+  Tuple tuple;
+  for (size_t i = 1; i < rids.size(); i += 2) {
+    EXPECT_TRUE(page->GetTuple(rids[i], tuple, transaction, nullptr));
+    EXPECT_EQ((int64_t)i, tuple.GetValue(schema, 0).GetAs<int64_t>());
+  }
+  EXPECT_TRUE(page->GetTuple(rid, tuple, transaction, nullptr));
+  EXPECT_EQ(big_tuple.GetLength(), tuple.GetLength());
+
+  // the remaining empty slots are reused before new ones are added
+  int reused = 0, appended = 0;
+  while (page->InsertTuple(small_tuple, rid, transaction, nullptr, nullptr)) {
+    if (rid.GetSlotNum() < (int)rids.size()) {
+      EXPECT_EQ(0, appended);
+      reused++;
+    } else {
+      appended++;
+    }
+  }
+  EXPECT_GT(reused, 0);
+
+  buffer_pool_manager->UnpinPage(page_id, true);
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete transaction;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, FreeSpaceMapTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)0),
+                            Value(TypeId::VARCHAR, "free space map")};
+  Tuple tuple(values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 5000; ++i) {
+    EXPECT_TRUE(table->InsertTuple(tuple, rid, transaction));
+    rid_v.push_back(rid);
+  }
+  std::set<page_id_t> page_ids;
+  for (auto &r : rid_v)
+    page_ids.insert(r.GetPageId());
+
+  // free every other tuple, then reopen the heap from its first page
+  for (size_t i = 0; i < rid_v.size(); i += 2) {
+    EXPECT_TRUE(table->MarkDelete(rid_v[i], transaction));
+    table->ApplyDelete(rid_v[i], transaction);
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  delete table;
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                        first_page_id);
+
+  // the freed space is reused, fill classes are rounded down so the last
+  // few bytes of a page may be left over
+  size_t reused = 0;
+  for (int i = 0; i < 2500; ++i) {
+    EXPECT_TRUE(table->InsertTuple(tuple, rid, transaction));
+    reused += page_ids.count(rid.GetPageId());
+  }
+  EXPECT_GT(reused, 2000);
+  int count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    count++;
+  EXPECT_EQ(5000, count);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, ColumnChunkTest) {
+  char data[PAGE_SIZE * 8];
+  auto check = [&](TypeId type, const std::vector<Value> &values,
+                   ColumnChunk::Encoding encoding,
+                   const std::vector<Value> &constants) {
+    int32_t size = ColumnChunk::GetEncodedSize(type, values);
+    ASSERT_GE((int32_t)sizeof(data), size);
+    EXPECT_EQ(size, ColumnChunk::Encode(type, values, data));
+    ColumnChunk chunk(type, data);
+    EXPECT_EQ(encoding, chunk.GetEncoding());
+    char bytes[PAGE_SIZE], expected[PAGE_SIZE];
+    for (size_t i = 0; i < values.size(); i++) {
+      Value value = chunk.GetValue(i);
+      if (values[i].IsNull()) {
+        EXPECT_TRUE(value.IsNull());
+      } else {
+        EXPECT_EQ(CMP_TRUE, values[i].CompareEquals(value));
+      }
+      // bytes as in a tuple
+      values[i].SerializeTo(expected);
+      int32_t length = chunk.CopyValue(i, bytes);
+      EXPECT_EQ(0, memcmp(expected, bytes, length));
+      if (type == TypeId::VARCHAR) {
+        EXPECT_EQ(length, chunk.GetVarcharSize(i));
+      }
+    }
+    // filters on encoded values agree with comparing them one by one
+    for (auto &constant : constants) {
+      for (int op = 0; op <= (int)CompareOp::GREATER_THAN_EQUAL; op++) {
+        std::vector<char> matches(values.size(), 1);
+        chunk.Filter((CompareOp)op, constant, values.size(), matches);
+        for (size_t i = 0; i < values.size(); i++)
+          EXPECT_EQ(ColumnChunk::Compare(values[i], (CompareOp)op, constant),
+                    (bool)matches[i]);
+      }
+    }
+  };
+  const int count = 200;
+  std::vector<Value> values;
+
+  // small range integers are bit packed from their minimum
+  for (int i = 0; i < count; i++)
+    values.emplace_back(TypeId::INTEGER, 1000 + i * 7 % 300);
+  check(TypeId::INTEGER, values, ColumnChunk::FOR,
+        {Value(TypeId::INTEGER, 1100), Value(TypeId::BIGINT, (int64_t)5),
+         Value(TypeId::INTEGER, 2000), Value(TypeId::DECIMAL, 1150.5)});
+  EXPECT_GT(count * 2, ColumnChunk::GetEncodedSize(TypeId::INTEGER, values));
+
+  // long runs of wide values
+  values.clear();
+  for (int i = 0; i < count; i++)
+    values.emplace_back(TypeId::BIGINT, (int64_t)(i / 50) * 1000000000000);
+  check(TypeId::BIGINT, values, ColumnChunk::RLE,
+        {Value(TypeId::BIGINT, (int64_t)1000000000000),
+         Value(TypeId::BIGINT, (int64_t)-1)});
+
+  // low cardinality strings, null included
+  std::vector<std::string> states{"pending", "shipped", "delivered"};
+  values.clear();
+  for (int i = 0; i < count; i++) {
+    if (i % 17 == 0)
+      values.emplace_back(TypeId::VARCHAR, nullptr, PELOTON_VALUE_NULL, false);
+    else
+      values.emplace_back(TypeId::VARCHAR, states[i * 5 % 3]);
+  }
+  check(TypeId::VARCHAR, values, ColumnChunk::DICTIONARY,
+        {Value(TypeId::VARCHAR, "shipped"), Value(TypeId::VARCHAR, "o"),
+         Value(TypeId::VARCHAR, nullptr, PELOTON_VALUE_NULL, false)});
+
+  // null integers keep out of a frame
+  values.clear();
+  for (int i = 0; i < count; i++) {
+    int32_t value = i % 3 == 0 ? PELOTON_INT32_NULL : i % 3 * 1000000;
+    values.emplace_back(TypeId::INTEGER, value);
+  }
+  check(TypeId::INTEGER, values, ColumnChunk::DICTIONARY,
+        {Value(TypeId::INTEGER, 1000000), Value(TypeId::INTEGER, 0)});
+
+  // distinct values stay plain
+  std::mt19937 generator(0);
+  values.clear();
+  for (int i = 0; i < count; i++)
+    values.emplace_back(TypeId::VARCHAR,
+                        std::to_string(generator() % 1000 * count + i));
+  check(TypeId::VARCHAR, values, ColumnChunk::PLAIN,
+        {values[10], Value(TypeId::VARCHAR, "5")});
+  values.clear();
+  for (int i = 0; i < count; i++)
+    values.emplace_back(TypeId::DECIMAL, generator() / 3.0);
+  check(TypeId::DECIMAL, values, ColumnChunk::PLAIN,
+        {values[0], Value(TypeId::INTEGER, 1000)});
+  values.clear();
+  check(TypeId::INTEGER, values, ColumnChunk::PLAIN, {});
+}
+
+TEST(TupleTest, PaxCompressTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16), c int");
+  std::vector<std::string> states{"pending", "shipped", "delivered",
+                                  "returned"};
+  auto make_tuple = [&](int64_t key) {
+    std::vector<Value> values{Value(TypeId::BIGINT, key),
+                              Value(TypeId::VARCHAR, states[key % 4]),
+                              Value(TypeId::INTEGER, (int32_t)key % 50)};
+    return Tuple(values, schema);
+  };
+  auto check_tuple = [&](const TupleView &view, int64_t key) {
+    Tuple tuple = view.ToTuple();
+    Tuple expected = make_tuple(key);
+    ASSERT_EQ(expected.GetLength(), tuple.GetLength());
+    EXPECT_EQ(0, memcmp(expected.GetData(), tuple.GetData(),
+                        tuple.GetLength()));
+    EXPECT_EQ(states[key % 4], view.GetValue(schema, 1).ToString());
+  };
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction, schema);
+  std::map<int64_t, int64_t> rows; // rid -> key
+  RID rid;
+  for (int64_t i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(table->InsertTuple(make_tuple(i), rid, transaction));
+    if (i % 10 == 3)
+      table->ApplyDelete(rid, transaction);
+    else
+      rows[rid.Get()] = i;
+  }
+  transaction->GetWriteSet()->clear();
+  int plain_page_count =
+      CountTablePages(buffer_pool_manager, table->GetFirstPageId());
+
+  // tuples are packed into fewer pages and keep their bytes
+  std::map<int64_t, int64_t> moved_rows;
+  table->Compress(transaction, [&](const Tuple &tuple, const RID &old_rid,
+                                   const RID &new_rid) {
+    ASSERT_EQ(1, rows.count(old_rid.Get()));
+    EXPECT_EQ(rows[old_rid.Get()],
+              tuple.GetValue(schema, 0).GetAs<int64_t>());
+    moved_rows[new_rid.Get()] = rows[old_rid.Get()];
+    rows.erase(old_rid.Get());
+  });
+  rows.insert(moved_rows.begin(), moved_rows.end());
+  int encoded_page_count =
+      CountTablePages(buffer_pool_manager, table->GetFirstPageId());
+  EXPECT_GT(plain_page_count / 3, encoded_page_count);
+  size_t count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    ASSERT_EQ(1, rows.count(itr->GetRid().Get()));
+    check_tuple(*itr, rows[itr->GetRid().Get()]);
+    count++;
+  }
+  EXPECT_EQ(rows.size(), count);
+
+  // predicates read the encoded pages
+  auto count_matches = [&]() {
+    size_t match_count = 0;
+    TableBatchIterator itr(table, transaction);
+    while (itr.Next()) {
+      PaxPage *page = itr.GetPaxPage();
+      std::vector<char> matches;
+      page->Filter(1, CompareOp::EQUAL, Value(TypeId::VARCHAR, "shipped"),
+                   matches);
+      page->Filter(2, CompareOp::LESS_THAN, Value(TypeId::INTEGER, 10),
+                   matches);
+      for (auto &view : itr.GetBatch())
+        match_count += matches[view.GetRid().GetSlotNum()];
+    }
+    return match_count;
+  };
+  auto expected_matches = [&]() {
+    size_t match_count = 0;
+    for (auto &row : rows)
+      match_count += row.second % 4 == 1 && row.second % 50 < 10;
+    return match_count;
+  };
+  EXPECT_LT(0, expected_matches());
+  EXPECT_EQ(expected_matches(), count_matches());
+
+  // an encoded page deletes in place, but updates by delete and insert
+  int updated = 0;
+  for (auto &row : std::map<int64_t, int64_t>(rows)) {
+    rid.Set(row.first >> 32, (uint32_t)row.first);
+    int64_t key = row.second;
+    if (key % 7 > 1)
+      continue;
+    if (key % 7 == 1) {
+      EXPECT_FALSE(table->UpdateTuple(make_tuple(key), rid, transaction));
+    }
+    EXPECT_TRUE(table->MarkDelete(rid, transaction));
+    table->ApplyDelete(rid, transaction);
+    rows.erase(row.first);
+    if (key % 7 == 1) {
+      EXPECT_TRUE(table->InsertTuple(make_tuple(key), rid, transaction));
+      rows[rid.Get()] = key;
+      updated++;
+    }
+  }
+  EXPECT_LT(0, updated);
+  transaction->GetWriteSet()->clear();
+  EXPECT_EQ(expected_matches(), count_matches());
+
+  // once more, pages appended meanwhile are encoded too; then reopen
+  moved_rows.clear();
+  table->Compress(transaction, [&](const Tuple &tuple, const RID &old_rid,
+                                   const RID &new_rid) {
+    ASSERT_EQ(1, rows.count(old_rid.Get()));
+    moved_rows[new_rid.Get()] = rows[old_rid.Get()];
+    rows.erase(old_rid.Get());
+  });
+  rows.insert(moved_rows.begin(), moved_rows.end());
+  EXPECT_GE(encoded_page_count,
+            CountTablePages(buffer_pool_manager, table->GetFirstPageId()));
+  page_id_t first_page_id = table->GetFirstPageId();
+  delete table;
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                        first_page_id);
+  EXPECT_TRUE(table->IsPax());
+  count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    ASSERT_EQ(1, rows.count(itr->GetRid().Get()));
+    check_tuple(*itr, rows[itr->GetRid().Get()]);
+    count++;
+  }
+  EXPECT_EQ(rows.size(), count);
+  EXPECT_EQ(expected_matches(), count_matches());
+  // inserts go to plain pages behind the encoded ones
+  for (int64_t i = 1000; i < 1100; ++i) {
+    EXPECT_TRUE(table->InsertTuple(make_tuple(i), rid, transaction));
+    rows[rid.Get()] = i;
+  }
+  transaction->GetWriteSet()->clear();
+  EXPECT_EQ(expected_matches(), count_matches());
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: insert throughput of a table heap as it grows
+ */
+TEST(TupleTest, VacuumTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  // keep one row out of ten, scattered over all pages
+  RID rid;
+  std::map<int64_t, int64_t> rows; // rid -> key
+  std::mt19937 gen(0);
+  for (int64_t i = 0; i < 5000; ++i) {
+    std::vector<Value> values{Value(TypeId::BIGINT, i),
+                              Value(TypeId::VARCHAR, "vacuum")};
+    EXPECT_TRUE(table->InsertTuple(Tuple(values, schema), rid, transaction));
+    rows[rid.Get()] = i;
+  }
+  for (auto it = rows.begin(); it != rows.end();) {
+    if (gen() % 10 != 0) {
+      rid.Set(it->first >> 32, (uint32_t)it->first);
+      table->MarkDelete(rid, transaction);
+      table->ApplyDelete(rid, transaction);
+      it = rows.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  transaction->GetWriteSet()->clear();
+  int page_count =
+      CountTablePages(buffer_pool_manager, table->GetFirstPageId());
+
+  int moved = 0;
+  table->Vacuum(transaction, [&](const Tuple &tuple, const RID &old_rid,
+                                 const RID &new_rid) {
+    EXPECT_EQ(rows[old_rid.Get()],
+              tuple.GetValue(schema, 0).GetAs<int64_t>());
+    EXPECT_EQ(0, rows.count(new_rid.Get()));
+    rows[new_rid.Get()] = rows[old_rid.Get()];
+    rows.erase(old_rid.Get());
+    moved++;
+  });
+  EXPECT_GT(moved, 0);
+  EXPECT_LT(CountTablePages(buffer_pool_manager, table->GetFirstPageId()),
+            page_count / 5);
+
+  // every row is still there, at the rid reported
+  size_t count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    EXPECT_EQ(rows[itr->GetRid().Get()],
+              itr->GetValue(schema, 0).GetAs<int64_t>());
+    count++;
+  }
+  EXPECT_EQ(rows.size(), count);
+
+  // inserts go on after the tail moved
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)-1),
+                            Value(TypeId::VARCHAR, "vacuum")};
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_TRUE(table->InsertTuple(Tuple(values, schema), rid, transaction));
+  count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    count++;
+  EXPECT_EQ(rows.size() + 1000, count);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, OverflowTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(4096), c int");
+  auto make_tuple = [&](int64_t key, size_t length) {
+    std::vector<Value> values{
+        Value(TypeId::BIGINT, key),
+        Value(TypeId::VARCHAR, std::string(length, 'a' + key % 26)),
+        Value(TypeId::INTEGER, (int32_t)key)};
+    return Tuple(values, schema);
+  };
+  auto length_of = [](int64_t key) { return key % 3 == 0 ? 3000 : 10; };
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < 300; ++i) {
+    EXPECT_TRUE(table->InsertTuple(make_tuple(i, length_of(i)), rid,
+                                   transaction));
+    rids.push_back(rid);
+  }
+  // a large tuple is not updated in place
+  EXPECT_FALSE(table->UpdateTuple(make_tuple(1, 3000), rids[1], transaction));
+  EXPECT_TRUE(table->UpdateTuple(make_tuple(1, 10), rids[1], transaction));
+  EXPECT_FALSE(table->UpdateTuple(make_tuple(0, 20), rids[0], transaction));
+
+  // columns in the head are read without overflow pages; a small tuple
+  // may fill a page before a large one inserted ahead of it
+  int reads = disk_manager->GetNumReads();
+  std::set<int64_t> scanned;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    EXPECT_TRUE(scanned.insert(itr->GetValue(schema, 0).GetAs<int64_t>())
+                    .second);
+  EXPECT_EQ(300, scanned.size());
+  EXPECT_EQ(0, *scanned.begin());
+  EXPECT_EQ(299, *scanned.rbegin());
+  int head_reads = disk_manager->GetNumReads() - reads;
+  reads = disk_manager->GetNumReads();
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    int64_t key = itr->GetValue(schema, 2).GetAs<int32_t>();
+    Value value = itr->GetValue(schema, 1);
+    size_t length = length_of(key);
+    EXPECT_EQ(length, value.GetLength() - 1);
+    EXPECT_EQ(std::string(length, 'a' + key % 26),
+              std::string(value.GetData(), length));
+  }
+  EXPECT_GT(disk_manager->GetNumReads() - reads, 5 * head_reads);
+
+  // copies keep reading lazily, serialization reads everything
+  Tuple tuple;
+  EXPECT_TRUE(table->GetTuple(rids[3], tuple, transaction));
+  Tuple copy(tuple);
+  EXPECT_EQ(3000 + 1, copy.GetValue(schema, 1).GetLength());
+  std::vector<char> storage(tuple.GetLength() + sizeof(int32_t));
+  tuple.SerializeTo(storage.data());
+  Tuple deserialized;
+  deserialized.DeserializeFrom(storage.data());
+  EXPECT_EQ(3, deserialized.GetValue(schema, 2).GetAs<int32_t>());
+
+  // deleted large tuples give their pages back, vacuum keeps the rest
+  for (size_t i = 0; i < rids.size(); i += 2) {
+    table->MarkDelete(rids[i], transaction);
+    table->DeleteOverflowPages(table->ApplyDelete(rids[i], transaction));
+  }
+  transaction->GetWriteSet()->clear();
+  table->Vacuum(transaction);
+  std::set<int64_t> keys;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    int64_t key = itr->GetValue(schema, 2).GetAs<int32_t>();
+    EXPECT_EQ(1, key % 2);
+    EXPECT_EQ(length_of(key), itr->GetValue(schema, 1).GetLength() - 1);
+    keys.insert(key);
+  }
+  EXPECT_EQ(150, keys.size());
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, InsertTuplesTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(4096)");
+  auto make_tuple = [&](int64_t key, size_t length) {
+    std::vector<Value> values{
+        Value(TypeId::BIGINT, key),
+        Value(TypeId::VARCHAR, std::string(length, 'a' + key % 26))};
+    return Tuple(values, schema);
+  };
+  auto length_of = [](int64_t key) { return key % 50 == 7 ? 1000 : 20; };
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  TableHeap *single_table = new TableHeap(buffer_pool_manager, lock_manager,
+                                          log_manager, transaction);
+
+  // batches of small tuples with a large one here and there
+  std::vector<RID> rids;
+  for (int64_t batch = 0; batch < 4; batch++) {
+    std::vector<Tuple> tuples;
+    for (int64_t i = batch * 100; i < batch * 100 + 100; i++)
+      tuples.push_back(make_tuple(i, length_of(i)));
+    std::vector<RID> batch_rids;
+    EXPECT_TRUE(table->InsertTuples(tuples, batch_rids, transaction));
+    EXPECT_EQ(100, batch_rids.size());
+    rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+  }
+  EXPECT_TRUE(table->InsertTuples({}, rids, transaction));
+  EXPECT_EQ(0, rids.size());
+  EXPECT_EQ(400, transaction->GetWriteSet()->size());
+
+  RID rid;
+  for (int64_t i = 0; i < 400; i++)
+    EXPECT_TRUE(single_table->InsertTuple(make_tuple(i, length_of(i)), rid,
+                                          transaction));
+
+  // same rows, same number of pages as inserting one by one
+  Tuple tuple;
+  for (int64_t i = 0; i < 400; i++) {
+    EXPECT_TRUE(table->GetTuple(rids[i], tuple, transaction));
+    EXPECT_EQ(i, tuple.GetValue(schema, 0).GetAs<int64_t>());
+    EXPECT_EQ(length_of(i) + 1, tuple.GetValue(schema, 1).GetLength());
+  }
+  std::set<int64_t> keys;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    keys.insert(itr->GetValue(schema, 0).GetAs<int64_t>());
+  EXPECT_EQ(400, keys.size());
+  EXPECT_EQ(
+      CountTablePages(buffer_pool_manager, single_table->GetFirstPageId()),
+      CountTablePages(buffer_pool_manager, table->GetFirstPageId()));
+
+  // a batch fills the room left by deletes first
+  for (int64_t i = 0; i < 400; i += 2) {
+    EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  int page_count =
+      CountTablePages(buffer_pool_manager, table->GetFirstPageId());
+  std::vector<Tuple> tuples;
+  for (int64_t i = 0; i < 150; i++)
+    tuples.push_back(make_tuple(i, 20));
+  EXPECT_TRUE(table->InsertTuples(tuples, rids, transaction));
+  EXPECT_EQ(page_count,
+            CountTablePages(buffer_pool_manager, table->GetFirstPageId()));
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete single_table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, TupleViewTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(4096), c int");
+  auto make_tuple = [&](int64_t key, size_t length) {
+    std::vector<Value> values{
+        Value(TypeId::BIGINT, key),
+        Value(TypeId::VARCHAR, std::string(length, 'a' + key % 26)),
+        Value(TypeId::INTEGER, (int32_t)key)};
+    return Tuple(values, schema);
+  };
+  auto length_of = [](int64_t key) { return key % 10 == 3 ? 1000 : 10; };
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < 100; ++i) {
+    EXPECT_TRUE(table->InsertTuple(make_tuple(i, length_of(i)), rid,
+                                   transaction));
+    rids.push_back(rid);
+  }
+
+  // views read every column, large ones included, in the page frame
+  int64_t key = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    EXPECT_EQ(rids[key].Get(), itr->GetRid().Get());
+    EXPECT_EQ(key, itr->GetValue(schema, 0).GetAs<int64_t>());
+    EXPECT_EQ(key, itr->GetValue(schema, 2).GetAs<int32_t>());
+    Value value = itr->GetValue(schema, 1);
+    EXPECT_EQ(std::string(length_of(key), 'a' + key % 26),
+              std::string(value.GetData(), value.GetLength() - 1));
+    key++;
+  }
+  EXPECT_EQ(100, key);
+
+  // a view outlives nothing, copies of it do
+  ReadPageGuard guard;
+  TupleView view;
+  Tuple copy;
+  for (int64_t i : {5, 13}) {
+    EXPECT_TRUE(table->GetTupleView(rids[i], view, guard, transaction));
+    EXPECT_TRUE(guard.IsValid());
+    EXPECT_EQ(make_tuple(i, length_of(i)).GetLength(), view.GetLength());
+    copy = view.ToTuple();
+  }
+  guard.Release();
+  EXPECT_EQ(13, copy.GetValue(schema, 0).GetAs<int64_t>());
+  EXPECT_EQ(1000 + 1, copy.GetValue(schema, 1).GetLength());
+
+  // assignment replaces the data of a tuple, moves take it over
+  Tuple tuple = make_tuple(7, 10);
+  tuple = copy;
+  tuple = tuple;
+  EXPECT_EQ(13, tuple.GetValue(schema, 2).GetAs<int32_t>());
+  Tuple moved(std::move(tuple));
+  EXPECT_EQ(13, moved.GetValue(schema, 0).GetAs<int64_t>());
+  EXPECT_EQ(nullptr, tuple.GetData());
+  tuple = std::move(moved);
+  EXPECT_EQ(1000 + 1, tuple.GetValue(schema, 1).GetLength());
+
+  // a scan starts behind a first page without tuples
+  TableHeap *empty_first = new TableHeap(buffer_pool_manager, lock_manager,
+                                         log_manager, transaction);
+  for (int64_t i = 0; i < 40; ++i) {
+    EXPECT_TRUE(empty_first->InsertTuple(make_tuple(i, 10), rid,
+                                         transaction));
+    rids[i] = rid;
+  }
+  for (int64_t i = 0; i < 40; ++i) {
+    if (rids[i].GetPageId() != empty_first->GetFirstPageId())
+      continue;
+    EXPECT_TRUE(empty_first->MarkDelete(rids[i], transaction));
+    empty_first->ApplyDelete(rids[i], transaction);
+  }
+  key = 0;
+  for (auto itr = empty_first->begin(transaction); itr != empty_first->end();
+       ++itr)
+    key++;
+  EXPECT_LT(0, key);
+  EXPECT_GT(40, key);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete empty_first;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, BatchIteratorTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(4096), c int");
+  auto make_tuple = [&](int64_t key, size_t length) {
+    std::vector<Value> values{
+        Value(TypeId::BIGINT, key),
+        Value(TypeId::VARCHAR, std::string(length, 'a' + key % 26)),
+        Value(TypeId::INTEGER, (int32_t)key)};
+    return Tuple(values, schema);
+  };
+  auto length_of = [](int64_t key) { return key % 10 == 3 ? 1000 : 10; };
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < 500; ++i) {
+    EXPECT_TRUE(table->InsertTuple(make_tuple(i, length_of(i)), rid,
+                                   transaction));
+    rids.push_back(rid);
+  }
+  // leave some pages without tuples
+  for (int64_t i = 0; i < 500; ++i) {
+    if (i % 100 >= 50) {
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+    }
+  }
+
+  // same rows as the tuple iterator, batches don't cross pages
+  std::vector<int64_t> expected;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    expected.push_back(itr->GetValue(schema, 0).GetAs<int64_t>());
+  EXPECT_EQ(250, expected.size());
+  for (size_t batch_size : {1, 4, 64}) {
+    TableBatchIterator itr(table, transaction, batch_size);
+    std::vector<int64_t> keys;
+    std::vector<Value> column;
+    while (itr.Next()) {
+      EXPECT_GE(batch_size, itr.GetBatchSize());
+      page_id_t page_id = itr[0].GetRid().GetPageId();
+      itr.GetColumn(schema, 2, column);
+      ASSERT_EQ(itr.GetBatchSize(), column.size());
+      for (size_t i = 0; i < itr.GetBatchSize(); i++) {
+        int64_t key = itr[i].GetValue(schema, 0).GetAs<int64_t>();
+        EXPECT_EQ(page_id, itr[i].GetRid().GetPageId());
+        EXPECT_EQ(key, column[i].GetAs<int32_t>());
+        EXPECT_EQ(length_of(key) + 1, itr[i].GetValue(schema, 1).GetLength());
+        keys.push_back(key);
+      }
+    }
+    EXPECT_TRUE(itr.IsEnd());
+    EXPECT_EQ(0, itr.GetBatchSize());
+    EXPECT_FALSE(itr.Next());
+    EXPECT_EQ(expected, keys);
+  }
+
+  // a closed iterator gives its page back
+  TableBatchIterator itr(table, transaction);
+  EXPECT_TRUE(itr.Next());
+  itr.Close();
+  EXPECT_FALSE(itr.Next());
+  for (int i = 0; i < BUFFER_POOL_SIZE; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, buffer_pool_manager->NewPage(page_id));
+    buffer_pool_manager->UnpinPage(page_id, false);
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, BatchIteratorAbortTest) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  LogManager *log_manager = new LogManager(disk_manager);
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager, log_manager);
+  LockManager *lock_manager = new LockManager(true);
+
+  for (bool is_pax : {false, true}) {
+    Transaction *old_txn = new Transaction(0);
+    Transaction *young_txn = new Transaction(1);
+    TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                     log_manager, old_txn,
+                                     is_pax ? schema : nullptr);
+    RID rid;
+    std::vector<RID> rids;
+    for (int64_t i = 0; i < 100; ++i) {
+      std::vector<Value> values{Value(TypeId::BIGINT, i)};
+      EXPECT_TRUE(table->InsertTuple(Tuple(values, schema), rid, old_txn));
+      rids.push_back(rid);
+    }
+    old_txn->GetWriteSet()->clear();
+
+    // tuples are locked from here on. The younger transaction has read the
+    // last ones already, the older one holds the lock of a tuple before them
+    log_manager->RunFlushThread();
+    for (int i = 90; i < 100; ++i)
+      EXPECT_TRUE(lock_manager->LockShared(young_txn, rids[i]));
+    EXPECT_TRUE(lock_manager->LockExclusive(old_txn, rids[80]));
+    EXPECT_NE(rids[0].GetPageId(), rids[80].GetPageId());
+
+    // the younger one dies instead of waiting, its scan ends at that tuple
+    TableBatchIterator itr(table, young_txn);
+    std::vector<int64_t> keys;
+    while (itr.Next()) {
+      for (auto &view : itr.GetBatch())
+        keys.push_back(view.GetValue(schema, 0).GetAs<int64_t>());
+    }
+    EXPECT_EQ(TransactionState::ABORTED, young_txn->GetState());
+    EXPECT_TRUE(itr.IsEnd());
+    EXPECT_FALSE(itr.Next());
+    ASSERT_EQ(80, keys.size());
+    for (int64_t i = 0; i < 80; ++i)
+      EXPECT_EQ(i, keys[i]);
+
+    old_txn->SetState(TransactionState::ABORTED);
+    for (auto txn : {old_txn, young_txn}) {
+      std::vector<RID> locked_rids(txn->GetSharedLockSet()->begin(),
+                                   txn->GetSharedLockSet()->end());
+      locked_rids.insert(locked_rids.end(),
+                         txn->GetExclusiveLockSet()->begin(),
+                         txn->GetExclusiveLockSet()->end());
+      for (auto &locked_rid : locked_rids)
+        lock_manager->Unlock(txn, locked_rid);
+    }
+    log_manager->StopFlushThread();
+    delete table;
+    delete young_txn;
+    delete old_txn;
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete log_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, ParallelScanTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(32)");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < 2000; ++i) {
+    std::vector<Value> values{Value(TypeId::BIGINT, i),
+                              Value(TypeId::VARCHAR, "parallel scan")};
+    EXPECT_TRUE(table->InsertTuple(Tuple(values, schema), rid, transaction));
+    rids.push_back(rid);
+  }
+  // leave some pages without tuples
+  std::vector<int64_t> expected;
+  std::set<page_id_t> live_pages;
+  for (int64_t i = 0; i < 2000; ++i) {
+    if (i % 400 < 100) {
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+    } else {
+      expected.push_back(i);
+      live_pages.insert(rids[i].GetPageId());
+    }
+  }
+  size_t page_count = 0;
+  for (page_id_t page_id = table->GetFirstPageId();
+       page_id != INVALID_PAGE_ID; page_count++) {
+    auto page = static_cast<TablePage *>(
+        buffer_pool_manager->FetchPage(page_id));
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = page->GetNextPageId();
+  }
+
+  // every tuple once, whatever the number of threads and morsel size
+  for (size_t thread_count : {1, 2, 4, 8}) {
+    for (size_t morsel_size : {1, 3, 16}) {
+      ParallelTableScan scan(table, transaction, thread_count, morsel_size);
+      auto keys = scan.Reduce(
+          std::vector<int64_t>(),
+          [&](std::vector<int64_t> &result, const TupleView &view) {
+            result.push_back(view.GetValue(schema, 0).GetAs<int64_t>());
+          },
+          [](std::vector<int64_t> &result,
+             const std::vector<int64_t> &local) {
+            result.insert(result.end(), local.begin(), local.end());
+          });
+      std::sort(keys.begin(), keys.end());
+      EXPECT_EQ(expected, keys);
+      EXPECT_EQ(page_count, scan.GetPageCount());
+    }
+  }
+
+  // slow pages of one morsel are taken over by the other workers
+  ParallelTableScan scan(table, transaction, 4, page_count);
+  std::vector<std::set<page_id_t>> pages(4);
+  scan.Run([&](size_t worker_id, const TupleView &view) {
+    if (pages[worker_id].insert(view.GetRid().GetPageId()).second)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+  EXPECT_LT(0, scan.GetStealCount());
+  EXPECT_EQ(page_count, scan.GetPageCount());
+  std::set<page_id_t> scanned;
+  for (auto &worker_pages : pages) {
+    for (auto page_id : worker_pages)
+      EXPECT_TRUE(scanned.insert(page_id).second);
+  }
+  EXPECT_EQ(live_pages, scanned);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, PaxTableTest) {
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(64), c int");
+  auto make_tuple = [&](int64_t key, size_t length) {
+    std::vector<Value> values{
+        Value(TypeId::BIGINT, key),
+        Value(TypeId::VARCHAR, std::string(length, 'a' + key % 26)),
+        Value(TypeId::INTEGER, (int32_t)key * 2)};
+    return Tuple(values, schema);
+  };
+  auto check_tuple = [&](const TupleView &view, int64_t key, size_t length) {
+    EXPECT_EQ(key, view.GetValue(schema, 0).GetAs<int64_t>());
+    EXPECT_EQ(std::string(length, 'a' + key % 26),
+              view.GetValue(schema, 1).ToString());
+    EXPECT_EQ(key * 2, view.GetValue(schema, 2).GetAs<int32_t>());
+    // rows come back in row format, byte for byte
+    Tuple tuple = view.ToTuple();
+    Tuple expected = make_tuple(key, length);
+    ASSERT_EQ(expected.GetLength(), tuple.GetLength());
+    EXPECT_EQ(0, memcmp(expected.GetData(), tuple.GetData(),
+                        tuple.GetLength()));
+  };
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction, schema);
+  EXPECT_TRUE(table->IsPax());
+  // the fixed length part of a row has to fit in a page
+  std::string columns = "c0 bigint";
+  for (int i = 1; i < 60; i++)
+    columns += ", c" + std::to_string(i) + " bigint";
+  Schema *wide_schema = ParseCreateStatement(columns);
+  EXPECT_THROW(TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                         transaction, wide_schema),
+               Exception);
+  delete wide_schema;
+
+  RID rid;
+  std::map<int64_t, std::pair<int64_t, size_t>> rows; // rid -> key, length
+  for (int64_t i = 0; i < 1000; ++i) {
+    size_t length = i % 7 == 0 ? 40 : i % 5;
+    EXPECT_TRUE(
+        table->InsertTuple(make_tuple(i, length), rid, transaction));
+    rows[rid.Get()] = std::make_pair(i, length);
+  }
+  // tuples with overflow pages, or larger than a page, are refused
+  EXPECT_FALSE(table->InsertTuple(make_tuple(0, 200), rid, transaction));
+  transaction->SetState(TransactionState::GROWING);
+  EXPECT_FALSE(table->InsertTuple(make_tuple(0, 120), rid, transaction));
+  transaction->SetState(TransactionState::GROWING);
+
+  // updates in place while the page has room, deletes and their rollback
+  int updated = 0;
+  for (auto &row : rows) {
+    int64_t key = row.second.first;
+    rid.Set(row.first >> 32, (uint32_t)row.first);
+    if (key % 3 == 0) {
+      size_t length = 30 - row.second.second % 7;
+      if (table->UpdateTuple(make_tuple(key, length), rid, transaction)) {
+        row.second.second = length;
+        updated++;
+      }
+    } else if (key % 3 == 1) {
+      EXPECT_TRUE(table->MarkDelete(rid, transaction));
+      if (key % 2 == 0)
+        table->ApplyDelete(rid, transaction);
+      else
+        table->RollbackDelete(rid, transaction);
+    }
+  }
+  for (auto it = rows.begin(); it != rows.end();) {
+    int64_t key = it->second.first;
+    it = key % 3 == 1 && key % 2 == 0 ? rows.erase(it) : std::next(it);
+  }
+  EXPECT_LT(100, updated);
+  transaction->GetWriteSet()->clear();
+  Tuple tuple;
+  for (auto &row : rows) {
+    rid.Set(row.first >> 32, (uint32_t)row.first);
+    EXPECT_TRUE(table->GetTuple(rid, tuple, transaction));
+    EXPECT_EQ(row.second.first, tuple.GetValue(schema, 0).GetAs<int64_t>());
+  }
+
+  // slots of deleted tuples are taken again, varchar holes compacted
+  size_t count = rows.size();
+  for (int64_t i = 1000; i < 1200; ++i) {
+    EXPECT_TRUE(table->InsertTuple(make_tuple(i, 20), rid, transaction));
+    EXPECT_EQ(0, rows.count(rid.Get()));
+    rows[rid.Get()] = std::make_pair(i, 20);
+  }
+  EXPECT_EQ(count + 200, rows.size());
+
+  // iterators see the same rows, batches carry their PAX page
+  count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    auto &row = rows[itr->GetRid().Get()];
+    check_tuple(*itr, row.first, row.second);
+    count++;
+  }
+  EXPECT_EQ(rows.size(), count);
+  TableBatchIterator batch_itr(table, transaction);
+  count = 0;
+  while (batch_itr.Next()) {
+    PaxPage *page = batch_itr.GetPaxPage();
+    ASSERT_NE(nullptr, page);
+    auto keys = reinterpret_cast<const int64_t *>(page->GetMinipage(0));
+    for (auto &view : batch_itr.GetBatch()) {
+      EXPECT_EQ(rows[view.GetRid().Get()].first,
+                keys[view.GetRid().GetSlotNum()]);
+      count++;
+    }
+  }
+  EXPECT_EQ(rows.size(), count);
+
+  // vacuum and reopen, the pages tell their format
+  table->Vacuum(transaction, [&](const Tuple &tuple, const RID &old_rid,
+                                 const RID &new_rid) {
+    rows[new_rid.Get()] = rows[old_rid.Get()];
+    rows.erase(old_rid.Get());
+  });
+  page_id_t first_page_id = table->GetFirstPageId();
+  delete table;
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                        first_page_id);
+  EXPECT_TRUE(table->IsPax());
+  count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    auto &row = rows[itr->GetRid().Get()];
+    check_tuple(*itr, row.first, row.second);
+    count++;
+  }
+  EXPECT_EQ(rows.size(), count);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, DISABLED_InsertBenchmark) {
+  const int row_count = 2000000;
+  const int batch_size = 250000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)0),
+                            Value(TypeId::VARCHAR, "insert benchmark")};
+  Tuple tuple(values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  for (int rows = 0; rows < row_count; rows += batch_size) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < batch_size; ++i) {
+      table->InsertTuple(tuple, rid, transaction);
+      transaction->GetWriteSet()->clear();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << rows + batch_size << " rows: "
+              << batch_size /
+                     std::chrono::duration<double>(end - start).count()
+              << " inserts/s" << std::endl;
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: delete-heavy churn on full table pages, every step deletes a
+ * random tuple and inserts one of random size.
+ */
+TEST(TupleTest, DISABLED_ChurnBenchmark) {
+  const int page_count = 8;
+  const int step_count = 20000000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(64)");
+  std::vector<Tuple> tuples;
+  for (size_t length = 1; length <= 48; length++) {
+    std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)length),
+                              Value(TypeId::VARCHAR, std::string(length, 'x'))};
+    tuples.emplace_back(values, schema);
+  }
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  std::mt19937 gen(0);
+  std::vector<TablePage *> pages;
+  std::vector<std::vector<RID>> live(page_count);
+  RID rid;
+  for (int i = 0; i < page_count; i++) {
+    page_id_t page_id;
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager->NewPage(page_id));
+    page->Init(page_id, PAGE_SIZE, INVALID_PAGE_ID, nullptr, transaction);
+    while (page->InsertTuple(tuples[gen() % tuples.size()], rid, transaction,
+                             nullptr, nullptr))
+      live[i].push_back(rid);
+    pages.push_back(page);
+  }
+
+  int inserted = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step < step_count; step++) {
+    int i = gen() % page_count;
+    if (!live[i].empty()) {
+      size_t victim = gen() % live[i].size();
+      pages[i]->ApplyDelete(live[i][victim], transaction, nullptr);
+      live[i][victim] = live[i].back();
+      live[i].pop_back();
+    }
+    if (pages[i]->InsertTuple(tuples[gen() % tuples.size()], rid,
+                              transaction, nullptr, nullptr)) {
+      live[i].push_back(rid);
+      inserted++;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::cout << step_count << " delete/insert steps: "
+            << step_count / std::chrono::duration<double>(end - start).count()
+            << " steps/s, " << inserted << " inserts succeeded" << std::endl;
+
+  for (auto page : pages)
+    buffer_pool_manager->UnpinPage(page->GetPageId(), true);
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete transaction;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: scan time and file size of a table heap after churn deleted 90%
+ * of its rows, before and after vacuum.
+ */
+TEST(TupleTest, DISABLED_VacuumBenchmark) {
+  const int row_count = 500000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16)");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)0),
+                            Value(TypeId::VARCHAR, "vacuum benchmark")};
+  Tuple tuple(values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  std::vector<RID> rids;
+  for (int i = 0; i < row_count; ++i) {
+    table->InsertTuple(tuple, rid, transaction);
+    rids.push_back(rid);
+  }
+  std::mt19937 gen(0);
+  for (auto &rid : rids) {
+    if (gen() % 10 != 0) {
+      table->MarkDelete(rid, transaction);
+      table->ApplyDelete(rid, transaction);
+    }
+  }
+  transaction->GetWriteSet()->clear();
+
+  auto report = [&](const char *name) {
+    auto start = std::chrono::steady_clock::now();
+    int count = 0;
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+      count++;
+    auto end = std::chrono::steady_clock::now();
+    struct stat stat_buf;
+    stat("test.db", &stat_buf);
+    std::cout << name << ": scan " << count << " rows in "
+              << std::chrono::duration<double>(end - start).count() << "s, "
+              << CountTablePages(buffer_pool_manager, table->GetFirstPageId())
+              << " pages, file size " << stat_buf.st_size << " bytes"
+              << std::endl;
+  };
+  report("before vacuum");
+  auto start = std::chrono::steady_clock::now();
+  table->Vacuum(transaction);
+  auto end = std::chrono::steady_clock::now();
+  std::cout << "vacuum: " << std::chrono::duration<double>(end - start).count()
+            << "s" << std::endl;
+  report("after vacuum");
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: scan a table where one row in ten carries a 2KB column, reading
+ * the small columns only versus all of them.
+ */
+TEST(TupleTest, DISABLED_OverflowScanBenchmark) {
+  const int row_count = 200000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(4096), c int");
+  std::vector<Value> small_values{Value(TypeId::BIGINT, (int64_t)0),
+                                  Value(TypeId::VARCHAR, "small"),
+                                  Value(TypeId::INTEGER, 0)};
+  std::vector<Value> large_values{
+      Value(TypeId::BIGINT, (int64_t)0),
+      Value(TypeId::VARCHAR, std::string(2000, 'x')),
+      Value(TypeId::INTEGER, 0)};
+  Tuple small_tuple(small_values, schema), large_tuple(large_values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  RID rid;
+  for (int i = 0; i < row_count; ++i) {
+    table->InsertTuple(i % 10 == 0 ? large_tuple : small_tuple, rid,
+                       transaction);
+    transaction->GetWriteSet()->clear();
+  }
+
+  for (int column_count : {2, 3}) {
+    int reads = disk_manager->GetNumReads();
+    auto start = std::chrono::steady_clock::now();
+    int64_t checksum = 0;
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      checksum += itr->GetValue(schema, 0).GetAs<int64_t>();
+      checksum += itr->GetValue(schema, 2).GetAs<int32_t>();
+      if (column_count == 3)
+        checksum += itr->GetValue(schema, 1).GetLength();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << (column_count == 2 ? "scan a, c:    " : "scan a, b, c: ")
+              << std::chrono::duration<double>(end - start).count() << "s, "
+              << disk_manager->GetNumReads() - reads << " page reads, "
+              << "checksum " << checksum << std::endl;
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: full scans reading every column of small rows, counting heap
+ * allocations per row
+ */
+TEST(TupleTest, DISABLED_ScanBenchmark) {
+  const int row_count = 200000;
+  const int round_count = 10;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16), c int");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)1),
+                            Value(TypeId::VARCHAR, "scan benchmark"),
+                            Value(TypeId::INTEGER, 2)};
+  Tuple tuple(values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  RID rid;
+  for (int i = 0; i < row_count; ++i) {
+    table->InsertTuple(tuple, rid, transaction);
+    transaction->GetWriteSet()->clear();
+  }
+
+  int64_t allocations = allocation_count;
+  auto start = std::chrono::steady_clock::now();
+  int64_t checksum = 0;
+  for (int round = 0; round < round_count; round++) {
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      checksum += itr->GetValue(schema, 0).GetAs<int64_t>();
+      checksum += itr->GetValue(schema, 1).GetLength();
+      checksum += itr->GetValue(schema, 2).GetAs<int32_t>();
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << row_count * round_count / seconds << " rows/s, "
+            << (double)(allocation_count - allocations) /
+                   (row_count * round_count)
+            << " allocations/row, checksum " << checksum << std::endl;
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: the same full scans as DISABLED_ScanBenchmark, row by row with
+ * TableIterator versus a page at a time with TableBatchIterator
+ */
+TEST(TupleTest, DISABLED_BatchScanBenchmark) {
+  const int row_count = 200000;
+  const int round_count = 10;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16), c int");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)1),
+                            Value(TypeId::VARCHAR, "scan benchmark"),
+                            Value(TypeId::INTEGER, 2)};
+  Tuple tuple(values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  RID rid;
+  for (int i = 0; i < row_count; ++i) {
+    table->InsertTuple(tuple, rid, transaction);
+    transaction->GetWriteSet()->clear();
+  }
+
+  auto report = [&](const std::string &name,
+                    std::chrono::steady_clock::time_point start,
+                    int64_t checksum) {
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << name << row_count * round_count / seconds
+              << " rows/s, checksum " << checksum << std::endl;
+  };
+  auto start = std::chrono::steady_clock::now();
+  int64_t checksum = 0;
+  for (int round = 0; round < round_count; round++) {
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      checksum += itr->GetValue(schema, 0).GetAs<int64_t>();
+      checksum += itr->GetValue(schema, 2).GetAs<int32_t>();
+    }
+  }
+  report("tuple iterator: ", start, checksum);
+
+  start = std::chrono::steady_clock::now();
+  checksum = 0;
+  for (int round = 0; round < round_count; round++) {
+    TableBatchIterator itr(table, transaction);
+    while (itr.Next()) {
+      for (auto &view : itr.GetBatch()) {
+        checksum += view.GetValue(schema, 0).GetAs<int64_t>();
+        checksum += view.GetValue(schema, 2).GetAs<int32_t>();
+      }
+    }
+  }
+  report("batch views:    ", start, checksum);
+
+  start = std::chrono::steady_clock::now();
+  checksum = 0;
+  std::vector<Value> a, c;
+  for (int round = 0; round < round_count; round++) {
+    TableBatchIterator itr(table, transaction);
+    while (itr.Next()) {
+      itr.GetColumn(schema, 0, a);
+      itr.GetColumn(schema, 2, c);
+      for (size_t i = 0; i < a.size(); i++)
+        checksum += a[i].GetAs<int64_t>() + c[i].GetAs<int32_t>();
+    }
+  }
+  report("batch columns:  ", start, checksum);
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: parallel scan of a table that is not cached, with 1 to 32
+ * threads, and some work per tuple
+ */
+TEST(TupleTest, DISABLED_ParallelScanBenchmark) {
+  const int row_count = 200000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar(16), c int");
+  std::vector<Value> values{Value(TypeId::BIGINT, (int64_t)1),
+                            Value(TypeId::VARCHAR, "scan benchmark"),
+                            Value(TypeId::INTEGER, 2)};
+  Tuple tuple(values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(64, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  RID rid;
+  for (int i = 0; i < row_count; ++i) {
+    table->InsertTuple(tuple, rid, transaction);
+    transaction->GetWriteSet()->clear();
+  }
+
+  for (size_t thread_count : {1, 2, 4, 8, 16, 32}) {
+    ParallelTableScan scan(table, transaction, thread_count);
+    auto start = std::chrono::steady_clock::now();
+    int64_t checksum = scan.Reduce(
+        (int64_t)0,
+        [&](int64_t &result, const TupleView &view) {
+          uint64_t hash = view.GetValue(schema, 0).GetAs<int64_t>();
+          for (int i = 0; i < 64; i++)
+            hash = hash * 6364136223846793005ULL + 1442695040888963407ULL;
+          result += hash >> 60;
+        },
+        [](int64_t &result, int64_t local) { result += local; });
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << thread_count << " threads: " << row_count / seconds
+              << " rows/s, " << scan.GetStealCount()
+              << " pages stolen, checksum " << checksum << std::endl;
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: scans reading 2 of 20 columns, slotted pages versus PAX pages
+ */
+TEST(TupleTest, DISABLED_PaxScanBenchmark) {
+  const int row_count = 100000;
+  const int round_count = 10;
+  std::string columns;
+  for (int i = 0; i < 20; i++)
+    columns += (i == 0 ? "c" : ", c") + std::to_string(i) + " int";
+  Schema *schema = ParseCreateStatement(columns);
+  std::vector<Value> values;
+  for (int i = 0; i < 20; i++)
+    values.emplace_back(TypeId::INTEGER, i);
+  Tuple tuple(values, schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // every page stays cached
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(30000, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  for (bool is_pax : {false, true}) {
+    TableHeap table(buffer_pool_manager, lock_manager, log_manager,
+                    transaction, is_pax ? schema : nullptr);
+    RID rid;
+    for (int i = 0; i < row_count; ++i) {
+      table.InsertTuple(tuple, rid, transaction);
+      transaction->GetWriteSet()->clear();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t checksum = 0;
+    for (int round = 0; round < round_count; round++) {
+      TableBatchIterator itr(&table, transaction);
+      while (itr.Next()) {
+        for (auto &view : itr.GetBatch()) {
+          checksum += view.GetValue(schema, 3).GetAs<int32_t>();
+          checksum += view.GetValue(schema, 17).GetAs<int32_t>();
+        }
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << (is_pax ? "pax values:     " : "slotted values: ")
+              << row_count * round_count / seconds << " rows/s, checksum "
+              << checksum << ", "
+              << CountTablePages(buffer_pool_manager, table.GetFirstPageId())
+              << " pages" << std::endl;
+    if (!is_pax)
+      continue;
+
+    start = std::chrono::steady_clock::now();
+    checksum = 0;
+    for (int round = 0; round < round_count; round++) {
+      TableBatchIterator itr(&table, transaction);
+      while (itr.Next()) {
+        PaxPage *page = itr.GetPaxPage();
+        auto c3 = reinterpret_cast<const int32_t *>(page->GetMinipage(3));
+        auto c17 = reinterpret_cast<const int32_t *>(page->GetMinipage(17));
+        for (auto &view : itr.GetBatch()) {
+          int slot_num = view.GetRid().GetSlotNum();
+          checksum += c3[slot_num] + c17[slot_num];
+        }
+      }
+    }
+    end = std::chrono::steady_clock::now();
+    seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "pax minipages:  " << row_count * round_count / seconds
+              << " rows/s, checksum " << checksum << std::endl;
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+/*
+ * Benchmark: pages of an order table and scans with a predicate on 2 of its
+ * columns, slotted pages, PAX pages and encoded PAX pages
+ */
+TEST(TupleTest, DISABLED_CompressedScanBenchmark) {
+  const int row_count = 100000;
+  const int round_count = 10;
+  Schema *schema = ParseCreateStatement(
+      "id bigint, status varchar(16), quantity int, price int, day int");
+  std::vector<std::string> states{"delivered", "shipped", "pending",
+                                  "returned", "cancelled"};
+  std::mt19937 generator(0);
+  std::vector<Tuple> tuples;
+  for (int64_t i = 0; i < row_count; i++) {
+    // most orders are delivered, days grow with ids
+    int state = generator() % 10;
+    std::vector<Value> values{
+        Value(TypeId::BIGINT, i + 1000000),
+        Value(TypeId::VARCHAR, states[state < 6 ? 0 : state - 5]),
+        Value(TypeId::INTEGER, (int32_t)(1 + generator() % 50)),
+        Value(TypeId::INTEGER, (int32_t)(generator() % 10000)),
+        Value(TypeId::INTEGER, (int32_t)(18000 + i / 300))};
+    tuples.emplace_back(values, schema);
+  }
+  Value shipped(TypeId::VARCHAR, "shipped");
+  Value ten(TypeId::INTEGER, 10);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // every page stays cached
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(30000, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  for (int format = 0; format < 3; format++) {
+    TableHeap table(buffer_pool_manager, lock_manager, log_manager,
+                    transaction, format == 0 ? nullptr : schema);
+    RID rid;
+    for (auto &tuple : tuples) {
+      table.InsertTuple(tuple, rid, transaction);
+      transaction->GetWriteSet()->clear();
+    }
+    if (format == 2)
+      table.Compress(transaction);
+    const char *name =
+        format == 0 ? "slotted" : format == 1 ? "pax" : "encoded";
+    std::cout << name << ": "
+              << CountTablePages(buffer_pool_manager, table.GetFirstPageId())
+              << " pages" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t match_count = 0;
+    for (int round = 0; round < round_count; round++) {
+      TableBatchIterator itr(&table, transaction);
+      while (itr.Next()) {
+        for (auto &view : itr.GetBatch()) {
+          match_count +=
+              view.GetValue(schema, 1).CompareEquals(shipped) == CMP_TRUE &&
+              view.GetValue(schema, 2).CompareLessThan(ten) == CMP_TRUE;
+        }
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "  values: " << row_count * round_count / seconds
+              << " rows/s, " << match_count / round_count << " matches"
+              << std::endl;
+    if (format == 0)
+      continue;
+
+    start = std::chrono::steady_clock::now();
+    match_count = 0;
+    for (int round = 0; round < round_count; round++) {
+      TableBatchIterator itr(&table, transaction);
+      std::vector<char> matches;
+      page_id_t page_id = INVALID_PAGE_ID;
+      while (itr.Next()) {
+        PaxPage *page = itr.GetPaxPage();
+        // a page may take more than one batch
+        if (page->GetPageId() != page_id) {
+          page_id = page->GetPageId();
+          matches.clear();
+          page->Filter(1, CompareOp::EQUAL, shipped, matches);
+          page->Filter(2, CompareOp::LESS_THAN, ten, matches);
+        }
+        for (auto &view : itr.GetBatch())
+          match_count += matches[view.GetRid().GetSlotNum()];
+      }
+    }
+    end = std::chrono::steady_clock::now();
+    seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "  filter: " << row_count * round_count / seconds
+              << " rows/s, " << match_count / round_count << " matches"
+              << std::endl;
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
 } // namespace scudb
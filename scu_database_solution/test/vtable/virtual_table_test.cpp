@@ -1,6 +1,10 @@
 /**
  * virtual_table_test.cpp
  */
+#include <chrono>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "vtable/testing_vtable_util.h"
 
 namespace scudb {
@@ -44,4 +48,575 @@ TEST(VtableTest, CreateTest) {
   remove("vtable.db");
   return;
 }
+
+namespace {
+// idxNum flags of VtabBestIndex, virtual_table.h can't be included here since
+// it is built against the sqlite extension api
+const int INDEX_SCAN_EQUAL = 1;
+const int INDEX_SCAN_LOWER = 2;
+const int INDEX_SCAN_UPPER = 4;
+const int INDEX_ONLY_SCAN = 8;
+
+// run a query and return the number of rows and sum of the first column
+int64_t QueryRows(sqlite3 *db, const std::string &sql,
+                  int64_t *sum = nullptr) {
+  sqlite3_stmt *stmt;
+  EXPECT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, 0));
+  int64_t rows = 0;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    rows++;
+    if (sum != nullptr)
+      *sum += sqlite3_column_int64(stmt, 0);
+  }
+  sqlite3_finalize(stmt);
+  return rows;
+}
+
+// run a query and return the first column of its first row as text
+std::string QueryText(sqlite3 *db, const std::string &sql) {
+  sqlite3_stmt *stmt;
+  EXPECT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, 0));
+  std::string text;
+  if (sqlite3_step(stmt) == SQLITE_ROW)
+    text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+  sqlite3_finalize(stmt);
+  return text;
+}
+
+// idxNum chosen by VtabBestIndex for a query
+int QueryIndexNum(sqlite3 *db, const std::string &sql) {
+  sqlite3_stmt *stmt;
+  std::string explain = "EXPLAIN QUERY PLAN " + sql;
+  EXPECT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, explain.c_str(), -1, &stmt, 0));
+  int idx_num = 0;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    std::string detail(
+        reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)));
+    auto n = detail.find("INDEX ");
+    if (n != std::string::npos)
+      idx_num = std::stoi(detail.substr(n + 6));
+  }
+  sqlite3_finalize(stmt);
+  return idx_num;
+}
+
+// open the database as left by the last connection
+sqlite3 *ReopenDatabase(const std::string &db_file) {
+  sqlite3 *db;
+  EXPECT_EQ(SQLITE_OK, sqlite3_open(db_file.c_str(), &db));
+  EXPECT_EQ(SQLITE_OK, sqlite3_enable_load_extension(db, 1));
+  EXPECT_EQ(SQLITE_OK, sqlite3_load_extension(db, "libvtable", 0, 0));
+  return db;
+}
+
+sqlite3 *OpenDatabase(const std::string &db_file) {
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return ReopenDatabase(db_file);
+}
+} // namespace
+
+TEST(VtableTest, CoveringIndexTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo2 USING vtable ('a int, "
+                          "b int, c varchar(8)', 'foo2_b b include(a)')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo2 VALUES(" + std::to_string(i) +
+                                ", " + std::to_string(i * 2) + ", 'x')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  // key and included columns only, table heap is never read
+  std::string sql = "SELECT a, b FROM foo2 WHERE b BETWEEN 10 AND 20";
+  EXPECT_EQ(INDEX_SCAN_LOWER | INDEX_SCAN_UPPER | INDEX_ONLY_SCAN,
+            QueryIndexNum(db, sql));
+  int64_t sum = 0;
+  EXPECT_EQ(6, QueryRows(db, sql, &sum));
+  EXPECT_EQ(5 + 6 + 7 + 8 + 9 + 10, sum);
+  sql = "SELECT b FROM foo2 WHERE b > 190";
+  EXPECT_EQ(INDEX_SCAN_LOWER | INDEX_ONLY_SCAN, QueryIndexNum(db, sql));
+  EXPECT_EQ(4, QueryRows(db, sql));
+  sql = "SELECT a FROM foo2 WHERE b = 42";
+  EXPECT_EQ(INDEX_SCAN_EQUAL | INDEX_ONLY_SCAN, QueryIndexNum(db, sql));
+  sum = 0;
+  EXPECT_EQ(1, QueryRows(db, sql, &sum));
+  EXPECT_EQ(21, sum);
+
+  // column c is not in the index
+  sql = "SELECT c FROM foo2 WHERE b <= 8";
+  EXPECT_EQ(INDEX_SCAN_UPPER, QueryIndexNum(db, sql));
+  EXPECT_EQ(5, QueryRows(db, sql));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo2"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+/*
+ * Entries are kept in keys of at most MAX_KEY_SIZE bytes. Included columns
+ * that can't fit at their declared length are refused, and so are longer
+ * values than declared, an index-only scan never reads a cut off entry
+ */
+TEST(VtableTest, LongIncludedColumnTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+  std::string long_text(62, 'x');
+  std::string text(39, 'y');
+
+  EXPECT_FALSE(ExecSQL(db, "CREATE VIRTUAL TABLE foo6 USING vtable ('a int, "
+                           "b varchar(100)', 'foo6_a a include(b)')"));
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo6 USING vtable ('a int, "
+                          "b varchar(40)', 'foo6_a a include(b)')"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo6 VALUES(1, '" + text + "')"));
+  EXPECT_FALSE(ExecSQL(db, "INSERT INTO foo6 VALUES(2, '" + long_text + "')"));
+  EXPECT_FALSE(
+      ExecSQL(db, "UPDATE foo6 SET b = '" + long_text + "' WHERE a = 1"));
+  std::string sql = "SELECT b FROM foo6 WHERE a = 1";
+  EXPECT_EQ(INDEX_SCAN_EQUAL | INDEX_ONLY_SCAN, QueryIndexNum(db, sql));
+  EXPECT_EQ(text, QueryText(db, sql));
+  EXPECT_EQ(0, QueryRows(db, "SELECT b FROM foo6 WHERE a = 2"));
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo6"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+
+  // a long varchar key may be cut off, the heap is read
+  db = OpenDatabase(db_file);
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo7 USING vtable ('a int, "
+                          "b varchar(100)', 'foo7_b b')"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo7 VALUES(1, '" + long_text + "')"));
+  sql = "SELECT b FROM foo7 WHERE b > 'a'";
+  EXPECT_EQ(INDEX_SCAN_LOWER, QueryIndexNum(db, sql));
+  EXPECT_EQ(long_text, QueryText(db, sql));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo7"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+TEST(VtableTest, BETreeIndexTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo4 USING vtable ('a int, "
+                          "b varchar(8)', 'foo4_a using betree a')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 300; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo4 VALUES(" +
+                                std::to_string(i * 7 % 300) + ", 'x')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo4 WHERE a < 100"));
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  std::string sql = "SELECT a FROM foo4 WHERE a = 150";
+  EXPECT_EQ(INDEX_SCAN_EQUAL | INDEX_ONLY_SCAN, QueryIndexNum(db, sql));
+  EXPECT_EQ(1, QueryRows(db, sql));
+  EXPECT_EQ(0, QueryRows(db, "SELECT a FROM foo4 WHERE a = 50"));
+  int64_t sum = 0;
+  EXPECT_EQ(11, QueryRows(db, "SELECT a FROM foo4 WHERE a BETWEEN 90 AND 110",
+                          &sum));
+  EXPECT_EQ(100 * 11 + 55, sum);
+  EXPECT_EQ(200, QueryRows(db, "SELECT b FROM foo4 WHERE a >= 0"));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo4"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+TEST(VtableTest, HashIndexTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo5 USING vtable ('a int, "
+                          "b int', 'foo5_a using hash a')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 300; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo5 VALUES(" + std::to_string(i) +
+                                ", " + std::to_string(i * 2) + ")"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo5 WHERE a = 7"));
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  std::string sql = "SELECT b FROM foo5 WHERE a = 150";
+  EXPECT_EQ(INDEX_SCAN_EQUAL, QueryIndexNum(db, sql));
+  int64_t sum = 0;
+  EXPECT_EQ(1, QueryRows(db, sql, &sum));
+  EXPECT_EQ(300, sum);
+  sql = "SELECT a FROM foo5 WHERE a = 7";
+  EXPECT_EQ(INDEX_SCAN_EQUAL | INDEX_ONLY_SCAN, QueryIndexNum(db, sql));
+  EXPECT_EQ(0, QueryRows(db, sql));
+  // ranges are not served by a hash index
+  sql = "SELECT a FROM foo5 WHERE a BETWEEN 0 AND 9";
+  EXPECT_EQ(0, QueryIndexNum(db, sql));
+  EXPECT_EQ(9, QueryRows(db, sql));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo5"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+TEST(VtableTest, LargeTupleTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  // rows with b of 1000 characters don't fit in a page
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo6 USING vtable ('a int, "
+                          "b varchar(2000), c int', 'foo6_a a')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 100; i++) {
+    std::string b = i % 2 == 0 ? "replace(hex(zeroblob(500)), '0', 'x')"
+                               : "'small'";
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo6 VALUES(" + std::to_string(i) +
+                                ", " + b + ", " + std::to_string(i) + ")"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  int64_t sum = 0;
+  EXPECT_EQ(100, QueryRows(db, "SELECT c FROM foo6", &sum));
+  EXPECT_EQ(99 * 50, sum);
+  sum = 0;
+  EXPECT_EQ(100, QueryRows(db, "SELECT length(b) FROM foo6", &sum));
+  EXPECT_EQ(50 * 1000 + 50 * 5, sum);
+  EXPECT_EQ(50, QueryRows(db, "SELECT a FROM foo6 WHERE b LIKE 'xxxx%'"));
+
+  // updates across the threshold, and deletes through the index
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo6 SET b = 'small' WHERE a < 10"));
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo6 SET b = replace(hex(zeroblob(600)), "
+                          "'0', 'y') WHERE a >= 90"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo6 WHERE a BETWEEN 40 AND 49"));
+  sum = 0;
+  EXPECT_EQ(90, QueryRows(db, "SELECT length(b) FROM foo6", &sum));
+  EXPECT_EQ(35 * 1000 + 10 * 1200 + 45 * 5, sum);
+  sum = 0;
+  EXPECT_EQ(1, QueryRows(db, "SELECT c FROM foo6 WHERE a = 92", &sum));
+  EXPECT_EQ(92, sum);
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo6"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+TEST(VtableTest, BulkInsertTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo7 USING vtable ('a int, "
+                          "b int, c varchar(8)', 'foo7_b nonunique b')"));
+  // rows are buffered, and written in batches along the statement
+  EXPECT_TRUE(ExecSQL(db, "WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT "
+                          "x + 1 FROM n WHERE x < 1000) INSERT INTO foo7 "
+                          "SELECT x, x % 100, 'bulk' FROM n"));
+  int64_t sum = 0;
+  EXPECT_EQ(1000, QueryRows(db, "SELECT a FROM foo7", &sum));
+  EXPECT_EQ(500500, sum);
+  EXPECT_EQ(10, QueryRows(db, "SELECT a FROM foo7 WHERE b = 42"));
+
+  // buffered rows are seen by reads, updates and deletes of the transaction
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 1001; i <= 1010; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo7 VALUES(" + std::to_string(i) +
+                                ", 200, 'txn')"));
+  }
+  EXPECT_EQ(10, QueryRows(db, "SELECT a FROM foo7 WHERE b = 200"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo7 VALUES(1011, 200, 'txn')"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo7 WHERE b = 200 AND a > 1005"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo7 VALUES(1012, 200, 'txn')"));
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo7 SET b = 201 WHERE b = 200"));
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+  sum = 0;
+  EXPECT_EQ(6, QueryRows(db, "SELECT a FROM foo7 WHERE b = 201", &sum));
+  EXPECT_EQ(1001 + 1002 + 1003 + 1004 + 1005 + 1012, sum);
+  EXPECT_EQ(1006, QueryRows(db, "SELECT a FROM foo7"));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo7"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+TEST(VtableTest, InsertFailureTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo8 USING vtable ('a int, "
+                          "b int', 'foo8_a a')"));
+  EXPECT_TRUE(ExecSQL(db, "WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT "
+                          "x + 1 FROM n WHERE x < 400) INSERT INTO foo8 "
+                          "SELECT x, x FROM n"));
+  // scans left on rows of different pages keep all the buffer pool but one
+  // page pinned, a batch fills the last page and finds no room for a new one
+  std::vector<sqlite3_stmt *> scans;
+  for (int i = 0; i < 9; i++) {
+    sqlite3_stmt *stmt;
+    std::string sql =
+        "SELECT a FROM foo8 WHERE b >= " + std::to_string(1 + 40 * i);
+    EXPECT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, 0));
+    EXPECT_EQ(SQLITE_ROW, sqlite3_step(stmt));
+    scans.push_back(stmt);
+  }
+  EXPECT_EQ(SQLITE_ABORT,
+            sqlite3_exec(db, "WITH RECURSIVE n(x) AS (SELECT 1001 UNION ALL "
+                             "SELECT x + 1 FROM n WHERE x < 1300) INSERT INTO "
+                             "foo8 SELECT x, x FROM n",
+                         nullptr, nullptr, nullptr));
+  for (auto stmt : scans)
+    sqlite3_finalize(stmt);
+
+  // rows of the failed batch are neither in table heap nor in the index
+  int64_t sum = 0;
+  EXPECT_EQ(400, QueryRows(db, "SELECT a FROM foo8", &sum));
+  EXPECT_EQ(80200, sum);
+  EXPECT_EQ(400, QueryRows(db, "SELECT a FROM foo8 WHERE a >= 1"));
+  EXPECT_EQ(0, QueryRows(db, "SELECT a FROM foo8 WHERE a > 400"));
+  // and the table takes them once there is room
+  EXPECT_TRUE(ExecSQL(db, "WITH RECURSIVE n(x) AS (SELECT 1001 UNION ALL "
+                          "SELECT x + 1 FROM n WHERE x < 1300) INSERT INTO "
+                          "foo8 SELECT x, x FROM n"));
+  EXPECT_EQ(700, QueryRows(db, "SELECT a FROM foo8"));
+  EXPECT_EQ(300, QueryRows(db, "SELECT a FROM foo8 WHERE a > 400"));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo8"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+/*
+ * Benchmark: SELECT over a range of the indexed column, answered from the
+ * index only versus fetching every row from the table heap
+ */
+TEST(VtableTest, PaxTableTest) {
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo8 USING vtable ('a int, "
+                          "b varchar(8), c bigint', 'foo8_a a', 'pax')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 300; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo8 VALUES(" + std::to_string(i) +
+                                ", 'x', " + std::to_string(i * 2) + ")"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo8 WHERE a < 100"));
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo8 SET b = 'longer' WHERE a >= 250"));
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  int64_t sum = 0;
+  EXPECT_EQ(200, QueryRows(db, "SELECT c FROM foo8", &sum));
+  EXPECT_EQ(2 * (100 + 299) * 200 / 2, sum);
+  EXPECT_EQ(50, QueryRows(db, "SELECT a FROM foo8 WHERE b = 'longer'"));
+  EXPECT_EQ(1, QueryRows(db, "SELECT b FROM foo8 WHERE a = 150"));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo8"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+// vtable.db with its log, the replica follows the log from its start
+static void RemoveVtableFiles() {
+  remove("vtable.db");
+  remove("vtable.master");
+  remove("vtable_replica.db");
+  remove("vtable.log");
+  for (int i = 1;; i++) {
+    if (remove(("vtable.log." + std::to_string(i)).c_str()) != 0)
+      break;
+  }
+}
+
+/*
+ * A replica in another process, with the schemas of the primary's sqlite
+ * database, reads the committed rows and is read-only. The child exits with
+ * the row count, plus 100 if it could write
+ */
+TEST(VtableTest, ReplicaTest) {
+  std::string db_file = "sqlite.db";
+  RemoveVtableFiles();
+  sqlite3 *db = OpenDatabase(db_file);
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo9 USING vtable ('a int, "
+                          "b varchar(8)', 'foo9_a a')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 40; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo9 VALUES(" + std::to_string(i) +
+                                ", 'x')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo9 WHERE a < 10"));
+
+  pid_t pid = fork();
+  ASSERT_LE(0, pid);
+  if (pid == 0) {
+    sqlite3 *replica_db;
+    if (sqlite3_open_v2(db_file.c_str(), &replica_db, SQLITE_OPEN_READONLY,
+                        nullptr) != SQLITE_OK ||
+        sqlite3_enable_load_extension(replica_db, 1) != SQLITE_OK ||
+        sqlite3_load_extension(replica_db, "libvtable",
+                               "sqlite3_vtablereplica_init", 0) != SQLITE_OK)
+      _exit(255);
+    int64_t rows = QueryRows(replica_db, "SELECT a FROM foo9 WHERE a >= 20");
+    rows += QueryRows(replica_db, "SELECT a FROM foo9 WHERE a < 20");
+    if (sqlite3_exec(replica_db, "INSERT INTO foo9 VALUES(100, 'y')", 0, 0,
+                     0) == SQLITE_OK)
+      rows += 100;
+    if (QueryRows(replica_db, "SELECT replica_lag()") != 1)
+      rows += 100;
+    _exit(rows);
+  }
+  int status;
+  EXPECT_EQ(pid, waitpid(pid, &status, 0));
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(30, WEXITSTATUS(status));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo9"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  RemoveVtableFiles();
+}
+
+/*
+ * Closing the database leaves the buffer pool unflushed, like a crash. The
+ * next connection recovers the committed rows from the log, again after a
+ * restart of its own
+ */
+TEST(VtableTest, ReopenTest) {
+  std::string db_file = "sqlite.db";
+  RemoveVtableFiles();
+  sqlite3 *db = OpenDatabase(db_file);
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo10 USING vtable ('a int, "
+                          "b varchar(8)', 'foo10_a a')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo10 VALUES(" + std::to_string(i) +
+                                ", 'x')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+
+  for (int restart = 0; restart < 2; restart++) {
+    db = ReopenDatabase(db_file);
+    EXPECT_EQ(1000 + restart, QueryRows(db, "SELECT a FROM foo10"));
+    std::string sql = "SELECT b FROM foo10 WHERE a = 500";
+    EXPECT_EQ(INDEX_SCAN_EQUAL, QueryIndexNum(db, sql));
+    EXPECT_EQ("x", QueryText(db, sql));
+    EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo10 VALUES(" +
+                                std::to_string(5000 + restart) + ", 'k1')"));
+    EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+    EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  }
+
+  db = ReopenDatabase(db_file);
+  EXPECT_EQ(1002, QueryRows(db, "SELECT a FROM foo10"));
+  EXPECT_EQ("k1", QueryText(db, "SELECT b FROM foo10 WHERE a = 5001"));
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo10"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  RemoveVtableFiles();
+}
+
+TEST(VtableTest, DISABLED_CoveringIndexBenchmark) {
+  const int row_count = 10000;
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo3 USING vtable ('a int, "
+                          "b int, c varchar(16)', 'foo3_b b include(a)')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < row_count; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo3 VALUES(" + std::to_string(i) +
+                                ", " + std::to_string(i) + ", 'payload')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  std::string range = " FROM foo3 WHERE b BETWEEN 0 AND " +
+                      std::to_string(row_count / 2);
+  for (std::string columns : {"SELECT b", "SELECT a, b", "SELECT b, c"}) {
+    std::string sql = columns + range;
+    auto start = std::chrono::steady_clock::now();
+    int64_t rows = QueryRows(db, sql);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << sql << " (idxNum " << QueryIndexNum(db, sql) << "): " << rows
+              << " rows, "
+              << std::chrono::duration<double>(end - start).count() << "s"
+              << std::endl;
+  }
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo3"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+/*
+ * Benchmark: index range scan over a wide (10 columns) table, every column
+ * of every row is read
+ */
+TEST(VtableTest, DISABLED_WideRowScanBenchmark) {
+  const int row_count = 5000;
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo4 USING vtable ('a int, "
+                          "b int, c int, d int, e int, f bigint, g bigint, "
+                          "h bigint, i bigint, j bigint', 'foo4_a a')"));
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < row_count; i++) {
+    std::string row = std::to_string(i);
+    for (int j = 1; j < 10; j++)
+      row += ", " + std::to_string(i * j);
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo4 VALUES(" + row + ")"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  std::string sql = "SELECT * FROM foo4 WHERE a BETWEEN 0 AND " +
+                    std::to_string(row_count);
+  auto start = std::chrono::steady_clock::now();
+  int64_t rows = 0;
+  for (int round = 0; round < 10; round++)
+    rows += QueryRows(db, sql);
+  auto end = std::chrono::steady_clock::now();
+  std::cout << sql << ": " << rows << " rows, "
+            << std::chrono::duration<double>(end - start).count() << "s"
+            << std::endl;
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo4"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
+
+/*
+ * Benchmark: bulk load with INSERT INTO ... SELECT, into a table with a
+ * B+ tree index on a column in random order
+ */
+TEST(VtableTest, DISABLED_BulkInsertBenchmark) {
+  const int row_count = 100000;
+  std::string db_file = "sqlite.db";
+  sqlite3 *db = OpenDatabase(db_file);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo8 USING vtable ('a int, "
+                          "b int, c varchar(16)', 'foo8_b b')"));
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(ExecSQL(db, "WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT "
+                          "x + 1 FROM n WHERE x < " +
+                              std::to_string(row_count) +
+                              ") INSERT INTO foo8 SELECT x, x * 7919 % " +
+                              std::to_string(row_count) +
+                              ", 'bulk payload' FROM n"));
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << row_count << " rows: " << seconds << "s, "
+            << row_count / seconds << " rows/s" << std::endl;
+  EXPECT_EQ(row_count, QueryRows(db, "SELECT b FROM foo8 WHERE b >= 0"));
+
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo8"));
+  EXPECT_EQ(SQLITE_OK, sqlite3_close(db));
+  remove(db_file.c_str());
+  remove("vtable.db");
+}
 } // namespace scudb